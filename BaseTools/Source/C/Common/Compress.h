@@ -20,7 +20,15 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #include <stdlib.h>
 
 #include "CommonLib.h"
+#include "LzMatchFinder.h"
 #include <Common/UefiBaseTypes.h>
+
+//
+// Window sizes of the compression algorithms.
+//
+#define EFI_COMPRESS_WINDOW_BIT     13
+#define TIANO_COMPRESS_WINDOW_BIT   19
+
 /*++
 
 Routine Description:
@@ -39,6 +47,25 @@ TianoCompress (
 
 /*++
 
+Routine Description:
+
+  Tiano compression routine using the given match finder. If the finder
+  has already parsed the same source data its tokens are reused, so the
+  matches of independent sections can be searched in parallel.
+
+--*/
+EFI_STATUS
+TianoCompressEx (
+  IN      LZ_MATCH_FINDER  *Finder,
+  IN      UINT8            *SrcBuffer,
+  IN      UINT32           SrcSize,
+  IN      UINT8            *DstBuffer,
+  IN OUT  UINT32           *DstSize
+  )
+;
+
+/*++
+
 Routine Description:
 
   Efi compression routine.
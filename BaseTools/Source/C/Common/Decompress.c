@@ -56,6 +56,7 @@ typedef struct {
   UINT32  mOrigSize;
 
   UINT16  mBadTableFlag;
+  UINT16  mPBit;      // Number of bits of the Position Set size, differs between Efi and Tiano
 
   UINT16  mLeft[2 * NC - 1];
   UINT16  mRight[2 * NC - 1];
@@ -65,8 +66,6 @@ typedef struct {
   UINT16  mPTTable[256];
 } SCRATCH_DATA;
 
-STATIC UINT16 mPbit = EFIPBIT;
-
 STATIC
 VOID
 FillBuf (
@@ -556,7 +555,7 @@ Returns:
 
     ReadCLen (Sd);
 
-    Sd->mBadTableFlag = ReadPTLen (Sd, MAXNP, mPbit, (UINT16) (-1));
+    Sd->mBadTableFlag = ReadPTLen (Sd, MAXNP, Sd->mPBit, (UINT16) (-1));
     if (Sd->mBadTableFlag != 0) {
       return 0;
     }
@@ -700,7 +699,8 @@ Decompress (
   IN OUT  VOID    *Destination,
   IN      UINT32  DstSize,
   IN OUT  VOID    *Scratch,
-  IN      UINT32  ScratchSize
+  IN      UINT32  ScratchSize,
+  IN      UINT16  PBit
   )
 /*++
 
@@ -716,6 +716,7 @@ Arguments:
   DstSize     - The size of destination buffer.
   Scratch     - The buffer used internally by the decompress routine. This  buffer is needed to store intermediate data.
   ScratchSize - The size of scratch buffer.
+  PBit        - The number of bits of the Position Set size.
 
 Returns:
 
@@ -767,6 +768,7 @@ Returns:
   Sd->mDstBase  = Dst;
   Sd->mCompSize = CompSize;
   Sd->mOrigSize = OrigSize;
+  Sd->mPBit     = PBit;
 
   //
   // Fill the first BITBUFSIZ bits
@@ -879,8 +881,7 @@ Returns:
 
 --*/
 {
-  mPbit = EFIPBIT;
-  return Decompress (Source, SrcSize, Destination, DstSize, Scratch, ScratchSize);
+  return Decompress (Source, SrcSize, Destination, DstSize, Scratch, ScratchSize, EFIPBIT);
 }
 
 EFI_STATUS
@@ -914,8 +915,7 @@ Returns:
 
 --*/
 {
-  mPbit = MAXPBIT;
-  return Decompress (Source, SrcSize, Destination, DstSize, Scratch, ScratchSize);
+  return Decompress (Source, SrcSize, Destination, DstSize, Scratch, ScratchSize, MAXPBIT);
 }
 
 EFI_STATUS
@@ -0,0 +1,581 @@
+/** @file
+LZ77 match finder shared by the EFI and Tiano compressors.
+
+Matches are searched either through hash chains, visiting a bounded number
+of earlier positions with the same hash, or through binary trees sorted by
+the following characters, which find the longest match with fewer
+comparisons on repetitive data. The parse is lazy: a match is only taken if
+the next position doesn't start a longer one.
+
+Copyright (c) 2015, Intel Corporation. All rights reserved.<BR>
+This program and the accompanying materials
+are licensed and made available under the terms and conditions of the BSD License
+which accompanies this distribution.  The full text of the license may be found at
+http://opensource.org/licenses/bsd-license.php
+
+THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+**/
+
+#include <stdlib.h>
+#include <string.h>
+#include "LzMatchFinder.h"
+
+#define LZ_HASH_BIT   16
+#define LZ_HASH_SIZE  (1U << LZ_HASH_BIT)
+#define LZ_HASH(p)    ((((UINT32) (p)[0] | ((UINT32) (p)[1] << 8) | ((UINT32) (p)[2] << 16)) * 2654435761U) >> (32 - LZ_HASH_BIT))
+
+//
+// A minimum length match this far away costs more bits than its characters.
+//
+#define LZ_TOO_FAR    ((1U << 11) + 1)
+
+//
+// When looking for a better match than one this long, a quarter of the
+// hash chain is searched.
+//
+#define LZ_GOOD_MATCH 32
+
+STATIC CONST LZ_MATCH_FINDER_CONFIG mLzDefaultConfig = {
+  LzHashChain,
+  LZ_HASH_CHAIN_DEPTH,
+  LZ_MAX_MATCH,
+  LZ_MAX_MATCH
+};
+
+STATIC
+UINT32
+MatchLength (
+  IN CONST UINT8  *Match,
+  IN CONST UINT8  *Cur,
+  IN UINT32       Len,
+  IN UINT32       Limit
+  )
+/*++
+
+Routine Description:
+
+  Extend a match as far as the strings agree, eight characters at a time.
+
+Arguments:
+
+  Match       - The earlier string
+  Cur         - The string at the current position
+  Len         - The length already known to match
+  Limit       - The maximum length of the match
+
+Returns:
+
+  The length of the match.
+
+--*/
+{
+  UINT64  Word1;
+  UINT64  Word2;
+
+  while (Len + sizeof (UINT64) <= Limit) {
+    memcpy (&Word1, Match + Len, sizeof (UINT64));
+    memcpy (&Word2, Cur + Len, sizeof (UINT64));
+    if (Word1 != Word2) {
+      break;
+    }
+    Len += sizeof (UINT64);
+  }
+
+  while (Len < Limit && Match[Len] == Cur[Len]) {
+    Len++;
+  }
+
+  return Len;
+}
+
+typedef
+UINT32
+(*LZ_FIND_MATCH) (
+  IN OUT LZ_MATCH_FINDER  *Finder,
+  IN     UINT32           Pos,
+  IN     UINT32           PrevLen,
+  OUT    UINT32           *Distance
+  );
+
+STATIC
+UINT32
+HashChainFind (
+  IN OUT LZ_MATCH_FINDER  *Finder,
+  IN     UINT32           Pos,
+  IN     UINT32           PrevLen,
+  OUT    UINT32           *Distance
+  )
+/*++
+
+Routine Description:
+
+  Find the longest match for a position by walking its hash chain, and
+  insert the position at the head of the chain.
+
+Arguments:
+
+  Finder      - The match finder
+  Pos         - The position in the source data
+  PrevLen     - Only matches longer than this are of interest
+  Distance    - The distance to the match
+
+Returns:
+
+  The length of the match, 0 if no match longer than both PrevLen and
+  LZ_MIN_MATCH - 1 is found.
+
+--*/
+{
+  UINT8   *Cur;
+  UINT8   *Match;
+  UINT32  Window;
+  UINT32  Limit;
+  UINT32  Hash;
+  UINT32  Candidate;
+  UINT32  Depth;
+  UINT32  Len;
+  UINT32  Best;
+  UINT32  Result;
+
+  Limit = Finder->SrcSize - Pos;
+  if (Limit < LZ_MIN_MATCH) {
+    return 0;
+  }
+  if (Limit > LZ_MAX_MATCH) {
+    Limit = LZ_MAX_MATCH;
+  }
+
+  Window    = 1U << Finder->WindowBits;
+  Cur       = Finder->Src + Pos;
+  Hash      = LZ_HASH (Cur);
+  Candidate = Finder->Head[Hash];
+  Depth     = Finder->Config.MaxDepth;
+  Best      = MAX (LZ_MIN_MATCH - 1, PrevLen);
+  Result    = 0;
+
+  if (PrevLen >= LZ_GOOD_MATCH) {
+    Depth = (Depth + 3) / 4;
+  }
+
+  while (Best < Limit && Candidate != 0 && Depth-- > 0 && Pos - (Candidate - 1) < Window) {
+    Match = Finder->Src + Candidate - 1;
+    if (Match[Best] == Cur[Best] && Match[0] == Cur[0] && Match[1] == Cur[1]) {
+      Len = MatchLength (Match, Cur, 2, Limit);
+      if (Len > Best) {
+        Best      = Len;
+        Result    = Len;
+        *Distance = Pos - (Candidate - 1);
+        if (Len >= Finder->Config.NiceLength) {
+          break;
+        }
+      }
+    }
+    Candidate = Finder->Link[(Candidate - 1) & Finder->LinkMask];
+  }
+
+  Finder->Link[Pos & Finder->LinkMask] = Finder->Head[Hash];
+  Finder->Head[Hash] = Pos + 1;
+
+  return Result;
+}
+
+STATIC
+UINT32
+BinaryTreeFind (
+  IN OUT LZ_MATCH_FINDER  *Finder,
+  IN     UINT32           Pos,
+  IN     UINT32           PrevLen,
+  OUT    UINT32           *Distance
+  )
+/*++
+
+Routine Description:
+
+  Find the longest match for a position by descending its binary tree, and
+  make the position the new root of the tree. The whole path is walked to
+  keep the tree sorted, whatever the length of the previous match.
+
+Arguments:
+
+  Finder      - The match finder
+  Pos         - The position in the source data
+  PrevLen     - Only matches longer than this are of interest
+  Distance    - The distance to the match
+
+Returns:
+
+  The length of the match, 0 if no match longer than both PrevLen and
+  LZ_MIN_MATCH - 1 is found.
+
+--*/
+{
+  UINT8   *Cur;
+  UINT8   *Match;
+  UINT32  *Pair;
+  UINT32  *Smaller;
+  UINT32  *Larger;
+  UINT32  Window;
+  UINT32  Limit;
+  UINT32  Hash;
+  UINT32  Candidate;
+  UINT32  Depth;
+  UINT32  Len;
+  UINT32  SmallerLen;
+  UINT32  LargerLen;
+  UINT32  Best;
+  UINT32  Result;
+
+  Limit = Finder->SrcSize - Pos;
+  if (Limit < LZ_MIN_MATCH) {
+    return 0;
+  }
+  if (Limit > LZ_MAX_MATCH) {
+    Limit = LZ_MAX_MATCH;
+  }
+
+  Window    = 1U << Finder->WindowBits;
+  Cur       = Finder->Src + Pos;
+  Hash      = LZ_HASH (Cur);
+  Candidate = Finder->Head[Hash];
+  Depth     = Finder->Config.MaxDepth;
+  Best      = MAX (LZ_MIN_MATCH - 1, PrevLen);
+  Result    = 0;
+
+  Finder->Head[Hash] = Pos + 1;
+  Smaller    = &Finder->Link[(Pos & Finder->LinkMask) << 1];
+  Larger     = Smaller + 1;
+  SmallerLen = 0;
+  LargerLen  = 0;
+
+  for (;;) {
+    if (Candidate == 0 || Depth-- == 0 || Pos - (Candidate - 1) >= Window) {
+      *Smaller = 0;
+      *Larger  = 0;
+      break;
+    }
+
+    Pair  = &Finder->Link[((Candidate - 1) & Finder->LinkMask) << 1];
+    Match = Finder->Src + Candidate - 1;
+
+    //
+    // All strings in the subtree share the shorter of the two prefixes
+    // already matched on the way down.
+    //
+    Len = MatchLength (Match, Cur, MIN (SmallerLen, LargerLen), Limit);
+    if (Len > Best) {
+      Best      = Len;
+      Result    = Len;
+      *Distance = Pos - (Candidate - 1);
+    }
+
+    if (Len == Limit) {
+      //
+      // The candidate is replaced by the current position in the tree.
+      //
+      *Smaller = Pair[0];
+      *Larger  = Pair[1];
+      break;
+    }
+
+    if (Match[Len] < Cur[Len]) {
+      *Smaller   = Candidate;
+      Smaller    = &Pair[1];
+      Candidate  = *Smaller;
+      SmallerLen = Len;
+    } else {
+      *Larger    = Candidate;
+      Larger     = &Pair[0];
+      Candidate  = *Larger;
+      LargerLen  = Len;
+    }
+  }
+
+  return Result;
+}
+
+STATIC
+VOID
+HashChainInsert (
+  IN OUT LZ_MATCH_FINDER  *Finder,
+  IN     UINT32           Pos
+  )
+/*++
+
+Routine Description:
+
+  Insert a position covered by a match into its hash chain.
+
+Arguments:
+
+  Finder      - The match finder
+  Pos         - The position in the source data
+
+Returns: (VOID)
+
+--*/
+{
+  UINT32  Hash;
+
+  if (Finder->SrcSize - Pos >= LZ_MIN_MATCH) {
+    Hash = LZ_HASH (Finder->Src + Pos);
+    Finder->Link[Pos & Finder->LinkMask] = Finder->Head[Hash];
+    Finder->Head[Hash] = Pos + 1;
+  }
+}
+
+STATIC
+EFI_STATUS
+AllocateTables (
+  IN OUT LZ_MATCH_FINDER  *Finder,
+  IN     UINT32           SrcSize
+  )
+/*++
+
+Routine Description:
+
+  Make sure the tables of the match finder are big enough for the source
+  data, reusing the memory of earlier calls.
+
+Arguments:
+
+  Finder      - The match finder
+  SrcSize     - The size of source data
+
+Returns:
+
+  EFI_SUCCESS           - The tables are allocated
+  EFI_OUT_OF_RESOURCES  - Allocation fails
+
+--*/
+{
+  UINT32  Entries;
+  UINT32  LinkSize;
+  VOID    *Buffer;
+
+  //
+  // Positions only wrap around in the Link table if the data is bigger
+  // than the window.
+  //
+  Entries = 1U << Finder->WindowBits;
+  while (Entries > 1 && Entries / 2 >= SrcSize) {
+    Entries /= 2;
+  }
+  Finder->LinkMask = Entries - 1;
+  LinkSize = Finder->Config.Type == LzBinaryTree ? Entries * 2 : Entries;
+
+  if (Finder->Head == NULL) {
+    Finder->Head = malloc (LZ_HASH_SIZE * sizeof (*Finder->Head));
+    if (Finder->Head == NULL) {
+      return EFI_OUT_OF_RESOURCES;
+    }
+  }
+
+  if (LinkSize > Finder->LinkSize) {
+    Buffer = realloc (Finder->Link, LinkSize * sizeof (*Finder->Link));
+    if (Buffer == NULL) {
+      return EFI_OUT_OF_RESOURCES;
+    }
+    Finder->Link     = Buffer;
+    Finder->LinkSize = LinkSize;
+  }
+
+  //
+  // At most one token is produced per character.
+  //
+  if (SrcSize + 1 > Finder->SrcBufferSize) {
+    Buffer = realloc (Finder->Src, SrcSize + 1);
+    if (Buffer == NULL) {
+      return EFI_OUT_OF_RESOURCES;
+    }
+    Finder->Src           = Buffer;
+    Finder->SrcBufferSize = SrcSize + 1;
+
+    Buffer = realloc (Finder->Tokens, (SrcSize + 1) * sizeof (*Finder->Tokens));
+    if (Buffer == NULL) {
+      return EFI_OUT_OF_RESOURCES;
+    }
+    Finder->Tokens          = Buffer;
+    Finder->TokenBufferSize = SrcSize + 1;
+  }
+
+  return EFI_SUCCESS;
+}
+
+VOID
+LzMatchFinderInit (
+  OUT LZ_MATCH_FINDER               *Finder,
+  IN  CONST LZ_MATCH_FINDER_CONFIG  *Config  OPTIONAL
+  )
+/*++
+
+Routine Description:
+
+  Initialize a match finder. No memory is allocated until the first parse.
+
+Arguments:
+
+  Finder      - The match finder to initialize
+  Config      - The search parameters, NULL for the defaults
+
+Returns: (VOID)
+
+--*/
+{
+  memset (Finder, 0, sizeof (*Finder));
+  Finder->Config = (Config != NULL) ? *Config : mLzDefaultConfig;
+  if (Finder->Config.MaxDepth == 0) {
+    Finder->Config.MaxDepth = 1;
+  }
+}
+
+VOID
+LzMatchFinderFree (
+  IN OUT LZ_MATCH_FINDER  *Finder
+  )
+/*++
+
+Routine Description:
+
+  Free the memory held by a match finder.
+
+Arguments:
+
+  Finder      - The match finder
+
+Returns: (VOID)
+
+--*/
+{
+  free (Finder->Head);
+  free (Finder->Link);
+  free (Finder->Src);
+  free (Finder->Tokens);
+  LzMatchFinderInit (Finder, &Finder->Config);
+}
+
+EFI_STATUS
+LzMatchFinderParse (
+  IN OUT LZ_MATCH_FINDER  *Finder,
+  IN     UINT32           WindowBits,
+  IN     CONST UINT8      *SrcBuffer,
+  IN     UINT32           SrcSize
+  )
+/*++
+
+Routine Description:
+
+  Parse the source data into tokens, with a window of 2^WindowBits bytes.
+  The tokens of the previous call are kept when the source data and the
+  window are the same.
+
+  Different match finders may be used by different threads concurrently.
+
+Arguments:
+
+  Finder      - The match finder
+  WindowBits  - The number of bits of the window size
+  SrcBuffer   - The buffer storing the source data
+  SrcSize     - The size of source data
+
+Returns:
+
+  EFI_SUCCESS           - Finder->Tokens holds Finder->TokenCount tokens
+  EFI_OUT_OF_RESOURCES  - Not enough memory for the search tables
+  EFI_INVALID_PARAMETER - WindowBits is out of range
+
+--*/
+{
+  EFI_STATUS     Status;
+  LZ_FIND_MATCH  Find;
+  UINT32         *Tokens;
+  UINT32         Pos;
+  UINT32         Len;
+  UINT32         Distance;
+  UINT32         NextLen;
+  UINT32         NextDistance;
+  UINT32         Next;
+  UINT32         End;
+
+  if (WindowBits == 0 || WindowBits > LZ_MAX_WINDOW_BIT) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (Finder->Valid &&
+      Finder->WindowBits == WindowBits &&
+      Finder->SrcSize == SrcSize &&
+      memcmp (Finder->Src, SrcBuffer, SrcSize) == 0) {
+    return EFI_SUCCESS;
+  }
+
+  Finder->Valid      = FALSE;
+  Finder->WindowBits = WindowBits;
+  Status = AllocateTables (Finder, SrcSize);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  memcpy (Finder->Src, SrcBuffer, SrcSize);
+  Finder->SrcSize = SrcSize;
+  memset (Finder->Head, 0, LZ_HASH_SIZE * sizeof (*Finder->Head));
+
+  Find     = (Finder->Config.Type == LzBinaryTree) ? BinaryTreeFind : HashChainFind;
+  Tokens   = Finder->Tokens;
+  Distance = 0;
+  Pos      = 0;
+  Len      = (SrcSize > 0) ? Find (Finder, Pos, 0, &Distance) : 0;
+
+  while (Pos < SrcSize) {
+    if (Len == LZ_MIN_MATCH && Distance > LZ_TOO_FAR) {
+      Len = 0;
+    }
+
+    if (Len == 0) {
+      *Tokens++ = Finder->Src[Pos++];
+      if (Pos < SrcSize) {
+        Len = Find (Finder, Pos, 0, &Distance);
+      }
+      continue;
+    }
+
+    //
+    // Defer the match if the next position starts a longer one.
+    //
+    Next = Pos + 1;
+    if (Len < Finder->Config.LazyLength) {
+      NextLen = Find (Finder, Pos + 1, Len, &NextDistance);
+      if (NextLen > Len) {
+        *Tokens++ = Finder->Src[Pos++];
+        Len       = NextLen;
+        Distance  = NextDistance;
+        continue;
+      }
+      Next = Pos + 2;
+    }
+
+    *Tokens++ = LZ_TOKEN_POINTER (Len, Distance - 1);
+
+    //
+    // The other positions covered by the match still have to enter the
+    // tables.
+    //
+    End = Pos + Len;
+    for (Pos = Next; Pos < End; Pos++) {
+      if (Finder->Config.Type == LzBinaryTree) {
+        BinaryTreeFind (Finder, Pos, LZ_MAX_MATCH, &NextDistance);
+      } else {
+        HashChainInsert (Finder, Pos);
+      }
+    }
+
+    if (Pos < SrcSize) {
+      Len = Find (Finder, Pos, 0, &Distance);
+    }
+  }
+
+  Finder->TokenCount = (UINT32) (Tokens - Finder->Tokens);
+  Finder->Valid      = TRUE;
+
+  return EFI_SUCCESS;
+}
@@ -0,0 +1,157 @@
+/** @file
+Header file for the LZ77 match finder shared by the EFI and Tiano compressors.
+
+The match finder turns the source data into a sequence of tokens, each one
+either an original character or a pointer to a repeated string. It keeps its
+tables and the last parsed input between calls, so compressing the same data
+twice (e.g. once to query the size and once into a big enough buffer) only
+searches for matches once.
+
+Copyright (c) 2015, Intel Corporation. All rights reserved.<BR>
+This program and the accompanying materials
+are licensed and made available under the terms and conditions of the BSD License
+which accompanies this distribution.  The full text of the license may be found at
+http://opensource.org/licenses/bsd-license.php
+
+THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+**/
+
+#ifndef _LZ_MATCH_FINDER_H_
+#define _LZ_MATCH_FINDER_H_
+
+#include <Common/UefiBaseTypes.h>
+
+#define LZ_MIN_MATCH          3
+#define LZ_MAX_MATCH          256
+#define LZ_MAX_WINDOW_BIT     20
+
+//
+// Default number of candidates visited per position by each match finder.
+//
+#define LZ_HASH_CHAIN_DEPTH   256
+#define LZ_BINARY_TREE_DEPTH  32
+
+//
+// A token is either an original character (value below 256), or a pointer
+// with the string length in the upper bits and the distance minus one, as
+// stored in the Position Set, in the lower LZ_MAX_WINDOW_BIT bits.
+//
+#define LZ_TOKEN_IS_POINTER(t)   ((t) > 0xff)
+#define LZ_TOKEN_LENGTH(t)       ((t) >> LZ_MAX_WINDOW_BIT)
+#define LZ_TOKEN_POSITION(t)     ((t) & ((1U << LZ_MAX_WINDOW_BIT) - 1))
+#define LZ_TOKEN_POINTER(l, p)   (((UINT32) (l) << LZ_MAX_WINDOW_BIT) | (UINT32) (p))
+
+typedef enum {
+  LzHashChain,
+  LzBinaryTree
+} LZ_MATCH_FINDER_TYPE;
+
+typedef struct {
+  LZ_MATCH_FINDER_TYPE  Type;
+  UINT32                MaxDepth;     // Candidates visited per position
+  UINT32                NiceLength;   // Stop searching once a match is this long
+  UINT32                LazyLength;   // Only look for a better match at the next position below this length
+} LZ_MATCH_FINDER_CONFIG;
+
+typedef struct {
+  LZ_MATCH_FINDER_CONFIG  Config;
+
+  //
+  // Search tables, kept across calls. Head is indexed by the hash of the
+  // next LZ_MIN_MATCH characters, Link by position modulo the window size:
+  // one entry per position for hash chains, two for the binary tree.
+  //
+  UINT32                  WindowBits;
+  UINT32                  *Head;
+  UINT32                  *Link;
+  UINT32                  LinkSize;
+  UINT32                  LinkMask;
+
+  //
+  // The last parsed input and its tokens.
+  //
+  UINT8                   *Src;
+  UINT32                  SrcSize;
+  UINT32                  SrcBufferSize;
+  UINT32                  *Tokens;
+  UINT32                  TokenCount;
+  UINT32                  TokenBufferSize;
+  BOOLEAN                 Valid;
+} LZ_MATCH_FINDER;
+
+VOID
+LzMatchFinderInit (
+  OUT LZ_MATCH_FINDER               *Finder,
+  IN  CONST LZ_MATCH_FINDER_CONFIG  *Config  OPTIONAL
+  )
+/*++
+
+Routine Description:
+
+  Initialize a match finder. No memory is allocated until the first parse.
+
+Arguments:
+
+  Finder      - The match finder to initialize
+  Config      - The search parameters, NULL for the defaults
+
+Returns: (VOID)
+
+--*/
+;
+
+VOID
+LzMatchFinderFree (
+  IN OUT LZ_MATCH_FINDER  *Finder
+  )
+/*++
+
+Routine Description:
+
+  Free the memory held by a match finder.
+
+Arguments:
+
+  Finder      - The match finder
+
+Returns: (VOID)
+
+--*/
+;
+
+EFI_STATUS
+LzMatchFinderParse (
+  IN OUT LZ_MATCH_FINDER  *Finder,
+  IN     UINT32           WindowBits,
+  IN     CONST UINT8      *SrcBuffer,
+  IN     UINT32           SrcSize
+  )
+/*++
+
+Routine Description:
+
+  Parse the source data into tokens, with a window of 2^WindowBits bytes.
+  The tokens of the previous call are kept when the source data and the
+  window are the same.
+
+  Different match finders may be used by different threads concurrently.
+
+Arguments:
+
+  Finder      - The match finder
+  WindowBits  - The number of bits of the window size
+  SrcBuffer   - The buffer storing the source data
+  SrcSize     - The size of source data
+
+Returns:
+
+  EFI_SUCCESS           - Finder->Tokens holds Finder->TokenCount tokens
+  EFI_OUT_OF_RESOURCES  - Not enough memory for the search tables
+  EFI_INVALID_PARAMETER - WindowBits is out of range
+
+--*/
+;
+
+#endif
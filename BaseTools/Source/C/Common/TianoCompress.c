@@ -21,22 +21,14 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 // Macro Definitions
 //
 #undef  UINT8_MAX
-typedef INT32 NODE;
 #define UINT8_MAX     0xff
 #define UINT8_BIT     8
-#define THRESHOLD     3
-#define INIT_CRC      0
-#define WNDBIT        19
+#define THRESHOLD     LZ_MIN_MATCH
+#define WNDBIT        TIANO_COMPRESS_WINDOW_BIT
 #define WNDSIZ        (1U << WNDBIT)
-#define MAXMATCH      256
+#define MAXMATCH      LZ_MAX_MATCH
 #define BLKSIZ        (1U << 14)  // 16 * 1024U
-#define PERC_FLAG     0x80000000U
 #define CODE_BIT      16
-#define NIL           0
-#define MAX_HASH_VAL  (3 * WNDSIZ + (WNDSIZ / 512 + 1) * UINT8_MAX)
-#define HASH(p, c)    ((p) + ((c) << (WNDBIT - 9)) + WNDSIZ * 2)
-#define CRCPOLY       0xA001
-#define UPDATE_CRC(c) mCrc = mCrcTable[(mCrc ^ (c)) & 0xFF] ^ (mCrc >> UINT8_BIT)
 
 //
 // C: the Char&Len Set; P: the Position Set; T: the exTra Set
@@ -68,61 +60,12 @@ AllocateMemory (
   VOID
   );
 
-STATIC
-VOID
-FreeMemory (
-  VOID
-  );
-
-STATIC
-VOID
-InitSlide (
-  VOID
-  );
-
-STATIC
-NODE
-Child (
-  IN NODE   NodeQ,
-  IN UINT8  CharC
-  );
-
-STATIC
-VOID
-MakeChild (
-  IN NODE  NodeQ,
-  IN UINT8 CharC,
-  IN NODE  NodeR
-  );
-
-STATIC
-VOID
-Split (
-  IN NODE Old
-  );
-
-STATIC
-VOID
-InsertNode (
-  VOID
-  );
-
-STATIC
-VOID
-DeleteNode (
-  VOID
-  );
-
-STATIC
-VOID
-GetNextMatch (
-  VOID
-  );
-
 STATIC
 EFI_STATUS
 Encode (
-  VOID
+  IN LZ_MATCH_FINDER  *Finder,
+  IN UINT8            *SrcBuffer,
+  IN UINT32           SrcSize
   );
 
 STATIC
@@ -182,12 +125,6 @@ HufEncodeEnd (
   VOID
   );
 
-STATIC
-VOID
-MakeCrcTable (
-  VOID
-  );
-
 STATIC
 VOID
 PutBits (
@@ -195,13 +132,6 @@ PutBits (
   IN UINT32 Value
   );
 
-STATIC
-INT32
-FreadCrc (
-  OUT UINT8 *Pointer,
-  IN  INT32 Number
-  );
-
 STATIC
 VOID
 InitPutBits (
@@ -246,18 +176,22 @@ MakeTree (
 //
 //  Global Variables
 //
-STATIC UINT8  *mSrc, *mDst, *mSrcUpperLimit, *mDstUpperLimit;
+STATIC UINT8  *mDst, *mDstUpperLimit;
 
-STATIC UINT8  *mLevel, *mText, *mChildCount, *mBuf, mCLen[NC], mPTLen[NPT], *mLen;
+STATIC UINT8  *mBuf, mCLen[NC], mPTLen[NPT], *mLen;
 STATIC INT16  mHeap[NC + 1];
-STATIC INT32  mRemainder, mMatchLen, mBitCount, mHeapSize, mN;
-STATIC UINT32 mBufSiz = 0, mOutputPos, mOutputMask, mSubBitBuf, mCrc;
+STATIC INT32  mBitCount, mHeapSize, mN;
+STATIC UINT32 mBufSiz = 0, mOutputPos, mOutputMask, mSubBitBuf;
 STATIC UINT32 mCompSize, mOrigSize;
 
-STATIC UINT16 *mFreq, *mSortPtr, mLenCnt[17], mLeft[2 * NC - 1], mRight[2 * NC - 1], mCrcTable[UINT8_MAX + 1],
+STATIC UINT16 *mFreq, *mSortPtr, mLenCnt[17], mLeft[2 * NC - 1], mRight[2 * NC - 1],
   mCFreq[2 * NC - 1], mCCode[NC], mPFreq[2 * NP - 1], mPTCode[NPT], mTFreq[2 * NT - 1];
 
-STATIC NODE   mPos, mMatchPos, mAvail, *mPosition, *mParent, *mPrev, *mNext = NULL;
+//
+// The match finder of TianoCompress(), kept with its tables between calls.
+//
+STATIC LZ_MATCH_FINDER  mMatchFinder;
+STATIC BOOLEAN          mMatchFinderInitialized = FALSE;
 
 //
 // functions
@@ -294,6 +228,48 @@ Returns:
   EFI_OUT_OF_RESOURCES  - No resource to complete function.
   EFI_INVALID_PARAMETER - Parameter supplied is wrong.
 
+--*/
+{
+  if (!mMatchFinderInitialized) {
+    LzMatchFinderInit (&mMatchFinder, NULL);
+    mMatchFinderInitialized = TRUE;
+  }
+
+  return TianoCompressEx (&mMatchFinder, SrcBuffer, SrcSize, DstBuffer, DstSize);
+}
+
+EFI_STATUS
+TianoCompressEx (
+  IN      LZ_MATCH_FINDER  *Finder,
+  IN      UINT8            *SrcBuffer,
+  IN      UINT32           SrcSize,
+  IN      UINT8            *DstBuffer,
+  IN OUT  UINT32           *DstSize
+  )
+/*++
+
+Routine Description:
+
+  Tiano compression routine using the given match finder. If the finder
+  has already parsed the same source data, e.g. in a worker thread or in
+  an earlier call to get the size, its tokens are reused.
+
+Arguments:
+
+  Finder      - The match finder
+  SrcBuffer   - The buffer storing the source data
+  SrcSize     - The size of source data
+  DstBuffer   - The buffer to store the compressed data
+  DstSize     - On input, the size of DstBuffer; On output,
+                the size of the actual compressed data.
+
+Returns:
+
+  EFI_BUFFER_TOO_SMALL  - The DstBuffer is too small. In this case,
+                DstSize contains the size needed.
+  EFI_SUCCESS           - Compression is successful.
+  EFI_OUT_OF_RESOURCES  - No resource to complete function.
+
 --*/
 {
   EFI_STATUS  Status;
@@ -301,33 +277,18 @@ Returns:
   //
   // Initializations
   //
-  mBufSiz         = 0;
-  mBuf            = NULL;
-  mText           = NULL;
-  mLevel          = NULL;
-  mChildCount     = NULL;
-  mPosition       = NULL;
-  mParent         = NULL;
-  mPrev           = NULL;
-  mNext           = NULL;
-
-  mSrc            = SrcBuffer;
-  mSrcUpperLimit  = mSrc + SrcSize;
   mDst            = DstBuffer;
   mDstUpperLimit  = mDst +*DstSize;
 
   PutDword (0L);
   PutDword (0L);
 
-  MakeCrcTable ();
-
   mOrigSize             = mCompSize = 0;
-  mCrc                  = INIT_CRC;
 
   //
   // Compress it
   //
-  Status = Encode ();
+  Status = Encode (Finder, SrcBuffer, SrcSize);
   if (EFI_ERROR (Status)) {
     return EFI_OUT_OF_RESOURCES;
   }
@@ -402,7 +363,8 @@ AllocateMemory (
 
 Routine Description:
 
-  Allocate memory spaces for data structures used in compression process
+  Allocate the block buffer used in compression process, unless an earlier
+  call already did.
   
 Argements: 
   VOID
@@ -414,20 +376,10 @@ Returns:
 
 --*/
 {
-  UINT32  Index;
-
-  mText = malloc (WNDSIZ * 2 + MAXMATCH);
-  for (Index = 0; Index < WNDSIZ * 2 + MAXMATCH; Index++) {
-    mText[Index] = 0;
+  if (mBuf != NULL) {
+    return EFI_SUCCESS;
   }
 
-  mLevel      = malloc ((WNDSIZ + UINT8_MAX + 1) * sizeof (*mLevel));
-  mChildCount = malloc ((WNDSIZ + UINT8_MAX + 1) * sizeof (*mChildCount));
-  mPosition   = malloc ((WNDSIZ + UINT8_MAX + 1) * sizeof (*mPosition));
-  mParent     = malloc (WNDSIZ * 2 * sizeof (*mParent));
-  mPrev       = malloc (WNDSIZ * 2 * sizeof (*mPrev));
-  mNext       = malloc ((MAX_HASH_VAL + 1) * sizeof (*mNext));
-
   mBufSiz     = BLKSIZ;
   mBuf        = malloc (mBufSiz);
   while (mBuf == NULL) {
@@ -444,471 +396,12 @@ Returns:
   return EFI_SUCCESS;
 }
 
-VOID
-FreeMemory (
-  VOID
-  )
-/*++
-
-Routine Description:
-
-  Called when compression is completed to free memory previously allocated.
-  
-Arguments: (VOID)
-
-Returns: (VOID)
-
---*/
-{
-  if (mText != NULL) {
-    free (mText);
-  }
-
-  if (mLevel != NULL) {
-    free (mLevel);
-  }
-
-  if (mChildCount != NULL) {
-    free (mChildCount);
-  }
-
-  if (mPosition != NULL) {
-    free (mPosition);
-  }
-
-  if (mParent != NULL) {
-    free (mParent);
-  }
-
-  if (mPrev != NULL) {
-    free (mPrev);
-  }
-
-  if (mNext != NULL) {
-    free (mNext);
-  }
-
-  if (mBuf != NULL) {
-    free (mBuf);
-  }
-
-  return ;
-}
-
-STATIC
-VOID
-InitSlide (
-  VOID
-  )
-/*++
-
-Routine Description:
-
-  Initialize String Info Log data structures
-  
-Arguments: (VOID)
-
-Returns: (VOID)
-
---*/
-{
-  NODE  Index;
-
-  for (Index = WNDSIZ; Index <= WNDSIZ + UINT8_MAX; Index++) {
-    mLevel[Index]     = 1;
-    mPosition[Index]  = NIL;  /* sentinel */
-  }
-
-  for (Index = WNDSIZ; Index < WNDSIZ * 2; Index++) {
-    mParent[Index] = NIL;
-  }
-
-  mAvail = 1;
-  for (Index = 1; Index < WNDSIZ - 1; Index++) {
-    mNext[Index] = (NODE) (Index + 1);
-  }
-
-  mNext[WNDSIZ - 1] = NIL;
-  for (Index = WNDSIZ * 2; Index <= MAX_HASH_VAL; Index++) {
-    mNext[Index] = NIL;
-  }
-}
-
-STATIC
-NODE
-Child (
-  IN NODE  NodeQ,
-  IN UINT8 CharC
-  )
-/*++
-
-Routine Description:
-
-  Find child node given the parent node and the edge character
-  
-Arguments:
-
-  NodeQ       - the parent node
-  CharC       - the edge character
-  
-Returns:
-
-  The child node (NIL if not found)  
-  
---*/
-{
-  NODE  NodeR;
-
-  NodeR = mNext[HASH (NodeQ, CharC)];
-  //
-  // sentinel
-  //
-  mParent[NIL] = NodeQ;
-  while (mParent[NodeR] != NodeQ) {
-    NodeR = mNext[NodeR];
-  }
-
-  return NodeR;
-}
-
-STATIC
-VOID
-MakeChild (
-  IN NODE  Parent,
-  IN UINT8 CharC,
-  IN NODE  Child
-  )
-/*++
-
-Routine Description:
-
-  Create a new child for a given parent node.
-  
-Arguments:
-
-  Parent       - the parent node
-  CharC   - the edge character
-  Child       - the child node
-  
-Returns: (VOID)
-
---*/
-{
-  NODE  Node1;
-  NODE  Node2;
-
-  Node1           = (NODE) HASH (Parent, CharC);
-  Node2           = mNext[Node1];
-  mNext[Node1]    = Child;
-  mNext[Child]    = Node2;
-  mPrev[Node2]    = Child;
-  mPrev[Child]    = Node1;
-  mParent[Child]  = Parent;
-  mChildCount[Parent]++;
-}
-
-STATIC
-VOID
-Split (
-  NODE Old
-  )
-/*++
-
-Routine Description:
-
-  Split a node.
-  
-Arguments:
-
-  Old     - the node to split
-  
-Returns: (VOID)
-
---*/
-{
-  NODE  New;
-  NODE  TempNode;
-
-  New               = mAvail;
-  mAvail            = mNext[New];
-  mChildCount[New]  = 0;
-  TempNode          = mPrev[Old];
-  mPrev[New]        = TempNode;
-  mNext[TempNode]   = New;
-  TempNode          = mNext[Old];
-  mNext[New]        = TempNode;
-  mPrev[TempNode]   = New;
-  mParent[New]      = mParent[Old];
-  mLevel[New]       = (UINT8) mMatchLen;
-  mPosition[New]    = mPos;
-  MakeChild (New, mText[mMatchPos + mMatchLen], Old);
-  MakeChild (New, mText[mPos + mMatchLen], mPos);
-}
-
-STATIC
-VOID
-InsertNode (
-  VOID
-  )
-/*++
-
-Routine Description:
-
-  Insert string info for current position into the String Info Log
-  
-Arguments: (VOID)
-
-Returns: (VOID)
-
---*/
-{
-  NODE  NodeQ;
-  NODE  NodeR;
-  NODE  Index2;
-  NODE  NodeT;
-  UINT8 CharC;
-  UINT8 *t1;
-  UINT8 *t2;
-
-  if (mMatchLen >= 4) {
-    //
-    // We have just got a long match, the target tree
-    // can be located by MatchPos + 1. Travese the tree
-    // from bottom up to get to a proper starting point.
-    // The usage of PERC_FLAG ensures proper node deletion
-    // in DeleteNode() later.
-    //
-    mMatchLen--;
-    NodeR = (NODE) ((mMatchPos + 1) | WNDSIZ);
-    NodeQ = mParent[NodeR];
-    while (NodeQ == NIL) {
-      NodeR = mNext[NodeR];
-      NodeQ = mParent[NodeR];
-    }
-
-    while (mLevel[NodeQ] >= mMatchLen) {
-      NodeR = NodeQ;
-      NodeQ = mParent[NodeQ];
-    }
-
-    NodeT = NodeQ;
-    while (mPosition[NodeT] < 0) {
-      mPosition[NodeT]  = mPos;
-      NodeT             = mParent[NodeT];
-    }
-
-    if (NodeT < WNDSIZ) {
-      mPosition[NodeT] = (NODE) (mPos | (UINT32) PERC_FLAG);
-    }
-  } else {
-    //
-    // Locate the target tree
-    //
-    NodeQ = (NODE) (mText[mPos] + WNDSIZ);
-    CharC = mText[mPos + 1];
-    NodeR = Child (NodeQ, CharC);
-    if (NodeR == NIL) {
-      MakeChild (NodeQ, CharC, mPos);
-      mMatchLen = 1;
-      return ;
-    }
-
-    mMatchLen = 2;
-  }
-  //
-  // Traverse down the tree to find a match.
-  // Update Position value along the route.
-  // Node split or creation is involved.
-  //
-  for (;;) {
-    if (NodeR >= WNDSIZ) {
-      Index2    = MAXMATCH;
-      mMatchPos = NodeR;
-    } else {
-      Index2    = mLevel[NodeR];
-      mMatchPos = (NODE) (mPosition[NodeR] & (UINT32)~PERC_FLAG);
-    }
-
-    if (mMatchPos >= mPos) {
-      mMatchPos -= WNDSIZ;
-    }
-
-    t1  = &mText[mPos + mMatchLen];
-    t2  = &mText[mMatchPos + mMatchLen];
-    while (mMatchLen < Index2) {
-      if (*t1 != *t2) {
-        Split (NodeR);
-        return ;
-      }
-
-      mMatchLen++;
-      t1++;
-      t2++;
-    }
-
-    if (mMatchLen >= MAXMATCH) {
-      break;
-    }
-
-    mPosition[NodeR]  = mPos;
-    NodeQ             = NodeR;
-    NodeR             = Child (NodeQ, *t1);
-    if (NodeR == NIL) {
-      MakeChild (NodeQ, *t1, mPos);
-      return ;
-    }
-
-    mMatchLen++;
-  }
-
-  NodeT           = mPrev[NodeR];
-  mPrev[mPos]     = NodeT;
-  mNext[NodeT]    = mPos;
-  NodeT           = mNext[NodeR];
-  mNext[mPos]     = NodeT;
-  mPrev[NodeT]    = mPos;
-  mParent[mPos]   = NodeQ;
-  mParent[NodeR]  = NIL;
-
-  //
-  // Special usage of 'next'
-  //
-  mNext[NodeR] = mPos;
-
-}
-
-STATIC
-VOID
-DeleteNode (
-  VOID
-  )
-/*++
-
-Routine Description:
-
-  Delete outdated string info. (The Usage of PERC_FLAG
-  ensures a clean deletion)
-  
-Arguments: (VOID)
-
-Returns: (VOID)
-
---*/
-{
-  NODE  NodeQ;
-  NODE  NodeR;
-  NODE  NodeS;
-  NODE  NodeT;
-  NODE  NodeU;
-
-  if (mParent[mPos] == NIL) {
-    return ;
-  }
-
-  NodeR         = mPrev[mPos];
-  NodeS         = mNext[mPos];
-  mNext[NodeR]  = NodeS;
-  mPrev[NodeS]  = NodeR;
-  NodeR         = mParent[mPos];
-  mParent[mPos] = NIL;
-  if (NodeR >= WNDSIZ) {
-    return ;
-  }
-
-  mChildCount[NodeR]--;
-  if (mChildCount[NodeR] > 1) {
-    return ;
-  }
-
-  NodeT = (NODE) (mPosition[NodeR] & (UINT32)~PERC_FLAG);
-  if (NodeT >= mPos) {
-    NodeT -= WNDSIZ;
-  }
-
-  NodeS = NodeT;
-  NodeQ = mParent[NodeR];
-  NodeU = mPosition[NodeQ];
-  while (NodeU & (UINT32) PERC_FLAG) {
-    NodeU &= (UINT32)~PERC_FLAG;
-    if (NodeU >= mPos) {
-      NodeU -= WNDSIZ;
-    }
-
-    if (NodeU > NodeS) {
-      NodeS = NodeU;
-    }
-
-    mPosition[NodeQ]  = (NODE) (NodeS | WNDSIZ);
-    NodeQ             = mParent[NodeQ];
-    NodeU             = mPosition[NodeQ];
-  }
-
-  if (NodeQ < WNDSIZ) {
-    if (NodeU >= mPos) {
-      NodeU -= WNDSIZ;
-    }
-
-    if (NodeU > NodeS) {
-      NodeS = NodeU;
-    }
-
-    mPosition[NodeQ] = (NODE) (NodeS | WNDSIZ | (UINT32) PERC_FLAG);
-  }
-
-  NodeS           = Child (NodeR, mText[NodeT + mLevel[NodeR]]);
-  NodeT           = mPrev[NodeS];
-  NodeU           = mNext[NodeS];
-  mNext[NodeT]    = NodeU;
-  mPrev[NodeU]    = NodeT;
-  NodeT           = mPrev[NodeR];
-  mNext[NodeT]    = NodeS;
-  mPrev[NodeS]    = NodeT;
-  NodeT           = mNext[NodeR];
-  mPrev[NodeT]    = NodeS;
-  mNext[NodeS]    = NodeT;
-  mParent[NodeS]  = mParent[NodeR];
-  mParent[NodeR]  = NIL;
-  mNext[NodeR]    = mAvail;
-  mAvail          = NodeR;
-}
-
-STATIC
-VOID
-GetNextMatch (
-  VOID
-  )
-/*++
-
-Routine Description:
-
-  Advance the current position (read in new data if needed).
-  Delete outdated string info. Find a match string for current position.
-
-Arguments: (VOID)
-
-Returns: (VOID)
-
---*/
-{
-  INT32 Number;
-
-  mRemainder--;
-  mPos++;
-  if (mPos == WNDSIZ * 2) {
-    memmove (&mText[0], &mText[WNDSIZ], WNDSIZ + MAXMATCH);
-    Number = FreadCrc (&mText[WNDSIZ + MAXMATCH], WNDSIZ);
-    mRemainder += Number;
-    mPos = WNDSIZ;
-  }
-
-  DeleteNode ();
-  InsertNode ();
-}
-
 STATIC
 EFI_STATUS
 Encode (
-  VOID
+  IN LZ_MATCH_FINDER  *Finder,
+  IN UINT8            *SrcBuffer,
+  IN UINT32           SrcSize
   )
 /*++
 
@@ -916,7 +409,11 @@ Routine Description:
 
   The main controlling routine for compression process.
 
-Arguments: (VOID)
+Arguments:
+
+  Finder      - The match finder
+  SrcBuffer   - The buffer storing the source data
+  SrcSize     - The size of source data
 
 Returns:
   
@@ -926,72 +423,36 @@ Returns:
 --*/
 {
   EFI_STATUS  Status;
-  INT32       LastMatchLen;
-  NODE        LastMatchPos;
+  UINT32      Index;
+  UINT32      Token;
 
   Status = AllocateMemory ();
   if (EFI_ERROR (Status)) {
-    FreeMemory ();
     return Status;
   }
 
-  InitSlide ();
-
-  HufEncodeStart ();
-
-  mRemainder  = FreadCrc (&mText[WNDSIZ], WNDSIZ + MAXMATCH);
-
-  mMatchLen   = 0;
-  mPos        = WNDSIZ;
-  InsertNode ();
-  if (mMatchLen > mRemainder) {
-    mMatchLen = mRemainder;
+  Status = LzMatchFinderParse (Finder, WNDBIT, SrcBuffer, SrcSize);
+  if (EFI_ERROR (Status)) {
+    return Status;
   }
 
-  while (mRemainder > 0) {
-    LastMatchLen  = mMatchLen;
-    LastMatchPos  = mMatchPos;
-    GetNextMatch ();
-    if (mMatchLen > mRemainder) {
-      mMatchLen = mRemainder;
-    }
-
-    if (mMatchLen > LastMatchLen || LastMatchLen < THRESHOLD) {
-      //
-      // Not enough benefits are gained by outputting a pointer,
-      // so just output the original character
-      //
-      Output (mText[mPos - 1], 0);
-
-    } else {
+  HufEncodeStart ();
 
-      if (LastMatchLen == THRESHOLD) {
-        if (((mPos - LastMatchPos - 2) & (WNDSIZ - 1)) > (1U << 11)) {
-          Output (mText[mPos - 1], 0);
-          continue;
-        }
-      }
-      //
-      // Outputting a pointer is beneficial enough, do it.
-      //
+  for (Index = 0; Index < Finder->TokenCount; Index++) {
+    Token = Finder->Tokens[Index];
+    if (LZ_TOKEN_IS_POINTER (Token)) {
       Output (
-        LastMatchLen + (UINT8_MAX + 1 - THRESHOLD),
-        (mPos - LastMatchPos - 2) & (WNDSIZ - 1)
+        LZ_TOKEN_LENGTH (Token) + (UINT8_MAX + 1 - THRESHOLD),
+        LZ_TOKEN_POSITION (Token)
         );
-      LastMatchLen--;
-      while (LastMatchLen > 0) {
-        GetNextMatch ();
-        LastMatchLen--;
-      }
-
-      if (mMatchLen > mRemainder) {
-        mMatchLen = mRemainder;
-      }
+    } else {
+      Output (Token, 0);
     }
   }
 
+  mOrigSize = SrcSize;
+
   HufEncodeEnd ();
-  FreeMemory ();
   return EFI_SUCCESS;
 }
 
@@ -1374,30 +835,6 @@ HufEncodeEnd (
   return ;
 }
 
-STATIC
-VOID
-MakeCrcTable (
-  VOID
-  )
-{
-  UINT32  Index;
-  UINT32  Index2;
-  UINT32  Temp;
-
-  for (Index = 0; Index <= UINT8_MAX; Index++) {
-    Temp = Index;
-    for (Index2 = 0; Index2 < UINT8_BIT; Index2++) {
-      if (Temp & 1) {
-        Temp = (Temp >> 1) ^ CRCPOLY;
-      } else {
-        Temp >>= 1;
-      }
-    }
-
-    mCrcTable[Index] = (UINT16) Temp;
-  }
-}
-
 STATIC
 VOID
 PutBits (
@@ -1438,48 +875,6 @@ Returns: (VOID)
   mSubBitBuf |= Value << (mBitCount -= Number);
 }
 
-STATIC
-INT32
-FreadCrc (
-  OUT UINT8 *Pointer,
-  IN  INT32 Number
-  )
-/*++
-
-Routine Description:
-
-  Read in source data
-  
-Arguments:
-
-  Pointer   - the buffer to hold the data
-  Number   - number of bytes to read
-
-Returns:
-
-  number of bytes actually read
-  
---*/
-{
-  INT32 Index;
-
-  for (Index = 0; mSrc < mSrcUpperLimit && Index < Number; Index++) {
-    *Pointer++ = *mSrc++;
-  }
-
-  Number = Index;
-
-  Pointer -= Number;
-  mOrigSize += Number;
-  Index--;
-  while (Index >= 0) {
-    UPDATE_CRC (*Pointer++);
-    Index--;
-  }
-
-  return Number;
-}
-
 STATIC
 VOID
 InitPutBits (
@@ -32,7 +32,7 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 // Utility version information
 //
 #define UTILITY_MAJOR_VERSION 0
-#define UTILITY_MINOR_VERSION 1
+#define UTILITY_MINOR_VERSION 2
 
 EFI_GUID  mEfiFirmwareFileSystem2Guid = EFI_FIRMWARE_FILE_SYSTEM2_GUID;
 EFI_GUID  mEfiFirmwareFileSystem3Guid = EFI_FIRMWARE_FILE_SYSTEM3_GUID;
@@ -129,6 +129,14 @@ Returns:
   fprintf (stdout, "  -m logfile, --map logfile\n\
                         Logfile is the output fv map file name. if it is not\n\
                         given, the FvName.map will be the default map file name\n"); 
+  fprintf (stdout, "  --ffs-cache CacheDir\n\
+                        CacheDir is an existing directory keeping rebased\n\
+                        FFS files between builds. An unchanged FFS rebased\n\
+                        to the same address is taken from it, and only the\n\
+                        changed parts of an FV file of the same size are\n\
+                        rewritten. The layout of the FV file is kept there\n\
+                        too, so that the changed parts are found without\n\
+                        reading the file back.\n");
   fprintf (stdout, "  -g Guid, --guid Guid\n\
                         GuidValue is one specific capsule guid value\n\
                         or fv file system guid value.\n\
@@ -500,6 +508,17 @@ Returns:
       continue; 
     }
 
+    if (stricmp (argv[0], "--ffs-cache") == 0) {
+      mFfsCacheDirectory = argv[1];
+      if (mFfsCacheDirectory == NULL) {
+        Error (NULL, 0, 1003, "Invalid option value", "FFS cache directory can't be null");
+        return STATUS_ERROR;
+      }
+      argc -= 2;
+      argv += 2;
+      continue; 
+    }
+
     if ((stricmp (argv[0], "-p") == 0) || (stricmp (argv[0], "--dump") == 0)) {
       DumpCapsule = TRUE;
       argc --;
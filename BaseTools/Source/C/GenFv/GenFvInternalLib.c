@@ -19,12 +19,18 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #ifdef __GNUC__
 #include <uuid/uuid.h>
 #include <sys/stat.h>
+#include <unistd.h>
 #endif
 #include <string.h>
 #ifndef __GNUC__
 #include <io.h>
+#include <process.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#define getpid  _getpid
 #endif
 #include <assert.h>
+#include <time.h>
 
 #include "GenFvInternalLib.h"
 #include "FvLib.h"
@@ -929,6 +935,705 @@ Returns:
   return EFI_SUCCESS;
 }
 
+//
+// Content addressed cache of rebased FFS files, enabled by --ffs-cache.
+// An entry is keyed by the FFS contents, its file name and the address it
+// is rebased to, and holds the FFS before and after the rebase together
+// with the lines FfsRebase added to the FV map file for it.
+//
+#define FFS_CACHE_SIGNATURE   SIGNATURE_32 ('F', 'F', 'S', 'C')
+#define FFS_CACHE_WRITE_CHUNK 0x1000
+
+typedef struct {
+  UINT32  Signature;
+  UINT32  FileSize;
+  UINT64  XipBase;
+  UINT32  MapTextSize;
+  UINT8   Arm;
+  UINT8   Reserved[3];
+} FFS_CACHE_ENTRY_HEADER;
+
+CHAR8          *mFfsCacheDirectory = NULL;
+STATIC BOOLEAN mFfsRebaseReadPeFile = FALSE;
+STATIC UINT32  mFfsCacheHits = 0;
+STATIC UINT32  mFfsCacheMisses = 0;
+STATIC clock_t mFfsRebaseTime = 0;
+
+//
+// Layout of an FV file as GenFv last wrote it, kept in the FFS cache as
+// <hash of the FV file name>.fvl. It holds the hash of every chunk of the
+// image, so that while the FV file is still the one the layout describes,
+// the chunks that changed are found without reading the file back.
+//
+// The FV file is taken to be unchanged if it has the size and modification
+// time recorded in the layout, and that time is older than the layout file
+// itself. A file modified within the same clock tick as the layout was saved
+// may have been rewritten by another tool after GenFv, so it is read back.
+//
+#define FV_LAYOUT_SIGNATURE   SIGNATURE_32 ('F', 'V', 'L', 'Y')
+
+typedef struct {
+  UINT32  Signature;
+  UINT32  ChunkSize;
+  UINT64  FvImageSize;
+  UINT64  FileTime;
+} FV_LAYOUT_HEADER;
+
+STATIC
+UINT64
+FfsCacheHash (
+  IN UINT64       Hash,
+  IN VOID        *Data,
+  IN UINTN        Size
+  )
+/*++
+
+Routine Description:
+
+  Accumulate Data into a 64-bit FNV-1a hash.
+
+Arguments:
+
+  Hash      The hash of the preceding data, or the FNV offset basis.
+  Data      The data to hash.
+  Size      The size of Data in bytes.
+
+Returns:
+
+  The updated hash.
+
+--*/
+{
+  UINT8  *Byte;
+
+  for (Byte = Data; Size > 0; Size--, Byte++) {
+    Hash = (Hash ^ *Byte) * 0x100000001B3ULL;
+  }
+  return Hash;
+}
+
+STATIC
+BOOLEAN
+FfsCacheLookup (
+  IN     CHAR8                 *EntryName,
+  IN OUT EFI_FFS_FILE_HEADER   *FfsFile,
+  IN     UINTN                 FileSize,
+  IN     EFI_PHYSICAL_ADDRESS  XipBase,
+  IN     FILE                  *FvMapFile
+  )
+/*++
+
+Routine Description:
+
+  Replace the FFS file with its rebased copy from the cache, and append the
+  cached map lines to the FV map file.
+
+Arguments:
+
+  EntryName     Path of the cache entry.
+  FfsFile       The FFS file image to rebase.
+  FileSize      Size of the FFS file image.
+  XipBase       The address the FFS file is rebased to.
+  FvMapFile     FvMapFile to record the function address in one Fvimage
+
+Returns:
+
+  TRUE          The file was found in the cache and rebased.
+  FALSE         No matching cache entry, FfsFile is unchanged.
+
+--*/
+{
+  FILE                    *EntryFile;
+  FFS_CACHE_ENTRY_HEADER  Header;
+  UINT8                   *Buffer;
+  BOOLEAN                 Found;
+
+  EntryFile = fopen (LongFilePath (EntryName), "rb");
+  if (EntryFile == NULL) {
+    return FALSE;
+  }
+
+  Found  = FALSE;
+  Buffer = NULL;
+  if (fread (&Header, sizeof (Header), 1, EntryFile) == 1 &&
+      Header.Signature == FFS_CACHE_SIGNATURE &&
+      Header.FileSize == FileSize &&
+      Header.XipBase == XipBase) {
+    Buffer = malloc (2 * FileSize + Header.MapTextSize + 1);
+  }
+
+  //
+  // The hash only names the entry, so compare the original contents before
+  // taking the rebased copy.
+  //
+  if (Buffer != NULL &&
+      fread (Buffer, 1, 2 * FileSize + Header.MapTextSize, EntryFile) == 2 * FileSize + Header.MapTextSize &&
+      memcmp (Buffer, FfsFile, FileSize) == 0) {
+    memcpy (FfsFile, Buffer + FileSize, FileSize);
+    fwrite (Buffer + 2 * FileSize, 1, Header.MapTextSize, FvMapFile);
+    if (Header.Arm != 0) {
+      mArm = TRUE;
+    }
+    Found = TRUE;
+  }
+
+  if (Buffer != NULL) {
+    free (Buffer);
+  }
+  fclose (EntryFile);
+  return Found;
+}
+
+STATIC
+VOID
+FfsCacheStore (
+  IN CHAR8                 *EntryName,
+  IN UINT8                 *OrigFfsFile,
+  IN EFI_FFS_FILE_HEADER   *FfsFile,
+  IN UINTN                 FileSize,
+  IN EFI_PHYSICAL_ADDRESS  XipBase,
+  IN BOOLEAN               Arm,
+  IN UINT8                 *MapText,
+  IN UINT32                MapTextSize
+  )
+/*++
+
+Routine Description:
+
+  Add a rebased FFS file to the cache. The entry is written to a temporary
+  file first, so that GenFv processes sharing the cache never read a
+  partial entry. Failures are ignored, the file is just rebased again on
+  the next build.
+
+Arguments:
+
+  EntryName     Path of the cache entry.
+  OrigFfsFile   The FFS file image before the rebase.
+  FfsFile       The rebased FFS file image.
+  FileSize      Size of the FFS file image.
+  XipBase       The address the FFS file was rebased to.
+  Arm           The FFS file holds ARM images.
+  MapText       The lines FfsRebase added to the FV map file.
+  MapTextSize   Size of MapText.
+
+Returns:
+
+  None
+
+--*/
+{
+  CHAR8                   TempName[MAX_LONG_FILE_PATH];
+  FILE                    *EntryFile;
+  FFS_CACHE_ENTRY_HEADER  Header;
+  BOOLEAN                 Written;
+
+  if (strlen (EntryName) + 16 >= MAX_LONG_FILE_PATH) {
+    return;
+  }
+  sprintf (TempName, "%s.%u", EntryName, (unsigned) getpid ());
+
+  EntryFile = fopen (LongFilePath (TempName), "wb");
+  if (EntryFile == NULL) {
+    return;
+  }
+
+  memset (&Header, 0, sizeof (Header));
+  Header.Signature   = FFS_CACHE_SIGNATURE;
+  Header.FileSize    = (UINT32) FileSize;
+  Header.XipBase     = XipBase;
+  Header.MapTextSize = MapTextSize;
+  Header.Arm         = (UINT8) Arm;
+
+  Written = (BOOLEAN) (fwrite (&Header, sizeof (Header), 1, EntryFile) == 1 &&
+                       fwrite (OrigFfsFile, 1, FileSize, EntryFile) == FileSize &&
+                       fwrite (FfsFile, 1, FileSize, EntryFile) == FileSize &&
+                       fwrite (MapText, 1, MapTextSize, EntryFile) == MapTextSize);
+  if (fclose (EntryFile) != 0) {
+    Written = FALSE;
+  }
+
+  if (!Written || rename (LongFilePath (TempName), LongFilePath (EntryName)) != 0) {
+    remove (LongFilePath (TempName));
+  }
+}
+
+STATIC
+EFI_STATUS
+FfsRebaseCached (
+  IN OUT  FV_INFO               *FvInfo,
+  IN      CHAR8                 *FileName,
+  IN OUT  EFI_FFS_FILE_HEADER   *FfsFile,
+  IN      UINTN                 FileSize,
+  IN      UINTN                 XipOffset,
+  IN      FILE                  *FvMapFile
+  )
+/*++
+
+Routine Description:
+
+  Rebase an FFS file like FfsRebase, taking the result from the FFS cache
+  when the same file was already rebased to the same address by an
+  earlier build.
+
+Arguments:
+
+  FvInfo            A pointer to FV_INFO struture.
+  FileName          Ffs File PathName
+  FfsFile           A pointer to Ffs file image.
+  FileSize          Size of the Ffs file image.
+  XipOffset         The offset address to use for rebasing the XIP file image.
+  FvMapFile         FvMapFile to record the function address in one Fvimage
+
+Returns:
+
+  The status of FfsRebase.
+
+--*/
+{
+  EFI_STATUS            Status;
+  EFI_PHYSICAL_ADDRESS  XipBase;
+  CHAR8                 EntryName[MAX_LONG_FILE_PATH];
+  UINT64                Hash;
+  UINT8                 *OrigFfsFile;
+  FILE                  *MapCapture;
+  UINT8                 *MapText;
+  long                  MapTextSize;
+  clock_t               StartTime;
+  BOOLEAN               SavedArm;
+  BOOLEAN               EntryArm;
+
+  StartTime   = clock ();
+  OrigFfsFile = NULL;
+  MapCapture  = NULL;
+  MapText     = NULL;
+
+  //
+  // Only cache files that FfsRebase actually relocates.
+  //
+  if (mFfsCacheDirectory == NULL ||
+      (FvInfo->BaseAddress == 0 && FvInfo->ForceRebase == -1) ||
+      FvInfo->ForceRebase == 0) {
+    Status = FfsRebase (FvInfo, FileName, FfsFile, XipOffset, FvMapFile);
+    goto Done;
+  }
+  switch (FfsFile->Type) {
+    case EFI_FV_FILETYPE_SECURITY_CORE:
+    case EFI_FV_FILETYPE_PEI_CORE:
+    case EFI_FV_FILETYPE_PEIM:
+    case EFI_FV_FILETYPE_COMBINED_PEIM_DRIVER:
+    case EFI_FV_FILETYPE_DRIVER:
+    case EFI_FV_FILETYPE_DXE_CORE:
+    case EFI_FV_FILETYPE_FIRMWARE_VOLUME_IMAGE:
+      break;
+    default:
+      Status = FfsRebase (FvInfo, FileName, FfsFile, XipOffset, FvMapFile);
+      goto Done;
+  }
+
+  XipBase = FvInfo->BaseAddress + XipOffset;
+  Hash    = FfsCacheHash (0xCBF29CE484222325ULL, FfsFile, FileSize);
+  Hash    = FfsCacheHash (Hash, FileName, strlen (FileName));
+  if (strlen (mFfsCacheDirectory) + 40 >= MAX_LONG_FILE_PATH) {
+    Status = FfsRebase (FvInfo, FileName, FfsFile, XipOffset, FvMapFile);
+    goto Done;
+  }
+  sprintf (EntryName, "%s/%016llx-%llx.ffs", mFfsCacheDirectory, (unsigned long long) Hash, (unsigned long long) XipBase);
+
+  if (FfsCacheLookup (EntryName, FfsFile, FileSize, XipBase, FvMapFile)) {
+    //
+    // Child FV base addresses are recorded by FfsRebase itself.
+    //
+    if (FfsFile->Type == EFI_FV_FILETYPE_FIRMWARE_VOLUME_IMAGE) {
+      GetChildFvFromFfs (FvInfo, FfsFile, XipOffset);
+    }
+    mFfsCacheHits++;
+    Status = EFI_SUCCESS;
+    goto Done;
+  }
+  mFfsCacheMisses++;
+
+  //
+  // Rebase into a temporary map file, so that its output can be kept in
+  // the cache entry as well.
+  //
+  OrigFfsFile = malloc (FileSize);
+  MapCapture  = tmpfile ();
+  if (OrigFfsFile == NULL || MapCapture == NULL) {
+    Status = FfsRebase (FvInfo, FileName, FfsFile, XipOffset, FvMapFile);
+    goto Done;
+  }
+  memcpy (OrigFfsFile, FfsFile, FileSize);
+
+  SavedArm             = mArm;
+  mArm                 = FALSE;
+  mFfsRebaseReadPeFile = FALSE;
+  Status = FfsRebase (FvInfo, FileName, FfsFile, XipOffset, MapCapture);
+  EntryArm = mArm;
+  mArm     = (BOOLEAN) (mArm || SavedArm);
+  if (EFI_ERROR (Status)) {
+    goto Done;
+  }
+
+  fseek (MapCapture, 0, SEEK_END);
+  MapTextSize = ftell (MapCapture);
+  fseek (MapCapture, 0, SEEK_SET);
+  MapText = malloc (MapTextSize + 1);
+  if (MapTextSize < 0 || MapText == NULL ||
+      fread (MapText, 1, MapTextSize, MapCapture) != (size_t) MapTextSize) {
+    Error (NULL, 0, 0004, "Error reading file", "the temporary FV map of %s", FileName);
+    Status = EFI_ABORTED;
+    goto Done;
+  }
+  fwrite (MapText, 1, MapTextSize, FvMapFile);
+
+  //
+  // Relocations taken from the original .efi file are not part of the key.
+  //
+  if (!mFfsRebaseReadPeFile) {
+    FfsCacheStore (EntryName, OrigFfsFile, FfsFile, FileSize, XipBase, EntryArm, MapText, (UINT32) MapTextSize);
+  }
+
+Done:
+  if (OrigFfsFile != NULL) {
+    free (OrigFfsFile);
+  }
+  if (MapText != NULL) {
+    free (MapText);
+  }
+  if (MapCapture != NULL) {
+    fclose (MapCapture);
+  }
+  mFfsRebaseTime += clock () - StartTime;
+  return Status;
+}
+
+STATIC
+UINT64
+FvFileTime (
+  IN struct stat  *StatBuf
+  )
+/*++
+
+Routine Description:
+
+  Return the modification time of a file in nanoseconds, with the resolution
+  of the file system where the C library reports it.
+
+Arguments:
+
+  StatBuf        The status of the file.
+
+Returns:
+
+  The modification time.
+
+--*/
+{
+  UINT64  Nanoseconds;
+
+#if defined(__APPLE__)
+  Nanoseconds = (UINT64) StatBuf->st_mtimespec.tv_nsec;
+#elif defined(__linux__)
+  Nanoseconds = (UINT64) StatBuf->st_mtim.tv_nsec;
+#else
+  Nanoseconds = 0;
+#endif
+  return (UINT64) StatBuf->st_mtime * 1000000000ULL + Nanoseconds;
+}
+
+STATIC
+BOOLEAN
+FvLayoutName (
+  IN  CHAR8   *FvFileName,
+  OUT CHAR8   *LayoutName
+  )
+/*++
+
+Routine Description:
+
+  Return the path of the layout of an FV file in the FFS cache.
+
+Arguments:
+
+  FvFileName     Name of the FV file.
+  LayoutName     Receives the path of the layout, MAX_LONG_FILE_PATH long.
+
+Returns:
+
+  TRUE           LayoutName is set.
+  FALSE          The path is too long.
+
+--*/
+{
+  UINT64  Hash;
+
+  if (strlen (mFfsCacheDirectory) + 40 >= MAX_LONG_FILE_PATH) {
+    return FALSE;
+  }
+  Hash = FfsCacheHash (0xCBF29CE484222325ULL, FvFileName, strlen (FvFileName));
+  sprintf (LayoutName, "%s/%016llx.fvl", mFfsCacheDirectory, (unsigned long long) Hash);
+  return TRUE;
+}
+
+STATIC
+UINT64 *
+FvLayoutLoad (
+  IN CHAR8   *LayoutName,
+  IN UINTN   FvImageSize,
+  IN UINT64  FileTime
+  )
+/*++
+
+Routine Description:
+
+  Read the chunk hashes of the previous layout of an FV file, if it still
+  describes the FV file on disk. It doesn't if the FV file was modified in
+  the same clock tick as the layout was saved, or later.
+
+Arguments:
+
+  LayoutName     Path of the layout.
+  FvImageSize    Size of the FV file.
+  FileTime       Modification time of the FV file, see FvFileTime().
+
+Returns:
+
+  The chunk hashes, to be freed by the caller, or NULL if there is no
+  matching layout.
+
+--*/
+{
+  FILE              *LayoutFile;
+  FV_LAYOUT_HEADER  Header;
+  UINT64            *Hashes;
+  UINTN             ChunkCount;
+  struct stat       StatBuf;
+
+  LayoutFile = fopen (LongFilePath (LayoutName), "rb");
+  if (LayoutFile == NULL) {
+    return NULL;
+  }
+
+  Hashes     = NULL;
+  ChunkCount = (FvImageSize + FFS_CACHE_WRITE_CHUNK - 1) / FFS_CACHE_WRITE_CHUNK;
+  if (fstat (fileno (LayoutFile), &StatBuf) == 0 &&
+      FileTime < FvFileTime (&StatBuf) &&
+      fread (&Header, sizeof (Header), 1, LayoutFile) == 1 &&
+      Header.Signature == FV_LAYOUT_SIGNATURE &&
+      Header.ChunkSize == FFS_CACHE_WRITE_CHUNK &&
+      Header.FvImageSize == FvImageSize &&
+      Header.FileTime == FileTime) {
+    Hashes = malloc (ChunkCount * sizeof (UINT64));
+    if (Hashes != NULL && fread (Hashes, sizeof (UINT64), ChunkCount, LayoutFile) != ChunkCount) {
+      free (Hashes);
+      Hashes = NULL;
+    }
+  }
+
+  fclose (LayoutFile);
+  return Hashes;
+}
+
+STATIC
+VOID
+FvLayoutStore (
+  IN CHAR8   *LayoutName,
+  IN UINTN   FvImageSize,
+  IN UINT64  FileTime,
+  IN UINT64  *Hashes
+  )
+/*++
+
+Routine Description:
+
+  Save the layout of the FV file just written. Like the cache entries, it
+  is written to a temporary file first and failures are ignored.
+
+Arguments:
+
+  LayoutName     Path of the layout.
+  FvImageSize    Size of the FV file.
+  FileTime       Modification time of the FV file, see FvFileTime().
+  Hashes         The hash of every chunk of the FV file.
+
+Returns:
+
+  None
+
+--*/
+{
+  CHAR8             TempName[MAX_LONG_FILE_PATH];
+  FILE              *LayoutFile;
+  FV_LAYOUT_HEADER  Header;
+  UINTN             ChunkCount;
+  BOOLEAN           Written;
+
+  if (strlen (LayoutName) + 16 >= MAX_LONG_FILE_PATH) {
+    return;
+  }
+  sprintf (TempName, "%s.%u", LayoutName, (unsigned) getpid ());
+
+  LayoutFile = fopen (LongFilePath (TempName), "wb");
+  if (LayoutFile == NULL) {
+    return;
+  }
+
+  memset (&Header, 0, sizeof (Header));
+  Header.Signature   = FV_LAYOUT_SIGNATURE;
+  Header.ChunkSize   = FFS_CACHE_WRITE_CHUNK;
+  Header.FvImageSize = FvImageSize;
+  Header.FileTime    = FileTime;
+  ChunkCount         = (FvImageSize + FFS_CACHE_WRITE_CHUNK - 1) / FFS_CACHE_WRITE_CHUNK;
+
+  Written = (BOOLEAN) (fwrite (&Header, sizeof (Header), 1, LayoutFile) == 1 &&
+                       fwrite (Hashes, sizeof (UINT64), ChunkCount, LayoutFile) == ChunkCount);
+  if (fclose (LayoutFile) != 0) {
+    Written = FALSE;
+  }
+
+  if (!Written || rename (LongFilePath (TempName), LongFilePath (LayoutName)) != 0) {
+    remove (LongFilePath (TempName));
+  }
+}
+
+STATIC
+EFI_STATUS
+WriteFvImageFile (
+  IN CHAR8   *FvFileName,
+  IN UINT8   *FvImage,
+  IN UINTN   FvImageSize
+  )
+/*++
+
+Routine Description:
+
+  Write the FV image to its file. With the FFS cache enabled, an existing
+  file of the same size is updated in place and only the chunks that
+  changed since the previous build are written. They are found from the
+  layout saved by the previous build when the file was not modified since,
+  else by reading the file back.
+
+Arguments:
+
+  FvFileName     Name of the FV file.
+  FvImage        The FV image.
+  FvImageSize    Size of the FV image.
+
+Returns:
+
+  EFI_SUCCESS    The FV file was written.
+  EFI_ABORTED    The FV file could not be written.
+
+--*/
+{
+  FILE        *FvFile;
+  UINT8       OldChunk[FFS_CACHE_WRITE_CHUNK];
+  UINTN       Offset;
+  UINTN       ChunkSize;
+  UINTN       Written;
+  BOOLEAN     Updated;
+  BOOLEAN     Changed;
+  CHAR8       LayoutName[MAX_LONG_FILE_PATH];
+  UINT64      *Hashes;
+  UINT64      *OldHashes;
+  struct stat StatBuf;
+  EFI_STATUS  Status;
+
+  Updated   = FALSE;
+  Written   = 0;
+  FvFile    = NULL;
+  Hashes    = NULL;
+  OldHashes = NULL;
+  if (mFfsCacheDirectory != NULL) {
+    if (FvLayoutName (FvFileName, LayoutName)) {
+      Hashes = malloc (((FvImageSize + FFS_CACHE_WRITE_CHUNK - 1) / FFS_CACHE_WRITE_CHUNK) * sizeof (UINT64));
+    }
+    for (Offset = 0; Offset < FvImageSize && Hashes != NULL; Offset += ChunkSize) {
+      ChunkSize = MIN (FFS_CACHE_WRITE_CHUNK, FvImageSize - Offset);
+      Hashes[Offset / FFS_CACHE_WRITE_CHUNK] = FfsCacheHash (0xCBF29CE484222325ULL, FvImage + Offset, ChunkSize);
+    }
+    FvFile = fopen (LongFilePath (FvFileName), "r+b");
+  }
+
+  if (FvFile != NULL && (UINTN) _filelength (fileno (FvFile)) == FvImageSize) {
+    if (Hashes != NULL && fstat (fileno (FvFile), &StatBuf) == 0) {
+      OldHashes = FvLayoutLoad (LayoutName, FvImageSize, FvFileTime (&StatBuf));
+    }
+    Updated = TRUE;
+    for (Offset = 0; Offset < FvImageSize && Updated; Offset += ChunkSize) {
+      ChunkSize = MIN (FFS_CACHE_WRITE_CHUNK, FvImageSize - Offset);
+      if (OldHashes != NULL) {
+        Changed = (BOOLEAN) (OldHashes[Offset / FFS_CACHE_WRITE_CHUNK] != Hashes[Offset / FFS_CACHE_WRITE_CHUNK]);
+      } else {
+        fseek (FvFile, (long) Offset, SEEK_SET);
+        if (fread (OldChunk, 1, ChunkSize, FvFile) != ChunkSize) {
+          Updated = FALSE;
+          break;
+        }
+        Changed = (BOOLEAN) (memcmp (OldChunk, FvImage + Offset, ChunkSize) != 0);
+      }
+      if (Changed) {
+        fseek (FvFile, (long) Offset, SEEK_SET);
+        if (fwrite (FvImage + Offset, 1, ChunkSize, FvFile) != ChunkSize) {
+          Updated = FALSE;
+        }
+        Written += ChunkSize;
+      }
+    }
+  }
+
+  if (FvFile != NULL) {
+    if (fclose (FvFile) != 0) {
+      Updated = FALSE;
+    }
+  }
+
+  if (!Updated) {
+    //
+    // New file, a different size or an error; write the whole image.
+    //
+    FvFile = fopen (LongFilePath (FvFileName), "wb");
+    if (FvFile == NULL) {
+      Error (NULL, 0, 0001, "Error opening file", FvFileName);
+      Status = EFI_ABORTED;
+      goto Done;
+    }
+    Written = fwrite (FvImage, 1, FvImageSize, FvFile);
+    if (fclose (FvFile) != 0 || Written != FvImageSize) {
+      Error (NULL, 0, 0002, "Error writing file", FvFileName);
+      Status = EFI_ABORTED;
+      goto Done;
+    }
+  }
+
+  if (Hashes != NULL && stat (LongFilePath (FvFileName), &StatBuf) == 0) {
+    FvLayoutStore (LayoutName, FvImageSize, FvFileTime (&StatBuf), Hashes);
+  }
+
+  if (mFfsCacheDirectory != NULL) {
+    VerboseMsg (
+      "FFS cache: %u hit(s), %u miss(es), %.3f seconds rebasing, %u of %u bytes of %s written%s",
+      (unsigned) mFfsCacheHits,
+      (unsigned) mFfsCacheMisses,
+      (double) mFfsRebaseTime / CLOCKS_PER_SEC,
+      (unsigned) Written,
+      (unsigned) FvImageSize,
+      FvFileName,
+      OldHashes != NULL ? " (from the previous layout)" : ""
+      );
+  }
+  Status = EFI_SUCCESS;
+
+Done:
+  if (Hashes != NULL) {
+    free (Hashes);
+  }
+  if (OldHashes != NULL) {
+    free (OldHashes);
+  }
+  return Status;
+}
+
 EFI_STATUS
 AddFile (
   IN OUT MEMORY_FILE          *FvImage,
@@ -1106,7 +1811,7 @@ Returns:
       // Rebase the PE or TE image in FileBuffer of FFS file for XIP 
       // Rebase for the debug genfvmap tool
       //
-      Status = FfsRebase (FvInfo, FvInfo->FvFiles[Index], (EFI_FFS_FILE_HEADER *) FileBuffer, (UINTN) *VtfFileImage - (UINTN) FvImage->FileImage, FvMapFile);
+      Status = FfsRebaseCached (FvInfo, FvInfo->FvFiles[Index], (EFI_FFS_FILE_HEADER *) FileBuffer, FileSize, (UINTN) *VtfFileImage - (UINTN) FvImage->FileImage, FvMapFile);
       if (EFI_ERROR (Status)) {
         Error (NULL, 0, 3000, "Invalid", "Could not rebase %s.", FvInfo->FvFiles[Index]);
         return Status;
@@ -1149,7 +1854,7 @@ Returns:
     // Rebase the PE or TE image in FileBuffer of FFS file for XIP. 
     // Rebase Bs and Rt drivers for the debug genfvmap tool.
     //
-    Status = FfsRebase (FvInfo, FvInfo->FvFiles[Index], (EFI_FFS_FILE_HEADER *) FileBuffer, (UINTN) FvImage->CurrentFilePointer - (UINTN) FvImage->FileImage, FvMapFile);
+    Status = FfsRebaseCached (FvInfo, FvInfo->FvFiles[Index], (EFI_FFS_FILE_HEADER *) FileBuffer, FileSize, (UINTN) FvImage->CurrentFilePointer - (UINTN) FvImage->FileImage, FvMapFile);
 	if (EFI_ERROR (Status)) {
 	  Error (NULL, 0, 3000, "Invalid", "Could not rebase %s.", FvInfo->FvFiles[Index]);
 	  return Status;
@@ -2069,7 +2774,6 @@ Returns:
   UINT8                           *FvBufferHeader; // to make sure fvimage header 8 type alignment.
   UINT8                           *FvImage;
   UINTN                           FvImageSize;
-  FILE                            *FvFile;
   CHAR8                           FvMapName [MAX_LONG_FILE_PATH];
   FILE                            *FvMapFile;
   EFI_FIRMWARE_VOLUME_EXT_HEADER  *FvExtHeader;
@@ -2079,7 +2783,6 @@ Returns:
   FILE                            *FvReportFile;
 
   FvBufferHeader = NULL;
-  FvFile         = NULL;
   FvMapFile      = NULL;
   FvReportFile   = NULL;
 
@@ -2477,18 +3180,7 @@ WriteFile:
   //
   // Write fv file
   //
-  FvFile = fopen (LongFilePath (FvFileName), "wb");
-  if (FvFile == NULL) {
-    Error (NULL, 0, 0001, "Error opening file", FvFileName);
-    Status = EFI_ABORTED;
-    goto Finish;
-  }
-
-  if (fwrite (FvImage, 1, FvImageSize, FvFile) != FvImageSize) {
-    Error (NULL, 0, 0002, "Error writing file", FvFileName);
-    Status = EFI_ABORTED;
-    goto Finish;
-  }
+  Status = WriteFvImageFile (FvFileName, FvImage, FvImageSize);
 
 Finish:
   if (FvBufferHeader != NULL) {
@@ -2499,11 +3191,6 @@ Finish:
     free (FvExtHeader);
   }
   
-  if (FvFile != NULL) {
-    fflush (FvFile);
-    fclose (FvFile);
-  }
-  
   if (FvMapFile != NULL) {
     fflush (FvMapFile);
     fclose (FvMapFile);
@@ -3066,6 +3753,7 @@ Returns:
             //return EFI_ABORTED;
             break;
           }
+          mFfsRebaseReadPeFile = TRUE;
           //
           // Get the file size
           //
@@ -3321,6 +4009,7 @@ Returns:
         //Error (NULL, 0, 3000, "Invalid", "The file %s has no .reloc section.", FileName);
         //return EFI_ABORTED;
       } else {
+        mFfsRebaseReadPeFile = TRUE;
         //
         // Get the file size
         //
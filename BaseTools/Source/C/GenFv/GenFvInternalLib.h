@@ -261,6 +261,7 @@ extern UINT32     mFvTakenSize;
 
 extern EFI_PHYSICAL_ADDRESS mFvBaseAddress[];
 extern UINT32               mFvBaseAddressNumber;
+extern CHAR8                *mFfsCacheDirectory;
 //
 // Local function prototypes
 //
@@ -352,6 +353,13 @@ FfsRebase (
   IN      FILE                  *FvMapFile
   );
 
+EFI_STATUS
+GetChildFvFromFfs (
+  IN      FV_INFO               *FvInfo, 
+  IN      EFI_FFS_FILE_HEADER   *FfsFile,
+  IN      UINTN                 XipOffset
+  );
+
 //
 // Exported function prototypes
 //
@@ -942,6 +942,8 @@ WriteRelocations32 (
     }
   }
 
+  CoffWriteFixups ();
+
   //
   // Pad by adding empty entries.
   //
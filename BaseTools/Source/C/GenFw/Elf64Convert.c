@@ -853,6 +853,8 @@ WriteRelocations64 (
     }
   }
 
+  CoffWriteFixups ();
+
   //
   // Pad by adding empty entries.
   //
@@ -46,6 +46,19 @@ UINT8 *mCoffFile = NULL;
 EFI_IMAGE_BASE_RELOCATION *mCoffBaseRel;
 UINT16                    *mCoffEntryRel;
 
+//
+// Fixups collected by CoffAddFixup, written sorted by CoffWriteFixups.
+//
+typedef struct {
+  UINT32  Offset;
+  UINT32  Index;
+  UINT8   Type;
+} COFF_FIXUP;
+
+STATIC COFF_FIXUP *mCoffFixups     = NULL;
+STATIC UINT32     mCoffFixupCount  = 0;
+STATIC UINT32     mCoffFixupMax    = 0;
+
 //
 // Current offset in coff file.
 //
@@ -79,42 +92,113 @@ CoffAddFixup(
   UINT8  Type
   )
 {
-  if (mCoffBaseRel == NULL
-      || mCoffBaseRel->VirtualAddress != (Offset & ~0xfff)) {
-    if (mCoffBaseRel != NULL) {
-      //
-      // Add a null entry (is it required ?)
-      //
-      CoffAddFixupEntry (0);
-      
-      //
-      // Pad for alignment.
-      //
-      if (mCoffOffset % 4 != 0)
-        CoffAddFixupEntry (0);
+  if (mCoffFixupCount == mCoffFixupMax) {
+    mCoffFixupMax = (mCoffFixupMax == 0) ? 0x100 : mCoffFixupMax * 2;
+    mCoffFixups = realloc (mCoffFixups, mCoffFixupMax * sizeof (COFF_FIXUP));
+    if (mCoffFixups == NULL) {
+      Error (NULL, 0, 4001, "Resource", "memory cannot be allocated!");
+      exit (EXIT_FAILURE);
     }
+  }
+
+  mCoffFixups[mCoffFixupCount].Offset = Offset;
+  mCoffFixups[mCoffFixupCount].Index  = mCoffFixupCount;
+  mCoffFixups[mCoffFixupCount].Type   = Type;
+  mCoffFixupCount++;
+}
+
+STATIC
+int
+CompareCoffFixup (
+  CONST VOID *Left,
+  CONST VOID *Right
+  )
+{
+  CONST COFF_FIXUP *Fixup1;
+  CONST COFF_FIXUP *Fixup2;
+
+  Fixup1 = (CONST COFF_FIXUP *) Left;
+  Fixup2 = (CONST COFF_FIXUP *) Right;
+  if (Fixup1->Offset != Fixup2->Offset) {
+    return (Fixup1->Offset < Fixup2->Offset) ? -1 : 1;
+  }
+  return (Fixup1->Index < Fixup2->Index) ? -1 : 1;
+}
+
+VOID
+CoffWriteFixups (
+  VOID
+  )
+{
+  UINT32  Index;
+  UINT32  BlockCount;
+  UINT32  Size;
 
-    mCoffFile = realloc (
-      mCoffFile,
-      mCoffOffset + sizeof(EFI_IMAGE_BASE_RELOCATION) + 2*0x1000
-      );
-    memset (
-      mCoffFile + mCoffOffset, 0,
-      sizeof(EFI_IMAGE_BASE_RELOCATION) + 2*0x1000
-      );
-
-    mCoffBaseRel = (EFI_IMAGE_BASE_RELOCATION*)(mCoffFile + mCoffOffset);
-    mCoffBaseRel->VirtualAddress = Offset & ~0xfff;
-    mCoffBaseRel->SizeOfBlock = sizeof(EFI_IMAGE_BASE_RELOCATION);
-
-    mCoffEntryRel = (UINT16 *)(mCoffBaseRel + 1);
-    mCoffOffset += sizeof(EFI_IMAGE_BASE_RELOCATION);
+  mCoffBaseRel = NULL;
+  if (mCoffFixupCount == 0) {
+    return;
   }
 
   //
-  // Fill the entry.
+  // The fixups are added section by section, in the order of the ELF
+  // relocations. Sorting them by offset gives one block per page.
   //
-  CoffAddFixupEntry((UINT16) ((Type << 12) | (Offset & 0xfff)));
+  qsort (mCoffFixups, mCoffFixupCount, sizeof (COFF_FIXUP), CompareCoffFixup);
+
+  BlockCount = 1;
+  for (Index = 1; Index < mCoffFixupCount; Index++) {
+    if ((mCoffFixups[Index].Offset & ~0xfff) != (mCoffFixups[Index - 1].Offset & ~0xfff)) {
+      BlockCount++;
+    }
+  }
+
+  //
+  // Every block but the last one ends with a null entry and is padded to
+  // 4 bytes; the last one gets padded to the section alignment afterwards.
+  //
+  Size = BlockCount * (sizeof (EFI_IMAGE_BASE_RELOCATION) + 2 * sizeof (UINT16))
+         + mCoffFixupCount * sizeof (UINT16) + 0x100;
+  mCoffFile = realloc (mCoffFile, mCoffOffset + Size);
+  if (mCoffFile == NULL) {
+    Error (NULL, 0, 4001, "Resource", "memory cannot be allocated!");
+    exit (EXIT_FAILURE);
+  }
+  memset (mCoffFile + mCoffOffset, 0, Size);
+
+  for (Index = 0; Index < mCoffFixupCount; Index++) {
+    if (mCoffBaseRel == NULL
+        || mCoffBaseRel->VirtualAddress != (mCoffFixups[Index].Offset & ~0xfff)) {
+      if (mCoffBaseRel != NULL) {
+        //
+        // Add a null entry (is it required ?)
+        //
+        CoffAddFixupEntry (0);
+
+        //
+        // Pad for alignment.
+        //
+        if (mCoffOffset % 4 != 0)
+          CoffAddFixupEntry (0);
+      }
+
+      mCoffBaseRel = (EFI_IMAGE_BASE_RELOCATION*)(mCoffFile + mCoffOffset);
+      mCoffBaseRel->VirtualAddress = mCoffFixups[Index].Offset & ~0xfff;
+      mCoffBaseRel->SizeOfBlock = sizeof(EFI_IMAGE_BASE_RELOCATION);
+
+      mCoffEntryRel = (UINT16 *)(mCoffBaseRel + 1);
+      mCoffOffset += sizeof(EFI_IMAGE_BASE_RELOCATION);
+    }
+
+    //
+    // Fill the entry.
+    //
+    CoffAddFixupEntry((UINT16) ((mCoffFixups[Index].Type << 12) | (mCoffFixups[Index].Offset & 0xfff)));
+  }
+
+  free (mCoffFixups);
+  mCoffFixups     = NULL;
+  mCoffFixupCount = 0;
+  mCoffFixupMax   = 0;
 }
 
 VOID
@@ -168,6 +252,9 @@ ConvertElf (
   ELF_FUNCTION_TABLE              ElfFunctions;
   UINT8                           EiClass;
 
+  mCoffBaseRel    = NULL;
+  mCoffFixupCount = 0;
+
   //
   // Determine ELF type and set function table pointer correctly.
   //
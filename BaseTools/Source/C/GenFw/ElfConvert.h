@@ -72,6 +72,11 @@ CoffAddFixupEntry (
   UINT16 Val
   );
 
+VOID
+CoffWriteFixups (
+  VOID
+  );
+
 
 VOID
 CreateSectionHeader (
@@ -59,6 +59,9 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #define DEFAULT_MC_PAD_BYTE_VALUE  0xFF
 #define DEFAULT_MC_ALIGNMENT       16
 
+#define MAX_BATCH_LINE_LENGTH      0x4000
+#define MAX_BATCH_ARGUMENTS        0x100
+
 #define STATUS_IGNORE 0xA
 //
 // Structure definition for a microcode header
@@ -280,6 +283,12 @@ Returns:
                         except for -o or -r option. It is a action option.\n\
                         If it is combined with other action options, the later\n\
                         input action option will override the previous one.\n");
+  fprintf (stdout, "  --batch BatchFile     Process the images listed in BatchFile in one run.\n\
+                        Each line of BatchFile holds the options and input\n\
+                        file of one image, as given on the command line.\n\
+                        Empty lines and lines starting with # are skipped.\n\
+                        Processing stops at the first image that fails.\n\
+                        It can't be combined with other options.\n");
   fprintf (stdout, "  -v, --verbose         Turn on verbose output with informational messages.\n");
   fprintf (stdout, "  -q, --quiet           Disable all messages except key message and fatal error\n");
   fprintf (stdout, "  -d, --debug level     Enable debug messages, at input debug level.\n");
@@ -1026,8 +1035,9 @@ Returns:
   return Status;
 }
 
+STATIC
 int
-main (
+ProcessImage (
   int  argc,
   char *argv[]
   )
@@ -1035,7 +1045,7 @@ main (
 
 Routine Description:
 
-  Main function.
+  Process one image, as given on the command line.
 
 Arguments:
 
@@ -2725,6 +2735,151 @@ Finish:
   return GetUtilityStatus ();
 }
 
+STATIC
+int
+ProcessBatchFile (
+  CHAR8 *BatchFileName
+  )
+/*++
+
+Routine Description:
+
+  Process the images listed in a batch file, one line per image, so that
+  a build converting many modules only starts GenFw once.
+
+Arguments:
+
+  BatchFileName - The batch file, each line holds the command line options
+                  of one image.
+
+Returns:
+  STATUS_SUCCESS - All images were processed successfully.
+  STATUS_ERROR   - An image failed, or the batch file can't be read.
+
+--*/
+{
+  FILE    *BatchFile;
+  CHAR8   *Line;
+  CHAR8   *Ptr;
+  CHAR8   *Argv[MAX_BATCH_ARGUMENTS + 1];
+  int     Argc;
+  UINT32  LineNum;
+  int     Status;
+
+  BatchFile = fopen (LongFilePath (BatchFileName), "r");
+  if (BatchFile == NULL) {
+    Error (NULL, 0, 0001, "Error opening file", BatchFileName);
+    return STATUS_ERROR;
+  }
+  Line = (CHAR8 *) malloc (MAX_BATCH_LINE_LENGTH);
+  if (Line == NULL) {
+    Error (NULL, 0, 4001, "Resource", "memory cannot be allocated!");
+    fclose (BatchFile);
+    return STATUS_ERROR;
+  }
+
+  Status  = STATUS_SUCCESS;
+  LineNum = 0;
+  while (fgets (Line, MAX_BATCH_LINE_LENGTH, BatchFile) != NULL) {
+    LineNum++;
+    if (strchr (Line, '\n') == NULL && !feof (BatchFile)) {
+      Error (BatchFileName, LineNum, 2000, "Invalid parameter", "line is too long");
+      Status = STATUS_ERROR;
+      break;
+    }
+
+    //
+    // Split the line into arguments; double quotes group an argument with spaces.
+    //
+    Argv[0] = UTILITY_NAME;
+    Argc    = 1;
+    Ptr     = Line;
+    while (TRUE) {
+      while (isspace ((int) *Ptr)) {
+        Ptr++;
+      }
+      if (*Ptr == '\0' || (Argc == 1 && *Ptr == '#')) {
+        break;
+      }
+      if (Argc == MAX_BATCH_ARGUMENTS) {
+        Error (BatchFileName, LineNum, 2000, "Invalid parameter", "too many arguments");
+        Status = STATUS_ERROR;
+        break;
+      }
+      if (*Ptr == '"') {
+        Argv[Argc++] = ++Ptr;
+        while (*Ptr != '\0' && *Ptr != '"') {
+          Ptr++;
+        }
+      } else {
+        Argv[Argc++] = Ptr;
+        while (*Ptr != '\0' && !isspace ((int) *Ptr)) {
+          Ptr++;
+        }
+      }
+      if (*Ptr == '\0') {
+        break;
+      }
+      *Ptr++ = '\0';
+    }
+    Argv[Argc] = NULL;
+    if (Status != STATUS_SUCCESS) {
+      break;
+    }
+    if (Argc == 1) {
+      continue;
+    }
+
+    //
+    // Each image starts from the default settings.
+    //
+    mOutImageType   = FW_DUMMY_IMAGE;
+    mImageTimeStamp = 0;
+    mImageSize      = 0;
+    SetPrintLevel (INFO_LOG_LEVEL);
+
+    Status = ProcessImage (Argc, Argv);
+    if (Status == STATUS_ERROR) {
+      Error (BatchFileName, LineNum, 0, NULL, "image processing failed");
+      break;
+    }
+  }
+
+  free (Line);
+  fclose (BatchFile);
+  return Status;
+}
+
+int
+main (
+  int  argc,
+  char *argv[]
+  )
+/*++
+
+Routine Description:
+
+  Main function.
+
+Arguments:
+
+  argc - Number of command line parameters.
+  argv - Array of pointers to command line parameter strings.
+
+Returns:
+  STATUS_SUCCESS - Utility exits successfully.
+  STATUS_ERROR   - Some error occurred during execution.
+
+--*/
+{
+  if (argc == 3 && stricmp (argv[1], "--batch") == 0) {
+    SetUtilityName (UTILITY_NAME);
+    return ProcessBatchFile (argv[2]);
+  }
+
+  return ProcessImage (argc, argv);
+}
+
 STATIC
 EFI_STATUS
 ZeroDebugData (
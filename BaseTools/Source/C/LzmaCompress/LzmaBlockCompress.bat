@@ -0,0 +1,17 @@
+@REM @file
+@REM This script will exec LzmaCompress tool with --block-size option that
+@REM encodes the input in independent blocks, on all the processors.
+@REM
+@REM Copyright (c) 2015, Intel Corporation. All rights reserved.<BR>
+@REM This program and the accompanying materials
+@REM are licensed and made available under the terms and conditions of the BSD License
+@REM which accompanies this distribution.  The full text of the license may be found at
+@REM http://opensource.org/licenses/bsd-license.php
+@REM
+@REM THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+@REM WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+@REM
+
+@echo off
+LzmaCompress --block-size 4M %*
+@echo on
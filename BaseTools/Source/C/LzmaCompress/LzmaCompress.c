@@ -21,6 +21,10 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#ifndef _WIN32
+#include <time.h>
+#include <unistd.h>
+#endif
 
 #include "Sdk/C/Alloc.h"
 #include "Sdk/C/7zFile.h"
@@ -28,10 +32,28 @@
 #include "Sdk/C/LzmaDec.h"
 #include "Sdk/C/LzmaEnc.h"
 #include "Sdk/C/Bra.h"
+#include "Sdk/C/Threads.h"
 #include "CommonLib.h"
 
 #define LZMA_HEADER_SIZE (LZMA_PROPS_SIZE + 8)
 
+//
+// The block format is a header followed by independent LZMA streams, each
+// one with its own LZMA header. Every block but the last one decodes to
+// BlockSize bytes. The first byte of the signature is never a valid LZMA
+// properties byte, so the format can be told apart from a plain LZMA stream.
+//
+//   UINT32  Signature
+//   UINT32  BlockSize
+//   UINT64  UncompressedSize
+//   UINT32  NumberOfBlocks
+//   UINT32  CompressedSize[NumberOfBlocks]
+//
+#define LZMA_BLOCK_SIGNATURE      0x4B425AFF
+#define LZMA_BLOCK_HEADER_SIZE    20
+#define LZMA_BLOCK_MIN_SIZE       (1 << 12)
+#define LZMA_BLOCK_MAX_SIZE       (1 << 30)
+
 typedef enum {
   NoConverter, 
   X86Converter,
@@ -49,10 +71,12 @@ static ISzAlloc g_Alloc = { SzAlloc, SzFree };
 
 static Bool mQuietMode = False;
 static CONVERTER_TYPE mConType = NoConverter;
+static int mNumThreads = -1;
+static size_t mBlockSize = 0;
 
 #define UTILITY_NAME "LzmaCompress"
 #define UTILITY_MAJOR_VERSION 0
-#define UTILITY_MINOR_VERSION 2
+#define UTILITY_MINOR_VERSION 3
 #define INTEL_COPYRIGHT \
   "Copyright (c) 2009-2012, Intel Corporation. All rights reserved."
 void PrintHelp(char *buffer)
@@ -61,10 +85,17 @@ void PrintHelp(char *buffer)
       "\n" UTILITY_NAME " - " INTEL_COPYRIGHT "\n"
       "Based on LZMA Utility " MY_VERSION_COPYRIGHT_DATE "\n"
       "\nUsage:  LzmaCompress -e|-d [options] <inputFile>\n"
+             "        LzmaCompress --benchmark [options] <inputFile> [<inputFile>...]\n"
              "  -e: encode file\n"
-             "  -d: decode file\n"
+             "  -d: decode file, in either the plain or the block format\n"
              "  -o FileName, --output FileName: specify the output filename\n"
              "  --f86: enable converter for x86 code\n"
+             "  --threads N: number of threads, 0 for one per processor. Without\n"
+             "      --block-size, 2 or more run the match finder in its own thread.\n"
+             "  --block-size N[K|M]: encode independent blocks of N bytes in\n"
+             "      parallel, in the block format of the LZMA block GUIDed section\n"
+             "  --benchmark: encode the input files with the single threaded encoder\n"
+             "      and with the selected options, and report speed and ratio\n"
              "  -v, --verbose: increase output messages\n"
              "  -q, --quiet: reduce output messages\n"
              "  --debug [0-9]: set debug level\n"
@@ -97,86 +128,437 @@ void PrintVersion(char *buffer)
   sprintf (buffer, "%s Version %d.%d %s ", UTILITY_NAME, UTILITY_MAJOR_VERSION, UTILITY_MINOR_VERSION, __BUILD_VERSION);
 }
 
-static SRes Encode(ISeqOutStream *outStream, ISeqInStream *inStream, UInt64 fileSize)
+static int GetNumberOfProcessors(void)
+{
+#ifdef _WIN32
+  SYSTEM_INFO systemInfo;
+  GetSystemInfo(&systemInfo);
+  return (int)systemInfo.dwNumberOfProcessors;
+#else
+  long numProcessors = sysconf(_SC_NPROCESSORS_ONLN);
+  return (numProcessors > 0) ? (int)numProcessors : 1;
+#endif
+}
+
+static double GetTimeInSeconds(void)
+{
+#ifdef _WIN32
+  LARGE_INTEGER frequency;
+  LARGE_INTEGER counter;
+  QueryPerformanceFrequency(&frequency);
+  QueryPerformanceCounter(&counter);
+  return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+#endif
+}
+
+static void SetUi32(Byte *p, UInt32 value)
+{
+  int i;
+  for (i = 0; i < 4; i++)
+    p[i] = (Byte)(value >> (8 * i));
+}
+
+static UInt32 GetUi32(const Byte *p)
+{
+  return (UInt32)p[0] | ((UInt32)p[1] << 8) | ((UInt32)p[2] << 16) | ((UInt32)p[3] << 24);
+}
+
+static UInt64 GetUi64(const Byte *p)
+{
+  return (UInt64)GetUi32(p) | ((UInt64)GetUi32(p + 4) << 32);
+}
+
+/**
+  Encode a buffer into one LZMA stream with its LZMA header.
+
+  @param inBuffer    The data to encode.
+  @param inSize      The size of the data.
+  @param numThreads  2 or more to run the match finder in its own thread.
+  @param dictSize    The dictionary size, 0 for the default one.
+  @param outBuffer   Returns the allocated LZMA stream, freed by the caller.
+  @param outSize     Returns the size of the LZMA stream.
+**/
+static SRes EncodeBuffer(const Byte *inBuffer, size_t inSize, int numThreads, UInt32 dictSize, Byte **outBuffer, size_t *outSize)
 {
   SRes res;
-  size_t inSize = (size_t)fileSize;
-  Byte *inBuffer = 0;
-  Byte *outBuffer = 0;
-  Byte *filteredStream = 0;
-  size_t outSize;
+  Byte *buffer;
+  size_t bufferSize;
+  size_t outSizeProcessed;
+  size_t outPropsSize = LZMA_PROPS_SIZE;
   CLzmaEncProps props;
+  int i;
 
   LzmaEncProps_Init(&props);
+  //
+  // The multithreaded match finder is only used when asked for, so the
+  // default output doesn't depend on the build of the tool.
+  //
+  props.numThreads = (numThreads > 1) ? 2 : 1;
+  if (dictSize != 0)
+    props.dictSize = dictSize;
   LzmaEncProps_Normalize(&props);
 
-  if (inSize != 0) {
-    inBuffer = (Byte *)MyAlloc(inSize);
-    if (inBuffer == 0)
-      return SZ_ERROR_MEM;
-  } else {
-    return SZ_ERROR_INPUT_EOF;
+  // we allocate 105% of original size + 64KB for output buffer
+  bufferSize = inSize / 20 * 21 + (1 << 16);
+  buffer = (Byte *)MyAlloc(bufferSize);
+  if (buffer == 0)
+    return SZ_ERROR_MEM;
+
+  for (i = 0; i < 8; i++)
+    buffer[i + LZMA_PROPS_SIZE] = (Byte)((UInt64)inSize >> (8 * i));
+
+  outSizeProcessed = bufferSize - LZMA_HEADER_SIZE;
+  res = LzmaEncode(buffer + LZMA_HEADER_SIZE, &outSizeProcessed,
+      inBuffer, inSize,
+      &props, buffer, &outPropsSize, 0,
+      NULL, &g_Alloc, &g_Alloc);
+  if (res != SZ_OK) {
+    MyFree(buffer);
+    return res;
+  }
+
+  *outBuffer = buffer;
+  *outSize = LZMA_HEADER_SIZE + outSizeProcessed;
+  return SZ_OK;
+}
+
+//
+// The state shared by the threads encoding the blocks. Each thread takes the
+// next block to encode until all of them are done, or one of them failed.
+//
+typedef struct {
+  const Byte *inBuffer;
+  size_t inSize;
+  size_t blockSize;
+  UInt32 numBlocks;
+  UInt32 nextBlock;
+  Byte **blockBuffers;
+  size_t *blockSizes;
+  SRes res;
+  CCriticalSection cs;
+} CBlockEncoder;
+
+static THREAD_FUNC_DECL BlockEncoderThread(void *p)
+{
+  CBlockEncoder *encoder = (CBlockEncoder *)p;
+  UInt32 block;
+  size_t offset;
+  size_t size;
+  SRes res;
+
+  for (;;) {
+    CriticalSection_Enter(&encoder->cs);
+    block = encoder->nextBlock;
+    if (encoder->res == SZ_OK && block < encoder->numBlocks)
+      encoder->nextBlock++;
+    else
+      block = encoder->numBlocks;
+    CriticalSection_Leave(&encoder->cs);
+
+    if (block == encoder->numBlocks)
+      break;
+
+    offset = (size_t)block * encoder->blockSize;
+    size = encoder->inSize - offset;
+    if (size > encoder->blockSize)
+      size = encoder->blockSize;
+
+    //
+    // A block never refers to data beyond itself, so a bigger dictionary
+    // would only cost time to allocate and initialize.
+    //
+    res = EncodeBuffer(encoder->inBuffer + offset, size, 1, (UInt32)encoder->blockSize,
+        &encoder->blockBuffers[block], &encoder->blockSizes[block]);
+    if (res != SZ_OK) {
+      CriticalSection_Enter(&encoder->cs);
+      encoder->res = res;
+      CriticalSection_Leave(&encoder->cs);
+    }
   }
-  
-  if (SeqInStream_Read(inStream, inBuffer, inSize) != SZ_OK) {
-    res = SZ_ERROR_READ;
+
+  return 0;
+}
+
+/**
+  Encode a buffer into the block format, encoding the blocks in parallel.
+
+  @param inBuffer    The data to encode.
+  @param inSize      The size of the data.
+  @param blockSize   The uncompressed size of each block.
+  @param numThreads  The number of threads encoding blocks.
+  @param outBuffer   Returns the allocated output, freed by the caller.
+  @param outSize     Returns the size of the output.
+**/
+static SRes EncodeBlocks(const Byte *inBuffer, size_t inSize, size_t blockSize, int numThreads, Byte **outBuffer, size_t *outSize)
+{
+  CBlockEncoder encoder;
+  CThread *threads = 0;
+  int numCreated = 0;
+  size_t headerSize;
+  size_t totalSize;
+  Byte *buffer;
+  Byte *p;
+  UInt32 i;
+  int t;
+  SRes res;
+
+  memset(&encoder, 0, sizeof(encoder));
+  encoder.inBuffer = inBuffer;
+  encoder.inSize = inSize;
+  encoder.blockSize = blockSize;
+  encoder.numBlocks = (UInt32)((inSize + blockSize - 1) / blockSize);
+  encoder.res = SZ_OK;
+
+  encoder.blockBuffers = (Byte **)MyAlloc(encoder.numBlocks * sizeof(Byte *));
+  encoder.blockSizes = (size_t *)MyAlloc(encoder.numBlocks * sizeof(size_t));
+  if (encoder.blockBuffers == 0 || encoder.blockSizes == 0) {
+    res = SZ_ERROR_MEM;
     goto Done;
   }
+  memset(encoder.blockBuffers, 0, encoder.numBlocks * sizeof(Byte *));
 
-  // we allocate 105% of original size + 64KB for output buffer
-  outSize = (size_t)fileSize / 20 * 21 + (1 << 16);
-  outBuffer = (Byte *)MyAlloc(outSize);
-  if (outBuffer == 0) {
+  if (CriticalSection_Init(&encoder.cs) != 0) {
+    res = SZ_ERROR_THREAD;
+    goto Done;
+  }
+
+  if (numThreads > (int)encoder.numBlocks)
+    numThreads = (int)encoder.numBlocks;
+
+  //
+  // The calling thread encodes blocks too.
+  //
+  if (numThreads > 1) {
+    threads = (CThread *)MyAlloc((numThreads - 1) * sizeof(CThread));
+    if (threads != 0) {
+      for (t = 0; t < numThreads - 1; t++) {
+        Thread_Construct(&threads[t]);
+        if (Thread_Create(&threads[t], BlockEncoderThread, &encoder) != 0)
+          break;
+        numCreated++;
+      }
+    }
+  }
+
+  BlockEncoderThread(&encoder);
+
+  for (t = 0; t < numCreated; t++) {
+    Thread_Wait(&threads[t]);
+    Thread_Close(&threads[t]);
+  }
+  MyFree(threads);
+  CriticalSection_Delete(&encoder.cs);
+
+  res = encoder.res;
+  if (res != SZ_OK)
+    goto Done;
+
+  headerSize = LZMA_BLOCK_HEADER_SIZE + (size_t)encoder.numBlocks * 4;
+  totalSize = headerSize;
+  for (i = 0; i < encoder.numBlocks; i++)
+    totalSize += encoder.blockSizes[i];
+
+  buffer = (Byte *)MyAlloc(totalSize);
+  if (buffer == 0) {
     res = SZ_ERROR_MEM;
     goto Done;
   }
-  
-  {
-    int i;
+
+  SetUi32(buffer, LZMA_BLOCK_SIGNATURE);
+  SetUi32(buffer + 4, (UInt32)blockSize);
+  SetUi32(buffer + 8, (UInt32)inSize);
+  SetUi32(buffer + 12, (UInt32)((UInt64)inSize >> 32));
+  SetUi32(buffer + 16, encoder.numBlocks);
+
+  p = buffer + headerSize;
+  for (i = 0; i < encoder.numBlocks; i++) {
+    SetUi32(buffer + LZMA_BLOCK_HEADER_SIZE + i * 4, (UInt32)encoder.blockSizes[i]);
+    memcpy(p, encoder.blockBuffers[i], encoder.blockSizes[i]);
+    p += encoder.blockSizes[i];
+  }
+
+  *outBuffer = buffer;
+  *outSize = totalSize;
+
+Done:
+  if (encoder.blockBuffers != 0) {
+    for (i = 0; i < encoder.numBlocks; i++)
+      MyFree(encoder.blockBuffers[i]);
+  }
+  MyFree(encoder.blockBuffers);
+  MyFree(encoder.blockSizes);
+
+  return res;
+}
+
+/**
+  Encode a buffer with the options selected on the command line.
+
+  @param inBuffer    The data to encode. It is filtered in place if a converter is selected.
+  @param inSize      The size of the data.
+  @param numThreads  The number of threads.
+  @param blockSize   The uncompressed size of each block, 0 for a plain LZMA stream.
+  @param outBuffer   Returns the allocated output, freed by the caller.
+  @param outSize     Returns the size of the output.
+**/
+static SRes EncodeData(Byte *inBuffer, size_t inSize, int numThreads, size_t blockSize, Byte **outBuffer, size_t *outSize)
+{
+  if (mConType == X86Converter) {
+    UInt32 x86State;
+    x86_Convert_Init(x86State);
+    x86_Convert(inBuffer, (SizeT) inSize, 0, &x86State, 1);
+  }
+
+  if (blockSize != 0)
+    return EncodeBlocks(inBuffer, inSize, blockSize, numThreads, outBuffer, outSize);
+
+  return EncodeBuffer(inBuffer, inSize, numThreads, 0, outBuffer, outSize);
+}
+
+/**
+  Decode a buffer in the plain or the block format.
+
+  @param inBuffer    The encoded data.
+  @param inSize      The size of the encoded data.
+  @param outBuffer   Returns the allocated decoded data, freed by the caller.
+  @param outSize     Returns the size of the decoded data.
+**/
+static SRes DecodeData(const Byte *inBuffer, size_t inSize, Byte **outBuffer, size_t *outSize)
+{
+  SRes res;
+  Byte *buffer;
+  UInt64 outSize64;
+  size_t destLen;
+  size_t srcLen;
+  ELzmaStatus status;
+  UInt32 blockSize;
+  UInt32 numBlocks;
+  UInt32 i;
+  size_t offset;
+  size_t blockLen;
+  size_t blockOut;
+  const Byte *p;
+  const Byte *end;
+
+  if (inSize < LZMA_HEADER_SIZE)
+    return SZ_ERROR_INPUT_EOF;
+
+  if (GetUi32(inBuffer) == LZMA_BLOCK_SIGNATURE) {
+    if (inSize < LZMA_BLOCK_HEADER_SIZE)
+      return SZ_ERROR_INPUT_EOF;
+    blockSize = GetUi32(inBuffer + 4);
+    outSize64 = GetUi64(inBuffer + 8);
+    numBlocks = GetUi32(inBuffer + 16);
+    if (blockSize == 0 || (inSize - LZMA_BLOCK_HEADER_SIZE) / 4 < numBlocks ||
+        (outSize64 + blockSize - 1) / blockSize != numBlocks)
+      return SZ_ERROR_DATA;
+  } else {
+    blockSize = 0;
+    numBlocks = 1;
+    outSize64 = 0;
     for (i = 0; i < 8; i++)
-      outBuffer[i + LZMA_PROPS_SIZE] = (Byte)(fileSize >> (8 * i));
+      outSize64 += ((UInt64)inBuffer[LZMA_PROPS_SIZE + i]) << (i * 8);
   }
 
-  if (mConType != NoConverter)
-  {
-    filteredStream = (Byte *)MyAlloc(inSize);
-    if (filteredStream == 0) {
-      res = SZ_ERROR_MEM;
-      goto Done;
-    }
-    memcpy(filteredStream, inBuffer, inSize);
-    
-    if (mConType == X86Converter) {
-      {
-        UInt32 x86State;
-        x86_Convert_Init(x86State);
-        x86_Convert(filteredStream, (SizeT) inSize, 0, &x86State, 1);
+  *outSize = (size_t)outSize64;
+  *outBuffer = 0;
+  if (*outSize == 0)
+    return SZ_OK;
+
+  buffer = (Byte *)MyAlloc(*outSize);
+  if (buffer == 0)
+    return SZ_ERROR_MEM;
+
+  if (blockSize == 0) {
+    destLen = *outSize;
+    srcLen = inSize - LZMA_HEADER_SIZE;
+    res = LzmaDecode(buffer, &destLen, inBuffer + LZMA_HEADER_SIZE, &srcLen,
+        inBuffer, LZMA_PROPS_SIZE, LZMA_FINISH_END, &status, &g_Alloc);
+  } else {
+    res = SZ_OK;
+    p = inBuffer + LZMA_BLOCK_HEADER_SIZE + (size_t)numBlocks * 4;
+    end = inBuffer + inSize;
+    for (i = 0, offset = 0; i < numBlocks && res == SZ_OK; i++, offset += destLen) {
+      blockLen = GetUi32(inBuffer + LZMA_BLOCK_HEADER_SIZE + i * 4);
+      if (blockLen < LZMA_HEADER_SIZE || blockLen > (size_t)(end - p)) {
+        res = SZ_ERROR_DATA;
+        break;
       }
+      blockOut = *outSize - offset;
+      if (blockOut > blockSize)
+        blockOut = blockSize;
+      destLen = blockOut;
+      srcLen = blockLen - LZMA_HEADER_SIZE;
+      res = LzmaDecode(buffer + offset, &destLen, p + LZMA_HEADER_SIZE, &srcLen,
+          p, LZMA_PROPS_SIZE, LZMA_FINISH_END, &status, &g_Alloc);
+      /* Every block but the last one holds exactly blockSize bytes */
+      if (res == SZ_OK && destLen != blockOut)
+        res = SZ_ERROR_DATA;
+      p += blockLen;
     }
   }
 
+  if (res != SZ_OK) {
+    MyFree(buffer);
+    return res;
+  }
+
+  if (mConType == X86Converter)
   {
-    size_t outSizeProcessed = outSize - LZMA_HEADER_SIZE;
-    size_t outPropsSize = LZMA_PROPS_SIZE;
-    
-    res = LzmaEncode(outBuffer + LZMA_HEADER_SIZE, &outSizeProcessed,
-        mConType != NoConverter ? filteredStream : inBuffer, inSize,
-        &props, outBuffer, &outPropsSize, 0,
-        NULL, &g_Alloc, &g_Alloc);
-    
-    if (res != SZ_OK)
-      goto Done;
-
-    outSize = LZMA_HEADER_SIZE + outSizeProcessed;
+    UInt32 x86State;
+    x86_Convert_Init(x86State);
+    x86_Convert(buffer, (SizeT) *outSize, 0, &x86State, 0);
+  }
+
+  *outBuffer = buffer;
+  return SZ_OK;
+}
+
+static SRes ReadInput(ISeqInStream *inStream, UInt64 fileSize, Byte **inBuffer)
+{
+  size_t inSize = (size_t)fileSize;
+
+  if (inSize == 0)
+    return SZ_ERROR_INPUT_EOF;
+
+  *inBuffer = (Byte *)MyAlloc(inSize);
+  if (*inBuffer == 0)
+    return SZ_ERROR_MEM;
+
+  if (SeqInStream_Read(inStream, *inBuffer, inSize) != SZ_OK) {
+    MyFree(*inBuffer);
+    *inBuffer = 0;
+    return SZ_ERROR_READ;
   }
 
+  return SZ_OK;
+}
+
+static SRes Encode(ISeqOutStream *outStream, ISeqInStream *inStream, UInt64 fileSize)
+{
+  SRes res;
+  Byte *inBuffer = 0;
+  Byte *outBuffer = 0;
+  size_t outSize;
+
+  res = ReadInput(inStream, fileSize, &inBuffer);
+  if (res != SZ_OK)
+    return res;
+
+  res = EncodeData(inBuffer, (size_t)fileSize, mNumThreads, mBlockSize, &outBuffer, &outSize);
+  if (res != SZ_OK)
+    goto Done;
+
   if (outStream->Write(outStream, outBuffer, outSize) != outSize)
     res = SZ_ERROR_WRITE;
 
 Done:
   MyFree(outBuffer);
   MyFree(inBuffer);
-  MyFree(filteredStream);
 
   return res;
 }
@@ -184,67 +566,138 @@ Done:
 static SRes Decode(ISeqOutStream *outStream, ISeqInStream *inStream, UInt64 fileSize)
 {
   SRes res;
-  size_t inSize = (size_t)fileSize;
   Byte *inBuffer = 0;
   Byte *outBuffer = 0;
   size_t outSize = 0;
-  size_t inSizePure;
-  ELzmaStatus status;
-  UInt64 outSize64 = 0;
-
-  int i;
 
-  if (inSize < LZMA_HEADER_SIZE) 
+  if (fileSize < LZMA_HEADER_SIZE)
     return SZ_ERROR_INPUT_EOF;
 
-  inBuffer = (Byte *)MyAlloc(inSize);
-  if (inBuffer == 0)
-    return SZ_ERROR_MEM;
-  
-  if (SeqInStream_Read(inStream, inBuffer, inSize) != SZ_OK) {
-    res = SZ_ERROR_READ;
+  res = ReadInput(inStream, fileSize, &inBuffer);
+  if (res != SZ_OK)
+    return res;
+
+  res = DecodeData(inBuffer, (size_t)fileSize, &outBuffer, &outSize);
+  if (res != SZ_OK)
     goto Done;
-  }
 
-  for (i = 0; i < 8; i++)
-    outSize64 += ((UInt64)inBuffer[LZMA_PROPS_SIZE + i]) << (i * 8);
-
-  outSize = (size_t)outSize64;
-  if (outSize != 0) {
-    outBuffer = (Byte *)MyAlloc(outSize);
-    if (outBuffer == 0) {
-      res = SZ_ERROR_MEM;
-      goto Done;
-    }
-  } else {
-    res = SZ_OK;
+  if (outSize != 0 && outStream->Write(outStream, outBuffer, outSize) != outSize)
+    res = SZ_ERROR_WRITE;
+
+Done:
+  MyFree(outBuffer);
+  MyFree(inBuffer);
+
+  return res;
+}
+
+/**
+  Encode a file with the single threaded encoder and with the selected
+  options, check that the output of the selected options decodes back to the
+  input, and print the speed and the ratio of both.
+
+  @param inputFile    The file to encode.
+  @param totalIn      Accumulates the size of the input files.
+  @param totalOut     Accumulates the output sizes, [0] single threaded and [1] selected.
+  @param totalTime    Accumulates the encoding times, [0] single threaded and [1] selected.
+**/
+static SRes Benchmark(const char *inputFile, UInt64 *totalIn, UInt64 totalOut[2], double totalTime[2])
+{
+  CFileSeqInStream inStream;
+  UInt64 fileSize;
+  Byte *inBuffer = 0;
+  Byte *workBuffer = 0;
+  Byte *outBuffer = 0;
+  Byte *decodedBuffer = 0;
+  size_t inSize;
+  size_t outSize[2];
+  size_t decodedSize;
+  double time[2];
+  int pass;
+  SRes res;
+
+  FileSeqInStream_CreateVTable(&inStream);
+  File_Construct(&inStream.file);
+
+  if (InFile_Open(&inStream.file, inputFile) != 0)
+    return SZ_ERROR_READ;
+  File_GetLength(&inStream.file, &fileSize);
+  res = ReadInput(&inStream.s, fileSize, &inBuffer);
+  File_Close(&inStream.file);
+  if (res != SZ_OK)
+    return res;
+
+  inSize = (size_t)fileSize;
+  workBuffer = (Byte *)MyAlloc(inSize);
+  if (workBuffer == 0) {
+    res = SZ_ERROR_MEM;
     goto Done;
   }
 
-  inSizePure = inSize - LZMA_HEADER_SIZE;
-  res = LzmaDecode(outBuffer, &outSize, inBuffer + LZMA_HEADER_SIZE, &inSizePure,
-      inBuffer, LZMA_PROPS_SIZE, LZMA_FINISH_END, &status, &g_Alloc);
+  //
+  // The single threaded encoder first, its output is only measured.
+  //
+  memcpy(workBuffer, inBuffer, inSize);
+  time[0] = GetTimeInSeconds();
+  res = EncodeData(workBuffer, inSize, 1, 0, &outBuffer, &outSize[0]);
+  time[0] = GetTimeInSeconds() - time[0];
+  if (res != SZ_OK)
+    goto Done;
+  MyFree(outBuffer);
+  outBuffer = 0;
 
+  memcpy(workBuffer, inBuffer, inSize);
+  time[1] = GetTimeInSeconds();
+  res = EncodeData(workBuffer, inSize, mNumThreads, mBlockSize, &outBuffer, &outSize[1]);
+  time[1] = GetTimeInSeconds() - time[1];
   if (res != SZ_OK)
     goto Done;
 
-  if (mConType == X86Converter)
-  {
-    UInt32 x86State;
-    x86_Convert_Init(x86State);
-    x86_Convert(outBuffer, (SizeT) outSize, 0, &x86State, 0);
-  }
+  res = DecodeData(outBuffer, outSize[1], &decodedBuffer, &decodedSize);
+  if (res == SZ_OK && (decodedSize != inSize || memcmp(decodedBuffer, inBuffer, inSize) != 0))
+    res = SZ_ERROR_DATA;
+  if (res != SZ_OK)
+    goto Done;
 
-  if (outStream->Write(outStream, outBuffer, outSize) != outSize)
-    res = SZ_ERROR_WRITE;
+  printf("%s: %u bytes\n", inputFile, (unsigned)inSize);
+  for (pass = 0; pass < 2; pass++) {
+    printf("  %-16s %8.2f MB/s  %10u bytes  ratio %6.2f%%\n",
+        pass == 0 ? "single thread:" : "selected:",
+        (double)inSize / (time[pass] > 0 ? time[pass] : 1e-9) / (1024 * 1024),
+        (unsigned)outSize[pass],
+        100.0 * (double)outSize[pass] / (double)inSize);
+    totalOut[pass] += outSize[pass];
+    totalTime[pass] += time[pass];
+  }
+  *totalIn += inSize;
 
 Done:
+  MyFree(decodedBuffer);
   MyFree(outBuffer);
+  MyFree(workBuffer);
   MyFree(inBuffer);
-
   return res;
 }
 
+static size_t ParseSize(const char *str)
+{
+  char *end;
+  unsigned long value = strtoul(str, &end, 0);
+
+  if (end == str)
+    return 0;
+  if (*end == 'K' || *end == 'k') {
+    value <<= 10;
+    end++;
+  } else if (*end == 'M' || *end == 'm') {
+    value <<= 20;
+    end++;
+  }
+  if (*end != '\0')
+    return 0;
+  return (size_t)value;
+}
+
 int main2(int numArgs, const char *args[], char *rs)
 {
   CFileSeqInStream inStream;
@@ -252,6 +705,9 @@ int main2(int numArgs, const char *args[], char *rs)
   int res;
   int encodeMode = 0;
   Bool modeWasSet = False;
+  Bool benchmarkMode = False;
+  const char *inputFiles[64];
+  int numInputFiles = 0;
   const char *inputFile = NULL;
   const char *outputFile = "file.tmp";
   int param;
@@ -273,6 +729,8 @@ int main2(int numArgs, const char *args[], char *rs)
     if (strcmp(args[param], "-e") == 0 || strcmp(args[param], "-d") == 0) {
       encodeMode = (args[param][1] == 'e');
       modeWasSet = True;
+    } else if (strcmp(args[param], "--benchmark") == 0) {
+      benchmarkMode = True;
     } else if (strcmp(args[param], "--f86") == 0) {
       mConType = X86Converter;
     } else if (strcmp(args[param], "-o") == 0 ||
@@ -281,6 +739,22 @@ int main2(int numArgs, const char *args[], char *rs)
         return PrintUserError(rs);
       }
       outputFile = args[++param];
+    } else if (strcmp(args[param], "--threads") == 0) {
+      if (numArgs < (param + 2)) {
+        return PrintUserError(rs);
+      }
+      mNumThreads = atoi(args[++param]);
+      if (mNumThreads < 0) {
+        return PrintUserError(rs);
+      }
+    } else if (strcmp(args[param], "--block-size") == 0) {
+      if (numArgs < (param + 2)) {
+        return PrintUserError(rs);
+      }
+      mBlockSize = ParseSize(args[++param]);
+      if (mBlockSize < LZMA_BLOCK_MIN_SIZE || mBlockSize > LZMA_BLOCK_MAX_SIZE) {
+        return PrintError(rs, "Block size must be from 4K to 1024M");
+      }
     } else if (strcmp(args[param], "--debug") == 0) {
       if (numArgs < (param + 2)) {
         return PrintUserError(rs);
@@ -312,16 +786,63 @@ int main2(int numArgs, const char *args[], char *rs)
     } else if (strcmp(args[param], "--version") == 0) {
       PrintVersion(rs);
       return 0;
-    } else if (inputFile == NULL) {
-      inputFile = args[param];
+    } else if (numInputFiles < (int)(sizeof(inputFiles) / sizeof(inputFiles[0]))) {
+      inputFiles[numInputFiles++] = args[param];
     } else {
       return PrintUserError(rs);
     }
   }
 
-  if ((inputFile == NULL) || !modeWasSet) {
+  //
+  // Blocks are encoded by one thread per processor unless told otherwise,
+  // a plain LZMA stream by one thread.
+  //
+  if (mBlockSize != 0 && mConType != NoConverter) {
+    return PrintError(rs, "--f86 can not be used with --block-size");
+  }
+
+  if (mNumThreads == 0 || (mNumThreads < 0 && mBlockSize != 0)) {
+    mNumThreads = GetNumberOfProcessors();
+  } else if (mNumThreads < 0) {
+    mNumThreads = 1;
+  }
+
+  if (benchmarkMode) {
+    UInt64 totalIn = 0;
+    UInt64 totalOut[2] = { 0, 0 };
+    double totalTime[2] = { 0, 0 };
+    int i;
+
+    if (numInputFiles == 0) {
+      return PrintUserError(rs);
+    }
+
+    for (i = 0; i < numInputFiles; i++) {
+      res = Benchmark(inputFiles[i], &totalIn, totalOut, totalTime);
+      if (res != SZ_OK) {
+        sprintf(rs + strlen(rs), "\nError: benchmark of %s failed", inputFiles[i]);
+        return PrintErrorNumber(rs, res);
+      }
+    }
+
+    printf("Total %u bytes, %d threads, block size %u:\n", (unsigned)totalIn, mNumThreads, (unsigned)mBlockSize);
+    for (i = 0; i < 2; i++) {
+      printf("  %-16s %8.2f MB/s  %10u bytes  ratio %6.2f%%\n",
+          i == 0 ? "single thread:" : "selected:",
+          (double)totalIn / (totalTime[i] > 0 ? totalTime[i] : 1e-9) / (1024 * 1024),
+          (unsigned)totalOut[i],
+          100.0 * (double)totalOut[i] / (double)totalIn);
+    }
+    printf("  speedup %.2fx, size %+.2f%%\n",
+        totalTime[0] / (totalTime[1] > 0 ? totalTime[1] : 1e-9),
+        100.0 * ((double)totalOut[1] - (double)totalOut[0]) / (double)totalOut[0]);
+    return 0;
+  }
+
+  if (numInputFiles != 1 || !modeWasSet) {
     return PrintUserError(rs);
   }
+  inputFile = inputFiles[0];
 
   {
     size_t t4 = sizeof(UInt32);
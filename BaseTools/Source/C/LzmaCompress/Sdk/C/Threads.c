@@ -4,6 +4,9 @@ Igor Pavlov
 Public domain */
 
 #include "Threads.h"
+
+#ifdef _WIN32
+
 #include <process.h>
 
 static WRes GetError()
@@ -107,3 +110,166 @@ WRes CriticalSection_Init(CCriticalSection *p)
   return 0;
 }
 
+#else
+
+#include <errno.h>
+
+static void *ThreadStart(void *p)
+{
+  CThread *thread = (CThread *)p;
+  thread->startAddress(thread->parameter);
+  return NULL;
+}
+
+WRes Thread_Create(CThread *thread, THREAD_FUNC_RET_TYPE (THREAD_FUNC_CALL_TYPE *startAddress)(void *), void *parameter)
+{
+  WRes res;
+  thread->startAddress = startAddress;
+  thread->parameter = parameter;
+  res = pthread_create(&thread->thread, NULL, ThreadStart, thread);
+  thread->created = (res == 0);
+  return res;
+}
+
+WRes Thread_Wait(CThread *thread)
+{
+  if (!thread->created)
+    return EINVAL;
+  return pthread_join(thread->thread, NULL);
+}
+
+WRes Thread_Close(CThread *thread)
+{
+  thread->created = 0;
+  return 0;
+}
+
+static WRes Event_Create(CEvent *p, int manualReset, int initialSignaled)
+{
+  WRes res = pthread_mutex_init(&p->mutex, NULL);
+  if (res != 0)
+    return res;
+  res = pthread_cond_init(&p->cond, NULL);
+  if (res != 0)
+  {
+    pthread_mutex_destroy(&p->mutex);
+    return res;
+  }
+  p->manualReset = manualReset;
+  p->state = (initialSignaled ? 1 : 0);
+  p->created = 1;
+  return 0;
+}
+
+WRes ManualResetEvent_Create(CManualResetEvent *p, int initialSignaled)
+  { return Event_Create(p, 1, initialSignaled); }
+WRes ManualResetEvent_CreateNotSignaled(CManualResetEvent *p)
+  { return ManualResetEvent_Create(p, 0); }
+
+WRes AutoResetEvent_Create(CAutoResetEvent *p, int initialSignaled)
+  { return Event_Create(p, 0, initialSignaled); }
+WRes AutoResetEvent_CreateNotSignaled(CAutoResetEvent *p)
+  { return AutoResetEvent_Create(p, 0); }
+
+WRes Event_Set(CEvent *p)
+{
+  pthread_mutex_lock(&p->mutex);
+  p->state = 1;
+  if (p->manualReset)
+    pthread_cond_broadcast(&p->cond);
+  else
+    pthread_cond_signal(&p->cond);
+  pthread_mutex_unlock(&p->mutex);
+  return 0;
+}
+
+WRes Event_Reset(CEvent *p)
+{
+  pthread_mutex_lock(&p->mutex);
+  p->state = 0;
+  pthread_mutex_unlock(&p->mutex);
+  return 0;
+}
+
+WRes Event_Wait(CEvent *p)
+{
+  pthread_mutex_lock(&p->mutex);
+  while (p->state == 0)
+    pthread_cond_wait(&p->cond, &p->mutex);
+  if (!p->manualReset)
+    p->state = 0;
+  pthread_mutex_unlock(&p->mutex);
+  return 0;
+}
+
+WRes Event_Close(CEvent *p)
+{
+  if (!p->created)
+    return 0;
+  p->created = 0;
+  pthread_cond_destroy(&p->cond);
+  return pthread_mutex_destroy(&p->mutex);
+}
+
+
+WRes Semaphore_Create(CSemaphore *p, UInt32 initiallyCount, UInt32 maxCount)
+{
+  WRes res = pthread_mutex_init(&p->mutex, NULL);
+  if (res != 0)
+    return res;
+  res = pthread_cond_init(&p->cond, NULL);
+  if (res != 0)
+  {
+    pthread_mutex_destroy(&p->mutex);
+    return res;
+  }
+  p->count = initiallyCount;
+  p->maxCount = maxCount;
+  p->created = 1;
+  return 0;
+}
+
+WRes Semaphore_ReleaseN(CSemaphore *p, UInt32 releaseCount)
+{
+  WRes res = 0;
+  pthread_mutex_lock(&p->mutex);
+  if (p->count + releaseCount > p->maxCount)
+    res = EINVAL;
+  else
+  {
+    p->count += releaseCount;
+    pthread_cond_broadcast(&p->cond);
+  }
+  pthread_mutex_unlock(&p->mutex);
+  return res;
+}
+WRes Semaphore_Release1(CSemaphore *p)
+{
+  return Semaphore_ReleaseN(p, 1);
+}
+
+WRes Semaphore_Wait(CSemaphore *p)
+{
+  pthread_mutex_lock(&p->mutex);
+  while (p->count == 0)
+    pthread_cond_wait(&p->cond, &p->mutex);
+  p->count--;
+  pthread_mutex_unlock(&p->mutex);
+  return 0;
+}
+
+WRes Semaphore_Close(CSemaphore *p)
+{
+  if (!p->created)
+    return 0;
+  p->created = 0;
+  pthread_cond_destroy(&p->cond);
+  return pthread_mutex_destroy(&p->mutex);
+}
+
+WRes CriticalSection_Init(CCriticalSection *p)
+{
+  return pthread_mutex_init(p, NULL);
+}
+
+#endif
@@ -25,7 +25,7 @@
 //
 #define UTILITY_NAME "TianoCompress"
 #define UTILITY_MAJOR_VERSION 0
-#define UTILITY_MINOR_VERSION 1
+#define UTILITY_MINOR_VERSION 2
 
 //
 // Default output file name
@@ -96,194 +96,6 @@ GetFileContents (
   OUT UINT32  *BufferLength
   );
   
-STATIC
-VOID
-PutDword(
-  IN UINT32 Data
-  );
-
-STATIC
-EFI_STATUS
-AllocateMemory (
-  VOID
-  );
-
-STATIC
-VOID
-FreeMemory (
-  VOID
-  );
-
-STATIC
-VOID
-InitSlide (
-  VOID
-  );
-
-STATIC
-NODE
-Child (
-  IN NODE   NodeQ,
-  IN UINT8  CharC
-  );
-
-STATIC
-VOID
-MakeChild (
-  IN NODE  NodeQ,
-  IN UINT8 CharC,
-  IN NODE  NodeR
-  );
-
-STATIC
-VOID
-Split (
-  IN NODE Old
-  );
-
-STATIC
-VOID
-InsertNode (
-  VOID
-  );
-
-STATIC
-VOID
-DeleteNode (
-  VOID
-  );
-
-STATIC
-VOID
-GetNextMatch (
-  VOID
-  );
-
-STATIC
-EFI_STATUS
-Encode (
-  VOID
-  );
-
-STATIC
-VOID
-CountTFreq (
-  VOID
-  );
-
-STATIC
-VOID
-WritePTLen (
-  IN INT32 Number,
-  IN INT32 nbit,
-  IN INT32 Special
-  );
-
-STATIC
-VOID
-WriteCLen (
-  VOID
-  );
-
-STATIC
-VOID
-EncodeC (
-  IN INT32 Value
-  );
-
-STATIC
-VOID
-EncodeP (
-  IN UINT32 Value
-  );
-
-STATIC
-VOID
-SendBlock (
-  VOID
-  );
-
-STATIC
-VOID
-Output (
-  IN UINT32 c,
-  IN UINT32 p
-  );
-
-STATIC
-VOID
-HufEncodeStart (
-  VOID
-  );
-
-STATIC
-VOID
-HufEncodeEnd (
-  VOID
-  );
-
-STATIC
-VOID
-MakeCrcTable (
-  VOID
-  );
-
-  
-STATIC
-VOID
-PutBits (
-  IN INT32  Number,
-  IN UINT32 Value
-  );
-
-STATIC
-INT32
-FreadCrc (
-  OUT UINT8 *Pointer,
-  IN  INT32 Number
-  );
-
-STATIC
-VOID
-InitPutBits (
-  VOID
-  );
-
-STATIC
-VOID
-CountLen (
-  IN INT32 Index
-  );
-
-STATIC
-VOID
-MakeLen (
-  IN INT32 Root
-  );
-
-STATIC
-VOID
-DownHeap (
-  IN INT32 Index
-  );
-
-STATIC
-VOID
-MakeCode (
-  IN  INT32       Number,
-  IN  UINT8 Len[  ],
-  OUT UINT16 Code[]
-  );
-
-STATIC
-INT32
-MakeTree (
-  IN  INT32            NParm,
-  IN  UINT16  FreqParm[],
-  OUT UINT8   LenParm[ ],
-  OUT UINT16  CodeParm[]
-  );
-  
 /**
   Read NumOfBit of bits from source into mBitBuf
 
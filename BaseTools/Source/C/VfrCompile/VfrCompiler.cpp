@@ -16,14 +16,125 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #include "stdio.h"
 #include "stdlib.h"
 #include "string.h"
+#include "ctype.h"
 #include "VfrCompiler.h"
 #include "CommonLib.h"
 #include "EfiUtilityMsgs.h"
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <windows.h>
+#include <process.h>
+#include <direct.h>
+#define getpid  _getpid
+#else
+#include <time.h>
+#include <unistd.h>
+#endif
 
 PACKAGE_DATA  gCBuffer;
 PACKAGE_DATA  gRBuffer;
 CVfrStringDB  gCVfrStringDB;
 
+//
+// A type cache entry holds the declarations before the formset, and what
+// parsing them added to the data type database and the file scope records.
+//
+#define VFR_TYPE_CACHE_SIGNATURE  SIGNATURE_32 ('V', 'F', 'R', 'T')
+
+typedef struct {
+  UINT32  Signature;
+  UINT32  PrefixSize;
+  UINT32  PrefixLine;
+} VFR_TYPE_CACHE_HEADER;
+
+static
+double
+GetTimeInSeconds (
+  VOID
+  )
+{
+#ifdef _WIN32
+  LARGE_INTEGER  Frequency;
+  LARGE_INTEGER  Counter;
+
+  QueryPerformanceFrequency (&Frequency);
+  QueryPerformanceCounter (&Counter);
+  return (double) Counter.QuadPart / (double) Frequency.QuadPart;
+#else
+  struct timespec  Now;
+
+  clock_gettime (CLOCK_MONOTONIC, &Now);
+  return (double) Now.tv_sec + (double) Now.tv_nsec / 1e9;
+#endif
+}
+
+/**
+  Find the "formset" keyword that ends the pragma and structure declarations
+  of a VFR file. Comments, strings and extern lines are skipped the way the
+  lexer skips them.
+
+  @param Buffer   The content of the file.
+  @param Size     The size of Buffer.
+  @param Offset   The offset of the keyword.
+  @param LineNum  The line of the keyword.
+
+  @retval TRUE    The keyword was found.
+  @retval FALSE   There is no formset in the file.
+**/
+static
+BOOLEAN
+FindFormSetStart (
+  IN  CHAR8   *Buffer,
+  IN  UINT32  Size,
+  OUT UINT32  *Offset,
+  OUT UINT32  *LineNum
+  )
+{
+  UINT32  Index;
+  UINT32  Start;
+  UINT32  Line;
+
+  Line  = 1;
+  Index = 0;
+  while (Index < Size) {
+    if (Buffer[Index] == '\n') {
+      Line++;
+      Index++;
+    } else if (Buffer[Index] == '"') {
+      for (Index++; (Index < Size) && (Buffer[Index] != '"'); Index++) {
+        if (Buffer[Index] == '\n') {
+          Line++;
+        }
+      }
+      Index++;
+    } else if ((Buffer[Index] == '/') && (Index + 1 < Size) && (Buffer[Index + 1] == '/')) {
+      while ((Index < Size) && (Buffer[Index] != '\n')) {
+        Index++;
+      }
+    } else if (isalpha ((UINT8) Buffer[Index]) || (Buffer[Index] == '_')) {
+      Start = Index;
+      while ((Index < Size) && (isalnum ((UINT8) Buffer[Index]) || (Buffer[Index] == '_'))) {
+        Index++;
+      }
+      if ((Index - Start == 7) && (strncmp (&Buffer[Start], "formset", 7) == 0)) {
+        *Offset  = Start;
+        *LineNum = Line;
+        return TRUE;
+      }
+      if ((Index - Start == 6) && (strncmp (&Buffer[Start], "extern", 6) == 0)) {
+        while ((Index < Size) && (Buffer[Index] != '\n')) {
+          Index++;
+        }
+      }
+    } else {
+      Index++;
+    }
+  }
+
+  return FALSE;
+}
+
 VOID 
 CVfrCompiler::DebugError (
   IN CHAR8         *FileName,
@@ -83,6 +194,8 @@ CVfrCompiler::OptionInitialization (
   mOptions.CompatibleMode                = FALSE;
   mOptions.HasOverrideClassGuid          = FALSE;
   mOptions.WarningAsError                = FALSE;
+  mOptions.TypeCacheDirectory            = NULL;
+  mOptions.Profile                       = FALSE;
   memset (&mOptions.OverrideClassGuid, 0, sizeof (EFI_GUID));
   
   if (Argc == 1) {
@@ -160,6 +273,15 @@ CVfrCompiler::OptionInitialization (
       mOptions.HasOverrideClassGuid = TRUE;
     } else if (stricmp(Argv[Index], "-w") == 0 || stricmp(Argv[Index], "--warning-as-error") == 0) {
       mOptions.WarningAsError = TRUE;
+    } else if (stricmp(Argv[Index], "--type-cache") == 0) {
+      Index++;
+      if ((Index >= Argc) || (Argv[Index][0] == '-')) {
+        DebugError (NULL, 0, 1001, "Missing option", "--type-cache missing cache directory name");
+        goto Fail;
+      }
+      mOptions.TypeCacheDirectory = Argv[Index];
+    } else if (stricmp(Argv[Index], "--profile") == 0) {
+      mOptions.Profile = TRUE;
     } else {
       DebugError (NULL, 0, 1000, "Unknown option", "unrecognized option %s", Argv[Index]);
       goto Fail;
@@ -188,6 +310,9 @@ CVfrCompiler::OptionInitialization (
   if (SetRecordListFileName () != 0) {
     goto Fail;
   }
+  if (CreateTypeCacheDirectory () != 0) {
+    goto Fail;
+  }
   return;
 
 Fail:
@@ -368,17 +493,87 @@ CVfrCompiler::SetRecordListFileName (
   return 0;
 }
 
+/**
+  Create the --type-cache directory and its missing parents, so that the
+  entries can be stored on the first compile.
+
+  @retval 0   The directory exists or the type cache is not used.
+  @retval -1  The directory can't be created.
+**/
+INT8
+CVfrCompiler::CreateTypeCacheDirectory (
+  VOID
+  )
+{
+  CHAR8       *Path;
+  CHAR8       *Cur;
+  struct stat StatBuf;
+
+  if (mOptions.TypeCacheDirectory == NULL) {
+    return 0;
+  }
+
+  Path = new CHAR8[strlen (mOptions.TypeCacheDirectory) + 1];
+  strcpy (Path, mOptions.TypeCacheDirectory);
+
+  //
+  // Skip the leading separators and the drive letter, they name the root.
+  //
+  Cur = Path;
+  if (isalpha (Cur[0]) && (Cur[1] == ':')) {
+    Cur += 2;
+  }
+  while ((*Cur == '/') || (*Cur == '\\')) {
+    Cur++;
+  }
+
+  for (;; Cur++) {
+    if ((*Cur == '/') || (*Cur == '\\') || (*Cur == '\0')) {
+      CHAR8 Separator = *Cur;
+
+      *Cur = '\0';
+      if (stat (LongFilePath (Path), &StatBuf) != 0) {
+        mkdir (LongFilePath (Path), S_IRWXU | S_IRWXG | S_IRWXO);
+      }
+      *Cur = Separator;
+    }
+    if (*Cur == '\0') {
+      break;
+    }
+  }
+  delete[] Path;
+
+  if ((stat (LongFilePath (mOptions.TypeCacheDirectory), &StatBuf) != 0) ||
+      ((StatBuf.st_mode & S_IFMT) != S_IFDIR)) {
+    DebugError (NULL, 0, 1, "Error creating directory", "type cache directory %s", mOptions.TypeCacheDirectory);
+    return -1;
+  }
+
+  return 0;
+}
+
 CVfrCompiler::CVfrCompiler (
   IN INT32      Argc, 
   IN CHAR8      **Argv
   )
 {
-  mPreProcessCmd = (CHAR8 *) PREPROCESSOR_COMMAND;
-  mPreProcessOpt = (CHAR8 *) PREPROCESSOR_OPTIONS;
+  UINT32  Index;
+
+  mPreProcessCmd       = (CHAR8 *) PREPROCESSOR_COMMAND;
+  mPreProcessOpt       = (CHAR8 *) PREPROCESSOR_OPTIONS;
+  mTypeCacheStatus     = TYPE_CACHE_DISABLED;
+  mTypeCachePrefix     = NULL;
+  mTypeCachePrefixSize = 0;
+  mTypeCachePrefixLine = 0;
+  mTypeCacheEntry[0]   = '\0';
+  for (Index = 0; Index < PHASE_MAX; Index++) {
+    mPhaseTime[Index] = 0;
+  }
 
   SET_RUN_STATUS (STATUS_STARTED);
 
   OptionInitialization(Argc, Argv);
+  mPhaseMark = GetTimeInSeconds ();
 
   if ((IS_RUN_STATUS(STATUS_FAILED)) || (IS_RUN_STATUS(STATUS_DEAD))) {
     return;
@@ -401,6 +596,11 @@ CVfrCompiler::~CVfrCompiler (
     mOptions.CPreprocessorOptions = NULL;
   }
 
+  if (mTypeCachePrefix != NULL) {
+    delete[] mTypeCachePrefix;
+    mTypeCachePrefix = NULL;
+  }
+
   SET_RUN_STATUS(STATUS_DEAD);
 }
 
@@ -437,6 +637,10 @@ CVfrCompiler::Usage (
     "                 format is xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx",
     "  -w  --warning-as-error",
     "                 treat warning as an error",
+    "  --type-cache DIR",
+    "                 reuse the structures parsed from the same declarations",
+    "                 by an earlier compile, cached in directory DIR",
+    "  --profile      print the time spent in each compile phase",
     NULL
     };
   for (Index = 0; Help[Index] != NULL; Index++) {
@@ -525,6 +729,147 @@ Fail:
   delete PreProcessCmd;
 }
 
+/**
+  Restore the structures and file scope records of the declarations before
+  the formset from the type cache, and move the input file past them.
+
+  @param InFileName  The name of the file to compile.
+  @param pInFile     The file to compile, opened for the parser.
+  @param StartLine   The line the parser starts from.
+**/
+VOID
+CVfrCompiler::LoadTypeCache (
+  IN  CHAR8   *InFileName,
+  IN  FILE    *pInFile,
+  OUT UINT32  *StartLine
+  )
+{
+  FILE                   *pFile;
+  CHAR8                  *Buffer;
+  CHAR8                  *EntryPrefix;
+  long                   FileSize;
+  UINT64                 Hash;
+  UINT32                 Index;
+  VFR_TYPE_CACHE_HEADER  Header;
+
+  mTypeCacheStatus = TYPE_CACHE_UNUSED;
+
+  if ((pFile = fopen (LongFilePath (InFileName), "rb")) == NULL) {
+    return;
+  }
+  Buffer = NULL;
+  if ((fseek (pFile, 0, SEEK_END) == 0) && ((FileSize = ftell (pFile)) > 0) && (fseek (pFile, 0, SEEK_SET) == 0)) {
+    Buffer = new CHAR8[FileSize];
+    if ((Buffer != NULL) && (fread (Buffer, 1, FileSize, pFile) != (size_t) FileSize)) {
+      delete[] Buffer;
+      Buffer = NULL;
+    }
+  }
+  fclose (pFile);
+  if (Buffer == NULL) {
+    return;
+  }
+
+  if (!FindFormSetStart (Buffer, (UINT32) FileSize, &mTypeCachePrefixSize, &mTypeCachePrefixLine) ||
+      (mTypeCachePrefixSize == 0) ||
+      (strlen (mOptions.TypeCacheDirectory) + 24 >= MAX_PATH)) {
+    delete[] Buffer;
+    return;
+  }
+  mTypeCachePrefix = Buffer;
+
+  //
+  // 64-bit FNV-1a of the declarations names the entry.
+  //
+  Hash = 0xCBF29CE484222325ULL;
+  for (Index = 0; Index < mTypeCachePrefixSize; Index++) {
+    Hash = (Hash ^ (UINT8) Buffer[Index]) * 0x100000001B3ULL;
+  }
+  sprintf (mTypeCacheEntry, "%s/%016llx" VFR_TYPECACHE_FILENAME_EXTENSION, mOptions.TypeCacheDirectory, (unsigned long long) Hash);
+  mTypeCacheStatus = TYPE_CACHE_MISS;
+
+  if ((pFile = fopen (LongFilePath (mTypeCacheEntry), "rb")) == NULL) {
+    return;
+  }
+
+  EntryPrefix = NULL;
+  if ((fread (&Header, sizeof (Header), 1, pFile) == 1) &&
+      (Header.Signature == VFR_TYPE_CACHE_SIGNATURE) &&
+      (Header.PrefixSize == mTypeCachePrefixSize) &&
+      (Header.PrefixLine == mTypeCachePrefixLine)) {
+    EntryPrefix = new CHAR8[mTypeCachePrefixSize];
+  }
+
+  //
+  // The hash only names the entry, so compare the declarations too. The
+  // parser input is a text stream, but as the offset comes from the same
+  // file, seeking to it still lands on the formset keyword.
+  //
+  if ((EntryPrefix != NULL) &&
+      (fread (EntryPrefix, 1, mTypeCachePrefixSize, pFile) == mTypeCachePrefixSize) &&
+      (memcmp (EntryPrefix, mTypeCachePrefix, mTypeCachePrefixSize) == 0)) {
+    if ((gCVfrErrorHandle.ReadFileScopeRecords (pFile) == VFR_RETURN_SUCCESS) &&
+        (fseek (pInFile, mTypeCachePrefixSize, SEEK_SET) == 0)) {
+      if (gCVfrVarDataTypeDB.ReadUserDefinedTypes (pFile) == VFR_RETURN_SUCCESS) {
+        *StartLine       = mTypeCachePrefixLine;
+        mTypeCacheStatus = TYPE_CACHE_HIT;
+      } else {
+        fseek (pInFile, 0, SEEK_SET);
+      }
+    }
+    if (mTypeCacheStatus != TYPE_CACHE_HIT) {
+      gCVfrErrorHandle.ClearFileScopeRecords ();
+    }
+  }
+
+  if (EntryPrefix != NULL) {
+    delete[] EntryPrefix;
+  }
+  fclose (pFile);
+}
+
+/**
+  Add the structures and file scope records of the declarations before the
+  formset to the type cache. The entry is written to a temporary file first,
+  so that compiles sharing the cache never read a partial entry. Failures
+  are ignored, the declarations are just parsed again next time.
+**/
+VOID
+CVfrCompiler::StoreTypeCache (
+  VOID
+  )
+{
+  CHAR8                  TempName[MAX_PATH + 16];
+  FILE                   *pFile;
+  VFR_TYPE_CACHE_HEADER  Header;
+  BOOLEAN                Written;
+
+  if (mTypeCacheStatus != TYPE_CACHE_MISS) {
+    return;
+  }
+
+  sprintf (TempName, "%s.%u", mTypeCacheEntry, (unsigned) getpid ());
+  if ((pFile = fopen (LongFilePath (TempName), "wb")) == NULL) {
+    return;
+  }
+
+  Header.Signature  = VFR_TYPE_CACHE_SIGNATURE;
+  Header.PrefixSize = mTypeCachePrefixSize;
+  Header.PrefixLine = mTypeCachePrefixLine;
+
+  Written = (BOOLEAN) ((fwrite (&Header, sizeof (Header), 1, pFile) == 1) &&
+                       (fwrite (mTypeCachePrefix, 1, mTypeCachePrefixSize, pFile) == mTypeCachePrefixSize) &&
+                       (gCVfrErrorHandle.WriteFileScopeRecords (pFile, mTypeCachePrefixLine) == VFR_RETURN_SUCCESS) &&
+                       (gCVfrVarDataTypeDB.WriteUserDefinedTypes (pFile) == VFR_RETURN_SUCCESS));
+  if (fclose (pFile) != 0) {
+    Written = FALSE;
+  }
+
+  if (!Written || (rename (LongFilePath (TempName), LongFilePath (mTypeCacheEntry)) != 0)) {
+    remove (LongFilePath (TempName));
+  }
+}
+
 extern UINT8 VfrParserStart (IN FILE *, IN INPUT_INFO_TO_SYNTAX *);
 
 VOID
@@ -557,6 +902,12 @@ CVfrCompiler::Compile (
     InputInfo.OverrideClassGuid = NULL;
   }
 
+  InputInfo.StartLine = 1;
+  if (mOptions.TypeCacheDirectory != NULL) {
+    LoadTypeCache (InFileName, pInFile, &InputInfo.StartLine);
+  }
+  ProfilePhase (PHASE_TYPE_CACHE);
+
   if (VfrParserStart (pInFile, &InputInfo) != 0) {
     goto Fail;
   }
@@ -568,6 +919,12 @@ CVfrCompiler::Compile (
     goto Fail;
   }
 
+  if (mTypeCacheStatus == TYPE_CACHE_MISS) {
+    ProfilePhase (PHASE_PARSE);
+    StoreTypeCache ();
+    ProfilePhase (PHASE_TYPE_CACHE);
+  }
+
   SET_RUN_STATUS (STATUS_COMPILEED);
   return;
 
@@ -823,6 +1180,65 @@ Err1:
   fclose (pInFile);
 }
 
+VOID
+CVfrCompiler::ProfilePhase (
+  IN COMPILER_PHASE  Phase
+  )
+{
+  double  Now;
+
+  Now                = GetTimeInSeconds ();
+  mPhaseTime[Phase] += Now - mPhaseMark;
+  mPhaseMark         = Now;
+}
+
+VOID
+CVfrCompiler::ProfileReport (
+  VOID
+  )
+{
+  UINT32       Index;
+  double       Total;
+  CONST CHAR8  *PhaseName[PHASE_MAX] = {
+    "preprocess",
+    "type cache",
+    "parse",
+    "adjust binary",
+    "generate package",
+    "generate C file",
+    "record list"
+  };
+
+  if (!mOptions.Profile || IS_RUN_STATUS(STATUS_DEAD)) {
+    return;
+  }
+
+  fprintf (stdout, "VfrCompile profile of %s:\n", mOptions.VfrFileName);
+  Total = 0;
+  for (Index = 0; Index < PHASE_MAX; Index++) {
+    fprintf (stdout, "  %-18s %10.6f s", PhaseName[Index], mPhaseTime[Index]);
+    if (Index == PHASE_TYPE_CACHE) {
+      switch (mTypeCacheStatus) {
+      case TYPE_CACHE_DISABLED:
+        fprintf (stdout, "  (disabled)");
+        break;
+      case TYPE_CACHE_UNUSED:
+        fprintf (stdout, "  (not used)");
+        break;
+      case TYPE_CACHE_HIT:
+        fprintf (stdout, "  (hit, %u lines not parsed)", (unsigned) mTypeCachePrefixLine - 1);
+        break;
+      case TYPE_CACHE_MISS:
+        fprintf (stdout, "  (miss)");
+        break;
+      }
+    }
+    fprintf (stdout, "\n");
+    Total += mPhaseTime[Index];
+  }
+  fprintf (stdout, "  %-18s %10.6f s\n", "total", Total);
+}
+
 int
 main (
   IN int             Argc, 
@@ -835,11 +1251,18 @@ main (
   CVfrCompiler         Compiler(Argc, Argv);
   
   Compiler.PreProcess();
+  Compiler.ProfilePhase (PHASE_PREPROCESS);
   Compiler.Compile();
+  Compiler.ProfilePhase (PHASE_PARSE);
   Compiler.AdjustBin();
+  Compiler.ProfilePhase (PHASE_ADJUST_BIN);
   Compiler.GenBinary();
+  Compiler.ProfilePhase (PHASE_GEN_BINARY);
   Compiler.GenCFile();
+  Compiler.ProfilePhase (PHASE_GEN_C_FILE);
   Compiler.GenRecordListFile ();
+  Compiler.ProfilePhase (PHASE_RECORD_LIST);
+  Compiler.ProfileReport ();
 
   Status = Compiler.RunStatus ();
   if ((Status == STATUS_DEAD) || (Status == STATUS_FAILED)) {
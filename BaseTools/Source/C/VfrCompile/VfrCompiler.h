@@ -39,6 +39,7 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #define VFR_PREPROCESS_FILENAME_EXTENSION   ".i"
 #define VFR_PACKAGE_FILENAME_EXTENSION      ".hpk"
 #define VFR_RECORDLIST_FILENAME_EXTENSION   ".lst"
+#define VFR_TYPECACHE_FILENAME_EXTENSION    ".vtc"
 
 typedef struct {
   CHAR8   VfrFileName[MAX_PATH];
@@ -57,6 +58,8 @@ typedef struct {
   BOOLEAN HasOverrideClassGuid;
   EFI_GUID OverrideClassGuid;
   BOOLEAN WarningAsError;
+  CHAR8   *TypeCacheDirectory;
+  BOOLEAN Profile;
 } OPTIONS;
 
 typedef enum {
@@ -70,6 +73,24 @@ typedef enum {
   STATUS_DEAD,
 } COMPILER_RUN_STATUS;
 
+typedef enum {
+  PHASE_PREPROCESS = 0,
+  PHASE_TYPE_CACHE,
+  PHASE_PARSE,
+  PHASE_ADJUST_BIN,
+  PHASE_GEN_BINARY,
+  PHASE_GEN_C_FILE,
+  PHASE_RECORD_LIST,
+  PHASE_MAX
+} COMPILER_PHASE;
+
+typedef enum {
+  TYPE_CACHE_DISABLED = 0,
+  TYPE_CACHE_UNUSED,
+  TYPE_CACHE_HIT,
+  TYPE_CACHE_MISS
+} TYPE_CACHE_STATUS;
+
 class CVfrCompiler {
 private:
   COMPILER_RUN_STATUS  mRunStatus;
@@ -77,6 +98,18 @@ private:
   CHAR8                *mPreProcessCmd;
   CHAR8                *mPreProcessOpt;
 
+  //
+  // The declarations before the formset, and the type cache entry for them.
+  //
+  TYPE_CACHE_STATUS    mTypeCacheStatus;
+  CHAR8                *mTypeCachePrefix;
+  UINT32               mTypeCachePrefixSize;
+  UINT32               mTypeCachePrefixLine;
+  CHAR8                mTypeCacheEntry[MAX_PATH];
+
+  double               mPhaseTime[PHASE_MAX];
+  double               mPhaseMark;
+
   VOID    OptionInitialization (IN INT32 , IN CHAR8 **);
   VOID    AppendIncludePath (IN CHAR8 *);
   VOID    AppendCPreprocessorOptions (IN CHAR8 *);
@@ -85,10 +118,13 @@ private:
   INT8    SetCOutputFileName(VOID);
   INT8    SetPreprocessorOutputFileName (VOID);
   INT8    SetRecordListFileName (VOID);
+  INT8    CreateTypeCacheDirectory (VOID);
 
   VOID    SET_RUN_STATUS (IN COMPILER_RUN_STATUS);
   BOOLEAN IS_RUN_STATUS (IN COMPILER_RUN_STATUS);
   VOID    UpdateInfoForDynamicOpcode (VOID);
+  VOID    LoadTypeCache (IN CHAR8 *, IN FILE *, OUT UINT32 *);
+  VOID    StoreTypeCache (VOID);
 
 public:
   COMPILER_RUN_STATUS RunStatus (VOID) {
@@ -108,6 +144,8 @@ public:
   VOID                GenBinary (VOID);
   VOID                GenCFile (VOID);
   VOID                GenRecordListFile (VOID);
+  VOID                ProfilePhase (IN COMPILER_PHASE);
+  VOID                ProfileReport (VOID);
   VOID                DebugError (IN CHAR8*, IN UINT32, IN UINT32, IN CONST CHAR8*, IN CONST CHAR8*, ...);
 };
 
@@ -16,6 +16,7 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #include "stdio.h"
 #include "string.h"
 #include "stdlib.h"
+#include "EfiVfr.h"
 #include "VfrError.h"
 #include "EfiUtilityMsgs.h"
 
@@ -72,20 +73,12 @@ CVfrErrorHandle::~CVfrErrorHandle (
   VOID
   )
 {
-  SVfrFileScopeRecord *pNode = NULL;
-
   if (mInputFileName != NULL) {
     delete mInputFileName;
   }
 
-  while (mScopeRecordListHead != NULL) {
-    pNode = mScopeRecordListHead;
-    mScopeRecordListHead = mScopeRecordListHead->mNext;
-    delete pNode;
-  }
+  ClearFileScopeRecords ();
 
-  mScopeRecordListHead   = NULL;
-  mScopeRecordListTail   = NULL;
   mVfrErrorHandleTable   = NULL;
   mVfrWarningHandleTable = NULL;
 }
@@ -140,6 +133,21 @@ SVfrFileScopeRecord::SVfrFileScopeRecord (
   return;
 }
 
+SVfrFileScopeRecord::SVfrFileScopeRecord (
+  IN CHAR8    *FileName,
+  IN UINT32   ScopeLineStart,
+  IN UINT32   LineNum
+  )
+{
+  mWholeScopeLine = LineNum;
+  mScopeLineStart = ScopeLineStart;
+  mNext           = NULL;
+
+  if ((mFileName = new CHAR8[strlen(FileName) + 1]) != NULL) {
+    strcpy (mFileName, FileName);
+  }
+}
+
 SVfrFileScopeRecord::~SVfrFileScopeRecord (
   VOID
   )
@@ -210,6 +218,103 @@ CVfrErrorHandle::GetFileNameLineNum (
   *FileLine = LineNum - pNode->mWholeScopeLine + pNode->mScopeLineStart - 1;
 }
 
+VOID
+CVfrErrorHandle::ClearFileScopeRecords (
+  VOID
+  )
+{
+  SVfrFileScopeRecord *pNode = NULL;
+
+  while (mScopeRecordListHead != NULL) {
+    pNode = mScopeRecordListHead;
+    mScopeRecordListHead = mScopeRecordListHead->mNext;
+    delete pNode;
+  }
+
+  mScopeRecordListHead   = NULL;
+  mScopeRecordListTail   = NULL;
+}
+
+/**
+  Save the file scope records of the lines before LineNum, which can be
+  restored by ReadFileScopeRecords instead of parsing these lines again.
+**/
+EFI_VFR_RETURN_CODE
+CVfrErrorHandle::WriteFileScopeRecords (
+  IN FILE      *File,
+  IN UINT32    LineNum
+  )
+{
+  SVfrFileScopeRecord *pNode;
+  UINT32              Count;
+  UINT32              Record[3];
+
+  Count = 0;
+  for (pNode = mScopeRecordListHead; pNode != NULL; pNode = pNode->mNext) {
+    if (pNode->mWholeScopeLine < LineNum) {
+      Count++;
+    }
+  }
+  if (fwrite (&Count, sizeof (Count), 1, File) != 1) {
+    return VFR_RETURN_FATAL_ERROR;
+  }
+
+  for (pNode = mScopeRecordListHead; pNode != NULL; pNode = pNode->mNext) {
+    if (pNode->mWholeScopeLine >= LineNum) {
+      continue;
+    }
+    Record[0] = pNode->mWholeScopeLine;
+    Record[1] = pNode->mScopeLineStart;
+    Record[2] = (pNode->mFileName != NULL) ? (UINT32) strlen (pNode->mFileName) : 0;
+    if ((fwrite (Record, sizeof (Record), 1, File) != 1) ||
+        (fwrite (pNode->mFileName, 1, Record[2], File) != Record[2])) {
+      return VFR_RETURN_FATAL_ERROR;
+    }
+  }
+
+  return VFR_RETURN_SUCCESS;
+}
+
+EFI_VFR_RETURN_CODE
+CVfrErrorHandle::ReadFileScopeRecords (
+  IN FILE      *File
+  )
+{
+  SVfrFileScopeRecord *pNode;
+  UINT32              Count;
+  UINT32              Index;
+  UINT32              Record[3];
+  CHAR8               FileName[MAX_VFR_LINE_LEN];
+
+  if (mScopeRecordListHead != NULL) {
+    return VFR_RETURN_FATAL_ERROR;
+  }
+
+  if (fread (&Count, sizeof (Count), 1, File) != 1) {
+    return VFR_RETURN_FATAL_ERROR;
+  }
+
+  for (Index = 0; Index < Count; Index++) {
+    if ((fread (Record, sizeof (Record), 1, File) != 1) || (Record[2] >= MAX_VFR_LINE_LEN) ||
+        (fread (FileName, 1, Record[2], File) != Record[2])) {
+      return VFR_RETURN_FATAL_ERROR;
+    }
+    FileName[Record[2]] = '\0';
+
+    if ((pNode = new SVfrFileScopeRecord(FileName, Record[1], Record[0])) == NULL) {
+      return VFR_RETURN_OUT_FOR_RESOURCES;
+    }
+    if (mScopeRecordListHead == NULL) {
+      mScopeRecordListTail = mScopeRecordListHead = pNode;
+    } else {
+      mScopeRecordListTail->mNext = pNode;
+      mScopeRecordListTail        = pNode;
+    }
+  }
+
+  return VFR_RETURN_SUCCESS;
+}
+
 VOID
 CVfrErrorHandle::PrintMsg (
   IN UINT32               LineNum,
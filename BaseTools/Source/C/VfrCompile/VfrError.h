@@ -16,6 +16,7 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #ifndef _VFRERROR_H_
 #define _VFRERROR_H_
 
+#include "stdio.h"
 #include "Common/UefiBaseTypes.h"
 
 typedef enum {
@@ -72,6 +73,7 @@ struct SVfrFileScopeRecord {
   SVfrFileScopeRecord *mNext;
 
   SVfrFileScopeRecord (IN CHAR8 *, IN UINT32);
+  SVfrFileScopeRecord (IN CHAR8 *, IN UINT32, IN UINT32);
   ~SVfrFileScopeRecord();
 };
 
@@ -92,6 +94,9 @@ public:
   VOID  SetInputFile (IN CHAR8 *);
   VOID  ParseFileScopeRecord (IN CHAR8 *, IN UINT32);
   VOID  GetFileNameLineNum (IN UINT32, OUT CHAR8 **, OUT UINT32 *);
+  EFI_VFR_RETURN_CODE WriteFileScopeRecords (IN FILE *, IN UINT32);
+  EFI_VFR_RETURN_CODE ReadFileScopeRecords (IN FILE *);
+  VOID  ClearFileScopeRecords (VOID);
   UINT8 HandleError (IN EFI_VFR_RETURN_CODE, IN UINT32 LineNum = 0, IN CHAR8 *TokName = NULL);
   UINT8 HandleWarning (IN EFI_VFR_WARNING_CODE, IN UINT32 LineNum = 0, IN CHAR8 *TokName = NULL);
   VOID  PrintMsg (IN UINT32 LineNum = 0, IN CHAR8 *TokName = NULL, IN CONST CHAR8 *MsgType = "Error", IN CONST CHAR8 *ErrorMsg = "");
@@ -99,6 +99,7 @@ struct SBufferNode {
 typedef struct {
   BOOLEAN  CompatibleMode;
   EFI_GUID *OverrideClassGuid;
+  UINT32   StartLine;          // line number of the current position in the input file
 } INPUT_INFO_TO_SYNTAX;
 
 class CFormPkg {
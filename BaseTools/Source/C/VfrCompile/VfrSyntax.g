@@ -51,10 +51,23 @@ VfrParserStart (
   IN INPUT_INFO_TO_SYNTAX *InputInfo
   )
 {
-  ParserBlackBox<CVfrDLGLexer, EfiVfrParser, ANTLRToken> VfrParser(File);
-  VfrParser.parser()->SetCompatibleMode (InputInfo->CompatibleMode);
-  VfrParser.parser()->SetOverrideClassGuid (InputInfo->OverrideClassGuid);
-  return VfrParser.parser()->vfrProgram();
+  DLGFileInput      VfrInput (File);
+  CVfrDLGLexer      VfrScan (&VfrInput);
+  ANTLRTokenBuffer  VfrPipe (&VfrScan);
+  ANTLRToken        VfrToken;
+  EfiVfrParser      VfrParser (&VfrPipe);
+
+  //
+  // Same setup as ParserBlackBox, but the line number is set before the
+  // parser reads the first tokens, as the input may start in the middle of
+  // the file.
+  //
+  VfrScan.setToken (&VfrToken);
+  VfrScan.set_line (InputInfo->StartLine);
+  VfrParser.init ();
+  VfrParser.SetCompatibleMode (InputInfo->CompatibleMode);
+  VfrParser.SetOverrideClassGuid (InputInfo->OverrideClassGuid);
+  return VfrParser.vfrProgram();
 }
 >>
 
@@ -564,6 +564,196 @@ _STR2U32 (
   return Value;
 }
 
+CVfrNameTable::CVfrNameTable (
+  VOID
+  )
+{
+  mBuckets     = NULL;
+  mBucketCount = 0;
+  mEntryCount  = 0;
+}
+
+CVfrNameTable::~CVfrNameTable (
+  VOID
+  )
+{
+  RemoveAll ();
+}
+
+UINT32
+CVfrNameTable::Hash (
+  IN CONST CHAR8  *Name
+  )
+{
+  UINT32  Value;
+
+  //
+  // 32-bit FNV-1a
+  //
+  for (Value = 0x811C9DC5; *Name != '\0'; Name++) {
+    Value = (Value ^ (UINT8) *Name) * 0x01000193;
+  }
+
+  return Value;
+}
+
+VOID
+CVfrNameTable::Grow (
+  VOID
+  )
+{
+  SVfrNameTableEntry  **NewBuckets;
+  SVfrNameTableEntry  **Tail;
+  SVfrNameTableEntry  *pEntry;
+  UINT32              NewCount;
+  UINT32              Index;
+  UINT32              NewIndex;
+
+  NewCount = (mBucketCount == 0) ? VFR_NAME_TABLE_INIT_SIZE : mBucketCount * 2;
+  if ((NewBuckets = new SVfrNameTableEntry *[NewCount]) == NULL) {
+    return;
+  }
+  if ((Tail = new SVfrNameTableEntry *[NewCount]) == NULL) {
+    delete[] NewBuckets;
+    return;
+  }
+  for (Index = 0; Index < NewCount; Index++) {
+    NewBuckets[Index] = NULL;
+    Tail[Index]       = NULL;
+  }
+
+  //
+  // Append to the tail of the new chains to keep the entries of a name in
+  // the same order.
+  //
+  for (Index = 0; Index < mBucketCount; Index++) {
+    while (mBuckets[Index] != NULL) {
+      pEntry          = mBuckets[Index];
+      mBuckets[Index] = pEntry->mNext;
+      pEntry->mNext   = NULL;
+      NewIndex        = Hash (pEntry->mName) & (NewCount - 1);
+      if (Tail[NewIndex] == NULL) {
+        NewBuckets[NewIndex] = pEntry;
+      } else {
+        Tail[NewIndex]->mNext = pEntry;
+      }
+      Tail[NewIndex]  = pEntry;
+    }
+  }
+
+  delete[] Tail;
+  if (mBuckets != NULL) {
+    delete[] mBuckets;
+  }
+  mBuckets     = NewBuckets;
+  mBucketCount = NewCount;
+}
+
+VOID
+CVfrNameTable::Add (
+  IN CONST CHAR8  *Name,
+  IN VOID         *Data
+  )
+{
+  SVfrNameTableEntry  *pEntry;
+  UINT32              Index;
+
+  if (Name == NULL) {
+    return;
+  }
+
+  if (mEntryCount >= mBucketCount) {
+    Grow ();
+    if (mBuckets == NULL) {
+      return;
+    }
+  }
+
+  if ((pEntry = new SVfrNameTableEntry) == NULL) {
+    return;
+  }
+  Index            = Hash (Name) & (mBucketCount - 1);
+  pEntry->mName    = Name;
+  pEntry->mData    = Data;
+  pEntry->mNext    = mBuckets[Index];
+  mBuckets[Index]  = pEntry;
+  mEntryCount++;
+}
+
+SVfrNameTableEntry *
+CVfrNameTable::FindFirst (
+  IN CONST CHAR8  *Name
+  )
+{
+  SVfrNameTableEntry  *pEntry;
+
+  if ((Name == NULL) || (mBucketCount == 0)) {
+    return NULL;
+  }
+
+  for (pEntry = mBuckets[Hash (Name) & (mBucketCount - 1)]; pEntry != NULL; pEntry = pEntry->mNext) {
+    if (strcmp (pEntry->mName, Name) == 0) {
+      return pEntry;
+    }
+  }
+
+  return NULL;
+}
+
+SVfrNameTableEntry *
+CVfrNameTable::FindNext (
+  IN SVfrNameTableEntry  *Prev
+  )
+{
+  SVfrNameTableEntry  *pEntry;
+
+  if (Prev == NULL) {
+    return NULL;
+  }
+
+  for (pEntry = Prev->mNext; pEntry != NULL; pEntry = pEntry->mNext) {
+    if (strcmp (pEntry->mName, Prev->mName) == 0) {
+      return pEntry;
+    }
+  }
+
+  return NULL;
+}
+
+VOID *
+CVfrNameTable::Find (
+  IN CONST CHAR8  *Name
+  )
+{
+  SVfrNameTableEntry  *pEntry;
+
+  pEntry = FindFirst (Name);
+  return (pEntry != NULL) ? pEntry->mData : NULL;
+}
+
+VOID
+CVfrNameTable::RemoveAll (
+  VOID
+  )
+{
+  SVfrNameTableEntry  *pEntry;
+  UINT32              Index;
+
+  for (Index = 0; Index < mBucketCount; Index++) {
+    while (mBuckets[Index] != NULL) {
+      pEntry          = mBuckets[Index];
+      mBuckets[Index] = pEntry->mNext;
+      delete pEntry;
+    }
+  }
+  if (mBuckets != NULL) {
+    delete[] mBuckets;
+  }
+  mBuckets     = NULL;
+  mBucketCount = 0;
+  mEntryCount  = 0;
+}
+
 VOID
 CVfrVarDataTypeDB::RegisterNewType (
   IN SVfrDataType  *New
@@ -571,6 +761,7 @@ CVfrVarDataTypeDB::RegisterNewType (
 {
   New->mNext               = mDataTypeList;
   mDataTypeList            = New;
+  mDataTypeTable.Add (New->mTypeName, New);
 }
 
 EFI_VFR_RETURN_CODE
@@ -983,8 +1174,6 @@ CVfrVarDataTypeDB::SetNewTypeName (
   IN CHAR8   *TypeName
   )
 {
-  SVfrDataType *pType;
-
   if (mNewDataType == NULL) {
     return VFR_RETURN_ERROR_SKIPED;
   }
@@ -995,10 +1184,8 @@ CVfrVarDataTypeDB::SetNewTypeName (
     return VFR_RETURN_INVALID_PARAMETER;
   }
 
-  for (pType = mDataTypeList; pType != NULL; pType = pType->mNext) {
-    if (strcmp(pType->mTypeName, TypeName) == 0) {
-      return VFR_RETURN_REDEFINED;
-    }
+  if (mDataTypeTable.Find (TypeName) != NULL) {
+    return VFR_RETURN_REDEFINED;
   }
 
   strcpy(mNewDataType->mTypeName, TypeName);
@@ -1097,11 +1284,9 @@ CVfrVarDataTypeDB::GetDataType (
 
   *DataType = NULL;
 
-  for (pDataType = mDataTypeList; pDataType != NULL; pDataType = pDataType->mNext) {
-    if (strcmp (TypeName, pDataType->mTypeName) == 0) {
-      *DataType = pDataType;
-      return VFR_RETURN_SUCCESS;
-    }
+  if ((pDataType = (SVfrDataType *) mDataTypeTable.Find (TypeName)) != NULL) {
+    *DataType = pDataType;
+    return VFR_RETURN_SUCCESS;
   }
 
   return VFR_RETURN_UNDEFINED;
@@ -1153,11 +1338,9 @@ CVfrVarDataTypeDB::GetDataTypeSize (
 
   *Size = 0;
 
-  for (pDataType = mDataTypeList; pDataType != NULL; pDataType = pDataType->mNext) {
-    if (strcmp (TypeName, pDataType->mTypeName) == 0) {
-      *Size = pDataType->mTotalSize;
-      return VFR_RETURN_SUCCESS;
-    }
+  if ((pDataType = (SVfrDataType *) mDataTypeTable.Find (TypeName)) != NULL) {
+    *Size = pDataType->mTotalSize;
+    return VFR_RETURN_SUCCESS;
   }
 
   return VFR_RETURN_UNDEFINED;
@@ -1245,19 +1428,240 @@ CVfrVarDataTypeDB::IsTypeNameDefined (
   IN CHAR8 *TypeName
   )
 {
-  SVfrDataType *pType;
-
   if (TypeName == NULL) {
     return FALSE;
   }
 
+  return (BOOLEAN) (mDataTypeTable.Find (TypeName) != NULL);
+}
+
+//
+// Layout of the user defined types saved by WriteUserDefinedTypes: the pack
+// alignment and the number of types, then the types oldest first, each one
+// followed by its fields.
+//
+typedef struct {
+  UINT32  mPackAlign;
+  UINT32  mTypeCount;
+} SVfrTypeListRecord;
+
+typedef struct {
+  CHAR8   mTypeName[MAX_NAME_LEN];
+  UINT32  mType;
+  UINT32  mAlign;
+  UINT32  mTotalSize;
+  UINT32  mFieldCount;
+} SVfrTypeRecord;
+
+typedef struct {
+  CHAR8   mFieldName[MAX_NAME_LEN];
+  CHAR8   mFieldTypeName[MAX_NAME_LEN];
+  UINT32  mOffset;
+  UINT32  mArrayNum;
+} SVfrFieldRecord;
+
+EFI_VFR_RETURN_CODE
+CVfrVarDataTypeDB::WriteUserDefinedTypes (
+  IN FILE         *File
+  )
+{
+  SVfrTypeListRecord  ListRecord;
+  SVfrTypeRecord      TypeRecord;
+  SVfrFieldRecord     FieldRecord;
+  SVfrDataType        **TypeArray;
+  SVfrDataType        *pType;
+  SVfrDataField       *pField;
+  UINT32              Index;
+  EFI_VFR_RETURN_CODE Status;
+
+  if (File == NULL) {
+    return VFR_RETURN_FATAL_ERROR;
+  }
+
+  memset (&ListRecord, 0, sizeof (ListRecord));
+  ListRecord.mPackAlign = mPackAlign;
   for (pType = mDataTypeList; pType != NULL; pType = pType->mNext) {
-    if (strcmp (pType->mTypeName, TypeName) == 0) {
-      return TRUE;
+    if (_IS_INTERNAL_TYPE(pType->mTypeName) == FALSE) {
+      ListRecord.mTypeCount++;
     }
   }
 
-  return FALSE;
+  TypeArray = NULL;
+  if ((ListRecord.mTypeCount != 0) && ((TypeArray = new SVfrDataType *[ListRecord.mTypeCount]) == NULL)) {
+    return VFR_RETURN_OUT_FOR_RESOURCES;
+  }
+
+  //
+  // The list is newest first.
+  //
+  Index = ListRecord.mTypeCount;
+  for (pType = mDataTypeList; pType != NULL; pType = pType->mNext) {
+    if (_IS_INTERNAL_TYPE(pType->mTypeName) == FALSE) {
+      TypeArray[--Index] = pType;
+    }
+  }
+
+  Status = VFR_RETURN_SUCCESS;
+  if (fwrite (&ListRecord, sizeof (ListRecord), 1, File) != 1) {
+    Status = VFR_RETURN_FATAL_ERROR;
+  }
+  for (Index = 0; (Index < ListRecord.mTypeCount) && (Status == VFR_RETURN_SUCCESS); Index++) {
+    pType = TypeArray[Index];
+    memset (&TypeRecord, 0, sizeof (TypeRecord));
+    strcpy (TypeRecord.mTypeName, pType->mTypeName);
+    TypeRecord.mType      = pType->mType;
+    TypeRecord.mAlign     = pType->mAlign;
+    TypeRecord.mTotalSize = pType->mTotalSize;
+    for (pField = pType->mMembers; pField != NULL; pField = pField->mNext) {
+      TypeRecord.mFieldCount++;
+    }
+    if (fwrite (&TypeRecord, sizeof (TypeRecord), 1, File) != 1) {
+      Status = VFR_RETURN_FATAL_ERROR;
+      break;
+    }
+
+    for (pField = pType->mMembers; pField != NULL; pField = pField->mNext) {
+      memset (&FieldRecord, 0, sizeof (FieldRecord));
+      strcpy (FieldRecord.mFieldName, pField->mFieldName);
+      strcpy (FieldRecord.mFieldTypeName, pField->mFieldType->mTypeName);
+      FieldRecord.mOffset   = pField->mOffset;
+      FieldRecord.mArrayNum = pField->mArrayNum;
+      if (fwrite (&FieldRecord, sizeof (FieldRecord), 1, File) != 1) {
+        Status = VFR_RETURN_FATAL_ERROR;
+        break;
+      }
+    }
+  }
+
+  if (TypeArray != NULL) {
+    delete[] TypeArray;
+  }
+  return Status;
+}
+
+/**
+  Add the types saved by WriteUserDefinedTypes to a data type database that
+  holds no user defined type yet. Nothing is added if the data is not valid.
+**/
+EFI_VFR_RETURN_CODE
+CVfrVarDataTypeDB::ReadUserDefinedTypes (
+  IN FILE         *File
+  )
+{
+  SVfrTypeListRecord  ListRecord;
+  SVfrTypeRecord      TypeRecord;
+  SVfrFieldRecord     FieldRecord;
+  CVfrNameTable       NewTypeTable;
+  SVfrDataType        *NewTypeList;
+  SVfrDataType        **TypeTail;
+  SVfrDataType        *pType;
+  SVfrDataType        *pFieldType;
+  SVfrDataField       *pField;
+  SVfrDataField       **FieldTail;
+  UINT32              Index;
+  UINT32              FieldIndex;
+  EFI_VFR_RETURN_CODE Status;
+
+  if ((File == NULL) || (mFirstNewDataTypeName != NULL)) {
+    return VFR_RETURN_FATAL_ERROR;
+  }
+
+  if ((fread (&ListRecord, sizeof (ListRecord), 1, File) != 1) ||
+      (ListRecord.mPackAlign == 0) || (ListRecord.mPackAlign > 16)) {
+    return VFR_RETURN_FATAL_ERROR;
+  }
+
+  NewTypeList = NULL;
+  TypeTail    = &NewTypeList;
+  Status      = VFR_RETURN_SUCCESS;
+  for (Index = 0; (Index < ListRecord.mTypeCount) && (Status == VFR_RETURN_SUCCESS); Index++) {
+    if (fread (&TypeRecord, sizeof (TypeRecord), 1, File) != 1) {
+      Status = VFR_RETURN_FATAL_ERROR;
+      break;
+    }
+    TypeRecord.mTypeName[MAX_NAME_LEN - 1] = '\0';
+    if ((TypeRecord.mTypeName[0] == '\0') || (TypeRecord.mAlign == 0) ||
+        (mDataTypeTable.Find (TypeRecord.mTypeName) != NULL) ||
+        (NewTypeTable.Find (TypeRecord.mTypeName) != NULL)) {
+      Status = VFR_RETURN_FATAL_ERROR;
+      break;
+    }
+
+    if ((pType = new SVfrDataType) == NULL) {
+      Status = VFR_RETURN_OUT_FOR_RESOURCES;
+      break;
+    }
+    strcpy (pType->mTypeName, TypeRecord.mTypeName);
+    pType->mType      = (UINT8) TypeRecord.mType;
+    pType->mAlign     = TypeRecord.mAlign;
+    pType->mTotalSize = TypeRecord.mTotalSize;
+    pType->mMembers   = NULL;
+    pType->mNext      = NULL;
+    *TypeTail         = pType;
+    TypeTail          = &pType->mNext;
+
+    FieldTail = &pType->mMembers;
+    for (FieldIndex = 0; FieldIndex < TypeRecord.mFieldCount; FieldIndex++) {
+      if (fread (&FieldRecord, sizeof (FieldRecord), 1, File) != 1) {
+        Status = VFR_RETURN_FATAL_ERROR;
+        break;
+      }
+      FieldRecord.mFieldName[MAX_NAME_LEN - 1]     = '\0';
+      FieldRecord.mFieldTypeName[MAX_NAME_LEN - 1] = '\0';
+
+      //
+      // A field is of a type declared before the structure.
+      //
+      pFieldType = (SVfrDataType *) NewTypeTable.Find (FieldRecord.mFieldTypeName);
+      if (pFieldType == NULL) {
+        pFieldType = (SVfrDataType *) mDataTypeTable.Find (FieldRecord.mFieldTypeName);
+      }
+      if (pFieldType == NULL) {
+        Status = VFR_RETURN_FATAL_ERROR;
+        break;
+      }
+
+      if ((pField = new SVfrDataField) == NULL) {
+        Status = VFR_RETURN_OUT_FOR_RESOURCES;
+        break;
+      }
+      strcpy (pField->mFieldName, FieldRecord.mFieldName);
+      pField->mFieldType = pFieldType;
+      pField->mOffset    = FieldRecord.mOffset;
+      pField->mArrayNum  = FieldRecord.mArrayNum;
+      pField->mNext      = NULL;
+      *FieldTail         = pField;
+      FieldTail          = &pField->mNext;
+    }
+
+    NewTypeTable.Add (pType->mTypeName, pType);
+  }
+
+  if (Status != VFR_RETURN_SUCCESS) {
+    while (NewTypeList != NULL) {
+      pType       = NewTypeList;
+      NewTypeList = NewTypeList->mNext;
+      while (pType->mMembers != NULL) {
+        pField          = pType->mMembers;
+        pType->mMembers = pType->mMembers->mNext;
+        delete pField;
+      }
+      delete pType;
+    }
+    return Status;
+  }
+
+  while (NewTypeList != NULL) {
+    pType       = NewTypeList;
+    NewTypeList = NewTypeList->mNext;
+    RegisterNewType (pType);
+    if (mFirstNewDataTypeName == NULL) {
+      mFirstNewDataTypeName = pType->mTypeName;
+    }
+  }
+  mPackAlign = ListRecord.mPackAlign;
+
+  return VFR_RETURN_SUCCESS;
 }
 
 VOID
@@ -1579,6 +1983,7 @@ CVfrDataStorage::DeclareNameVarStoreEnd (
   mNewVarStorageNode->mGuid = *Guid;
   mNewVarStorageNode->mNext = mNameVarStoreList;
   mNameVarStoreList         = mNewVarStorageNode;
+  mVarStoreNameTable.Add (mNewVarStorageNode->mVarStoreName, mNewVarStorageNode);
 
   mNewVarStorageNode        = NULL;
 
@@ -1616,6 +2021,7 @@ CVfrDataStorage::DeclareEfiVarStore (
 
   pNode->mNext       = mEfiVarStoreList;
   mEfiVarStoreList   = pNode;
+  mVarStoreNameTable.Add (pNode->mVarStoreName, pNode);
 
   return VFR_RETURN_SUCCESS;
 }
@@ -1659,6 +2065,8 @@ CVfrDataStorage::DeclareBufferVarStore (
 
   pNew->mNext         = mBufferVarStoreList;
   mBufferVarStoreList = pNew;
+  mVarStoreNameTable.Add (pNew->mVarStoreName, pNew);
+  mBufferVarStoreTypeTable.Add (pDataType->mTypeName, pNew);
 
   if (gCVfrBufferConfig.Register(StoreName, Guid) != 0) {
     return VFR_RETURN_FATAL_ERROR;
@@ -1676,6 +2084,7 @@ CVfrDataStorage::GetVarStoreByDataType (
 {
   SVfrVarStorageNode    *pNode;
   SVfrVarStorageNode    *MatchNode;
+  SVfrNameTableEntry    *pEntry;
   
   //
   // Framework VFR uses Data type name as varstore name, so don't need check again.
@@ -1685,10 +2094,8 @@ CVfrDataStorage::GetVarStoreByDataType (
   }
 
   MatchNode = NULL;
-  for (pNode = mBufferVarStoreList; pNode != NULL; pNode = pNode->mNext) {
-    if (strcmp (pNode->mStorageInfo.mDataType->mTypeName, DataTypeName) != 0) {
-      continue;
-    }
+  for (pEntry = mBufferVarStoreTypeTable.FindFirst (DataTypeName); pEntry != NULL; pEntry = mBufferVarStoreTypeTable.FindNext (pEntry)) {
+    pNode = (SVfrVarStorageNode *) pEntry->mData;
 
     if ((VarGuid != NULL)) {
       if (memcmp (VarGuid, &pNode->mGuid, sizeof (EFI_GUID)) == 0) {
@@ -1775,30 +2182,26 @@ CVfrDataStorage::GetVarStoreId (
 {
   EFI_VFR_RETURN_CODE   ReturnCode;
   SVfrVarStorageNode    *pNode;
+  SVfrNameTableEntry    *pEntry;
   BOOLEAN               HasFoundOne = FALSE;
+  UINT32                Index;
+  STATIC CONST EFI_VFR_VARSTORE_TYPE ListOrder[] = {
+    EFI_VFR_VARSTORE_BUFFER,
+    EFI_VFR_VARSTORE_EFI,
+    EFI_VFR_VARSTORE_NAME
+  };
 
   mCurrVarStorageNode = NULL;
 
-  for (pNode = mBufferVarStoreList; pNode != NULL; pNode = pNode->mNext) {
-    if (strcmp (pNode->mVarStoreName, StoreName) == 0) {
-      if (CheckGuidField(pNode, StoreGuid, &HasFoundOne, &ReturnCode)) {
-        *VarStoreId = mCurrVarStorageNode->mVarStoreId;
-        return ReturnCode;
-      }
-    }
-  }
-
-  for (pNode = mEfiVarStoreList; pNode != NULL; pNode = pNode->mNext) {
-    if (strcmp (pNode->mVarStoreName, StoreName) == 0) {
-      if (CheckGuidField(pNode, StoreGuid, &HasFoundOne, &ReturnCode)) {
-        *VarStoreId = mCurrVarStorageNode->mVarStoreId;
-        return ReturnCode;
+  //
+  // Check the buffer, EFI and name/value varstores in turn.
+  //
+  for (Index = 0; Index < sizeof (ListOrder) / sizeof (ListOrder[0]); Index++) {
+    for (pEntry = mVarStoreNameTable.FindFirst (StoreName); pEntry != NULL; pEntry = mVarStoreNameTable.FindNext (pEntry)) {
+      pNode = (SVfrVarStorageNode *) pEntry->mData;
+      if (pNode->mVarStoreType != ListOrder[Index]) {
+        continue;
       }
-    }
-  }
-
-  for (pNode = mNameVarStoreList; pNode != NULL; pNode = pNode->mNext) {
-    if (strcmp (pNode->mVarStoreName, StoreName) == 0) {
       if (CheckGuidField(pNode, StoreGuid, &HasFoundOne, &ReturnCode)) {
         *VarStoreId = mCurrVarStorageNode->mVarStoreId;
         return ReturnCode;
@@ -1816,6 +2219,7 @@ CVfrDataStorage::GetVarStoreId (
   //
   // Assume that Data strucutre name is used as StoreName, and check again. 
   //
+  pNode      = NULL;
   ReturnCode = GetVarStoreByDataType (StoreName, &pNode, StoreGuid);
   if (pNode != NULL) {
     mCurrVarStorageNode = pNode;
@@ -2495,6 +2899,8 @@ CVfrQuestionDB::ResetInit(
     mQuestionList = mQuestionList->mNext;
     delete pNode;
   }
+  mQuestionNameTable.RemoveAll ();
+  mQuestionVarIdTable.RemoveAll ();
 
   for (Index = 0; Index < EFI_FREE_QUESTION_ID_BITMAP_SIZE; Index++) {
     mFreeQIdBitMap[Index] = 0;
@@ -2517,6 +2923,26 @@ CVfrQuestionDB::PrintAllQuestion (
   }
 }
 
+VOID
+CVfrQuestionDB::InsertQuestion (
+  IN SVfrQuestionNode *pNode
+  )
+{
+  pNode->mNext  = mQuestionList;
+  mQuestionList = pNode;
+
+  //
+  // "$DEFAULT" and "$" stand for a missing name or variable, which can't be
+  // looked up, so they are left out of the tables.
+  //
+  if (strcmp (pNode->mName, "$DEFAULT") != 0) {
+    mQuestionNameTable.Add (pNode->mName, pNode);
+  }
+  if (strcmp (pNode->mVarIdStr, "$") != 0) {
+    mQuestionVarIdTable.Add (pNode->mVarIdStr, pNode);
+  }
+}
+
 EFI_VFR_RETURN_CODE
 CVfrQuestionDB::RegisterQuestion (
   IN     CHAR8             *Name,
@@ -2548,8 +2974,7 @@ CVfrQuestionDB::RegisterQuestion (
   }
   pNode->mQuestionId = QuestionId;
 
-  pNode->mNext       = mQuestionList;
-  mQuestionList      = pNode;
+  InsertQuestion (pNode);
 
   gCFormPkg.DoPendingAssign (VarIdStr, (VOID *)&QuestionId, sizeof(EFI_QUESTION_ID));
 
@@ -2596,10 +3021,9 @@ CVfrQuestionDB::RegisterOldDateQuestion (
   pNode[0]->mQtype      = QUESTION_DATE;
   pNode[1]->mQtype      = QUESTION_DATE;
   pNode[2]->mQtype      = QUESTION_DATE;
-  pNode[0]->mNext       = pNode[1];
-  pNode[1]->mNext       = pNode[2];
-  pNode[2]->mNext       = mQuestionList;
-  mQuestionList         = pNode[0];
+  InsertQuestion (pNode[2]);
+  InsertQuestion (pNode[1]);
+  InsertQuestion (pNode[0]);
 
   gCFormPkg.DoPendingAssign (YearVarId, (VOID *)&QuestionId, sizeof(EFI_QUESTION_ID));
   gCFormPkg.DoPendingAssign (MonthVarId, (VOID *)&QuestionId, sizeof(EFI_QUESTION_ID));
@@ -2703,10 +3127,9 @@ CVfrQuestionDB::RegisterNewDateQuestion (
   pNode[0]->mQtype      = QUESTION_DATE;
   pNode[1]->mQtype      = QUESTION_DATE;
   pNode[2]->mQtype      = QUESTION_DATE;
-  pNode[0]->mNext       = pNode[1];
-  pNode[1]->mNext       = pNode[2];
-  pNode[2]->mNext       = mQuestionList;
-  mQuestionList         = pNode[0];
+  InsertQuestion (pNode[2]);
+  InsertQuestion (pNode[1]);
+  InsertQuestion (pNode[0]);
 
   for (Index = 0; Index < 3; Index++) {
     if (VarIdStr[Index] != NULL) {
@@ -2772,10 +3195,9 @@ CVfrQuestionDB::RegisterOldTimeQuestion (
   pNode[0]->mQtype      = QUESTION_TIME;
   pNode[1]->mQtype      = QUESTION_TIME;
   pNode[2]->mQtype      = QUESTION_TIME;
-  pNode[0]->mNext       = pNode[1];
-  pNode[1]->mNext       = pNode[2];
-  pNode[2]->mNext       = mQuestionList;
-  mQuestionList         = pNode[0];
+  InsertQuestion (pNode[2]);
+  InsertQuestion (pNode[1]);
+  InsertQuestion (pNode[0]);
 
   gCFormPkg.DoPendingAssign (HourVarId, (VOID *)&QuestionId, sizeof(EFI_QUESTION_ID));
   gCFormPkg.DoPendingAssign (MinuteVarId, (VOID *)&QuestionId, sizeof(EFI_QUESTION_ID));
@@ -2879,10 +3301,9 @@ CVfrQuestionDB::RegisterNewTimeQuestion (
   pNode[0]->mQtype      = QUESTION_TIME;
   pNode[1]->mQtype      = QUESTION_TIME;
   pNode[2]->mQtype      = QUESTION_TIME;
-  pNode[0]->mNext       = pNode[1];
-  pNode[1]->mNext       = pNode[2];
-  pNode[2]->mNext       = mQuestionList;
-  mQuestionList         = pNode[0];
+  InsertQuestion (pNode[2]);
+  InsertQuestion (pNode[1]);
+  InsertQuestion (pNode[0]);
 
   for (Index = 0; Index < 3; Index++) {
     if (VarIdStr[Index] != NULL) {
@@ -3002,11 +3423,10 @@ CVfrQuestionDB::RegisterRefQuestion (
   pNode[1]->mQtype      = QUESTION_REF;
   pNode[2]->mQtype      = QUESTION_REF;
   pNode[3]->mQtype      = QUESTION_REF;  
-  pNode[0]->mNext       = pNode[1];
-  pNode[1]->mNext       = pNode[2];
-  pNode[2]->mNext       = pNode[3];
-  pNode[3]->mNext       = mQuestionList;  
-  mQuestionList         = pNode[0];
+  InsertQuestion (pNode[3]);
+  InsertQuestion (pNode[2]);
+  InsertQuestion (pNode[1]);
+  InsertQuestion (pNode[0]);
 
   gCFormPkg.DoPendingAssign (VarIdStr[0], (VOID *)&QuestionId, sizeof(EFI_QUESTION_ID));
   gCFormPkg.DoPendingAssign (VarIdStr[1], (VOID *)&QuestionId, sizeof(EFI_QUESTION_ID));
@@ -3075,7 +3495,8 @@ CVfrQuestionDB::GetQuestionId (
   OUT EFI_QUESION_TYPE  *QType
   )
 {
-  SVfrQuestionNode *pNode;
+  SVfrQuestionNode   *pNode;
+  SVfrNameTableEntry *pEntry;
 
   QuestionId = EFI_QUESTION_ID_INVALID;
   BitMask    = 0x00000000;
@@ -3087,7 +3508,13 @@ CVfrQuestionDB::GetQuestionId (
     return ;
   }
 
-  for (pNode = mQuestionList; pNode != NULL; pNode = pNode->mNext) {
+  if (VarIdStr != NULL) {
+    pEntry = mQuestionVarIdTable.FindFirst (VarIdStr);
+  } else {
+    pEntry = mQuestionNameTable.FindFirst (Name);
+  }
+  for (; pEntry != NULL; pEntry = (VarIdStr != NULL) ? mQuestionVarIdTable.FindNext (pEntry) : mQuestionNameTable.FindNext (pEntry)) {
+    pNode = (SVfrQuestionNode *) pEntry->mData;
     if (Name != NULL) {
       if (strcmp (pNode->mName, Name) != 0) {
         continue;
@@ -3136,16 +3563,12 @@ CVfrQuestionDB::FindQuestion (
   IN CHAR8 *Name
   )
 {
-  SVfrQuestionNode *pNode;
-
   if (Name == NULL) {
     return VFR_RETURN_FATAL_ERROR;
   }
 
-  for (pNode = mQuestionList; pNode != NULL; pNode = pNode->mNext) {
-    if (strcmp (pNode->mName, Name) == 0) {
-      return VFR_RETURN_SUCCESS;
-    }
+  if (mQuestionNameTable.Find (Name) != NULL) {
+    return VFR_RETURN_SUCCESS;
   }
 
   return VFR_RETURN_UNDEFINED;
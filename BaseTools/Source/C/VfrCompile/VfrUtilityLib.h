@@ -45,6 +45,40 @@ _STR2U32 (
   IN CHAR8 *Str
   );
 
+//
+// Index of the nodes of a list by name. The list still owns the nodes and
+// their names. Entries of a bucket are chained newest first, which is the
+// order the lists are built in, so a lookup finds the same node as a walk
+// of the list would.
+//
+#define VFR_NAME_TABLE_INIT_SIZE           0x100
+
+struct SVfrNameTableEntry {
+  CONST CHAR8               *mName;
+  VOID                      *mData;
+  SVfrNameTableEntry        *mNext;
+};
+
+class CVfrNameTable {
+private:
+  SVfrNameTableEntry        **mBuckets;
+  UINT32                    mBucketCount;
+  UINT32                    mEntryCount;
+
+  UINT32 Hash (IN CONST CHAR8 *);
+  VOID   Grow (VOID);
+
+public:
+  CVfrNameTable (VOID);
+  ~CVfrNameTable (VOID);
+
+  VOID                Add (IN CONST CHAR8 *, IN VOID *);
+  VOID                *Find (IN CONST CHAR8 *);
+  SVfrNameTableEntry  *FindFirst (IN CONST CHAR8 *);
+  SVfrNameTableEntry  *FindNext (IN SVfrNameTableEntry *);
+  VOID                RemoveAll (VOID);
+};
+
 struct SConfigInfo {
   UINT16             mOffset;
   UINT16             mWidth;
@@ -167,6 +201,7 @@ public:
 
 private:
   SVfrDataType              *mDataTypeList;
+  CVfrNameTable             mDataTypeTable;
 
   SVfrDataType              *mNewDataType;
   SVfrDataType              *mCurrDataType;
@@ -200,6 +235,9 @@ public:
 
   BOOLEAN             IsTypeNameDefined (IN CHAR8 *);
 
+  EFI_VFR_RETURN_CODE WriteUserDefinedTypes (IN FILE *);
+  EFI_VFR_RETURN_CODE ReadUserDefinedTypes (IN FILE *);
+
   VOID                Dump(IN FILE *);
   //
   // First the declared 
@@ -276,6 +314,9 @@ private:
   struct SVfrVarStorageNode *mEfiVarStoreList;
   struct SVfrVarStorageNode *mNameVarStoreList;
 
+  CVfrNameTable             mVarStoreNameTable;
+  CVfrNameTable             mBufferVarStoreTypeTable;
+
   struct SVfrVarStorageNode *mCurrVarStorageNode;
   struct SVfrVarStorageNode *mNewVarStorageNode;
 
@@ -345,9 +386,12 @@ struct SVfrQuestionNode {
 class CVfrQuestionDB {
 private:
   SVfrQuestionNode          *mQuestionList;
+  CVfrNameTable             mQuestionNameTable;
+  CVfrNameTable             mQuestionVarIdTable;
   UINT32                    mFreeQIdBitMap[EFI_FREE_QUESTION_ID_BITMAP_SIZE];
 
 private:
+  VOID            InsertQuestion (IN SVfrQuestionNode *);
   EFI_QUESTION_ID GetFreeQuestionId (VOID);
   BOOLEAN         ChekQuestionIdFree (IN EFI_QUESTION_ID);
   VOID            MarkQuestionIdUsed (IN EFI_QUESTION_ID);
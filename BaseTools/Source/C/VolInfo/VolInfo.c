@@ -36,6 +36,18 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #include "OsPath.h"
 #include "ParseGuidedSectionTools.h"
 #include "StringFuncs.h"
+#include "../LzmaCompress/Sdk/C/LzmaDec.h"
+#include "../LzmaCompress/Sdk/C/Bra.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 
 //
 // Utility global variables
@@ -43,8 +55,15 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 
 EFI_GUID  gEfiCrc32GuidedSectionExtractionProtocolGuid = EFI_CRC32_GUIDED_SECTION_EXTRACTION_PROTOCOL_GUID;
 
+//
+// GUIDed sections decoded without calling the tool of GuidedSectionTools.txt
+//
+EFI_GUID  mTianoCustomDecompressGuid   = { 0xA31280AD, 0x481E, 0x41B6, { 0x95, 0xE8, 0x12, 0x7F, 0x4C, 0x98, 0x47, 0x79 }};
+EFI_GUID  mLzmaCustomDecompressGuid    = { 0xEE4E5898, 0x3914, 0x4259, { 0x9D, 0x6E, 0xDC, 0x7B, 0xD7, 0x94, 0x03, 0xCF }};
+EFI_GUID  mLzmaF86CustomDecompressGuid = { 0xD42AE6BD, 0x1352, 0x4BFB, { 0x90, 0x9A, 0xCA, 0x72, 0xA6, 0xEA, 0xE8, 0x89 }};
+
 #define UTILITY_MAJOR_VERSION      0
-#define UTILITY_MINOR_VERSION      83
+#define UTILITY_MINOR_VERSION      84
 
 #define UTILITY_NAME         "VolInfo"
 
@@ -52,6 +71,17 @@ EFI_GUID  gEfiCrc32GuidedSectionExtractionProtocolGuid = EFI_CRC32_GUIDED_SECTIO
 
 #define MAX_BASENAME_LEN  60  // not good to hardcode, but let's be reasonable
 
+#define MAX_DECODE_THREADS  64
+#define MAX_JSON_DEPTH      256
+
+//
+// LZMA encoded data, either one LZMA stream or a block header followed by
+// independently encoded blocks, as written by LzmaCompress
+//
+#define LZMA_HEADER_SIZE        (LZMA_PROPS_SIZE + 8)
+#define LZMA_BLOCK_SIGNATURE    0x4B425AFF
+#define LZMA_BLOCK_HEADER_SIZE  20
+
 //
 // Structure to keep a list of guid-to-basenames
 //
@@ -63,6 +93,48 @@ typedef struct _GUID_TO_BASENAME {
 
 static GUID_TO_BASENAME *mGuidBaseNameList = NULL;
 
+//
+// Compressed and GUIDed sections are decoded by worker threads before the
+// FV is printed. Decoding the sections found in decoded data is another round.
+//
+typedef enum {
+  DecodeEfi,
+  DecodeTiano,
+  DecodeLzma,
+  DecodeLzmaF86
+} DECODE_METHOD;
+
+typedef struct {
+  UINT8           *Section;     // The compression or GUIDed section
+  UINT8           *Data;        // The encoded data of the section
+  UINT32          DataLength;
+  DECODE_METHOD   Method;
+  UINT8           *Buffer;      // The decoded data
+  UINT32          Length;
+  EFI_STATUS      Status;
+} DECODE_JOB;
+
+#ifdef _WIN32
+typedef HANDLE     WORKER_THREAD;
+#else
+typedef pthread_t  WORKER_THREAD;
+#endif
+
+STATIC DECODE_JOB       *mDecodeJobs = NULL;
+STATIC UINT32           mDecodeJobCount = 0;
+STATIC UINT32           mDecodeJobMax = 0;
+STATIC volatile INT32   mNextDecodeJob = 0;
+STATIC UINT32           mDecodeJobEnd = 0;
+
+//
+// JSON report written with --json. Each open object or array keeps its
+// closing character, and whether a member was already written to it.
+//
+STATIC FILE     *mJsonFile = NULL;
+STATIC UINT32   mJsonDepth = 0;
+STATIC CHAR8    mJsonClose[MAX_JSON_DEPTH];
+STATIC BOOLEAN  mJsonHasMember[MAX_JSON_DEPTH];
+
 //
 // Store GUIDed Section guid->tool mapping
 //
@@ -85,6 +157,12 @@ PrintGuidName (
   IN UINT8    *GuidStr
   );
 
+STATIC
+CHAR8 *
+FindGuidBaseName (
+  IN UINT8    *GuidStr
+  );
+
 EFI_STATUS
 ParseSection (
   IN UINT8  *SectionBuffer,
@@ -126,6 +204,94 @@ LoadGuidedSectionToolsTxt (
   IN CHAR8* FirmwareVolumeFilename
   );
 
+STATIC
+VOID *
+MapInputFile (
+  IN  CHAR8   *FileName,
+  IN  UINT32  Offset,
+  IN  UINT32  FvSize,
+  OUT UINTN   *MappedSize
+  );
+
+STATIC
+VOID
+UnmapInputFile (
+  IN VOID   *Base,
+  IN UINTN  MappedSize
+  );
+
+STATIC
+VOID
+CollectFvDecodeJobs (
+  IN VOID  *Fv
+  );
+
+STATIC
+VOID
+DecodeAllSections (
+  IN VOID  *Fv
+  );
+
+STATIC
+DECODE_JOB *
+FindDecodeJob (
+  IN UINT8  *Section
+  );
+
+STATIC
+VOID
+FreeDecodeJobs (
+  VOID
+  );
+
+STATIC
+VOID
+JsonBegin (
+  IN CHAR8  *Name,
+  IN CHAR8  Open
+  );
+
+STATIC
+VOID
+JsonEnd (
+  VOID
+  );
+
+STATIC
+VOID
+JsonCloseTo (
+  IN UINT32  Depth
+  );
+
+STATIC
+VOID
+JsonString (
+  IN CHAR8  *Name,
+  IN CHAR8  *Value
+  );
+
+STATIC
+VOID
+JsonString16 (
+  IN CHAR8  *Name,
+  IN UINT8  *Value,
+  IN UINT32 MaxLength
+  );
+
+STATIC
+VOID
+JsonNumber (
+  IN CHAR8   *Name,
+  IN UINT64  Value
+  );
+
+STATIC
+VOID
+JsonGuid (
+  IN CHAR8     *Name,
+  IN EFI_GUID  *Guid
+  );
+
 void
 Usage (
   VOID
@@ -160,6 +326,8 @@ Returns:
   EFI_STATUS                  Status;
   int                         Offset;
   BOOLEAN                     ErasePolarity;
+  UINTN                       MappedSize;
+  CHAR8                       *JsonFileName;
 
   SetUtilityName (UTILITY_NAME);
   //
@@ -181,6 +349,7 @@ Returns:
   argv++;
 
   Offset = 0;
+  JsonFileName = NULL;
 
   //
   // If they specified -x xref guid/basename cross-reference files, process it.
@@ -216,6 +385,10 @@ Returns:
         }
       }
 
+      argc -= 2;
+      argv += 2;
+    } else if (strcmp(argv[0], "--json") == 0) {
+      JsonFileName = argv[1];
       argc -= 2;
       argv += 2;
     } else {
@@ -264,34 +437,69 @@ Returns:
     return GetUtilityStatus ();
   }
   //
-  // Allocate a buffer for the FV image
+  // Map the FV image. Only the pages actually parsed are read from the file.
   //
-  FvImage = malloc (FvSize);
-  if (FvImage == NULL) {
-    Error (NULL, 0, 4001, "Resource: Memory can't be allocated", NULL);
+  FvImage = MapInputFile (argv[0], (UINT32) Offset, FvSize, &MappedSize);
+  if (FvImage != NULL) {
     fclose (InputFile);
-    return GetUtilityStatus ();
+  } else {
+    //
+    // Allocate a buffer for the FV image
+    //
+    FvImage = malloc (FvSize);
+    if (FvImage == NULL) {
+      Error (NULL, 0, 4001, "Resource: Memory can't be allocated", NULL);
+      fclose (InputFile);
+      return GetUtilityStatus ();
+    }
+    //
+    // Seek to the start of the image, then read the entire FV to the buffer
+    //
+    fseek (InputFile, Offset, SEEK_SET);
+    BytesRead = fread (FvImage, 1, FvSize, InputFile);
+    fclose (InputFile);
+    if ((unsigned int) BytesRead != FvSize) {
+      Error (NULL, 0, 0004, "error reading FvImage from", argv[0]);
+      free (FvImage);
+      return GetUtilityStatus ();
+    }
   }
-  //
-  // Seek to the start of the image, then read the entire FV to the buffer
-  //
-  fseek (InputFile, Offset, SEEK_SET);
-  BytesRead = fread (FvImage, 1, FvSize, InputFile);
-  fclose (InputFile);
-  if ((unsigned int) BytesRead != FvSize) {
-    Error (NULL, 0, 0004, "error reading FvImage from", argv[0]);
-    free (FvImage);
-    return GetUtilityStatus ();
+
+  if (JsonFileName != NULL) {
+    mJsonFile = fopen (LongFilePath (JsonFileName), "w");
+    if (mJsonFile == NULL) {
+      Error (NULL, 0, 0001, "Error opening the output file", JsonFileName);
+    }
   }
 
   LoadGuidedSectionToolsTxt (argv[0]);
 
+  //
+  // Decode the compressed and GUIDed sections of all nesting levels in
+  // parallel, PrintFvInfo () then only looks the decoded data up.
+  //
+  DecodeAllSections (FvImage);
+
+  JsonBegin (NULL, '{');
+  JsonString ("file", argv[0]);
+  JsonNumber ("offset", (UINT64) Offset);
   PrintFvInfo (FvImage, FALSE);
+  JsonCloseTo (0);
+  if (mJsonFile != NULL) {
+    fprintf (mJsonFile, "\n");
+    fclose (mJsonFile);
+    mJsonFile = NULL;
+  }
 
   //
   // Clean up
   //
-  free (FvImage);
+  FreeDecodeJobs ();
+  if (MappedSize != 0) {
+    UnmapInputFile ((UINT8 *) FvImage - Offset, MappedSize);
+  } else {
+    free (FvImage);
+  }
   FreeGuidBaseNameList ();
   return GetUtilityStatus ();
 }
@@ -326,9 +534,31 @@ Returns:
   UINTN                       FvSize;
   EFI_FFS_FILE_HEADER         *CurrentFile;
   UINTN                       Key;
+  UINT32                      JsonDepth;
+  EFI_FIRMWARE_VOLUME_HEADER  *FvHeader;
+  EFI_FV_BLOCK_MAP_ENTRY      *BlockMap;
 
   Status = FvBufGetSize (Fv, &FvSize);
 
+  FvHeader = (EFI_FIRMWARE_VOLUME_HEADER *) Fv;
+  JsonBegin ("fv", '{');
+  JsonGuid ("fileSystemGuid", &FvHeader->FileSystemGuid);
+  JsonNumber ("length", FvHeader->FvLength);
+  JsonNumber ("attributes", FvHeader->Attributes);
+  JsonNumber ("headerLength", FvHeader->HeaderLength);
+  JsonNumber ("revision", FvHeader->Revision);
+  JsonBegin ("blockMap", '[');
+  for (BlockMap = FvHeader->BlockMap;
+       ((UINT8 *) (BlockMap + 1) <= (UINT8 *) Fv + FvHeader->HeaderLength) && (BlockMap->NumBlocks != 0);
+       BlockMap++) {
+    JsonBegin (NULL, '{');
+    JsonNumber ("numBlocks", BlockMap->NumBlocks);
+    JsonNumber ("length", BlockMap->Length);
+    JsonEnd ();
+  }
+  JsonEnd ();
+  JsonBegin ("files", '[');
+
   NumberOfFiles = 0;
   ErasePolarity =
     (((EFI_FIRMWARE_VOLUME_HEADER*)Fv)->Attributes & EFI_FVB2_ERASE_POLARITY) ?
@@ -353,9 +583,12 @@ Returns:
     NumberOfFiles++;
 
     //
-    // Display info about this file
+    // Display info about this file. The JSON object of the file is still open
+    // if it was only partially parsed.
     //
+    JsonDepth = mJsonDepth;
     Status = PrintFileInfo (Fv, CurrentFile, ErasePolarity);
+    JsonCloseTo (JsonDepth);
     if (EFI_ERROR (Status)) {
       Error (NULL, 0, 0003, "error parsing FV image", "failed to parse a file in the FV");
       return GetUtilityStatus ();
@@ -372,6 +605,10 @@ Returns:
     }
   }
 
+  JsonEnd ();
+  JsonNumber ("fileCount", NumberOfFiles);
+  JsonEnd ();
+
   if (IsChildFv) {
     printf ("There are a total of %d files in the child FV\n", (int) NumberOfFiles);
   } else {
@@ -573,6 +810,76 @@ Returns:
   return SectionStr;
 }
 
+STATIC
+CHAR8 *
+FileTypeToStr (
+  IN EFI_FV_FILETYPE    Type
+  )
+/*++
+
+Routine Description:
+
+  Converts FFS file types to Strings
+
+Arguments:
+
+  Type  - The FFS file type
+
+Returns:
+
+  CHAR8* - The constant string of the file type name, NULL if the type is unrecognized.
+
+--*/
+{
+  switch (Type) {
+
+  case EFI_FV_FILETYPE_RAW:
+    return "EFI_FV_FILETYPE_RAW";
+
+  case EFI_FV_FILETYPE_FREEFORM:
+    return "EFI_FV_FILETYPE_FREEFORM";
+
+  case EFI_FV_FILETYPE_SECURITY_CORE:
+    return "EFI_FV_FILETYPE_SECURITY_CORE";
+
+  case EFI_FV_FILETYPE_PEI_CORE:
+    return "EFI_FV_FILETYPE_PEI_CORE";
+
+  case EFI_FV_FILETYPE_DXE_CORE:
+    return "EFI_FV_FILETYPE_DXE_CORE";
+
+  case EFI_FV_FILETYPE_PEIM:
+    return "EFI_FV_FILETYPE_PEIM";
+
+  case EFI_FV_FILETYPE_DRIVER:
+    return "EFI_FV_FILETYPE_DRIVER";
+
+  case EFI_FV_FILETYPE_COMBINED_PEIM_DRIVER:
+    return "EFI_FV_FILETYPE_COMBINED_PEIM_DRIVER";
+
+  case EFI_FV_FILETYPE_APPLICATION:
+    return "EFI_FV_FILETYPE_APPLICATION";
+
+  case EFI_FV_FILETYPE_SMM:
+    return "EFI_FV_FILETYPE_SMM";
+
+  case EFI_FV_FILETYPE_FIRMWARE_VOLUME_IMAGE:
+    return "EFI_FV_FILETYPE_FIRMWARE_VOLUME_IMAGE";
+
+  case EFI_FV_FILETYPE_COMBINED_SMM_DXE:
+    return "EFI_FV_FILETYPE_COMBINED_SMM_DXE";
+
+  case EFI_FV_FILETYPE_SMM_CORE:
+    return "EFI_FV_FILETYPE_SMM_CORE";
+
+  case EFI_FV_FILETYPE_FFS_PAD:
+    return "EFI_FV_FILETYPE_FFS_PAD";
+
+  default:
+    return NULL;
+  }
+}
+
 STATIC
 EFI_STATUS
 ReadHeader (
@@ -972,6 +1279,8 @@ Returns:
   EFI_STATUS          Status;
   UINT8               GuidBuffer[PRINTED_GUID_BUFFER_SIZE];
   UINT32              HeaderSize;
+  CHAR8               *FileTypeName;
+  CHAR8               *BaseName;
 #if (PI_SPECIFICATION_VERSION < 0x00010000) 
   UINT16              *Tail;
 #endif
@@ -1009,6 +1318,20 @@ Returns:
   printf ("File Attributes:  0x%02X\n", FileHeader->Attributes);
   printf ("File State:       0x%02X\n", FileHeader->State);
 
+  //
+  // The caller closes the JSON object of the file
+  //
+  JsonBegin (NULL, '{');
+  JsonString ("name", (CHAR8 *) GuidBuffer);
+  BaseName = FindGuidBaseName (GuidBuffer);
+  if (BaseName != NULL) {
+    JsonString ("baseName", BaseName);
+  }
+  JsonNumber ("offset", (UINTN) FileHeader - (UINTN) FvImage);
+  JsonNumber ("length", FileLength);
+  JsonNumber ("attributes", FileHeader->Attributes);
+  JsonNumber ("state", FileHeader->State);
+
   //
   // Print file state
   //
@@ -1099,70 +1422,16 @@ Returns:
 
   printf ("File Type:        0x%02X  ", FileHeader->Type);
 
-  switch (FileHeader->Type) {
-
-  case EFI_FV_FILETYPE_RAW:
-    printf ("EFI_FV_FILETYPE_RAW\n");
-    break;
-
-  case EFI_FV_FILETYPE_FREEFORM:
-    printf ("EFI_FV_FILETYPE_FREEFORM\n");
-    break;
-
-  case EFI_FV_FILETYPE_SECURITY_CORE:
-    printf ("EFI_FV_FILETYPE_SECURITY_CORE\n");
-    break;
-
-  case EFI_FV_FILETYPE_PEI_CORE:
-    printf ("EFI_FV_FILETYPE_PEI_CORE\n");
-    break;
-
-  case EFI_FV_FILETYPE_DXE_CORE:
-    printf ("EFI_FV_FILETYPE_DXE_CORE\n");
-    break;
-
-  case EFI_FV_FILETYPE_PEIM:
-    printf ("EFI_FV_FILETYPE_PEIM\n");
-    break;
-
-  case EFI_FV_FILETYPE_DRIVER:
-    printf ("EFI_FV_FILETYPE_DRIVER\n");
-    break;
-
-  case EFI_FV_FILETYPE_COMBINED_PEIM_DRIVER:
-    printf ("EFI_FV_FILETYPE_COMBINED_PEIM_DRIVER\n");
-    break;
-
-  case EFI_FV_FILETYPE_APPLICATION:
-    printf ("EFI_FV_FILETYPE_APPLICATION\n");
-    break;
-
-  case EFI_FV_FILETYPE_SMM:
-    printf ("EFI_FV_FILETYPE_SMM\n");
-    break;
-
-  case EFI_FV_FILETYPE_FIRMWARE_VOLUME_IMAGE:
-    printf ("EFI_FV_FILETYPE_FIRMWARE_VOLUME_IMAGE\n");
-    break;
-
-  case EFI_FV_FILETYPE_COMBINED_SMM_DXE:
-    printf ("EFI_FV_FILETYPE_COMBINED_SMM_DXE\n");
-    break;
-
-  case EFI_FV_FILETYPE_SMM_CORE:
-    printf ("EFI_FV_FILETYPE_SMM_CORE\n");
-    break;
-
-  case EFI_FV_FILETYPE_FFS_PAD:
-    printf ("EFI_FV_FILETYPE_FFS_PAD\n");
-    break;
-
-  default:
+  FileTypeName = FileTypeToStr (FileHeader->Type);
+  if (FileTypeName == NULL) {
     printf ("\nERROR: Unrecognized file type %X.\n", FileHeader->Type);
     return EFI_ABORTED;
-    break;
   }
 
+  printf ("%s\n", FileTypeName);
+  JsonNumber ("type", FileHeader->Type);
+  JsonString ("typeName", FileTypeName);
+
   switch (FileHeader->Type) {
 
   case EFI_FV_FILETYPE_ALL:
@@ -1174,6 +1443,7 @@ Returns:
     //
     // All other files have sections
     //
+    JsonBegin ("sections", '[');
     Status = ParseSection (
               (UINT8 *) ((UINTN) FileHeader + HeaderSize),
               FvBufGetFfsFileSize (FileHeader) - HeaderSize
@@ -1246,6 +1516,7 @@ Returns:
   UINT16              DataOffset;
   UINT16              Attributes;
   UINT32              RealHdrLen;
+  DECODE_JOB          *Job;
 
   ParsedLength = 0;
   while (ParsedLength < BufferLength) {
@@ -1273,8 +1544,13 @@ Returns:
     SectionName = SectionNameToStr (Type);
     printf ("------------------------------------------------------------\n");
     printf ("  Type:  %s\n  Size:  0x%08X\n", SectionName, (unsigned) SectionLength);
+    JsonBegin (NULL, '{');
+    JsonString ("type", SectionName);
+    JsonNumber ("size", SectionLength);
     free (SectionName);
 
+    Job = NULL;
+
     switch (Type) {
     case EFI_SECTION_RAW:
     case EFI_SECTION_PE32:
@@ -1286,6 +1562,7 @@ Returns:
     case EFI_SECTION_USER_INTERFACE:
       // name = &((EFI_USER_INTERFACE_SECTION *) Ptr)->FileNameString;
       // printf ("  String: %s\n", &name);
+      JsonString16 ("name", Ptr + SectionHeaderLen, SectionLength - SectionHeaderLen);
       break;
 
     case EFI_SECTION_FIRMWARE_VOLUME_IMAGE:
@@ -1312,6 +1589,8 @@ Returns:
     case EFI_SECTION_VERSION:
       printf ("  Build Number:  0x%02X\n", *(UINT16 *)(Ptr + SectionHeaderLen));
       printf ("  Version Strg:  %s\n", (char*) (Ptr + SectionHeaderLen + sizeof (UINT16)));
+      JsonNumber ("buildNumber", *(UINT16 *)(Ptr + SectionHeaderLen));
+      JsonString16 ("version", Ptr + SectionHeaderLen + sizeof (UINT16), SectionLength - SectionHeaderLen - sizeof (UINT16));
       break;
 
     case EFI_SECTION_COMPRESSION:
@@ -1327,9 +1606,11 @@ Returns:
       }
       CompressedLength    = SectionLength - RealHdrLen;
       printf ("  Uncompressed Length:  0x%08X\n", (unsigned) UncompressedLength);
+      JsonNumber ("uncompressedLength", UncompressedLength);
 
       if (CompressionType == EFI_NOT_COMPRESSED) {
         printf ("  Compression Type:  EFI_NOT_COMPRESSED\n");
+        JsonString ("compressionType", "EFI_NOT_COMPRESSED");
         if (CompressedLength != UncompressedLength) {
           Error (
             NULL,
@@ -1346,47 +1627,58 @@ Returns:
         GetInfoFunction     = EfiGetInfo;
         DecompressFunction  = EfiDecompress;
         printf ("  Compression Type:  EFI_STANDARD_COMPRESSION\n");
+        JsonString ("compressionType", "EFI_STANDARD_COMPRESSION");
 
         CompressedBuffer  = Ptr + RealHdrLen;
 
-        Status            = GetInfoFunction (CompressedBuffer, CompressedLength, &DstSize, &ScratchSize);
-        if (EFI_ERROR (Status)) {
-          Error (NULL, 0, 0003, "error getting compression info from compression section", NULL);
-          return EFI_SECTION_ERROR;
-        }
-
-        if (DstSize != UncompressedLength) {
-          Error (NULL, 0, 0003, "compression error in the compression section", NULL);
-          return EFI_SECTION_ERROR;
-        }
-
-        ScratchBuffer       = malloc (ScratchSize);
-        UncompressedBuffer  = malloc (UncompressedLength);
-        if ((ScratchBuffer == NULL) || (UncompressedBuffer == NULL)) {
-          return EFI_OUT_OF_RESOURCES;
-        }
-        Status = DecompressFunction (
-                  CompressedBuffer,
-                  CompressedLength,
-                  UncompressedBuffer,
-                  UncompressedLength,
-                  ScratchBuffer,
-                  ScratchSize
-                  );
-        free (ScratchBuffer);
-        if (EFI_ERROR (Status)) {
-          Error (NULL, 0, 0003, "decompress failed", NULL);
-          free (UncompressedBuffer);
-          return EFI_SECTION_ERROR;
+        Job = FindDecodeJob (Ptr);
+        if ((Job != NULL) && !EFI_ERROR (Job->Status) && (Job->Length == UncompressedLength)) {
+          //
+          // Decompressed by DecodeAllSections ()
+          //
+          UncompressedBuffer = Job->Buffer;
+        } else {
+          Status            = GetInfoFunction (CompressedBuffer, CompressedLength, &DstSize, &ScratchSize);
+          if (EFI_ERROR (Status)) {
+            Error (NULL, 0, 0003, "error getting compression info from compression section", NULL);
+            return EFI_SECTION_ERROR;
+          }
+
+          if (DstSize != UncompressedLength) {
+            Error (NULL, 0, 0003, "compression error in the compression section", NULL);
+            return EFI_SECTION_ERROR;
+          }
+
+          ScratchBuffer       = malloc (ScratchSize);
+          UncompressedBuffer  = malloc (UncompressedLength);
+          if ((ScratchBuffer == NULL) || (UncompressedBuffer == NULL)) {
+            return EFI_OUT_OF_RESOURCES;
+          }
+          Status = DecompressFunction (
+                    CompressedBuffer,
+                    CompressedLength,
+                    UncompressedBuffer,
+                    UncompressedLength,
+                    ScratchBuffer,
+                    ScratchSize
+                    );
+          free (ScratchBuffer);
+          if (EFI_ERROR (Status)) {
+            Error (NULL, 0, 0003, "decompress failed", NULL);
+            free (UncompressedBuffer);
+            return EFI_SECTION_ERROR;
+          }
         }
       } else {
         Error (NULL, 0, 0003, "unrecognized compression type", "type 0x%X", CompressionType);
         return EFI_SECTION_ERROR;
       }
 
+      JsonBegin ("sections", '[');
       Status = ParseSection (UncompressedBuffer, UncompressedLength);
+      JsonEnd ();
 
-      if (CompressionType == EFI_STANDARD_COMPRESSION) {
+      if ((CompressionType == EFI_STANDARD_COMPRESSION) && ((Job == NULL) || (UncompressedBuffer != Job->Buffer))) {
         //
         // We need to deallocate Buffer
         //
@@ -1414,14 +1706,37 @@ Returns:
       printf ("\n");
       printf ("  DataOffset:             0x%04X\n", (unsigned) DataOffset);
       printf ("  Attributes:             0x%04X\n", (unsigned) Attributes);
+      JsonGuid ("guid", EfiGuid);
+      JsonNumber ("dataOffset", DataOffset);
+      JsonNumber ("attributes", Attributes);
+      JsonBegin ("sections", '[');
 
-      ExtractionTool =
-        LookupGuidedSectionToolPath (
-          mParsedGuidedSectionTools,
-          EfiGuid
-          );
+      //
+      // LZMA and Tiano compressed sections are decoded by DecodeAllSections ()
+      //
+      Job = FindDecodeJob (Ptr);
+      ExtractionTool = NULL;
+      if (Job == NULL) {
+        ExtractionTool =
+          LookupGuidedSectionToolPath (
+            mParsedGuidedSectionTools,
+            EfiGuid
+            );
+      }
+
+      if (Job != NULL) {
+        if (EFI_ERROR (Job->Status)) {
+          Error (NULL, 0, 0003, "decode of GUIDED section failed", NULL);
+          return EFI_SECTION_ERROR;
+        }
+
+        Status = ParseSection (Job->Buffer, Job->Length);
+        if (EFI_ERROR (Status)) {
+          Error (NULL, 0, 0003, "parse of decoded GUIDED section failed", NULL);
+          return EFI_SECTION_ERROR;
+        }
 
-      if (ExtractionTool != NULL) {
+      } else if (ExtractionTool != NULL) {
 
         ToolInputFile = CloneString (tmpnam (NULL));
         ToolOutputFile = CloneString (tmpnam (NULL));
@@ -1449,8 +1764,8 @@ Returns:
         Status =
           PutFileImage (
             ToolInputFile,
-            (CHAR8*) SectionBuffer + DataOffset,
-            BufferLength - DataOffset
+            (CHAR8*) Ptr + DataOffset,
+            SectionLength - DataOffset
             );
 
         system (SystemCommand);
@@ -1491,8 +1806,8 @@ Returns:
         // CRC32 guided section
         //
         Status = ParseSection (
-                  SectionBuffer + DataOffset,
-                  BufferLength - DataOffset
+                  Ptr + DataOffset,
+                  SectionLength - DataOffset
                   );
         if (EFI_ERROR (Status)) {
           Error (NULL, 0, 0003, "parse of CRC32 GUIDED section failed", NULL);
@@ -1506,6 +1821,7 @@ Returns:
         "EFI_SECTION_GUID_DEFINED cannot be parsed at this time. Tool to decode this section should have been defined in GuidedSectionTools.txt (built in the FV directory).");
         return EFI_UNSUPPORTED;
       }
+      JsonEnd ();
       break;
 
     default:
@@ -1515,6 +1831,7 @@ Returns:
       Error (NULL, 0, 0003, "unrecognized section type found", "section type = 0x%X", Type);
       return EFI_SECTION_ERROR;
     }
+    JsonEnd ();
 
     ParsedLength += SectionLength;
     //
@@ -1664,51 +1981,84 @@ Returns:
 
 --*/
 {
-  GUID_TO_BASENAME  *GPtr;
+  CHAR8             *BaseName;
+
   //
-  // If we have a list of guid-to-basenames, then go through the list to
-  // look for a guid string match. If found, print the basename to stdout,
-  // otherwise return a failure.
+  // If found, print the basename to stdout, otherwise return a failure.
   //
-  GPtr = mGuidBaseNameList;
-  while (GPtr != NULL) {
-    if (_stricmp ((CHAR8*) GuidStr, (CHAR8*) GPtr->Guid) == 0) {
-      printf ("%s", GPtr->BaseName);
-      return EFI_SUCCESS;
-    }
-
-    GPtr = GPtr->Next;
+  BaseName = FindGuidBaseName (GuidStr);
+  if (BaseName != NULL) {
+    printf ("%s", BaseName);
+    return EFI_SUCCESS;
   }
 
   return EFI_INVALID_PARAMETER;
 }
 
-EFI_STATUS
-ParseGuidBaseNameFile (
-  CHAR8    *FileName
+STATIC
+CHAR8 *
+FindGuidBaseName (
+  IN UINT8    *GuidStr
   )
 /*++
 
 Routine Description:
 
-  GC_TODO: Add function description
+  Look a file guid up in the guid-to-basename cross reference.
 
 Arguments:
 
-  FileName  - GC_TODO: add argument description
+  GuidStr - The printed file guid
 
 Returns:
 
-  EFI_DEVICE_ERROR - GC_TODO: Add description for return value
-  EFI_OUT_OF_RESOURCES - GC_TODO: Add description for return value
-  EFI_SUCCESS - GC_TODO: Add description for return value
+  CHAR8* - The basename of the file, NULL if the guid is not in the list.
 
 --*/
 {
-  FILE              *Fptr;
-  CHAR8             Line[MAX_LINE_LEN];
   GUID_TO_BASENAME  *GPtr;
-
+  //
+  // If we have a list of guid-to-basenames, then go through the list to
+  // look for a guid string match.
+  //
+  GPtr = mGuidBaseNameList;
+  while (GPtr != NULL) {
+    if (_stricmp ((CHAR8*) GuidStr, (CHAR8*) GPtr->Guid) == 0) {
+      return (CHAR8 *) GPtr->BaseName;
+    }
+
+    GPtr = GPtr->Next;
+  }
+
+  return NULL;
+}
+
+EFI_STATUS
+ParseGuidBaseNameFile (
+  CHAR8    *FileName
+  )
+/*++
+
+Routine Description:
+
+  GC_TODO: Add function description
+
+Arguments:
+
+  FileName  - GC_TODO: add argument description
+
+Returns:
+
+  EFI_DEVICE_ERROR - GC_TODO: Add description for return value
+  EFI_OUT_OF_RESOURCES - GC_TODO: Add description for return value
+  EFI_SUCCESS - GC_TODO: Add description for return value
+
+--*/
+{
+  FILE              *Fptr;
+  CHAR8             Line[MAX_LINE_LEN];
+  GUID_TO_BASENAME  *GPtr;
+
   if ((Fptr = fopen (LongFilePath (FileName), "r")) == NULL) {
     printf ("ERROR: Failed to open input cross-reference file '%s'\n", FileName);
     return EFI_DEVICE_ERROR;
@@ -1803,6 +2153,914 @@ LoadGuidedSectionToolsTxt (
 }
 
 
+STATIC
+VOID *
+MapInputFile (
+  IN  CHAR8   *FileName,
+  IN  UINT32  Offset,
+  IN  UINT32  FvSize,
+  OUT UINTN   *MappedSize
+  )
+/*++
+
+Routine Description:
+
+  Map the whole input file copy-on-write, so the FV is parsed in place.
+
+Arguments:
+
+  FileName    - The input file
+  Offset      - Offset of the FV in the file
+  FvSize      - Size of the FV
+  MappedSize  - Returns the size of the mapping, 0 if the file is not mapped
+
+Returns:
+
+  VOID* - The FV in the mapping, NULL if the file cannot be mapped.
+
+--*/
+{
+  VOID            *Base;
+#ifdef _WIN32
+  HANDLE          File;
+  HANDLE          Mapping;
+  LARGE_INTEGER   FileSize;
+
+  *MappedSize = 0;
+  File = CreateFileA (LongFilePath (FileName), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (File == INVALID_HANDLE_VALUE) {
+    return NULL;
+  }
+  if (!GetFileSizeEx (File, &FileSize) || ((UINT64) FileSize.QuadPart < (UINT64) Offset + FvSize) ||
+      ((UINT64) FileSize.QuadPart != (UINTN) FileSize.QuadPart)) {
+    CloseHandle (File);
+    return NULL;
+  }
+  Mapping = CreateFileMapping (File, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+  CloseHandle (File);
+  if (Mapping == NULL) {
+    return NULL;
+  }
+  //
+  // The view keeps the mapping object alive
+  //
+  Base = MapViewOfFile (Mapping, FILE_MAP_COPY, 0, 0, 0);
+  CloseHandle (Mapping);
+  if (Base == NULL) {
+    return NULL;
+  }
+  *MappedSize = (UINTN) FileSize.QuadPart;
+#else
+  int             Fd;
+  struct stat     Stat;
+
+  *MappedSize = 0;
+  Fd = open (LongFilePath (FileName), O_RDONLY);
+  if (Fd < 0) {
+    return NULL;
+  }
+  if ((fstat (Fd, &Stat) != 0) || ((UINT64) Stat.st_size < (UINT64) Offset + FvSize) ||
+      ((UINT64) Stat.st_size != (size_t) Stat.st_size)) {
+    close (Fd);
+    return NULL;
+  }
+  Base = mmap (NULL, (size_t) Stat.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, Fd, 0);
+  close (Fd);
+  if (Base == MAP_FAILED) {
+    return NULL;
+  }
+  *MappedSize = (UINTN) Stat.st_size;
+#endif
+
+  return (UINT8 *) Base + Offset;
+}
+
+STATIC
+VOID
+UnmapInputFile (
+  IN VOID   *Base,
+  IN UINTN  MappedSize
+  )
+{
+#ifdef _WIN32
+  UnmapViewOfFile (Base);
+#else
+  munmap (Base, MappedSize);
+#endif
+}
+
+STATIC
+UINT32
+GetNumberOfProcessors (
+  VOID
+  )
+{
+#ifdef _WIN32
+  SYSTEM_INFO  SystemInfo;
+
+  GetSystemInfo (&SystemInfo);
+  return (UINT32) SystemInfo.dwNumberOfProcessors;
+#else
+  long  NumProcessors;
+
+  NumProcessors = sysconf (_SC_NPROCESSORS_ONLN);
+  return (NumProcessors > 0) ? (UINT32) NumProcessors : 1;
+#endif
+}
+
+STATIC
+void *
+LzmaAlloc (
+  IN void    *Context,
+  IN size_t  Size
+  )
+{
+  return malloc (Size);
+}
+
+STATIC
+void
+LzmaFree (
+  IN void    *Context,
+  IN void    *Address
+  )
+{
+  free (Address);
+}
+
+STATIC ISzAlloc mLzmaAlloc = { LzmaAlloc, LzmaFree };
+
+STATIC
+UINT32
+ReadUnaligned32 (
+  IN CONST UINT8  *Buffer
+  )
+{
+  return Buffer[0] | (Buffer[1] << 8) | (Buffer[2] << 16) | ((UINT32) Buffer[3] << 24);
+}
+
+STATIC
+EFI_STATUS
+LzmaDecodeData (
+  IN  CONST UINT8   *Source,
+  IN  UINT32        SrcSize,
+  IN  BOOLEAN       X86Converter,
+  OUT UINT8         **Destination,
+  OUT UINT32        *DstSize
+  )
+/*++
+
+Routine Description:
+
+  Decode the data of an LZMA GUIDed section, in the format written by
+  LzmaCompress: either one LZMA stream, or a block header, a table of the
+  block lengths and independently encoded blocks.
+
+Arguments:
+
+  Source        - The encoded data
+  SrcSize       - The size of the encoded data
+  X86Converter  - TRUE to undo the x86 branch conversion of LzmaF86Compress
+  Destination   - Returns the allocated decoded data
+  DstSize       - Returns the size of the decoded data
+
+Returns:
+
+  EFI_SUCCESS           - The data is decoded
+  EFI_VOLUME_CORRUPTED  - The encoded data is corrupted
+  EFI_OUT_OF_RESOURCES  - Memory allocation failed
+
+--*/
+{
+  UINT64        OutSize;
+  UINT32        BlockSize;
+  UINT32        NumBlocks;
+  UINT32        Index;
+  UINT32        Offset;
+  UINT32        BlockLength;
+  UINT32        X86State;
+  CONST UINT8   *Block;
+  CONST UINT8   *End;
+  UINT8         *Buffer;
+  SizeT         DestLen;
+  SizeT         SrcLen;
+  ELzmaStatus   LzmaStatus;
+  SRes          Result;
+
+  *Destination = NULL;
+  *DstSize     = 0;
+  if (SrcSize < LZMA_HEADER_SIZE) {
+    return EFI_VOLUME_CORRUPTED;
+  }
+
+  if (ReadUnaligned32 (Source) == LZMA_BLOCK_SIGNATURE) {
+    if (SrcSize < LZMA_BLOCK_HEADER_SIZE) {
+      return EFI_VOLUME_CORRUPTED;
+    }
+    BlockSize = ReadUnaligned32 (Source + 4);
+    OutSize   = ReadUnaligned32 (Source + 8) | ((UINT64) ReadUnaligned32 (Source + 12) << 32);
+    NumBlocks = ReadUnaligned32 (Source + 16);
+    if ((BlockSize == 0) || ((SrcSize - LZMA_BLOCK_HEADER_SIZE) / 4 < NumBlocks) ||
+        (OutSize > 0xFFFFFFFF) || ((OutSize + BlockSize - 1) / BlockSize != NumBlocks)) {
+      return EFI_VOLUME_CORRUPTED;
+    }
+  } else {
+    BlockSize = 0;
+    NumBlocks = 1;
+    OutSize   = ReadUnaligned32 (Source + LZMA_PROPS_SIZE) | ((UINT64) ReadUnaligned32 (Source + LZMA_PROPS_SIZE + 4) << 32);
+    if (OutSize > 0xFFFFFFFF) {
+      return EFI_VOLUME_CORRUPTED;
+    }
+  }
+
+  if (OutSize == 0) {
+    return EFI_SUCCESS;
+  }
+
+  Buffer = malloc ((size_t) OutSize);
+  if (Buffer == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  if (BlockSize == 0) {
+    DestLen = (SizeT) OutSize;
+    SrcLen  = SrcSize - LZMA_HEADER_SIZE;
+    Result  = LzmaDecode (Buffer, &DestLen, Source + LZMA_HEADER_SIZE, &SrcLen, Source, LZMA_PROPS_SIZE, LZMA_FINISH_END, &LzmaStatus, &mLzmaAlloc);
+    if ((Result == SZ_OK) && (DestLen != OutSize)) {
+      Result = SZ_ERROR_DATA;
+    }
+  } else {
+    Result = SZ_OK;
+    Block  = Source + LZMA_BLOCK_HEADER_SIZE + NumBlocks * 4;
+    End    = Source + SrcSize;
+    for (Index = 0, Offset = 0; (Index < NumBlocks) && (Result == SZ_OK); Index++, Offset += (UINT32) DestLen) {
+      BlockLength = ReadUnaligned32 (Source + LZMA_BLOCK_HEADER_SIZE + Index * 4);
+      if ((BlockLength < LZMA_HEADER_SIZE) || (BlockLength > (UINTN) (End - Block))) {
+        Result = SZ_ERROR_DATA;
+        break;
+      }
+      DestLen = (SizeT) OutSize - Offset;
+      if (DestLen > BlockSize) {
+        DestLen = BlockSize;
+      }
+      SrcLen = BlockLength - LZMA_HEADER_SIZE;
+      Result = LzmaDecode (Buffer + Offset, &DestLen, Block + LZMA_HEADER_SIZE, &SrcLen, Block, LZMA_PROPS_SIZE, LZMA_FINISH_END, &LzmaStatus, &mLzmaAlloc);
+      Block += BlockLength;
+    }
+  }
+
+  if (Result != SZ_OK) {
+    free (Buffer);
+    return (Result == SZ_ERROR_MEM) ? EFI_OUT_OF_RESOURCES : EFI_VOLUME_CORRUPTED;
+  }
+
+  if (X86Converter) {
+    x86_Convert_Init (X86State);
+    x86_Convert (Buffer, (SizeT) OutSize, 0, &X86State, 0);
+  }
+
+  *Destination = Buffer;
+  *DstSize     = (UINT32) OutSize;
+  return EFI_SUCCESS;
+}
+
+STATIC
+VOID
+DecodeSection (
+  IN OUT DECODE_JOB  *Job
+  )
+/*++
+
+Routine Description:
+
+  Decode the data of a compression or GUIDed section. Different jobs may be
+  decoded by different threads concurrently.
+
+Arguments:
+
+  Job   - The section to decode, returns the decoded data and the status
+
+Returns: (VOID)
+
+--*/
+{
+  UINT32      ScratchSize;
+  UINT8       *ScratchBuffer;
+
+  Job->Buffer = NULL;
+  Job->Length = 0;
+
+  switch (Job->Method) {
+  case DecodeEfi:
+  case DecodeTiano:
+    if (Job->Method == DecodeEfi) {
+      Job->Status = EfiGetInfo (Job->Data, Job->DataLength, &Job->Length, &ScratchSize);
+    } else {
+      Job->Status = TianoGetInfo (Job->Data, Job->DataLength, &Job->Length, &ScratchSize);
+    }
+    if (EFI_ERROR (Job->Status)) {
+      break;
+    }
+
+    ScratchBuffer = malloc (ScratchSize);
+    Job->Buffer   = malloc (Job->Length);
+    if ((ScratchBuffer == NULL) || ((Job->Buffer == NULL) && (Job->Length != 0))) {
+      Job->Status = EFI_OUT_OF_RESOURCES;
+    } else if (Job->Method == DecodeEfi) {
+      Job->Status = EfiDecompress (Job->Data, Job->DataLength, Job->Buffer, Job->Length, ScratchBuffer, ScratchSize);
+    } else {
+      Job->Status = TianoDecompress (Job->Data, Job->DataLength, Job->Buffer, Job->Length, ScratchBuffer, ScratchSize);
+    }
+    free (ScratchBuffer);
+    break;
+
+  case DecodeLzma:
+  case DecodeLzmaF86:
+    Job->Status = LzmaDecodeData (Job->Data, Job->DataLength, (BOOLEAN) (Job->Method == DecodeLzmaF86), &Job->Buffer, &Job->Length);
+    break;
+  }
+
+  if (EFI_ERROR (Job->Status)) {
+    free (Job->Buffer);
+    Job->Buffer = NULL;
+    Job->Length = 0;
+  }
+}
+
+#ifdef _WIN32
+STATIC
+DWORD
+WINAPI
+DecodeWorker (
+  IN LPVOID  Context
+  )
+#else
+STATIC
+void *
+DecodeWorker (
+  IN void    *Context
+  )
+#endif
+/*++
+
+Routine Description:
+
+  Thread entry point decoding the jobs of the current round until none is left.
+
+Arguments:
+
+  Context     - Not used
+
+Returns:
+
+  0
+
+--*/
+{
+  UINT32  Index;
+
+  for (;;) {
+#ifdef _WIN32
+    Index = (UINT32) InterlockedIncrement ((volatile LONG *) &mNextDecodeJob) - 1;
+#else
+    Index = (UINT32) __sync_fetch_and_add (&mNextDecodeJob, 1);
+#endif
+    if (Index >= mDecodeJobEnd) {
+      break;
+    }
+    DecodeSection (&mDecodeJobs[Index]);
+  }
+  return 0;
+}
+
+STATIC
+BOOLEAN
+StartWorker (
+  OUT WORKER_THREAD   *Thread
+  )
+{
+#ifdef _WIN32
+  *Thread = CreateThread (NULL, 0, DecodeWorker, NULL, 0, NULL);
+  return (BOOLEAN) (*Thread != NULL);
+#else
+  return (BOOLEAN) (pthread_create (Thread, NULL, DecodeWorker, NULL) == 0);
+#endif
+}
+
+STATIC
+VOID
+WaitWorker (
+  IN WORKER_THREAD  Thread
+  )
+{
+#ifdef _WIN32
+  WaitForSingleObject (Thread, INFINITE);
+  CloseHandle (Thread);
+#else
+  pthread_join (Thread, NULL);
+#endif
+}
+
+STATIC
+VOID
+AddDecodeJob (
+  IN UINT8          *Section,
+  IN UINT8          *Data,
+  IN UINT32         DataLength,
+  IN DECODE_METHOD  Method
+  )
+{
+  DECODE_JOB  *NewJobs;
+
+  if (mDecodeJobCount == mDecodeJobMax) {
+    NewJobs = realloc (mDecodeJobs, (mDecodeJobMax + 64) * sizeof (DECODE_JOB));
+    if (NewJobs == NULL) {
+      //
+      // The section is then decoded when it is printed
+      //
+      return;
+    }
+    mDecodeJobs   = NewJobs;
+    mDecodeJobMax += 64;
+  }
+
+  mDecodeJobs[mDecodeJobCount].Section    = Section;
+  mDecodeJobs[mDecodeJobCount].Data       = Data;
+  mDecodeJobs[mDecodeJobCount].DataLength = DataLength;
+  mDecodeJobs[mDecodeJobCount].Method     = Method;
+  mDecodeJobs[mDecodeJobCount].Buffer     = NULL;
+  mDecodeJobs[mDecodeJobCount].Length     = 0;
+  mDecodeJobs[mDecodeJobCount].Status     = EFI_NOT_READY;
+  mDecodeJobCount++;
+}
+
+STATIC
+VOID
+CollectSectionDecodeJobs (
+  IN UINT8   *SectionBuffer,
+  IN UINT32  BufferLength
+  )
+/*++
+
+Routine Description:
+
+  Add a decode job for each compression or GUIDed section found in a
+  sectioned buffer, looking into the sections which need no decoding.
+  Unlike ParseSection () a corrupted section only ends the search.
+
+Arguments:
+
+  SectionBuffer - Buffer containing the sections
+  BufferLength  - Length of SectionBuffer
+
+Returns: (VOID)
+
+--*/
+{
+  UINT8       *Ptr;
+  UINT32      ParsedLength;
+  UINT32      SectionLength;
+  UINT32      SectionHeaderLen;
+  UINT32      RealHdrLen;
+  UINT8       CompressionType;
+  EFI_GUID    *EfiGuid;
+  UINT16      DataOffset;
+  UINTN       FvSize;
+
+  ParsedLength = 0;
+  while ((ParsedLength < BufferLength) && (BufferLength - ParsedLength >= sizeof (EFI_COMMON_SECTION_HEADER2))) {
+    Ptr = SectionBuffer + ParsedLength;
+
+    if ((GetLength (((EFI_COMMON_SECTION_HEADER *) Ptr)->Size) == 0xffffff) &&
+        (((EFI_COMMON_SECTION_HEADER *) Ptr)->Type == 0xff)) {
+      ParsedLength += 4;
+      continue;
+    }
+
+    SectionLength    = GetSectionFileLength ((EFI_COMMON_SECTION_HEADER *) Ptr);
+    SectionHeaderLen = GetSectionHeaderLength ((EFI_COMMON_SECTION_HEADER *) Ptr);
+    if ((SectionLength < SectionHeaderLen) || (SectionLength > BufferLength - ParsedLength)) {
+      return;
+    }
+
+    switch (((EFI_COMMON_SECTION_HEADER *) Ptr)->Type) {
+    case EFI_SECTION_COMPRESSION:
+      if (SectionHeaderLen == sizeof (EFI_COMMON_SECTION_HEADER)) {
+        RealHdrLen      = sizeof (EFI_COMPRESSION_SECTION);
+        CompressionType = ((EFI_COMPRESSION_SECTION *) Ptr)->CompressionType;
+      } else {
+        RealHdrLen      = sizeof (EFI_COMPRESSION_SECTION2);
+        CompressionType = ((EFI_COMPRESSION_SECTION2 *) Ptr)->CompressionType;
+      }
+      if (SectionLength < RealHdrLen) {
+        return;
+      }
+      if (CompressionType == EFI_STANDARD_COMPRESSION) {
+        AddDecodeJob (Ptr, Ptr + RealHdrLen, SectionLength - RealHdrLen, DecodeEfi);
+      } else if (CompressionType == EFI_NOT_COMPRESSED) {
+        CollectSectionDecodeJobs (Ptr + RealHdrLen, SectionLength - RealHdrLen);
+      }
+      break;
+
+    case EFI_SECTION_GUID_DEFINED:
+      if (SectionHeaderLen == sizeof (EFI_COMMON_SECTION_HEADER)) {
+        EfiGuid    = &((EFI_GUID_DEFINED_SECTION *) Ptr)->SectionDefinitionGuid;
+        DataOffset = ((EFI_GUID_DEFINED_SECTION *) Ptr)->DataOffset;
+      } else {
+        EfiGuid    = &((EFI_GUID_DEFINED_SECTION2 *) Ptr)->SectionDefinitionGuid;
+        DataOffset = ((EFI_GUID_DEFINED_SECTION2 *) Ptr)->DataOffset;
+      }
+      if ((DataOffset < SectionHeaderLen) || (DataOffset > SectionLength)) {
+        return;
+      }
+      if (!CompareGuid (EfiGuid, &mLzmaCustomDecompressGuid)) {
+        AddDecodeJob (Ptr, Ptr + DataOffset, SectionLength - DataOffset, DecodeLzma);
+      } else if (!CompareGuid (EfiGuid, &mLzmaF86CustomDecompressGuid)) {
+        AddDecodeJob (Ptr, Ptr + DataOffset, SectionLength - DataOffset, DecodeLzmaF86);
+      } else if (!CompareGuid (EfiGuid, &mTianoCustomDecompressGuid)) {
+        AddDecodeJob (Ptr, Ptr + DataOffset, SectionLength - DataOffset, DecodeTiano);
+      } else if (!CompareGuid (EfiGuid, &gEfiCrc32GuidedSectionExtractionProtocolGuid)) {
+        CollectSectionDecodeJobs (Ptr + DataOffset, SectionLength - DataOffset);
+      }
+      break;
+
+    case EFI_SECTION_FIRMWARE_VOLUME_IMAGE:
+      if ((SectionLength - SectionHeaderLen >= sizeof (EFI_FIRMWARE_VOLUME_HEADER)) &&
+          (((EFI_FIRMWARE_VOLUME_HEADER *) (Ptr + SectionHeaderLen))->Signature == EFI_FVH_SIGNATURE) &&
+          !EFI_ERROR (FvBufGetSize (Ptr + SectionHeaderLen, &FvSize)) &&
+          (FvSize <= SectionLength - SectionHeaderLen)) {
+        CollectFvDecodeJobs (Ptr + SectionHeaderLen);
+      }
+      break;
+
+    default:
+      break;
+    }
+
+    ParsedLength = GetOccupiedSize (ParsedLength + SectionLength, 4);
+  }
+}
+
+STATIC
+VOID
+CollectFvDecodeJobs (
+  IN VOID  *Fv
+  )
+/*++
+
+Routine Description:
+
+  Add a decode job for each compression or GUIDed section of the files of an FV.
+
+Arguments:
+
+  Fv    - The firmware volume
+
+Returns: (VOID)
+
+--*/
+{
+  UINTN                 FvSize;
+  UINTN                 Key;
+  EFI_FFS_FILE_HEADER   *File;
+  UINT32                HeaderSize;
+  UINT32                FileLength;
+
+  if (EFI_ERROR (FvBufGetSize (Fv, &FvSize))) {
+    return;
+  }
+
+  Key = 0;
+  while (!EFI_ERROR (FvBufFindNextFile (Fv, &Key, (VOID **) &File))) {
+    switch (File->Type) {
+    case EFI_FV_FILETYPE_ALL:
+    case EFI_FV_FILETYPE_RAW:
+    case EFI_FV_FILETYPE_FFS_PAD:
+      break;
+
+    default:
+      HeaderSize = FvBufGetFfsHeaderSize (File);
+      FileLength = FvBufGetFfsFileSize (File);
+      if ((FileLength > HeaderSize) && (FileLength <= FvSize - ((UINTN) File - (UINTN) Fv))) {
+        CollectSectionDecodeJobs ((UINT8 *) File + HeaderSize, FileLength - HeaderSize);
+      }
+      break;
+    }
+  }
+}
+
+STATIC
+VOID
+DecodeAllSections (
+  IN VOID  *Fv
+  )
+/*++
+
+Routine Description:
+
+  Decode all the compression and GUIDed sections VolInfo can decode itself.
+  The sections found in an FV are decoded by worker threads, then the
+  sections found in the decoded data, and so on.
+
+Arguments:
+
+  Fv    - The firmware volume
+
+Returns: (VOID)
+
+--*/
+{
+  UINT32          Start;
+  UINT32          Index;
+  UINT32          ThreadCount;
+  UINT32          StartedCount;
+  WORKER_THREAD   Threads[MAX_DECODE_THREADS];
+
+  CollectFvDecodeJobs (Fv);
+
+  for (Start = 0; Start < mDecodeJobCount; Start = mDecodeJobEnd) {
+    mNextDecodeJob = (INT32) Start;
+    mDecodeJobEnd  = mDecodeJobCount;
+
+    ThreadCount = GetNumberOfProcessors ();
+    if (ThreadCount > mDecodeJobEnd - Start) {
+      ThreadCount = mDecodeJobEnd - Start;
+    }
+    if (ThreadCount > MAX_DECODE_THREADS) {
+      ThreadCount = MAX_DECODE_THREADS;
+    }
+
+    //
+    // The main thread is one of the workers
+    //
+    for (StartedCount = 0; StartedCount + 1 < ThreadCount; StartedCount++) {
+      if (!StartWorker (&Threads[StartedCount])) {
+        break;
+      }
+    }
+    DecodeWorker (NULL);
+    for (Index = 0; Index < StartedCount; Index++) {
+      WaitWorker (Threads[Index]);
+    }
+
+    for (Index = Start; Index < mDecodeJobEnd; Index++) {
+      if (!EFI_ERROR (mDecodeJobs[Index].Status)) {
+        CollectSectionDecodeJobs (mDecodeJobs[Index].Buffer, mDecodeJobs[Index].Length);
+      }
+    }
+  }
+}
+
+STATIC
+DECODE_JOB *
+FindDecodeJob (
+  IN UINT8  *Section
+  )
+{
+  UINT32  Index;
+
+  for (Index = 0; Index < mDecodeJobCount; Index++) {
+    if (mDecodeJobs[Index].Section == Section) {
+      return &mDecodeJobs[Index];
+    }
+  }
+  return NULL;
+}
+
+STATIC
+VOID
+FreeDecodeJobs (
+  VOID
+  )
+{
+  UINT32  Index;
+
+  for (Index = 0; Index < mDecodeJobCount; Index++) {
+    free (mDecodeJobs[Index].Buffer);
+  }
+  free (mDecodeJobs);
+  mDecodeJobs     = NULL;
+  mDecodeJobCount = 0;
+  mDecodeJobMax   = 0;
+}
+
+STATIC
+VOID
+JsonWriteChar (
+  IN UINT16  Char
+  )
+{
+  switch (Char) {
+  case '"':
+    fprintf (mJsonFile, "\\\"");
+    break;
+  case '\\':
+    fprintf (mJsonFile, "\\\\");
+    break;
+  default:
+    if ((Char < 0x20) || (Char > 0x7E)) {
+      fprintf (mJsonFile, "\\u%04x", (unsigned) Char);
+    } else {
+      fputc (Char, mJsonFile);
+    }
+    break;
+  }
+}
+
+STATIC
+VOID
+JsonWriteName (
+  IN CHAR8  *Name
+  )
+/*++
+
+Routine Description:
+
+  Start a value of the current JSON object or array.
+
+Arguments:
+
+  Name  - The member name in an object, NULL in an array
+
+Returns: (VOID)
+
+--*/
+{
+  if (mJsonDepth > 0) {
+    if (mJsonHasMember[mJsonDepth - 1]) {
+      fputc (',', mJsonFile);
+    }
+    mJsonHasMember[mJsonDepth - 1] = TRUE;
+  }
+
+  if (Name != NULL) {
+    fprintf (mJsonFile, "\"%s\":", Name);
+  }
+}
+
+STATIC
+VOID
+JsonBegin (
+  IN CHAR8  *Name,
+  IN CHAR8  Open
+  )
+/*++
+
+Routine Description:
+
+  Open a JSON object or array.
+
+Arguments:
+
+  Name  - The member name in an object, NULL in an array
+  Open  - '{' for an object, '[' for an array
+
+Returns: (VOID)
+
+--*/
+{
+  if ((mJsonFile == NULL) || (mJsonDepth == MAX_JSON_DEPTH)) {
+    return;
+  }
+
+  JsonWriteName (Name);
+  fputc (Open, mJsonFile);
+  mJsonClose[mJsonDepth]     = (CHAR8) ((Open == '{') ? '}' : ']');
+  mJsonHasMember[mJsonDepth] = FALSE;
+  mJsonDepth++;
+}
+
+STATIC
+VOID
+JsonEnd (
+  VOID
+  )
+{
+  if ((mJsonFile == NULL) || (mJsonDepth == 0)) {
+    return;
+  }
+
+  mJsonDepth--;
+  fputc (mJsonClose[mJsonDepth], mJsonFile);
+}
+
+STATIC
+VOID
+JsonCloseTo (
+  IN UINT32  Depth
+  )
+/*++
+
+Routine Description:
+
+  Close the JSON objects and arrays left open by a failed parse.
+
+Arguments:
+
+  Depth - The nesting depth to return to
+
+Returns: (VOID)
+
+--*/
+{
+  while (mJsonDepth > Depth) {
+    JsonEnd ();
+  }
+}
+
+STATIC
+VOID
+JsonString (
+  IN CHAR8  *Name,
+  IN CHAR8  *Value
+  )
+{
+  if (mJsonFile == NULL) {
+    return;
+  }
+
+  JsonWriteName (Name);
+  fputc ('"', mJsonFile);
+  while (*Value != '\0') {
+    JsonWriteChar ((UINT8) *Value);
+    Value++;
+  }
+  fputc ('"', mJsonFile);
+}
+
+STATIC
+VOID
+JsonString16 (
+  IN CHAR8  *Name,
+  IN UINT8  *Value,
+  IN UINT32 MaxLength
+  )
+/*++
+
+Routine Description:
+
+  Write a member with the value of a null-terminated UCS-2 string.
+
+Arguments:
+
+  Name      - The member name
+  Value     - The string, not necessarily aligned
+  MaxLength - The size of the buffer of the string, in bytes
+
+Returns: (VOID)
+
+--*/
+{
+  UINT16  Char;
+
+  if (mJsonFile == NULL) {
+    return;
+  }
+
+  JsonWriteName (Name);
+  fputc ('"', mJsonFile);
+  for (; MaxLength >= sizeof (UINT16); MaxLength -= sizeof (UINT16), Value += sizeof (UINT16)) {
+    Char = (UINT16) (Value[0] | (Value[1] << 8));
+    if (Char == 0) {
+      break;
+    }
+    JsonWriteChar (Char);
+  }
+  fputc ('"', mJsonFile);
+}
+
+STATIC
+VOID
+JsonNumber (
+  IN CHAR8   *Name,
+  IN UINT64  Value
+  )
+{
+  if (mJsonFile == NULL) {
+    return;
+  }
+
+  JsonWriteName (Name);
+  fprintf (mJsonFile, "%llu", (unsigned long long) Value);
+}
+
+STATIC
+VOID
+JsonGuid (
+  IN CHAR8     *Name,
+  IN EFI_GUID  *Guid
+  )
+{
+  UINT8   GuidBuffer[PRINTED_GUID_BUFFER_SIZE];
+
+  if (mJsonFile == NULL) {
+    return;
+  }
+
+  PrintGuidToBuffer (Guid, GuidBuffer, sizeof (GuidBuffer), TRUE);
+  JsonString (Name, (CHAR8 *) GuidBuffer);
+}
+
 void
 Usage (
   VOID
@@ -1842,6 +3100,8 @@ Returns:
             Parse basename to file-guid cross reference file(s).\n");
   fprintf (stdout, "  --offset offset\n\
             Offset of file to start processing FV at.\n");
+  fprintf (stdout, "  --json FileName\n\
+            Also write the FV contents in JSON format to FileName.\n");
   fprintf (stdout, "  -h, --help\n\
             Show this help message and exit.\n");
 
@@ -15,8 +15,10 @@
 #
 import Common.LongFilePathOs as os
 import re
+import sys
 import os.path as path
 import copy
+from hashlib import md5
 
 import GenC
 import GenMake
@@ -72,6 +74,43 @@ gAutoGenStringFileName = "%(module_name)sStrDefs.h"
 gAutoGenStringFormFileName = "%(module_name)sStrDefs.hpk"
 gAutoGenDepexFileName = "%(module_name)s.depex"
 
+## File recording what the code and makefile generated for a module depend on
+gAutoGenCacheFileName = "AutoGenCache.txt"
+
+## Time stamp and MD5 digest of the files checked by the AutoGen cache, by path
+gFileTimeCache = {}
+gFileDigestCache = {}
+
+## Return the time stamp of a file
+#
+#   @param      File        The path of the file
+#
+#   @retval     string      The time stamp, or None if the file doesn't exist
+#
+def GetFileTime(File):
+    if File not in gFileTimeCache:
+        Time = None
+        if os.path.isfile(File):
+            Time = repr(os.stat(File).st_mtime)
+        gFileTimeCache[File] = Time
+    return gFileTimeCache[File]
+
+## Return the MD5 digest of the content of a file
+#
+#   @param      File        The path of the file
+#
+#   @retval     string      The digest, or None if the file doesn't exist
+#
+def GetFileDigest(File):
+    if File not in gFileDigestCache:
+        Digest = None
+        if os.path.isfile(File):
+            FileObj = open(File, 'rb')
+            Digest = md5(FileObj.read()).hexdigest()
+            FileObj.close()
+        gFileDigestCache[File] = Digest
+    return gFileDigestCache[File]
+
 gInfSpecVersion = "0x00010017"
 
 #
@@ -408,6 +447,7 @@ class WorkspaceAutoGen(AutoGen):
         self._FvDir = None
         self._MakeFileDir = None
         self._BuildCommand = None
+        self._AutoGenCacheKey = None
 
         return True
 
@@ -711,6 +751,60 @@ class WorkspaceAutoGen(AutoGen):
     def _GenFdsCommand(self):
         return (GenMake.TopLevelMakefile(self)._TEMPLATE_.Replace(GenMake.TopLevelMakefile(self)._TemplateDict)).strip()
 
+    ## Return the digest of the build settings and platform files the AutoGen of all modules depends on
+    #
+    #   The digest covers the build options, target.txt and tools_def.txt settings,
+    #   the content of the DSC and FDF files and the files they include, the DEC files
+    #   of all packages, build_rule.txt, and the version of the build tools: the
+    #   executable, or all Python sources of BaseTools, since the code generated
+    #   for the modules doesn't only depend on the AutoGen package.
+    #
+    #   @retval     string  The digest
+    #
+    def _GetAutoGenCacheKey(self):
+        if self._AutoGenCacheKey == None:
+            Md5 = md5()
+            if hasattr(sys, "frozen"):
+                Md5.update(str(os.stat(os.path.abspath(sys.executable)).st_mtime))
+            else:
+                ToolDir = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+                for Root, Dirs, Files in os.walk(ToolDir):
+                    Dirs.sort()
+                    for Dir in Dirs[:]:
+                        if Dir.lower() in ['.svn', '_svn', 'cvs', '.git']:
+                            Dirs.remove(Dir)
+                    for File in sorted(Files):
+                        if File.endswith('.py'):
+                            FileStat = os.stat(os.path.join(Root, File))
+                            Md5.update('%s %s %s\n' % (os.path.join(Root[len(ToolDir):], File),
+                                                        FileStat.st_mtime, FileStat.st_size))
+
+            Defines = GlobalData.gGlobalDefines.copy()
+            Defines.pop('ARCH', None)
+            for Item in [self.BuildTarget, self.ToolChain, self.ArchList, self.SkuId, self.UniFlag,
+                         GlobalData.gCaseInsensitive, GlobalData.gIgnoreSource,
+                         sorted(Defines.items()), sorted(GlobalData.gCommandLineDefines.items()),
+                         sorted(self.TargetTxt.TargetTxtDictionary.items()),
+                         sorted(self.ToolDef.ToolsDefTxtDictionary.items())]:
+                Md5.update(repr(Item) + '\n')
+
+            FileList = [self.MetaFile.Path] + sorted(self.Platform._RawData.IncludedFiles)
+            if self.FdfFile:
+                FileList += [str(self.FdfFile)] + [Profile.FileName for Profile in IncludeFileList]
+            BuildRuleFile = self.TargetTxt.TargetTxtDictionary.get(TAB_TAT_DEFINES_BUILD_RULE_CONF)
+            if BuildRuleFile in [None, '']:
+                BuildRuleFile = gDefaultBuildRuleFile
+            FileList.append(BuildRuleFile)
+            PackageFileList = set()
+            for Pa in self.AutoGenObjectList:
+                for Package in Pa.PackageList:
+                    PackageFileList.add(Package.MetaFile.Path)
+            FileList += sorted(PackageFileList)
+            for File in FileList:
+                Md5.update('%s %s\n' % (File, GetFileDigest(File)))
+            self._AutoGenCacheKey = Md5.hexdigest()
+        return self._AutoGenCacheKey
+
     ## Create makefile for the platform and modules in it
     #
     #   @param      CreateDepsMakeFile      Flag indicating if the makefile for
@@ -752,6 +846,7 @@ class WorkspaceAutoGen(AutoGen):
     MakeFileDir         = property(_GetMakeFileDir)
     BuildCommand        = property(_GetBuildCommand)
     GenFdsCommand       = property(_GenFdsCommand)
+    AutoGenCacheKey     = property(_GetAutoGenCacheKey)
 
 ## AutoGen class for platform
 #
@@ -2143,6 +2238,10 @@ class PlatformAutoGen(AutoGen):
 # to the [depex] section in module's inf file.
 #
 class ModuleAutoGen(AutoGen):
+    ## Number of modules whose code and makefile generation was skipped, or done, with the AutoGen cache
+    AutoGenCacheHitCount = 0
+    AutoGenCacheMissCount = 0
+
     ## The real constructor of ModuleAutoGen
     #
     #  This method is not supposed to be called by users of ModuleAutoGen. It's
@@ -2190,6 +2289,9 @@ class ModuleAutoGen(AutoGen):
         self.IsCodeFileCreated = False
         self.IsAsBuiltInfCreated = False
         self.DepexGenerated = False
+        self._CanSkipAutoGen = None
+        self._AutoGenCacheKey = None
+        self._DependencyFileList = []
 
         self.BuildDatabase = self.Workspace.BuildDatabase
 
@@ -3400,6 +3502,10 @@ class ModuleAutoGen(AutoGen):
             for LibraryAutoGen in self.LibraryAutoGenList:
                 LibraryAutoGen.CreateMakeFile()
 
+        if self.CanSkipAutoGen():
+            self.IsMakeFileCreated = True
+            return
+
         if len(self.CustomMakefile) == 0:
             Makefile = GenMake.ModuleMakefile(self)
         else:
@@ -3410,8 +3516,11 @@ class ModuleAutoGen(AutoGen):
         else:
             EdkLogger.debug(EdkLogger.DEBUG_9, "Skipped the generation of makefile for module %s [%s]" %
                             (self.Name, self.Arch))
+        if len(self.CustomMakefile) == 0:
+            self._DependencyFileList = Makefile.DependencyFileList
 
         self.IsMakeFileCreated = True
+        self._SaveAutoGenCache()
 
     def CopyBinaryFiles(self):
         for File in self.Module.Binaries:
@@ -3436,6 +3545,10 @@ class ModuleAutoGen(AutoGen):
                 self.CopyBinaryFiles()
             return
 
+        if self.CanSkipAutoGen():
+            self.IsCodeFileCreated = True
+            return
+
         if not self.IsLibrary and CreateLibraryCodeFile:
             for LibraryAutoGen in self.LibraryAutoGenList:
                 LibraryAutoGen.CreateCodeFile()
@@ -3484,8 +3597,142 @@ class ModuleAutoGen(AutoGen):
                             (" ".join(AutoGenList), " ".join(IgoredAutoGenList), self.Name, self.Arch))
 
         self.IsCodeFileCreated = True
+        self._SaveAutoGenCache()
         return AutoGenList
 
+    ## Take over the result of the code and makefile generated for the module by another process
+    #
+    #   @param      CodeFileCreated     If the code files were generated
+    #   @param      MakeFileCreated     If the makefile was generated
+    #   @param      DepexGenerated      If a depex file was generated
+    #   @param      CanSkipAutoGen      If the generation was skipped by the AutoGen cache
+    #
+    def UpdateAutoGenResult(self, CodeFileCreated, MakeFileCreated, DepexGenerated, CanSkipAutoGen):
+        self.IsCodeFileCreated = self.IsCodeFileCreated or CodeFileCreated
+        self.IsMakeFileCreated = self.IsMakeFileCreated or MakeFileCreated
+        self.DepexGenerated = DepexGenerated
+        if self._CanSkipAutoGen == None:
+            self._CanSkipAutoGen = CanSkipAutoGen
+            if CanSkipAutoGen:
+                ModuleAutoGen.AutoGenCacheHitCount += 1
+            elif GlobalData.gUseAutoGenCache:
+                ModuleAutoGen.AutoGenCacheMissCount += 1
+
+    ## Check if the code and makefile generated for the module last time are still valid
+    #
+    #   They are if the key of the module recorded in its AutoGen cache file is
+    #   unchanged, each file recorded there
+    #   has the same time stamp or content, the generated files still exist, and the
+    #   same holds for all libraries of the module. PCD drivers are never skipped,
+    #   since their PCD database depends on all modules of the platform.
+    #
+    #   @retval     True    The code and makefile don't need to be generated again
+    #   @retval     False   The code and makefile have to be generated
+    #
+    def CanSkipAutoGen(self):
+        if self._CanSkipAutoGen == None:
+            self._CanSkipAutoGen = self._CheckAutoGenCache()
+            if self._CanSkipAutoGen:
+                ModuleAutoGen.AutoGenCacheHitCount += 1
+            elif GlobalData.gUseAutoGenCache:
+                ModuleAutoGen.AutoGenCacheMissCount += 1
+        return self._CanSkipAutoGen
+
+    ## Return the digest the AutoGen cache file of the module is keyed with
+    #
+    #   Besides the digest of the build settings and platform files, it covers the
+    #   token numbers of the PCDs the module and its libraries use. They are assigned
+    #   across all modules, so adding a PCD to one INF can renumber the PCDs of the
+    #   others; the token numbers of the other PCDs don't appear in the code of the
+    #   module.
+    #
+    #   @retval     string  The digest
+    #
+    def _GetAutoGenCacheKey(self):
+        if self._AutoGenCacheKey == None:
+            TokenNumber = self.PlatformInfo.PcdTokenNumber
+            Md5 = md5()
+            Md5.update(self.Workspace.AutoGenCacheKey + '\n')
+            ModuleTokenNumber = set()
+            for Pcd in self.ModulePcdList + self.LibraryPcdList:
+                Key = (Pcd.TokenCName, Pcd.TokenSpaceGuidCName)
+                if Key in TokenNumber:
+                    ModuleTokenNumber.add((Key, TokenNumber[Key]))
+            Md5.update(repr(sorted(ModuleTokenNumber)) + '\n')
+            self._AutoGenCacheKey = Md5.hexdigest()
+        return self._AutoGenCacheKey
+
+    def _CheckAutoGenCache(self):
+        if not GlobalData.gUseAutoGenCache or self.IsBinaryModule or self.PcdIsDriver != '':
+            return False
+        CacheFile = path.join(self.BuildDir, gAutoGenCacheFileName)
+        if not os.path.isfile(CacheFile):
+            return False
+        FileObj = open(CacheFile, 'r')
+        Lines = FileObj.read().splitlines()
+        FileObj.close()
+        if not Lines or Lines[0] != 'KEY ' + self.AutoGenCacheKey:
+            return False
+
+        DepexGenerated = False
+        for Line in Lines[1:]:
+            Fields = Line.split(' ', 3)
+            if Fields[0] == 'FILE' and len(Fields) == 4:
+                Time = GetFileTime(Fields[3])
+                if Time == None:
+                    return False
+                if Time != Fields[1] and GetFileDigest(Fields[3]) != Fields[2]:
+                    return False
+            elif Fields[0] == 'OUTPUT' and len(Fields) > 1:
+                if not os.path.exists(Line[len('OUTPUT '):]):
+                    return False
+            elif Fields[0] == 'DEPEX' and len(Fields) == 2:
+                DepexGenerated = (Fields[1] == '1')
+            else:
+                return False
+
+        if not self.IsLibrary:
+            for LibraryAutoGen in self.LibraryAutoGenList:
+                if not LibraryAutoGen.CanSkipAutoGen():
+                    return False
+        self.DepexGenerated = DepexGenerated
+        return True
+
+    ## Save the files the code and makefile of the module were generated from
+    #
+    #   The module's INF and source files, the INF files of its libraries, and the
+    #   files its sources include are recorded with their time stamp and digest,
+    #   besides the generated files. Files in the build directory of the module are
+    #   generated files, so their existence only is checked.
+    #
+    def _SaveAutoGenCache(self):
+        if not self.IsCodeFileCreated or not self.IsMakeFileCreated:
+            return
+        if not GlobalData.gUseAutoGenCache or self.IsBinaryModule or self.PcdIsDriver != '':
+            return
+
+        FileSet = set([self.MetaFile.Path])
+        FileSet.update([File.Path for File in self.Module.Sources])
+        FileSet.update(self._DependencyFileList)
+        if not self.IsLibrary:
+            FileSet.update([LibraryAutoGen.MetaFile.Path for LibraryAutoGen in self.LibraryAutoGenList])
+        OutputList = [path.join(self.MakeFileDir, GenMake.BuildFile._FILE_NAME_[GenMake.gMakeType])]
+        OutputList += [File.Path for File in self.AutoGenFileList]
+
+        BuildDir = path.join(self.BuildDir, '')
+        Lines = ['KEY ' + self.AutoGenCacheKey]
+        for File in sorted(FileSet):
+            if File.startswith(BuildDir):
+                OutputList.append(File)
+                continue
+            Time = GetFileTime(File)
+            if Time != None:
+                Lines.append('FILE %s %s %s' % (Time, GetFileDigest(File), File))
+        for File in sorted(set(OutputList)):
+            Lines.append('OUTPUT ' + File)
+        Lines.append('DEPEX %d' % self.DepexGenerated)
+        SaveFileOnChange(path.join(self.BuildDir, gAutoGenCacheFileName), '\n'.join(Lines) + '\n', False)
+
     ## Summarize the ModuleAutoGen objects of all libraries used by this module
     def _GetLibraryAutoGenList(self):
         if self._LibraryAutoGenList == None:
@@ -3519,6 +3766,7 @@ class ModuleAutoGen(AutoGen):
 
     IsLibrary       = property(_IsLibrary)
     IsBinaryModule  = property(_IsBinaryModule)
+    AutoGenCacheKey = property(_GetAutoGenCacheKey)
     BuildDir        = property(_GetBuildDir)
     OutputDir       = property(_GetOutputDir)
     DebugDir        = property(_GetDebugDir)
@@ -427,6 +427,7 @@ cleanlib:
 
         self.FileCache = {}
         self.FileDependency = []
+        self.DependencyFileList = []        # [path of all files the sources depend on]
         self.LibraryBuildCommandList = []
         self.LibraryFileList = []
         self.LibraryMakefileList = []
@@ -626,6 +627,11 @@ cleanlib:
                                     ForceIncludedFile,
                                     self._AutoGenObject.IncludePathList + self._AutoGenObject.BuildOptionIncPathList
                                     )
+        DependencyFileSet = set()
+        for File in self.FileDependency:
+            DependencyFileSet.update([Dep.Path for Dep in self.FileDependency[File]])
+        self.DependencyFileList = sorted(DependencyFileSet)
+
         DepSet = None
         for File in self.FileDependency:
             if not self.FileDependency[File]:
@@ -1270,6 +1276,12 @@ class TopLevelMakefile(BuildFile):
         if GlobalData.gIgnoreSource:
             ExtraOption += " --ignore-sources"
 
+        if GlobalData.gThreadNumber:
+            ExtraOption += " -n %d" % GlobalData.gThreadNumber
+
+        if GlobalData.gFfsCacheDir:
+            ExtraOption += " --ffs-cache %s" % GlobalData.gFfsCacheDir
+
         MakefileName = self._FILE_NAME_[self._FileType]
         SubBuildCommandList = []
         for A in PlatformInfo.ArchList:
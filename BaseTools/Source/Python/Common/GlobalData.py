@@ -65,6 +65,26 @@ gDatabasePath = ".cache/build.db"
 #
 gIgnoreSource = False
 
+#
+# Thread number given by -n or target.txt, 0 if not specified
+#
+gThreadNumber = 0
+
+#
+# Skip the AutoGen of modules whose AutoGen cache file is still valid
+#
+gUseAutoGenCache = False
+
+#
+# Cache of the files built for the modules, None if not used
+#
+gBuildCache = None
+
+#
+# Directory of the FFS cache of GenFv, None if not used
+#
+gFfsCacheDir = None
+
 #
 # FDF parser
 #
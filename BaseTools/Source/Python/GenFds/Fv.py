@@ -133,6 +133,8 @@ class FV (FvClassObject):
         OrigFvInfo = None
         if os.path.exists (FvInfoFileName):
             OrigFvInfo = open(FvInfoFileName, 'r').read()
+        # the large file flag is final once all sections of the FV are generated
+        GenFdsGlobalVariable.WaitForTools()
         if GenFdsGlobalVariable.LargeFileInFvFlags[-1]:
             FFSGuid = GenFdsGlobalVariable.EFI_FIRMWARE_FILE_SYSTEM3_GUID;
         GenFdsGlobalVariable.GenerateFirmwareVolume(
@@ -165,6 +167,7 @@ class FV (FvClassObject):
                 for FfsFile in self.FfsList :
                     FileName = FfsFile.GenFfs(MacroDict, FvChildAddr, BaseAddress)
                 
+                GenFdsGlobalVariable.WaitForTools()
                 if GenFdsGlobalVariable.LargeFileInFvFlags[-1]:
                     FFSGuid = GenFdsGlobalVariable.EFI_FIRMWARE_FILE_SYSTEM3_GUID;
                 #Update GenFv again
@@ -19,9 +19,11 @@ from optparse import OptionParser
 import sys
 import Common.LongFilePathOs as os
 import linecache
+import multiprocessing
 import FdfParser
 import Common.BuildToolError as BuildToolError
 from GenFdsGlobalVariable import GenFdsGlobalVariable
+from ToolScheduler import ToolScheduler
 from Workspace.WorkspaceDatabase import WorkspaceDatabase
 from Workspace.BuildClassObject import PcdClassObject
 from Workspace.BuildClassObject import ModuleBuildClassObject
@@ -36,6 +38,7 @@ from Common import EdkLogger
 from Common.String import *
 from Common.Misc import DirCache,PathClass
 from Common.Misc import SaveFileOnChange
+from Common.Misc import CreateDirectory
 from Common.Misc import ClearDuplicatedInf
 from Common.Misc import GuidStructureStringToGuidString
 from Common.BuildVersion import gBUILD_VERSION
@@ -170,6 +173,18 @@ def main():
         #Set global flag for build mode
         GlobalData.gIgnoreSource = Options.IgnoreSources
 
+        ThreadNumber = Options.ThreadNumber
+        if ThreadNumber == None:
+            try:
+                ThreadNumber = multiprocessing.cpu_count()
+            except NotImplementedError:
+                ThreadNumber = 1
+        GenFdsGlobalVariable.Scheduler = ToolScheduler(ThreadNumber)
+
+        if Options.FfsCacheDir:
+            GenFdsGlobalVariable.FfsCacheDir = os.path.abspath(Options.FfsCacheDir)
+            CreateDirectory(GenFdsGlobalVariable.FfsCacheDir)
+
         if Options.Macros:
             for Pair in Options.Macros:
                 if Pair.startswith('"'):
@@ -274,6 +289,8 @@ def main():
             GenFds.PreprocessImage(BuildWorkSpace, GenFdsGlobalVariable.ActivePlatform)
         """Call GenFds"""
         GenFds.GenFd('', FdfParserObj, BuildWorkSpace, ArchList)
+        GenFdsGlobalVariable.WaitForTools()
+        GenFdsGlobalVariable.Scheduler.ReportTiming()
 
         """Generate GUID cross reference file"""
         GenFds.GenerateGuidXRefFile(BuildWorkSpace, ArchList)
@@ -344,6 +361,10 @@ def myOptionParser():
     Parser.add_option("-s", "--specifyaddress", dest="FixedAddress", action="store_true", type=None, help="Specify driver load address.")
     Parser.add_option("--conf", action="store", type="string", dest="ConfDirectory", help="Specify the customized Conf directory.")
     Parser.add_option("--ignore-sources", action="store_true", dest="IgnoreSources", default=False, help="Focus to a binary build and ignore all source files")
+    Parser.add_option("-n", action="callback", type="int", dest="ThreadNumber", callback=SingleCheckCallback,
+                      help="Run the tools generating sections and FFS files in parallel using the given number of threads. Default is the number of processors, less than 2 runs them one by one.")
+    Parser.add_option("--ffs-cache", action="store", type="string", dest="FfsCacheDir",
+                      help="Keep the FFS files rebased by GenFv and the layout of the FV files in the given directory, so that the unchanged ones are not rebased and written again.")
 
     (Options, args) = Parser.parse_args()
     return Options
@@ -20,6 +20,7 @@ import sys
 import subprocess
 import struct
 import array
+import time
 
 from Common.BuildToolError import *
 from Common import EdkLogger
@@ -71,8 +72,8 @@ class GenFdsGlobalVariable:
     #
     # The list whose element are flags to indicate if large FFS or SECTION files exist in FV.
     # At the beginning of each generation of FV, false flag is appended to the list,
-    # after the call to GenerateSection returns, check the size of the output file,
-    # if it is greater than 0xFFFFFF, the tail flag in list is set to true,
+    # once the output file of GenerateSection is generated, check its size,
+    # if it is greater than 0xFFFFFF, the flag of the FV in list is set to true,
     # and EFI_FIRMWARE_FILE_SYSTEM3_GUID is passed to C GenFv.
     # At the end of generation of FV, pop the flag.
     # List is used as a stack to handle nested FV generation.
@@ -82,6 +83,17 @@ class GenFdsGlobalVariable:
     LARGE_FILE_SIZE = 0x1000000
 
     SectionHeader = struct.Struct("3B 1B")
+
+    #
+    # ToolScheduler object running GenSec, GenFfs and GenFw in parallel, set by GenFds.
+    # The other tools, whose output is read back by GenFds, wait for them and run at once.
+    #
+    Scheduler = None
+
+    #
+    # Directory GenFv keeps the rebased FFS files and the FV layouts in, given by --ffs-cache
+    #
+    FfsCacheDir = None
     
     ## LoadBuildRule
     #
@@ -346,6 +358,13 @@ class GenFdsGlobalVariable:
         if Input == None or len(Input) == 0:
             return True
 
+        # always update "Output" if it or any "Input" is still to be generated by a queued tool
+        Scheduler = GenFdsGlobalVariable.Scheduler
+        if Scheduler != None:
+            for F in [Output] + list(Input):
+                if Scheduler.IsPending(F):
+                    return True
+
         # if fdf file is changed after the 'Output" is generated, update the 'Output'
         OutputTime = os.path.getmtime(Output)
         if GenFdsGlobalVariable.FdfFileTimeStamp > OutputTime:
@@ -401,19 +420,37 @@ class GenFdsGlobalVariable:
             if not GenFdsGlobalVariable.NeedsUpdate(Output, list(Input) + [CommandFile]):
                 return
 
-            GenFdsGlobalVariable.CallExternalTool(Cmd, "Failed to generate section")
+            GenFdsGlobalVariable.CallExternalTool(Cmd, "Failed to generate section", Output=Output, Input=Input, Hash=True)
         else:
             Cmd += ["-o", Output]
             Cmd += Input
 
+            #
+            # The size of the section is checked once it is generated, which may be later
+            # when GenSec is queued. The FV waits for all queued tools before using the flag.
+            #
+            CheckLargeFile = None
+            if GenFdsGlobalVariable.LargeFileInFvFlags:
+                CheckLargeFile = lambda Index=len(GenFdsGlobalVariable.LargeFileInFvFlags) - 1: \
+                                     GenFdsGlobalVariable.CheckLargeFile(Output, Index)
+
             SaveFileOnChange(CommandFile, ' '.join(Cmd), False)
             if GenFdsGlobalVariable.NeedsUpdate(Output, list(Input) + [CommandFile]):
                 GenFdsGlobalVariable.DebugLogger(EdkLogger.DEBUG_5, "%s needs update because of newer %s" % (Output, Input))
-                GenFdsGlobalVariable.CallExternalTool(Cmd, "Failed to generate section")
+                GenFdsGlobalVariable.CallExternalTool(Cmd, "Failed to generate section", Output=Output, Input=Input,
+                                                      OnDone=CheckLargeFile, Hash=True)
+            elif CheckLargeFile != None:
+                CheckLargeFile()
 
-            if (os.path.getsize(Output) >= GenFdsGlobalVariable.LARGE_FILE_SIZE and
-                GenFdsGlobalVariable.LargeFileInFvFlags):
-                GenFdsGlobalVariable.LargeFileInFvFlags[-1] = True 
+    ## Set the large file flag of an FV if a section is not smaller than LARGE_FILE_SIZE
+    #
+    #   @param  Output          Path of the section file
+    #   @param  Index           Index of the flag in LargeFileInFvFlags
+    #
+    @staticmethod
+    def CheckLargeFile(Output, Index):
+        if os.path.getsize(Output) >= GenFdsGlobalVariable.LARGE_FILE_SIZE:
+            GenFdsGlobalVariable.LargeFileInFvFlags[Index] = True
 
     @staticmethod
     def GetAlignment (AlignString):
@@ -447,11 +484,12 @@ class GenFdsGlobalVariable:
             return
         GenFdsGlobalVariable.DebugLogger(EdkLogger.DEBUG_5, "%s needs update because of newer %s" % (Output, Input))
 
-        GenFdsGlobalVariable.CallExternalTool(Cmd, "Failed to generate FFS")
+        GenFdsGlobalVariable.CallExternalTool(Cmd, "Failed to generate FFS", Output=Output, Input=Input, Hash=True)
 
     @staticmethod
     def GenerateFirmwareVolume(Output, Input, BaseAddress=None, ForceRebase=None, Capsule=False, Dump=False,
                                AddressFile=None, MapFile=None, FfsList=[], FileSystemGuid=None):
+        GenFdsGlobalVariable.WaitForTools()
         if not GenFdsGlobalVariable.NeedsUpdate(Output, Input+FfsList):
             return
         GenFdsGlobalVariable.DebugLogger(EdkLogger.DEBUG_5, "%s needs update because of newer %s" % (Output, Input))
@@ -475,6 +513,8 @@ class GenFdsGlobalVariable:
             Cmd += ["-m", MapFile]
         if FileSystemGuid:
             Cmd += ["-g", FileSystemGuid]
+        if GenFdsGlobalVariable.FfsCacheDir:
+            Cmd += ["--ffs-cache", GenFdsGlobalVariable.FfsCacheDir]
         Cmd += ["-o", Output]
         for I in Input:
             Cmd += ["-i", I]
@@ -483,6 +523,7 @@ class GenFdsGlobalVariable:
 
     @staticmethod
     def GenerateVtf(Output, Input, BaseAddress=None, FvSize=None):
+        GenFdsGlobalVariable.WaitForTools()
         if not GenFdsGlobalVariable.NeedsUpdate(Output, Input):
             return
         GenFdsGlobalVariable.DebugLogger(EdkLogger.DEBUG_5, "%s needs update because of newer %s" % (Output, Input))
@@ -530,7 +571,7 @@ class GenFdsGlobalVariable:
         Cmd += ["-o", Output]
         Cmd += Input
 
-        GenFdsGlobalVariable.CallExternalTool(Cmd, "Failed to generate firmware image")
+        GenFdsGlobalVariable.CallExternalTool(Cmd, "Failed to generate firmware image", Output=Output, Input=Input)
 
     @staticmethod
     def GenerateOptionRom(Output, EfiInput, BinaryInput, Compress=False, ClassCode=None,
@@ -555,6 +596,7 @@ class GenFdsGlobalVariable:
                 InputList.append (BinFile)
 
         # Check List
+        GenFdsGlobalVariable.WaitForTools()
         if not GenFdsGlobalVariable.NeedsUpdate(Output, InputList):
             return
         GenFdsGlobalVariable.DebugLogger(EdkLogger.DEBUG_5, "%s needs update because of newer %s" % (Output, InputList))
@@ -573,6 +615,7 @@ class GenFdsGlobalVariable:
 
     @staticmethod
     def GuidTool(Output, Input, ToolPath, Options='', returnValue=[]):
+        GenFdsGlobalVariable.WaitForTools()
         if not GenFdsGlobalVariable.NeedsUpdate(Output, Input):
             return
         GenFdsGlobalVariable.DebugLogger(EdkLogger.DEBUG_5, "%s needs update because of newer %s" % (Output, Input))
@@ -584,7 +627,18 @@ class GenFdsGlobalVariable:
 
         GenFdsGlobalVariable.CallExternalTool(Cmd, "Failed to call " + ToolPath, returnValue)
 
-    def CallExternalTool (cmd, errorMess, returnValue=[]):
+    ## Call an external tool
+    #
+    #   @param  cmd             The command line list
+    #   @param  errorMess       Message reported if the tool fails
+    #   @param  returnValue     Receives the return value of the tool instead of reporting a failure
+    #   @param  Output          The file generated by the tool; if given the tool is queued to the
+    #                           Scheduler, else all queued tools are waited for and the tool runs at once
+    #   @param  Input           The files read by the tool
+    #   @param  OnDone          Called once the tool succeeded
+    #   @param  Hash            Skip the queued tool if Output was generated from the same input content
+    #
+    def CallExternalTool (cmd, errorMess, returnValue=[], Output=None, Input=[], OnDone=None, Hash=False):
 
         if type(cmd) not in (tuple, list):
             GenFdsGlobalVariable.ErrorLogger("ToolError!  Invalid parameter type in call to CallExternalTool")
@@ -603,6 +657,14 @@ class GenFdsGlobalVariable:
             if GenFdsGlobalVariable.SharpCounter % GenFdsGlobalVariable.SharpNumberPerLine == 0:
                 sys.stdout.write('\n')
 
+        Scheduler = GenFdsGlobalVariable.Scheduler
+        if Scheduler != None:
+            if Output != None:
+                Scheduler.Add(cmd, errorMess, Output, Input, OnDone, Hash)
+                return
+            Scheduler.Wait()
+
+        StartTime = time.time()
         try:
             PopenObject = subprocess.Popen(' '.join(cmd), stdout=subprocess.PIPE, stderr= subprocess.PIPE, shell=True)
         except Exception, X:
@@ -611,6 +673,8 @@ class GenFdsGlobalVariable:
 
         while PopenObject.returncode == None :
             PopenObject.wait()
+        if Scheduler != None:
+            Scheduler.AddTime(cmd, time.time() - StartTime)
         if returnValue != [] and returnValue[0] != 0:
             #get command return value
             returnValue[0] = PopenObject.returncode
@@ -622,6 +686,16 @@ class GenFdsGlobalVariable:
             if PopenObject.returncode != 0:
                 print "###", cmd
                 EdkLogger.error("GenFds", COMMAND_FAILURE, errorMess)
+        if OnDone != None:
+            OnDone()
+
+    ## Wait for the tools queued to the Scheduler
+    #
+    #   @param  Files           Wait only for the tools generating these files, None for all tools
+    #
+    def WaitForTools (Files=None):
+        if GenFdsGlobalVariable.Scheduler != None:
+            GenFdsGlobalVariable.Scheduler.Wait(Files)
 
     def VerboseLogger (msg):
         EdkLogger.verbose(msg)
@@ -719,6 +793,7 @@ class GenFdsGlobalVariable:
     SetDir = staticmethod(SetDir)
     ReplaceWorkspaceMacro = staticmethod(ReplaceWorkspaceMacro)
     CallExternalTool = staticmethod(CallExternalTool)
+    WaitForTools = staticmethod(WaitForTools)
     VerboseLogger = staticmethod(VerboseLogger)
     InfLogger = staticmethod(InfLogger)
     ErrorLogger = staticmethod(ErrorLogger)
@@ -159,6 +159,7 @@ class GuidSection(GuidSectionClassObject) :
                        SecNum     + \
                        '.tmp'
             TempFile = os.path.normpath(TempFile)
+            GenFdsGlobalVariable.WaitForTools([DummyFile])
             #
             # Remove temp file if its time stamp is older than dummy file
             # Just in case the external tool fails at this time but succeeded before
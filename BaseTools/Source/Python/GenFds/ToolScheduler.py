@@ -0,0 +1,307 @@
+## @file
+# Run the external tools called by GenFds concurrently
+#
+#  Copyright (c) 2015, Intel Corporation. All rights reserved.<BR>
+#
+#  This program and the accompanying materials
+#  are licensed and made available under the terms and conditions of the BSD License
+#  which accompanies this distribution.  The full text of the license may be found at
+#  http://opensource.org/licenses/bsd-license.php
+#
+#  THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+#  WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+#
+
+##
+# Import Modules
+#
+import Common.LongFilePathOs as os
+import subprocess
+import threading
+import hashlib
+import time
+import traceback
+from collections import deque
+
+from Common.BuildToolError import *
+from Common import EdkLogger
+from Common.LongFilePathSupport import OpenLongFilePath as open
+
+## One call of an external tool
+#
+# A job becomes ready when all the jobs generating its input files, or
+# generating or reading its output file, have finished.
+#
+class ToolJob:
+    def __init__(self, Cmd, ErrorMessage, Output, Input, OnDone=None, Hash=False):
+        self.Cmd = Cmd
+        self.ErrorMessage = ErrorMessage
+        self.Output = Output
+        self.Input = Input
+        self.OnDone = OnDone
+        self.Hash = Hash
+        self.WaitCount = 0
+        self.Dependents = []
+        self.Finished = False
+        self.ReturnCode = 0
+        self.Out = ''
+        self.Error = ''
+
+    ## Digest of the command line and the content of all input files
+    #
+    #   @retval string      The digest, or None if any input file is missing
+    #
+    def Digest(self):
+        Md5 = hashlib.md5()
+        Md5.update(' '.join(self.Cmd))
+        for File in self.Input:
+            if not os.path.isfile(File):
+                return None
+            Md5.update('\0' + File + '\0')
+            FileObj = open(File, 'rb')
+            Md5.update(FileObj.read())
+            FileObj.close()
+        return Md5.hexdigest()
+
+## Dependency-aware scheduler of external tool calls
+#
+# GenFds generates the commands in the same order as before; a command whose
+# result is not read back by GenFds is queued here instead of being run at
+# once. The worker threads run the queued commands as soon as the files they
+# depend on are generated. Anything reading a generated file has to call Wait()
+# on it first.
+#
+class ToolScheduler:
+    ## Constructor
+    #
+    #   @param  ThreadNumber    The number of worker threads, 1 runs each command at once
+    #                           in the calling thread
+    #
+    def __init__(self, ThreadNumber):
+        self.ThreadNumber = ThreadNumber
+        self.Lock = threading.Condition()
+        self.ReadyQueue = deque()
+        self.Writers = {}
+        self.Readers = {}
+        self.PendingCount = 0
+        self.FailedJob = None
+        self.Timing = {}
+        if ThreadNumber <= 1:
+            return
+        for Index in range(ThreadNumber):
+            Worker = threading.Thread(target=self.__Worker, name="GenFdsTool%d" % Index)
+            Worker.setDaemon(True)
+            Worker.start()
+
+    @staticmethod
+    def __Key(File):
+        return os.path.normcase(os.path.normpath(File))
+
+    ## Queue a tool call
+    #
+    #   @param  Cmd             The command line list
+    #   @param  ErrorMessage    Message reported if the tool fails
+    #   @param  Output          The file generated by the tool
+    #   @param  Input           The files read by the tool
+    #   @param  OnDone          Called after the tool succeeded, or was skipped
+    #   @param  Hash            Skip the tool if the command line and the content of
+    #                           the inputs are the same as when Output was generated
+    #
+    def Add(self, Cmd, ErrorMessage, Output, Input, OnDone=None, Hash=False):
+        Job = ToolJob(Cmd, ErrorMessage, Output, list(Input or []), OnDone, Hash)
+        if self.ThreadNumber <= 1:
+            self.__Run(Job)
+            self.__Finish(Job)
+            self.__CheckError()
+            return
+
+        self.Lock.acquire()
+        try:
+            if self.FailedJob == None:
+                OutputKey = self.__Key(Output)
+                InputKeys = [self.__Key(File) for File in Job.Input]
+                DependList = []
+                for Key in InputKeys + [OutputKey]:
+                    if Key in self.Writers:
+                        DependList.append(self.Writers[Key])
+                DependList += self.Readers.get(OutputKey, [])
+                for Depend in DependList:
+                    if not Depend.Finished and Job not in Depend.Dependents:
+                        Depend.Dependents.append(Job)
+                        Job.WaitCount += 1
+
+                self.Writers[OutputKey] = Job
+                for Key in InputKeys:
+                    self.Readers.setdefault(Key, []).append(Job)
+                self.PendingCount += 1
+                if Job.WaitCount == 0:
+                    self.ReadyQueue.append(Job)
+                    self.Lock.notify()
+        finally:
+            self.Lock.release()
+        self.__CheckError()
+
+    ## Check if a file is still to be generated by a queued tool
+    #
+    def IsPending(self, File):
+        self.Lock.acquire()
+        try:
+            return self.__Key(File) in self.Writers
+        finally:
+            self.Lock.release()
+
+    ## Wait for the queued tools
+    #
+    #   @param  Files           Wait only for the tools generating these files, and the
+    #                           tools they depend on; None to wait for all tools
+    #
+    def Wait(self, Files=None):
+        if Files != None:
+            Keys = [self.__Key(File) for File in Files]
+        self.Lock.acquire()
+        try:
+            while self.FailedJob == None:
+                if Files == None:
+                    if self.PendingCount == 0:
+                        break
+                elif not [Key for Key in Keys if Key in self.Writers]:
+                    break
+                #
+                # A timeout keeps the main thread responsive to Ctrl-C
+                #
+                self.Lock.wait(1)
+        finally:
+            self.Lock.release()
+        self.__CheckError()
+
+    ## Record the time spent in a tool called outside of the scheduler
+    #
+    def AddTime(self, Cmd, Seconds, Skipped=False):
+        Tool = os.path.basename(Cmd[0])
+        self.Lock.acquire()
+        try:
+            Entry = self.Timing.setdefault(Tool, [0, 0, 0.0])
+            Entry[0] += 1
+            if Skipped:
+                Entry[1] += 1
+            Entry[2] += Seconds
+        finally:
+            self.Lock.release()
+
+    ## Report the number of calls and the time spent per tool
+    #
+    def ReportTiming(self):
+        if not self.Timing:
+            return
+        EdkLogger.info("\nGenFds tool time (%d thread%s):" % (self.ThreadNumber, ['', 's'][self.ThreadNumber > 1]))
+        EdkLogger.info("  %-20s %8s %8s %10s" % ("Tool", "Calls", "Skipped", "Seconds"))
+        Total = 0.0
+        for Tool in sorted(self.Timing, key=lambda Tool: -self.Timing[Tool][2]):
+            Calls, Skipped, Seconds = self.Timing[Tool]
+            EdkLogger.info("  %-20s %8d %8d %10.2f" % (Tool, Calls, Skipped, Seconds))
+            Total += Seconds
+        EdkLogger.info("  %-20s %8s %8s %10.2f" % ("Total", "", "", Total))
+
+    def __Worker(self):
+        while True:
+            self.Lock.acquire()
+            try:
+                while not self.ReadyQueue:
+                    self.Lock.wait()
+                Job = self.ReadyQueue.popleft()
+            finally:
+                self.Lock.release()
+            #
+            # An exception must not end the thread before the job is finished,
+            # or the threads waiting for it would hang
+            #
+            try:
+                try:
+                    self.__Run(Job)
+                except Exception, X:
+                    Job.ReturnCode = -1
+                    Job.Error = "%s: %s\n%s" % (str(X), Job.Cmd[0], traceback.format_exc())
+            finally:
+                self.__Finish(Job)
+
+    ## Run the tool of a job, unless its output is up to date by content
+    #
+    def __Run(self, Job):
+        StartTime = time.time()
+        HashFile = Job.Output + '.hash'
+        Digest = None
+        if Job.Hash:
+            Digest = Job.Digest()
+            if Digest != None and os.path.exists(Job.Output) and os.path.exists(HashFile):
+                FileObj = open(HashFile, 'r')
+                OldDigest = FileObj.read().strip()
+                FileObj.close()
+                if OldDigest == Digest:
+                    EdkLogger.debug(EdkLogger.DEBUG_5, "%s is skipped because its input is unchanged" % Job.Output)
+                    self.AddTime(Job.Cmd, time.time() - StartTime, True)
+                    if Job.OnDone != None:
+                        Job.OnDone()
+                    return
+
+        if os.path.exists(HashFile):
+            os.remove(HashFile)
+        try:
+            PopenObject = subprocess.Popen(' '.join(Job.Cmd), stdout=subprocess.PIPE, stderr=subprocess.PIPE, shell=True)
+            (Job.Out, Job.Error) = PopenObject.communicate()
+            Job.ReturnCode = PopenObject.returncode
+        except Exception, X:
+            Job.ReturnCode = -1
+            Job.Error = "%s: %s" % (str(X), Job.Cmd[0])
+        self.AddTime(Job.Cmd, time.time() - StartTime)
+
+        if Job.ReturnCode != 0:
+            return
+        if EdkLogger.GetLevel() < EdkLogger.INFO:
+            EdkLogger.info("Return Value = %d" % Job.ReturnCode)
+            EdkLogger.info(Job.Out)
+            EdkLogger.info(Job.Error)
+        if Digest != None:
+            FileObj = open(HashFile, 'w')
+            FileObj.write(Digest)
+            FileObj.close()
+        if Job.OnDone != None:
+            Job.OnDone()
+
+    def __Finish(self, Job):
+        self.Lock.acquire()
+        try:
+            Job.Finished = True
+            if Job.ReturnCode != 0 and self.FailedJob == None:
+                self.FailedJob = Job
+            if self.ThreadNumber <= 1:
+                return
+            OutputKey = self.__Key(Job.Output)
+            if self.Writers.get(OutputKey) is Job:
+                del self.Writers[OutputKey]
+            for File in Job.Input:
+                Key = self.__Key(File)
+                Readers = self.Readers.get(Key)
+                if Readers and Job in Readers:
+                    Readers.remove(Job)
+                    if not Readers:
+                        del self.Readers[Key]
+            for Dependent in Job.Dependents:
+                Dependent.WaitCount -= 1
+                if Dependent.WaitCount == 0 and self.FailedJob == None:
+                    self.ReadyQueue.append(Dependent)
+            self.PendingCount -= 1
+            self.Lock.notifyAll()
+        finally:
+            self.Lock.release()
+
+    ## Report the first failed tool as GenFds would for a tool called at once
+    #
+    def __CheckError(self):
+        Job = self.FailedJob
+        if Job == None:
+            return
+        EdkLogger.info("Return Value = %d" % Job.ReturnCode)
+        EdkLogger.info(Job.Out)
+        EdkLogger.info(Job.Error)
+        print "###", Job.Cmd
+        EdkLogger.error("GenFds", COMMAND_FAILURE, Job.ErrorMessage)
@@ -867,6 +867,9 @@ class DscParser(MetaFileParser):
         #
         self._IdMapping = {-1:-1}
 
+        # Path of all files included by !include, directly or not
+        self.IncludedFiles = set()
+
     ## Parser starter
     def Start(self):
         Content = ''
@@ -1496,6 +1499,8 @@ class DscParser(MetaFileParser):
             Parser._Enabled = self._Enabled
             # Parse the included file
             Parser.Start()
+            self.IncludedFiles.add(IncludedFile1.Path)
+            self.IncludedFiles.update(Parser.IncludedFiles)
 
             # update current status with sub-parser's status
             self._SectionName = Parser._SectionName
@@ -2727,14 +2727,16 @@ class WorkspaceDatabase(object):
     # @param DbPath             Path of database file
     # @param GlobalMacros       Global macros used for replacement during file parsing
     # @prarm RenewDb=False      Create new database file if it's already there
+    # @param ReadOnly=False     Open an existing database file for reading only
     #
-    def __init__(self, DbPath, RenewDb=False):
+    def __init__(self, DbPath, RenewDb=False, ReadOnly=False):
         self._DbClosedFlag = False
         if not DbPath:
             DbPath = os.path.normpath(os.path.join(GlobalData.gWorkspace, 'Conf', GlobalData.gDatabasePath))
+        self.DbPath = DbPath
 
         # don't create necessary path for db in memory
-        if DbPath != ':memory:':
+        if DbPath != ':memory:' and not ReadOnly:
             DbDir = os.path.split(DbPath)[0]
             if not os.path.exists(DbDir):
                 os.makedirs(DbDir)
@@ -2750,6 +2752,8 @@ class WorkspaceDatabase(object):
         self.Conn.execute("PRAGMA count_changes=OFF")
         self.Conn.execute("PRAGMA cache_size=8192")
         #self.Conn.execute("PRAGMA page_size=8192")
+        if ReadOnly:
+            self.Conn.execute("PRAGMA query_only=ON")
 
         # to avoid non-ascii character conversion issue
         self.Conn.text_factory = str
@@ -0,0 +1,325 @@
+## @file
+# Content addressed cache of the files built for the modules
+#
+# Copyright (c) 2015, Intel Corporation. All rights reserved.<BR>
+#
+# This program and the accompanying materials
+# are licensed and made available under the terms and conditions of the BSD License
+# which accompanies this distribution.  The full text of the license may be found at
+# http://opensource.org/licenses/bsd-license.php
+#
+# THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+# WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+#
+
+##
+# Import Modules
+#
+import Common.LongFilePathOs as os
+import os.path as path
+import shutil
+import threading
+from hashlib import md5
+from os import getpid
+
+from Common import EdkLogger
+from Common.Misc import CreateDirectory
+from Common.LongFilePathSupport import OpenLongFilePath as open
+from Common.LongFilePathSupport import LongFilePath
+from AutoGen.AutoGen import gAutoGenCacheFileName
+
+## Result of the build cache for a module
+BUILD_CACHE_HIT = "Hit"
+BUILD_CACHE_MISS = "Miss"
+BUILD_CACHE_NONE = "Not cached"
+
+## Content addressed cache of the files built for the modules
+#
+# The key of a module is the digest of the AutoGen cache file the module was
+# generated with: the build settings and platform files, the PCD token numbers,
+# and the content of its INF, its sources and the headers they include;
+# combined with the identity of all tools of the module, and the keys of its
+# libraries. The content of the generated files doesn't need to be hashed,
+# since the AutoGen cache already relies on it being the same for the same
+# AutoGen cache file.
+#
+# After a module was built, the files in its OUTPUT and DEBUG directories, and
+# the images copied to the architecture directory, are saved to the cache
+# directory as:
+#
+#   objects/<digest of the file>
+#   modules/<key>.txt           the list of the module files and their digest
+#
+# A module whose key is found is restored from these files instead of being
+# built. Every tool with a PATH in the build options of the module, from the
+# compilers and linkers to GenFw and VfrCompile, is identified by its resolved
+# path and the digest of its executable, so updating any of them builds the
+# modules using it again.
+#
+class BuildCache:
+    ## Constructor
+    #
+    #   @param  CacheDir        The cache directory
+    #
+    def __init__(self, CacheDir):
+        self.CacheDir = CacheDir
+        self.ObjectDir = path.join(CacheDir, "objects")
+        self.ModuleDir = path.join(CacheDir, "modules")
+        CreateDirectory(self.ObjectDir)
+        CreateDirectory(self.ModuleDir)
+        self.Lock = threading.Lock()
+        self.KeyCache = {}
+        self.ToolCache = {}
+        self.Result = {}
+
+    @staticmethod
+    def __FileDigest(File):
+        Md5 = md5()
+        FileObj = open(File, 'rb')
+        while True:
+            Data = FileObj.read(0x100000)
+            if not Data:
+                break
+            Md5.update(Data)
+        FileObj.close()
+        return Md5.hexdigest()
+
+    ## Return the identity of a tool of a module, its resolved path and the digest of the executable
+    #
+    #   @param  Ma          The ModuleAutoGen object
+    #   @param  Tool        The tool code, like CC
+    #
+    def __GetToolIdentity(self, Ma, Tool):
+        ToolPath = Ma.BuildOption.get(Tool, {}).get('PATH', '').strip().strip('"')
+        if not ToolPath:
+            return ''
+        self.Lock.acquire()
+        try:
+            if ToolPath in self.ToolCache:
+                return self.ToolCache[ToolPath]
+        finally:
+            self.Lock.release()
+
+        FullPath = None
+        if os.path.isfile(ToolPath):
+            FullPath = ToolPath
+        else:
+            if 'PATHEXT' in os.environ:
+                ExtList = [''] + os.environ['PATHEXT'].split(os.pathsep)
+            else:
+                ExtList = ['']
+            for Dir in os.environ.get('PATH', '').split(os.pathsep):
+                for Ext in ExtList:
+                    if os.path.isfile(path.join(Dir, ToolPath + Ext)):
+                        FullPath = path.join(Dir, ToolPath + Ext)
+                        break
+                if FullPath:
+                    break
+        if FullPath:
+            FullPath = path.realpath(FullPath)
+            try:
+                Identity = '%s %s' % (FullPath, self.__FileDigest(FullPath))
+            except (IOError, OSError):
+                Identity = FullPath
+        else:
+            Identity = ToolPath
+
+        self.Lock.acquire()
+        self.ToolCache[ToolPath] = Identity
+        self.Lock.release()
+        return Identity
+
+    ## Return the key of a module
+    #
+    #   @param  Ma          The ModuleAutoGen object
+    #   @param  Target      The make target
+    #
+    #   @retval string      The key, or None if the module can't be cached
+    #
+    def GetKey(self, Ma, Target):
+        self.Lock.acquire()
+        try:
+            if Ma.BuildDir in self.KeyCache:
+                return self.KeyCache[Ma.BuildDir]
+        finally:
+            self.Lock.release()
+
+        Key = None
+        CacheFile = path.join(Ma.BuildDir, gAutoGenCacheFileName)
+        if not Ma.IsBinaryModule and os.path.isfile(CacheFile):
+            FileObj = open(CacheFile, 'r')
+            Lines = FileObj.read().splitlines()
+            FileObj.close()
+
+            Md5 = md5()
+            Md5.update('%s %s %s %s %s\n' % (Ma.BuildTarget, Ma.ToolChain, Ma.Arch, Target, Ma.BuildDir))
+            for Tool in sorted(Ma.BuildOption):
+                if 'PATH' in Ma.BuildOption[Tool]:
+                    Md5.update('%s %s\n' % (Tool, self.__GetToolIdentity(Ma, Tool)))
+            for Line in Lines:
+                #
+                # Leave the time stamp of the files out
+                #
+                Fields = Line.split(' ', 3)
+                if Fields[0] == 'FILE' and len(Fields) == 4:
+                    Line = 'FILE %s %s' % (Fields[2], Fields[3])
+                Md5.update(Line + '\n')
+            LibraryList = []
+            if not Ma.IsLibrary:
+                LibraryList = Ma.LibraryAutoGenList
+            for LibraryAutoGen in LibraryList:
+                LibraryKey = self.GetKey(LibraryAutoGen, Target)
+                if LibraryKey == None:
+                    break
+                Md5.update(LibraryKey + '\n')
+            else:
+                Key = Md5.hexdigest()
+
+        self.Lock.acquire()
+        self.KeyCache[Ma.BuildDir] = Key
+        self.Lock.release()
+        return Key
+
+    ## Return the directories the files of a module are saved from, by tag
+    def __GetDirs(self, Ma):
+        return {
+            'OUTPUT'    : Ma.OutputDir,
+            'DEBUG'     : Ma.DebugDir,
+            'BIN'       : path.join(Ma.PlatformInfo.BuildDir, Ma.Arch)
+        }
+
+    def __SetResult(self, Ma, Result):
+        self.Lock.acquire()
+        self.Result[Ma.BuildDir] = Result
+        self.Lock.release()
+
+    ## Return the result of the build cache for a module
+    #
+    #   @retval string      BUILD_CACHE_HIT, BUILD_CACHE_MISS, or BUILD_CACHE_NONE
+    #                       if the module was not built with the cache
+    #
+    def GetResult(self, Ma):
+        return self.Result.get(Ma.BuildDir, BUILD_CACHE_NONE)
+
+    ## Return the number of modules restored and saved
+    def GetCount(self):
+        Results = self.Result.values()
+        return (Results.count(BUILD_CACHE_HIT), Results.count(BUILD_CACHE_MISS))
+
+    ## Restore the files of a module
+    #
+    #   @param  Ma          The ModuleAutoGen object
+    #   @param  Target      The make target
+    #
+    #   @retval True        The files were restored, the module doesn't need to be built
+    #   @retval False       The module has to be built
+    #
+    def Restore(self, Ma, Target):
+        Key = self.GetKey(Ma, Target)
+        if Key == None:
+            self.__SetResult(Ma, BUILD_CACHE_NONE)
+            return False
+
+        self.__SetResult(Ma, BUILD_CACHE_MISS)
+        ListFile = path.join(self.ModuleDir, Key + '.txt')
+        if not os.path.isfile(ListFile):
+            return False
+        FileObj = open(ListFile, 'r')
+        Lines = FileObj.read().splitlines()
+        FileObj.close()
+
+        Dirs = self.__GetDirs(Ma)
+        FileList = []
+        for Line in Lines:
+            Fields = Line.split(' ', 2)
+            if len(Fields) != 3 or Fields[1] not in Dirs:
+                return False
+            Object = path.join(self.ObjectDir, Fields[0])
+            if not os.path.isfile(Object):
+                return False
+            FileList.append((Object, path.join(Dirs[Fields[1]], os.path.normpath(Fields[2]))))
+
+        #
+        # The files get the current time stamp, so that make sees them up to
+        # date with respect to the sources if the module is built again.
+        #
+        try:
+            for Object, File in FileList:
+                CreateDirectory(path.dirname(File))
+                shutil.copyfile(LongFilePath(Object), LongFilePath(File))
+        except (IOError, OSError), X:
+            EdkLogger.verbose("Failed to restore %s from build cache: %s" % (str(Ma), str(X)))
+            return False
+
+        EdkLogger.verbose("Restored %s [%s] from build cache" % (str(Ma), Ma.Arch))
+        self.__SetResult(Ma, BUILD_CACHE_HIT)
+        return True
+
+    ## Save the files of a module after it was built
+    #
+    #   Files are written to a temporary file first and renamed, so that builds
+    #   sharing the cache directory never see a partial file. Failures are
+    #   ignored, the module is just built again next time.
+    #
+    #   @param  Ma          The ModuleAutoGen object
+    #   @param  Target      The make target
+    #
+    def Save(self, Ma, Target):
+        Key = self.GetKey(Ma, Target)
+        if Key == None:
+            return
+
+        Dirs = self.__GetDirs(Ma)
+        FileList = []
+        for Tag in ['OUTPUT', 'DEBUG']:
+            for Root, DirList, Files in os.walk(LongFilePath(Dirs[Tag])):
+                for Name in Files:
+                    File = path.join(Root, Name)
+                    FileList.append((Tag, path.relpath(File, LongFilePath(Dirs[Tag])), File))
+        #
+        # The images of a driver are copied to the architecture directory by name
+        #
+        if not Ma.IsLibrary and os.path.isdir(Dirs['BIN']):
+            for Name in os.listdir(Dirs['BIN']):
+                File = path.join(Dirs['BIN'], Name)
+                if Name.startswith(Ma.Name + '.') and os.path.isfile(File):
+                    FileList.append(('BIN', Name, File))
+
+        Suffix = '.%d.%s' % (getpid(), threading.currentThread().getName().replace(' ', '_'))
+        TempFile = None
+        try:
+            Lines = []
+            for Tag, Name, File in FileList:
+                Digest = self.__FileDigest(File)
+                Object = path.join(self.ObjectDir, Digest)
+                if not os.path.isfile(Object):
+                    TempFile = Object + Suffix
+                    shutil.copyfile(LongFilePath(File), LongFilePath(TempFile))
+                    self.__Rename(TempFile, Object)
+                Lines.append('%s %s %s' % (Digest, Tag, Name.replace('\\', '/')))
+
+            ListFile = path.join(self.ModuleDir, Key + '.txt')
+            TempFile = ListFile + Suffix
+            FileObj = open(TempFile, 'w')
+            FileObj.write('\n'.join(Lines) + '\n')
+            FileObj.close()
+            self.__Rename(TempFile, ListFile)
+        except (IOError, OSError), X:
+            EdkLogger.verbose("Failed to save %s to build cache: %s" % (str(Ma), str(X)))
+            if TempFile and os.path.isfile(TempFile):
+                os.remove(TempFile)
+
+    ## Rename a file, replacing the destination
+    @staticmethod
+    def __Rename(Src, Dst):
+        try:
+            os.rename(Src, Dst)
+        except OSError:
+            #
+            # Windows doesn't replace an existing file
+            #
+            if os.path.isfile(Dst):
+                os.remove(Dst)
+                os.rename(Src, Dst)
+            else:
+                raise
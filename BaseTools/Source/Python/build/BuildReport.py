@@ -27,6 +27,7 @@ import struct
 from datetime import datetime
 from StringIO import StringIO
 from Common import EdkLogger
+import Common.GlobalData as GlobalData
 from Common.Misc import SaveFileOnChange
 from Common.Misc import GuidStructureByteArrayToGuidString
 from Common.Misc import GuidStructureStringToGuidString
@@ -544,6 +545,9 @@ class ModuleReport(object):
         self.PciDeviceId = M.Module.Defines.get("PCI_DEVICE_ID", "")
         self.PciVendorId = M.Module.Defines.get("PCI_VENDOR_ID", "")
         self.PciClassCode = M.Module.Defines.get("PCI_CLASS_CODE", "")
+        self.BuildCacheResult = None
+        if GlobalData.gBuildCache != None:
+            self.BuildCacheResult = GlobalData.gBuildCache.GetResult(M)
 
         self._BuildDir = M.BuildDir
         self.ModulePcdSet = {}
@@ -617,6 +621,8 @@ class ModuleReport(object):
             FileWrite(File, "PCI Vendor ID:        %s" % self.PciVendorId)
         if self.PciClassCode:
             FileWrite(File, "PCI Class Code:       %s" % self.PciClassCode)
+        if self.BuildCacheResult:
+            FileWrite(File, "Build Cache:          %s" % self.BuildCacheResult)
 
         FileWrite(File, gSectionSep)
 
@@ -1435,6 +1441,9 @@ class PlatformReport(object):
         self.Target = Wa.BuildTarget
         self.OutputPath = os.path.join(Wa.WorkspaceDir, Wa.OutputDir)
         self.BuildEnvironment = platform.platform()
+        self.BuildCacheCount = None
+        if GlobalData.gBuildCache != None:
+            self.BuildCacheCount = GlobalData.gBuildCache.GetCount()
 
         self.PcdReport = None
         if "PCD" in ReportType:
@@ -1488,6 +1497,8 @@ class PlatformReport(object):
         FileWrite(File, "Output Path:          %s" % self.OutputPath)
         FileWrite(File, "Build Environment:    %s" % self.BuildEnvironment)
         FileWrite(File, "Build Duration:       %s" % BuildDuration)
+        if self.BuildCacheCount:
+            FileWrite(File, "Build Cache:          %d module(s) restored, %d module(s) built" % self.BuildCacheCount)
         FileWrite(File, "Report Content:       %s" % ", ".join(ReportType))
 
         if not self._IsModuleBuild:
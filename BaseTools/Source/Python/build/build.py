@@ -24,6 +24,9 @@ import glob
 import time
 import platform
 import traceback
+import logging
+import multiprocessing
+import gc
 import encodings.ascii
 
 from struct import *
@@ -41,8 +44,10 @@ from Common.BuildVersion import gBUILD_VERSION
 from AutoGen.AutoGen import *
 from Common.BuildToolError import *
 from Workspace.WorkspaceDatabase import *
+from Workspace.MetaDataTable import Table
 
 from BuildReport import BuildReport
+from BuildCache import BuildCache
 from GenPatchPcdTable.GenPatchPcdTable import *
 from PatchPcdValue.PatchPcdValue import *
 
@@ -297,6 +302,73 @@ def LaunchCommand(Command, WorkingDir):
             Command = " ".join(Command)
         EdkLogger.error("build", COMMAND_FAILURE, ExtraData="%s [%s]" % (Command, WorkingDir))
 
+## The module AutoGen objects whose code and makefile are generated by the AutoGen worker processes
+gAutoGenJobList = []
+
+## The database connection inherited from build, kept so that the worker never closes it
+gInheritedDbConnection = []
+
+## Initialize an AutoGen worker process
+#
+# The worker is forked from build and inherits the parsed metadata. The
+# connection to the metadata database is shared with build and is left
+# untouched: the worker opens its own read-only connection to the database
+# file and the metadata tables are switched to it. A module needing to change
+# the database, or to read a temporary table of build, fails in the worker and
+# is generated again by build itself.
+#
+# @param  DbPath                The path of the metadata database file
+#
+def InitAutoGenWorker(DbPath):
+    #
+    # Other threads of build may have held the logging locks at the time of fork
+    #
+    logging._lock = RLock()
+    for Logger in [logging.getLogger()] + logging.Logger.manager.loggerDict.values():
+        for Handler in getattr(Logger, 'handlers', []):
+            Handler.createLock()
+
+    Db = WorkspaceDatabase(DbPath, ReadOnly=True)
+    for Object in gc.get_objects():
+        if isinstance(Object, Table):
+            Object.Cur = Db.Cur
+        elif isinstance(Object, WorkspaceDatabase) and Object is not Db:
+            gInheritedDbConnection.append((Object.Conn, Object.Cur))
+            Object.Conn = Db.Conn
+            Object.Cur = Db.Cur
+
+## Generate the code and makefile of a module in an AutoGen worker process
+#
+# @param  Args                  (index in gAutoGenJobList, create code, create makefile)
+#
+# @retval tuple                 (index, seconds generating code, seconds generating makefile,
+#                               depex generated, skipped by AutoGen cache, status), where status
+#                               is 0, the error code of a fatal error, or None if the module
+#                               has to be generated by build itself
+#
+def RunAutoGenWorker(Args):
+    Index, CreateCode, CreateMake = Args
+    Ma = gAutoGenJobList[Index]
+    CodeTime = 0.0
+    MakeTime = 0.0
+    try:
+        StartTime = time.time()
+        if CreateCode:
+            Ma.CreateCodeFile(False)
+        CodeTime = time.time() - StartTime
+        StartTime = time.time()
+        if CreateMake:
+            Ma.CreateMakeFile(False)
+        MakeTime = time.time() - StartTime
+    except FatalError, X:
+        return (Index, CodeTime, MakeTime, False, False, X.args[0])
+    except KeyboardInterrupt:
+        return (Index, CodeTime, MakeTime, False, False, ABORT_ERROR)
+    except:
+        EdkLogger.debug(EdkLogger.DEBUG_0, "AutoGen of %s is left to build:\n%s" % (Ma, traceback.format_exc()))
+        return (Index, CodeTime, MakeTime, False, False, None)
+    return (Index, CodeTime, MakeTime, Ma.DepexGenerated, Ma.CanSkipAutoGen(), 0)
+
 ## The smallest unit that can be built in multi-thread build mode
 #
 # This is the base class of build unit. The "Obj" parameter must provide
@@ -640,7 +712,13 @@ class BuildTask:
     #
     def _CommandThread(self, Command, WorkingDir):
         try:
-            LaunchCommand(Command, WorkingDir)
+            Cache = None
+            if isinstance(self.BuildItem, ModuleMakeUnit):
+                Cache = GlobalData.gBuildCache
+            if Cache == None or not Cache.Restore(self.BuildItem.BuildObject, self.BuildItem.Target):
+                LaunchCommand(Command, WorkingDir)
+                if Cache != None:
+                    Cache.Save(self.BuildItem.BuildObject, self.BuildItem.Target)
             self.CompleteFlag = True
         except:
             #
@@ -738,8 +816,26 @@ class Build():
         self.BuildReport    = BuildReport(BuildOptions.ReportFile, BuildOptions.ReportType)
         self.TargetTxt      = TargetTxtClassObject()
         self.ToolDef        = ToolDefClassObject()
+        self.AutoGenStats   = BuildOptions.AutoGenStats
+        self.PhaseTimeList  = []
+        self.ModuleTimeList = []
         #Set global flag for build mode
         GlobalData.gIgnoreSource = BuildOptions.IgnoreSources
+        GlobalData.gUseAutoGenCache = not (BuildOptions.DisableCache or BuildOptions.Reparse)
+        GlobalData.gBuildCache = None
+        GlobalData.gFfsCacheDir = None
+        if BuildOptions.BuildCacheDir:
+            #
+            # The FFS cache of GenFv checks the content of the FFS files itself
+            #
+            GlobalData.gFfsCacheDir = os.path.join(os.path.abspath(BuildOptions.BuildCacheDir), "ffs")
+            #
+            # The key of a module is based on its AutoGen cache file
+            #
+            if GlobalData.gUseAutoGenCache:
+                GlobalData.gBuildCache = BuildCache(os.path.abspath(BuildOptions.BuildCacheDir))
+            else:
+                EdkLogger.warn("build", "The build cache is not used with -N or -e")
 
         if self.ConfDirectory:
             # Get alternate Conf location, if it is absolute, then just use the absolute directory name
@@ -839,6 +935,7 @@ class Build():
                 self.ThreadNumber = 0
             else:
                 self.ThreadNumber = int(self.ThreadNumber, 0)
+        GlobalData.gThreadNumber = self.ThreadNumber
 
         if self.ThreadNumber == 0:
             self.ThreadNumber = 1
@@ -1019,12 +1116,14 @@ class Build():
 
         # skip file generation for cleanxxx targets, run and fds target
         if Target not in ['clean', 'cleanlib', 'cleanall', 'run', 'fds']:
+            StartTime = time.time()
             # for target which must generate AutoGen code and makefile
             if not self.SkipAutoGen or Target == 'genc':
                 self.Progress.Start("Generating code")
                 AutoGenObject.CreateCodeFile(CreateDepsCodeFile)
                 self.Progress.Stop("done!")
             if Target == "genc":
+                self._AddPhaseTime("AutoGen", StartTime)
                 return True
 
             if not self.SkipAutoGen or Target == 'genmake':
@@ -1032,6 +1131,7 @@ class Build():
                 AutoGenObject.CreateMakeFile(CreateDepsMakeFile)
                 #AutoGenObject.CreateAsBuiltInf()
                 self.Progress.Stop("done!")
+            self._AddPhaseTime("AutoGen", StartTime)
             if Target == "genmake":
                 return True
         else:
@@ -1054,13 +1154,17 @@ class Build():
         if BuildModule:
             if Target != 'fds':
                 BuildCommand = BuildCommand + [Target]
+            StartTime = time.time()
             LaunchCommand(BuildCommand, AutoGenObject.MakeFileDir)
+            self._AddPhaseTime("Make", StartTime)
             self.CreateAsBuiltInf()
             return True
 
         # genfds
         if Target == 'fds':
+            StartTime = time.time()
             LaunchCommand(AutoGenObject.GenFdsCommand, AutoGenObject.MakeFileDir)
+            self._AddPhaseTime("GenFds", StartTime)
             return True
 
         # run
@@ -1089,7 +1193,10 @@ class Build():
 
     ## Rebase module image and Get function address for the input module list.
     #
-    def _RebaseModule (self, MapBuffer, BaseAddress, ModuleList, AddrIsOffset = True, ModeIsSmm = False):
+    #   The GenFw commands rebasing the images are added to GenFwBatch, by
+    #   architecture, and run afterwards in one GenFw process per architecture.
+    #
+    def _RebaseModule (self, MapBuffer, BaseAddress, ModuleList, GenFwBatch, AddrIsOffset = True, ModeIsSmm = False):
         if ModeIsSmm:
             AddrIsOffset = False
         InfFileNameList = ModuleList.keys()
@@ -1107,14 +1214,14 @@ class Build():
                 #
                 # Update Image to new BaseAddress by GenFw tool
                 #
-                LaunchCommand(["GenFw", "--rebase", str(BaseAddress), "-r", ModuleOutputImage], ModuleInfo.OutputDir)
-                LaunchCommand(["GenFw", "--rebase", str(BaseAddress), "-r", ModuleDebugImage],  ModuleInfo.DebugDir)
+                Option = "--rebase"
             else:
                 #
                 # Set new address to the section header only for SMM driver.
                 #
-                LaunchCommand(["GenFw", "--address", str(BaseAddress), "-r", ModuleOutputImage], ModuleInfo.OutputDir)
-                LaunchCommand(["GenFw", "--address", str(BaseAddress), "-r", ModuleDebugImage],  ModuleInfo.DebugDir)
+                Option = "--address"
+            for Image in [ModuleOutputImage, ModuleDebugImage]:
+                GenFwBatch.setdefault(ModuleInfo.Arch, []).append('%s %s -r "%s"' % (Option, str(BaseAddress), Image))
             #
             # Collect funtion address from Map file
             #
@@ -1236,6 +1343,8 @@ class Build():
         BtModuleList   = {}
         RtModuleList   = {}
         SmmModuleList  = {}
+        GenFwBatchDir  = {}
+        GenFwBatch     = {}
         PeiSize = 0
         BtSize  = 0
         RtSize  = 0
@@ -1259,6 +1368,7 @@ class Build():
                     if not ImageClass.IsValid:
                         EdkLogger.error("build", FILE_PARSE_FAILURE, ExtraData=ImageClass.ErrorInfo)
                     ImageInfo = PeImageInfo(Module.Name, Module.Guid, Module.Arch, Module.OutputDir, Module.DebugDir, ImageClass)
+                    GenFwBatchDir[Module.Arch] = os.path.join(Module.PlatformInfo.BuildDir, Module.Arch)
                     if Module.ModuleType in ['PEI_CORE', 'PEIM', 'COMBINED_PEIM_DRIVER','PIC_PEIM', 'RELOCATABLE_PEIM', 'DXE_CORE']:
                         PeiModuleList[Module.MetaFile] = ImageInfo
                         PeiSize += ImageInfo.Image.Size
@@ -1360,10 +1470,17 @@ class Build():
         BtBaseAddr  = TopMemoryAddress - RtSize
         RtBaseAddr  = TopMemoryAddress - ReservedRuntimeMemorySize
 
-        self._RebaseModule (MapBuffer, PeiBaseAddr, PeiModuleList, TopMemoryAddress == 0)
-        self._RebaseModule (MapBuffer, BtBaseAddr, BtModuleList, TopMemoryAddress == 0)
-        self._RebaseModule (MapBuffer, RtBaseAddr, RtModuleList, TopMemoryAddress == 0)
-        self._RebaseModule (MapBuffer, 0x1000, SmmModuleList, AddrIsOffset = False, ModeIsSmm = True)
+        self._RebaseModule (MapBuffer, PeiBaseAddr, PeiModuleList, GenFwBatch, TopMemoryAddress == 0)
+        self._RebaseModule (MapBuffer, BtBaseAddr, BtModuleList, GenFwBatch, TopMemoryAddress == 0)
+        self._RebaseModule (MapBuffer, RtBaseAddr, RtModuleList, GenFwBatch, TopMemoryAddress == 0)
+        self._RebaseModule (MapBuffer, 0x1000, SmmModuleList, GenFwBatch, AddrIsOffset = False, ModeIsSmm = True)
+        #
+        # Rebase the images of each architecture in one GenFw process
+        #
+        for Arch in GenFwBatch:
+            BatchFile = os.path.join(GenFwBatchDir[Arch], 'GenFwRebase.txt')
+            SaveFileOnChange(BatchFile, '\n'.join(GenFwBatch[Arch]) + '\n', False)
+            LaunchCommand(["GenFw", "--batch", BatchFile], GenFwBatchDir[Arch])
         MapBuffer.write('\n\n')
         sys.stdout.write ("\n")
         sys.stdout.flush()
@@ -1392,6 +1509,7 @@ class Build():
             for ToolChain in self.ToolChainList:
                 GlobalData.gGlobalDefines['TOOLCHAIN'] = ToolChain
                 GlobalData.gGlobalDefines['TOOL_CHAIN_TAG'] = ToolChain
+                StartTime = time.time()
                 Wa = WorkspaceAutoGen(
                         self.WorkspaceDir,
                         self.PlatformFile,
@@ -1409,6 +1527,7 @@ class Build():
                         self.UniFlag,
                         self.Progress
                         )
+                self._AddPhaseTime("Parse metadata", StartTime)
                 self.Fdf = Wa.FdfFile
                 self.LoadFixAddress = Wa.Platform.LoadFixAddress
                 self.BuildReport.AddPlatformReport(Wa)
@@ -1476,6 +1595,7 @@ class Build():
                 # module build needs platform build information, so get platform
                 # AutoGen first
                 #
+                StartTime = time.time()
                 Wa = WorkspaceAutoGen(
                         self.WorkspaceDir,
                         self.PlatformFile,
@@ -1494,6 +1614,7 @@ class Build():
                         self.Progress,
                         self.ModuleFile
                         )
+                self._AddPhaseTime("Parse metadata", StartTime)
                 self.Fdf = Wa.FdfFile
                 self.LoadFixAddress = Wa.Platform.LoadFixAddress
                 Wa.CreateMakeFile(False)
@@ -1565,6 +1686,7 @@ class Build():
             for ToolChain in self.ToolChainList:
                 GlobalData.gGlobalDefines['TOOLCHAIN'] = ToolChain
                 GlobalData.gGlobalDefines['TOOL_CHAIN_TAG'] = ToolChain
+                StartTime = time.time()
                 Wa = WorkspaceAutoGen(
                         self.WorkspaceDir,
                         self.PlatformFile,
@@ -1582,6 +1704,7 @@ class Build():
                         self.UniFlag,
                         self.Progress
                         )
+                self._AddPhaseTime("Parse metadata", StartTime)
                 self.Fdf = Wa.FdfFile
                 self.LoadFixAddress = Wa.Platform.LoadFixAddress
                 self.BuildReport.AddPlatformReport(Wa)
@@ -1605,6 +1728,8 @@ class Build():
                             if Inf in Pa.Platform.Modules:
                                 continue
                             ModuleList.append(Inf)
+                    StartTime = time.time()
+                    AutoGenList = []
                     for Module in ModuleList:
                         # Get ModuleAutoGen object to generate C code file and makefile
                         Ma = ModuleAutoGen(Wa, Module, BuildTarget, ToolChain, Arch, self.PlatformFile)
@@ -1613,17 +1738,17 @@ class Build():
                             continue
                         # Not to auto-gen for targets 'clean', 'cleanlib', 'cleanall', 'run', 'fds'
                         if self.Target not in ['clean', 'cleanlib', 'cleanall', 'run', 'fds']:
-                            # for target which must generate AutoGen code and makefile
-                            if not self.SkipAutoGen or self.Target == 'genc':
-                                Ma.CreateCodeFile(True)
-                            if self.Target == "genc":
-                                continue
-
-                            if not self.SkipAutoGen or self.Target == 'genmake':
-                                Ma.CreateMakeFile(True)
-                            if self.Target == "genmake":
+                            AutoGenList.append(Ma)
+                            if self.Target in ["genc", "genmake"]:
                                 continue
                         self.BuildModules.append(Ma)
+                    # for target which must generate AutoGen code and makefile
+                    self._CreateModuleAutoGen(
+                            AutoGenList,
+                            not self.SkipAutoGen or self.Target == 'genc',
+                            (not self.SkipAutoGen or self.Target == 'genmake') and self.Target != 'genc'
+                            )
+                    self._AddPhaseTime("AutoGen", StartTime)
                     self.Progress.Stop("done!")
 
                     for Ma in self.BuildModules:
@@ -1658,8 +1783,10 @@ class Build():
                 # All modules have been put in build tasks queue. Tell task scheduler
                 # to exit if all tasks are completed
                 #
+                StartTime = time.time()
                 ExitFlag.set()
                 BuildTask.WaitForComplete()
+                self._AddPhaseTime("Make", StartTime)
                 self.CreateAsBuiltInf()
 
                 #
@@ -1698,7 +1825,9 @@ class Build():
                         #
                         # Generate FD image if there's a FDF file found
                         #
+                        StartTime = time.time()
                         LaunchCommand(Wa.GenFdsCommand, os.getcwd())
+                        self._AddPhaseTime("GenFds", StartTime)
 
                         #
                         # Create MAP file for all platform FVs after GenFds.
@@ -1709,6 +1838,117 @@ class Build():
                     #
                     self._SaveMapFile(MapBuffer, Wa)
 
+    ## Generate the code and makefiles of modules
+    #
+    #   With more than one build thread, where build can fork and the metadata
+    #   database is a file, the libraries of the modules and then the modules are
+    #   generated by a pool of worker processes.
+    #   Binary modules, the PCD drivers and the modules failed in the workers are
+    #   generated afterwards in the order of the module list.
+    #
+    #   @param  MaList      The list of module AutoGen objects
+    #   @param  CreateCode  Generate the code of the modules
+    #   @param  CreateMake  Generate the makefiles of the modules
+    #
+    def _CreateModuleAutoGen(self, MaList, CreateCode, CreateMake):
+        if not CreateCode and not CreateMake:
+            return
+        if self.ThreadNumber > 1 and hasattr(os, 'fork'):
+            LibrarySet = set()
+            LibraryList = []
+            for Ma in MaList:
+                if Ma.IsLibrary:
+                    continue
+                for La in Ma.LibraryAutoGenList:
+                    if La not in LibrarySet:
+                        LibrarySet.add(La)
+                        LibraryList.append(La)
+            for JobList in [LibraryList, [Ma for Ma in MaList if Ma.PcdIsDriver == '']]:
+                JobList = [Ma for Ma in JobList if not Ma.IsBinaryModule]
+                self._RunAutoGenWorkers(JobList, CreateCode, CreateMake)
+                for Ma in JobList:
+                    self._CreateOneModuleAutoGen(Ma, CreateCode, CreateMake)
+        for Ma in MaList:
+            self._CreateOneModuleAutoGen(Ma, CreateCode, CreateMake)
+
+    ## Generate the code and makefile of a module and its libraries in this process
+    #
+    def _CreateOneModuleAutoGen(self, Ma, CreateCode, CreateMake):
+        if (not CreateCode or Ma.IsCodeFileCreated) and (not CreateMake or Ma.IsMakeFileCreated):
+            return
+        StartTime = time.time()
+        if CreateCode:
+            Ma.CreateCodeFile(True)
+        CodeTime = time.time() - StartTime
+        StartTime = time.time()
+        if CreateMake:
+            Ma.CreateMakeFile(True)
+        self.ModuleTimeList.append([str(Ma), CodeTime, time.time() - StartTime])
+
+    ## Generate the code and makefiles of modules in AutoGen worker processes
+    #
+    def _RunAutoGenWorkers(self, MaList, CreateCode, CreateMake):
+        # a database in memory can't be opened by the workers
+        if len(MaList) < 2 or self.Db.DbPath == ':memory:':
+            return
+        del gAutoGenJobList[:]
+        gAutoGenJobList.extend(MaList)
+        # the workers must not see uncommitted changes of the database
+        self.Db.Conn.commit()
+        Pool = multiprocessing.Pool(min(self.ThreadNumber, len(MaList)), InitAutoGenWorker, (self.Db.DbPath,))
+        try:
+            # a timeout keeps the main thread responsive to Ctrl-C
+            ResultList = Pool.map_async(RunAutoGenWorker, [(Index, CreateCode, CreateMake) for Index in range(len(MaList))], 1).get(0x7FFFFFFF)
+            Pool.close()
+        except:
+            Pool.terminate()
+            raise
+        finally:
+            Pool.join()
+            del gAutoGenJobList[:]
+
+        ErrorCode = 0
+        for Index, CodeTime, MakeTime, DepexGenerated, CanSkipAutoGen, Status in ResultList:
+            if Status == None:
+                continue
+            if Status != 0:
+                if ErrorCode == 0:
+                    ErrorCode = Status
+                continue
+            MaList[Index].UpdateAutoGenResult(CreateCode, CreateMake, DepexGenerated, CanSkipAutoGen)
+            self.ModuleTimeList.append([str(MaList[Index]), CodeTime, MakeTime])
+        if ErrorCode != 0:
+            raise FatalError(ErrorCode)
+
+    ## Add the time elapsed since StartTime to a build phase
+    #
+    #   @param  Phase       The name of the phase
+    #   @param  StartTime   The time the phase was entered
+    #
+    def _AddPhaseTime(self, Phase, StartTime):
+        for Entry in self.PhaseTimeList:
+            if Entry[0] == Phase:
+                Entry[1] += time.time() - StartTime
+                return
+        self.PhaseTimeList.append([Phase, time.time() - StartTime])
+
+    ## Report the AutoGen cache hits and the time spent in each build phase
+    #
+    def ReportAutoGenStats(self):
+        if not self.AutoGenStats:
+            return
+        EdkLogger.quiet("\nAutoGen cache: %d module(s) skipped, %d module(s) generated%s" %
+                        (ModuleAutoGen.AutoGenCacheHitCount, ModuleAutoGen.AutoGenCacheMissCount,
+                         ['', ' (disabled)'][not GlobalData.gUseAutoGenCache]))
+        if GlobalData.gBuildCache != None:
+            EdkLogger.quiet("Build cache: %d module(s) restored, %d module(s) built" % GlobalData.gBuildCache.GetCount())
+        for Phase, Seconds in self.PhaseTimeList:
+            EdkLogger.quiet("  %-20s %10.2f s" % (Phase, Seconds))
+        if self.ModuleTimeList:
+            EdkLogger.quiet("\nAutoGen time per module (code, makefile):")
+            for Module, CodeTime, MakeTime in sorted(self.ModuleTimeList, key=lambda Entry: -(Entry[1] + Entry[2])):
+                EdkLogger.quiet("  %8.2f s %8.2f s  %s" % (CodeTime, MakeTime, Module))
+
     ## Generate GuidedSectionTools.txt in the FV directories.
     #
     def CreateGuidedSectionToolsFile(self):
@@ -1914,6 +2154,11 @@ def MyOptionParser():
     Parser.add_option("--conf", action="store", type="string", dest="ConfDirectory", help="Specify the customized Conf directory.")
     Parser.add_option("--check-usage", action="store_true", dest="CheckUsage", default=False, help="Check usage content of entries listed in INF file.")
     Parser.add_option("--ignore-sources", action="store_true", dest="IgnoreSources", default=False, help="Focus to a binary build and ignore all source files")
+    Parser.add_option("--build-cache", action="store", type="string", dest="BuildCacheDir",
+        help="Restore the files built for a module from the given directory, instead of building it, if its sources, "\
+             "the headers they include and its build settings have the same content as when they were saved there. "\
+             "Modules built are saved to the directory, and GenFv keeps the FFS files it rebases and the layout of the FV files in it.")
+    Parser.add_option("--autogen-stats", action="store_true", dest="AutoGenStats", default=False, help="Report the modules whose AutoGen was skipped by the AutoGen cache and the time spent in each build phase.")
 
     (Opt, Args)=Parser.parse_args()
     return (Opt, Args)
@@ -2096,6 +2341,7 @@ def Main():
         BuildDurationStr = time.strftime("%H:%M:%S", BuildDuration)
     if MyBuild != None:
         MyBuild.BuildReport.GenerateReport(BuildDurationStr)
+        MyBuild.ReportAutoGenStats()
         MyBuild.Db.Close()
     EdkLogger.SetLevel(EdkLogger.QUIET)
     EdkLogger.quiet("\n- %s -" % Conclusion)
@@ -0,0 +1,125 @@
+## @file
+#  Unit tests for the AutoGen cache of the modules
+#
+#  Copyright (c) 2015, Intel Corporation. All rights reserved.<BR>
+#
+#  This program and the accompanying materials
+#  are licensed and made available under the terms and conditions of the BSD License
+#  which accompanies this distribution.  The full text of the license may be found at
+#  http://opensource.org/licenses/bsd-license.php
+#
+#  THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+#  WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+#
+
+##
+# Import Modules
+#
+import os
+import shutil
+import tempfile
+import unittest
+
+import TestTools
+
+from Common import EdkLogger
+import Common.GlobalData as GlobalData
+from AutoGen.AutoGen import PlatformAutoGen
+from AutoGen.AutoGen import ModuleAutoGen
+from AutoGen.AutoGen import gAutoGenCacheFileName
+
+class Pcd:
+    def __init__(self, TokenCName, Phase='DXE', Type='Dynamic'):
+        self.TokenCName = TokenCName
+        self.TokenSpaceGuidCName = 'gTestTokenSpaceGuid'
+        self.Phase = Phase
+        self.Type = Type
+
+class Workspace:
+    AutoGenCacheKey = 'WorkspaceKey'
+
+##
+# A platform whose dynamic PCDs are the PCDs of its modules, in module order
+#
+class Platform(PlatformAutoGen):
+    def __new__(Class, ModulePcdLists):
+        return object.__new__(Class)
+
+    def __init__(self, ModulePcdLists):
+        self._PcdTokenNumber = None
+        self._DynamicPcdList = []
+        self._NonDynamicPcdList = []
+        for PcdList in ModulePcdLists:
+            self._DynamicPcdList += PcdList
+
+##
+# A source module whose AutoGen cache file is the only file it depends on
+#
+class Module(ModuleAutoGen):
+    IsBinaryModule = False
+    IsLibrary = True
+    PcdIsDriver = ''
+    BuildDir = None
+
+    def __new__(Class, Platform, PcdList, BuildDir):
+        return object.__new__(Class)
+
+    def __init__(self, Platform, PcdList, BuildDir):
+        self.Workspace = Workspace()
+        self.PlatformInfo = Platform
+        self.BuildDir = BuildDir
+        self._AutoGenCacheKey = None
+        self._ModulePcdList = PcdList
+        self._LibraryPcdList = []
+
+class Tests(unittest.TestCase):
+
+    def setUp(self):
+        EdkLogger.Initialize()
+        self.testDir = tempfile.mkdtemp()
+        self.SavedUseAutoGenCache = GlobalData.gUseAutoGenCache
+        GlobalData.gUseAutoGenCache = True
+
+    def tearDown(self):
+        GlobalData.gUseAutoGenCache = self.SavedUseAutoGenCache
+        shutil.rmtree(self.testDir)
+
+    def SaveCache(self, Ma):
+        FileObj = open(os.path.join(Ma.BuildDir, gAutoGenCacheFileName), 'w')
+        FileObj.write('KEY %s\nDEPEX 0\n' % Ma.AutoGenCacheKey)
+        FileObj.close()
+
+    def Build(self, PcdListA, PcdListB):
+        Pa = Platform([PcdListA, PcdListB])
+        return Module(Pa, PcdListA, self.testDir), Module(Pa, PcdListB, self.testDir)
+
+    def testUnchangedPcdsSkip(self):
+        A, B = self.Build([Pcd('PcdA')], [Pcd('PcdB')])
+        self.SaveCache(B)
+        A, B = self.Build([Pcd('PcdA')], [Pcd('PcdB')])
+        self.assertTrue(B._CheckAutoGenCache())
+
+    def testOtherModulePcdChangeRegenerates(self):
+        A, B = self.Build([Pcd('PcdA')], [Pcd('PcdB')])
+        self.SaveCache(B)
+        #
+        # Adding a PCD to the INF of A renumbers the PCD of B
+        #
+        A, B = self.Build([Pcd('PcdA'), Pcd('PcdA2')], [Pcd('PcdB')])
+        self.assertFalse(B._CheckAutoGenCache())
+
+    def testPlatformPcdRenumberSkips(self):
+        A, B = self.Build([Pcd('PcdA')], [Pcd('PcdB', 'PEI')])
+        self.SaveCache(A)
+        #
+        # The token number of the PCD of A is unchanged, only the numbering of the other PCDs
+        #
+        A, B = self.Build([Pcd('PcdA')], [Pcd('PcdB', 'PEI'), Pcd('PcdB2', 'DXE')])
+        self.assertTrue(A._CheckAutoGenCache())
+
+TheTestSuite = TestTools.MakeTheTestSuite(locals())
+
+if __name__ == '__main__':
+    allTests = TheTestSuite()
+    unittest.TextTestRunner().run(allTests)
+
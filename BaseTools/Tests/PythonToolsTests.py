@@ -24,6 +24,8 @@ def TheTestSuite():
     suites = []
     import CheckPythonSyntax
     suites.append(CheckPythonSyntax.TheTestSuite())
+    import AutoGenCache
+    suites.append(AutoGenCache.TheTestSuite())
     return unittest.TestSuite(suites)
 
 if __name__ == '__main__':
@@ -0,0 +1,430 @@
+/** @file
+  Application for Cryptographic Primitives Throughput Measurement.
+
+Copyright (c) 2015, Intel Corporation. All rights reserved.<BR>
+This program and the accompanying materials
+are licensed and made available under the terms and conditions of the BSD License
+which accompanies this distribution.  The full text of the license may be found at
+http://opensource.org/licenses/bsd-license.php
+
+THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+**/
+
+#include "Cryptest.h"
+
+#define BENCHMARK_BUFFER_SIZE   SIZE_16KB
+#define BENCHMARK_TIME          10000000      // 1 second, unit is 100nanosecond
+#define BENCHMARK_RSA_BITS      2048
+
+typedef
+UINTN
+(EFIAPI *BENCHMARK_GET_CONTEXT_SIZE) (
+  VOID
+  );
+
+typedef
+BOOLEAN
+(EFIAPI *BENCHMARK_HASH_INIT) (
+  OUT  VOID  *Context
+  );
+
+typedef
+BOOLEAN
+(EFIAPI *BENCHMARK_HMAC_INIT) (
+  OUT  VOID         *Context,
+  IN   CONST UINT8  *Key,
+  IN   UINTN        KeySize
+  );
+
+typedef
+BOOLEAN
+(EFIAPI *BENCHMARK_UPDATE) (
+  IN OUT  VOID        *Context,
+  IN      CONST VOID  *Data,
+  IN      UINTN       DataSize
+  );
+
+typedef
+BOOLEAN
+(EFIAPI *BENCHMARK_FINAL) (
+  IN OUT  VOID   *Context,
+  OUT     UINT8  *Value
+  );
+
+typedef
+BOOLEAN
+(EFIAPI *BENCHMARK_ECB) (
+  IN   VOID         *Context,
+  IN   CONST UINT8  *Input,
+  IN   UINTN        InputSize,
+  OUT  UINT8        *Output
+  );
+
+typedef
+BOOLEAN
+(EFIAPI *BENCHMARK_CBC) (
+  IN   VOID         *Context,
+  IN   CONST UINT8  *Input,
+  IN   UINTN        InputSize,
+  IN   CONST UINT8  *Ivec,
+  OUT  UINT8        *Output
+  );
+
+typedef struct {
+  CHAR16                      *Name;
+  BENCHMARK_GET_CONTEXT_SIZE  GetContextSize;
+  BENCHMARK_HASH_INIT         HashInit;
+  BENCHMARK_HMAC_INIT         HmacInit;
+  BENCHMARK_UPDATE            Update;
+  BENCHMARK_FINAL             Final;
+} BENCHMARK_DIGEST;
+
+typedef struct {
+  CHAR16                      *Name;
+  BENCHMARK_GET_CONTEXT_SIZE  GetContextSize;
+  UINTN                       KeyLength;
+  BENCHMARK_ECB               EcbEncrypt;
+  BENCHMARK_ECB               EcbDecrypt;
+  BENCHMARK_CBC               CbcEncrypt;
+  BENCHMARK_CBC               CbcDecrypt;
+} BENCHMARK_CIPHER;
+
+GLOBAL_REMOVE_IF_UNREFERENCED BENCHMARK_DIGEST mBenchmarkDigest[] = {
+  { L"MD4",       Md4GetContextSize,      Md4Init,    NULL,            Md4Update,      Md4Final      },
+  { L"MD5",       Md5GetContextSize,      Md5Init,    NULL,            Md5Update,      Md5Final      },
+  { L"SHA-1",     Sha1GetContextSize,     Sha1Init,   NULL,            Sha1Update,     Sha1Final     },
+  { L"SHA-256",   Sha256GetContextSize,   Sha256Init, NULL,            Sha256Update,   Sha256Final   },
+  { L"SHA-384",   Sha384GetContextSize,   Sha384Init, NULL,            Sha384Update,   Sha384Final   },
+  { L"SHA-512",   Sha512GetContextSize,   Sha512Init, NULL,            Sha512Update,   Sha512Final   },
+  { L"HMAC-MD5",  HmacMd5GetContextSize,  NULL,       HmacMd5Init,     HmacMd5Update,  HmacMd5Final  },
+  { L"HMAC-SHA1", HmacSha1GetContextSize, NULL,       HmacSha1Init,    HmacSha1Update, HmacSha1Final }
+};
+
+GLOBAL_REMOVE_IF_UNREFERENCED BENCHMARK_CIPHER mBenchmarkCipher[] = {
+  { L"TDES-192",  TdesGetContextSize, 192, TdesEcbEncrypt, TdesEcbDecrypt, TdesCbcEncrypt, TdesCbcDecrypt },
+  { L"AES-128",   AesGetContextSize,  128, AesEcbEncrypt,  AesEcbDecrypt,  AesCbcEncrypt,  AesCbcDecrypt  },
+  { L"AES-192",   AesGetContextSize,  192, AesEcbEncrypt,  AesEcbDecrypt,  AesCbcEncrypt,  AesCbcDecrypt  },
+  { L"AES-256",   AesGetContextSize,  256, AesEcbEncrypt,  AesEcbDecrypt,  AesCbcEncrypt,  AesCbcDecrypt  }
+};
+
+GLOBAL_REMOVE_IF_UNREFERENCED CHAR16 *mBenchmarkCipherMode[] = {
+  L"ECB Encrypt",
+  L"ECB Decrypt",
+  L"CBC Encrypt",
+  L"CBC Decrypt"
+};
+
+GLOBAL_REMOVE_IF_UNREFERENCED CONST UINT8  mBenchmarkKey[32] = {
+  0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
+  0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f
+  };
+
+EFI_EVENT  mBenchmarkTimer;
+
+/**
+  Start a measurement period of BENCHMARK_TIME.
+
+**/
+VOID
+BenchmarkStart (
+  VOID
+  )
+{
+  gBS->SetTimer (mBenchmarkTimer, TimerRelative, BENCHMARK_TIME);
+}
+
+/**
+  Check whether the measurement period has elapsed.
+
+  @retval TRUE   The measurement period has elapsed.
+  @retval FALSE  The measurement period is still running.
+
+**/
+BOOLEAN
+BenchmarkDone (
+  VOID
+  )
+{
+  return (BOOLEAN) (gBS->CheckEvent (mBenchmarkTimer) == EFI_SUCCESS);
+}
+
+/**
+  Print the throughput of one measurement period.
+
+  @param[in]  Name       The name of the algorithm.
+  @param[in]  Operation  The name of the operation.
+  @param[in]  Bytes      The bytes processed in the measurement period.
+
+**/
+VOID
+BenchmarkPrint (
+  IN CHAR16  *Name,
+  IN CHAR16  *Operation,
+  IN UINT64  Bytes
+  )
+{
+  Print (
+    L"- %-10s %-12s %8ld KB/s\n",
+    Name,
+    Operation,
+    DivU64x32 (MultU64x32 (Bytes, 10000000 / BENCHMARK_TIME), 1024)
+    );
+}
+
+/**
+  Measure the throughput of the digest and HMAC interfaces.
+
+  @param[in]  Buffer   Pointer to the data to hash.
+
+  @retval  EFI_SUCCESS  Measurement succeeded.
+  @retval  EFI_ABORTED  An interface failed.
+
+**/
+EFI_STATUS
+BenchmarkDigest (
+  IN UINT8  *Buffer
+  )
+{
+  UINTN    Index;
+  VOID     *Context;
+  UINT8    Value[64];
+  UINT64   Bytes;
+  BOOLEAN  Status;
+
+  for (Index = 0; Index < sizeof (mBenchmarkDigest) / sizeof (mBenchmarkDigest[0]); Index++) {
+    Context = AllocatePool (mBenchmarkDigest[Index].GetContextSize ());
+    if (Context == NULL) {
+      return EFI_ABORTED;
+    }
+
+    if (mBenchmarkDigest[Index].HashInit != NULL) {
+      Status = mBenchmarkDigest[Index].HashInit (Context);
+    } else {
+      Status = mBenchmarkDigest[Index].HmacInit (Context, mBenchmarkKey, sizeof (mBenchmarkKey));
+    }
+
+    Bytes = 0;
+    BenchmarkStart ();
+    while (Status && !BenchmarkDone ()) {
+      Status = mBenchmarkDigest[Index].Update (Context, Buffer, BENCHMARK_BUFFER_SIZE);
+      Bytes += BENCHMARK_BUFFER_SIZE;
+    }
+
+    if (Status) {
+      Status = mBenchmarkDigest[Index].Final (Context, Value);
+    }
+
+    FreePool (Context);
+    if (!Status) {
+      Print (L"- %-10s [Fail]\n", mBenchmarkDigest[Index].Name);
+      return EFI_ABORTED;
+    }
+
+    BenchmarkPrint (mBenchmarkDigest[Index].Name, L"Hash", Bytes);
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Measure the throughput of the block cipher and ARC4 interfaces.
+
+  @param[in]  Buffer   Pointer to the data to encrypt.
+  @param[in]  Output   Pointer to a buffer that receives the output.
+
+  @retval  EFI_SUCCESS  Measurement succeeded.
+  @retval  EFI_ABORTED  An interface failed.
+
+**/
+EFI_STATUS
+BenchmarkCipher (
+  IN UINT8  *Buffer,
+  IN UINT8  *Output
+  )
+{
+  UINTN    Index;
+  UINTN    Mode;
+  VOID     *Context;
+  UINT64   Bytes;
+  BOOLEAN  Status;
+
+  for (Index = 0; Index < sizeof (mBenchmarkCipher) / sizeof (mBenchmarkCipher[0]); Index++) {
+    Context = AllocatePool (mBenchmarkCipher[Index].GetContextSize ());
+    if (Context == NULL) {
+      return EFI_ABORTED;
+    }
+
+    if (mBenchmarkCipher[Index].GetContextSize == TdesGetContextSize) {
+      Status = TdesInit (Context, mBenchmarkKey, mBenchmarkCipher[Index].KeyLength);
+    } else {
+      Status = AesInit (Context, mBenchmarkKey, mBenchmarkCipher[Index].KeyLength);
+    }
+
+    for (Mode = 0; Status && Mode < 4; Mode++) {
+      Bytes = 0;
+      BenchmarkStart ();
+      while (Status && !BenchmarkDone ()) {
+        switch (Mode) {
+        case 0:
+          Status = mBenchmarkCipher[Index].EcbEncrypt (Context, Buffer, BENCHMARK_BUFFER_SIZE, Output);
+          break;
+        case 1:
+          Status = mBenchmarkCipher[Index].EcbDecrypt (Context, Buffer, BENCHMARK_BUFFER_SIZE, Output);
+          break;
+        case 2:
+          Status = mBenchmarkCipher[Index].CbcEncrypt (Context, Buffer, BENCHMARK_BUFFER_SIZE, mBenchmarkKey, Output);
+          break;
+        default:
+          Status = mBenchmarkCipher[Index].CbcDecrypt (Context, Buffer, BENCHMARK_BUFFER_SIZE, mBenchmarkKey, Output);
+          break;
+        }
+        Bytes += BENCHMARK_BUFFER_SIZE;
+      }
+
+      if (Status) {
+        BenchmarkPrint (mBenchmarkCipher[Index].Name, mBenchmarkCipherMode[Mode], Bytes);
+      }
+    }
+
+    FreePool (Context);
+    if (!Status) {
+      Print (L"- %-10s [Fail]\n", mBenchmarkCipher[Index].Name);
+      return EFI_ABORTED;
+    }
+  }
+
+  Context = AllocatePool (Arc4GetContextSize ());
+  if (Context == NULL) {
+    return EFI_ABORTED;
+  }
+
+  Status = Arc4Init (Context, mBenchmarkKey, 16);
+  Bytes  = 0;
+  BenchmarkStart ();
+  while (Status && !BenchmarkDone ()) {
+    Status = Arc4Encrypt (Context, Buffer, BENCHMARK_BUFFER_SIZE, Output);
+    Bytes += BENCHMARK_BUFFER_SIZE;
+  }
+
+  FreePool (Context);
+  if (!Status) {
+    Print (L"- %-10s [Fail]\n", L"ARC4");
+    return EFI_ABORTED;
+  }
+
+  BenchmarkPrint (L"ARC4", L"Encrypt", Bytes);
+  return EFI_SUCCESS;
+}
+
+/**
+  Measure the RSA PKCS#1 signing and verification rate.
+
+  @retval  EFI_SUCCESS  Measurement succeeded.
+  @retval  EFI_ABORTED  An interface failed.
+
+**/
+EFI_STATUS
+BenchmarkRsa (
+  VOID
+  )
+{
+  VOID     *Rsa;
+  UINT8    HashValue[SHA256_DIGEST_SIZE];
+  UINT8    Signature[BENCHMARK_RSA_BITS / 8];
+  UINTN    SigSize;
+  UINT32   Count;
+  BOOLEAN  Status;
+
+  Rsa = RsaNew ();
+  if (Rsa == NULL) {
+    return EFI_ABORTED;
+  }
+
+  ZeroMem (HashValue, sizeof (HashValue));
+  SigSize = sizeof (Signature);
+  Status  = RsaGenerateKey (Rsa, BENCHMARK_RSA_BITS, NULL, 0);
+
+  Count = 0;
+  BenchmarkStart ();
+  while (Status && !BenchmarkDone ()) {
+    SigSize = sizeof (Signature);
+    Status  = RsaPkcs1Sign (Rsa, HashValue, sizeof (HashValue), Signature, &SigSize);
+    Count++;
+  }
+
+  if (Status) {
+    Print (L"- %-10s %-12s %8d ops/s\n", L"RSA-2048", L"Sign", Count * 10000000 / BENCHMARK_TIME);
+
+    Count = 0;
+    BenchmarkStart ();
+    while (Status && !BenchmarkDone ()) {
+      Status = RsaPkcs1Verify (Rsa, HashValue, sizeof (HashValue), Signature, SigSize);
+      Count++;
+    }
+  }
+
+  RsaFree (Rsa);
+  if (!Status) {
+    Print (L"- %-10s [Fail]\n", L"RSA-2048");
+    return EFI_ABORTED;
+  }
+
+  Print (L"- %-10s %-12s %8d ops/s\n", L"RSA-2048", L"Verify", Count * 10000000 / BENCHMARK_TIME);
+  return EFI_SUCCESS;
+}
+
+/**
+  Measure the throughput of the UEFI-OpenSSL Cryptographic Interfaces.
+
+  @retval  EFI_SUCCESS  Measurement succeeded.
+  @retval  EFI_ABORTED  An interface failed.
+
+**/
+EFI_STATUS
+BenchmarkCrypt (
+  VOID
+  )
+{
+  EFI_STATUS  Status;
+  UINT8       *Buffer;
+  UINT8       *Output;
+
+  Print (L"\nUEFI-OpenSSL Throughput Measurement: \n");
+  Print (L"------------------------------------ \n");
+
+  Buffer = AllocatePool (BENCHMARK_BUFFER_SIZE);
+  Output = AllocatePool (BENCHMARK_BUFFER_SIZE);
+  if (Buffer == NULL || Output == NULL || !RandomBytes (Buffer, BENCHMARK_BUFFER_SIZE)) {
+    Status = EFI_ABORTED;
+    goto Exit;
+  }
+
+  Status = gBS->CreateEvent (EVT_TIMER, TPL_CALLBACK, NULL, NULL, &mBenchmarkTimer);
+  if (EFI_ERROR (Status)) {
+    goto Exit;
+  }
+
+  Status = BenchmarkDigest (Buffer);
+  if (!EFI_ERROR (Status)) {
+    Status = BenchmarkCipher (Buffer, Output);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = BenchmarkRsa ();
+  }
+
+  gBS->CloseEvent (mBenchmarkTimer);
+
+Exit:
+  if (Buffer != NULL) {
+    FreePool (Buffer);
+  }
+
+  if (Output != NULL) {
+    FreePool (Output);
+  }
+
+  return Status;
+}
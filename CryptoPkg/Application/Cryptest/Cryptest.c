@@ -88,5 +88,10 @@ CryptestMain (
     return Status;
   }
 
+  Status = BenchmarkCrypt ();
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
   return EFI_SUCCESS;
 }
\ No newline at end of file
@@ -21,6 +21,7 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #include <Library/MemoryAllocationLib.h>
 #include <Library/UefiLib.h>
 #include <Library/UefiApplicationEntryPoint.h>
+#include <Library/UefiBootServicesTableLib.h>
 #include <Library/DebugLib.h>
 #include <Library/BaseCryptLib.h>
 
@@ -144,4 +145,16 @@ ValidateCryptPrng (
   VOID
   );
 
+/**
+  Measure the throughput of the UEFI-OpenSSL Cryptographic Interfaces.
+
+  @retval  EFI_SUCCESS  Measurement succeeded.
+  @retval  EFI_ABORTED  An interface failed.
+
+**/
+EFI_STATUS
+BenchmarkCrypt (
+  VOID
+  );
+
 #endif
\ No newline at end of file
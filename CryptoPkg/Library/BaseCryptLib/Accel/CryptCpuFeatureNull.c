@@ -0,0 +1,179 @@
+/** @file
+  AES-NI and SHA extension code path instance for processors without them.
+
+Copyright (c) 2015, Intel Corporation. All rights reserved.<BR>
+This program and the accompanying materials
+are licensed and made available under the terms and conditions of the BSD License
+which accompanies this distribution.  The full text of the license may be found at
+http://opensource.org/licenses/bsd-license.php
+
+THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+**/
+
+#include "InternalCryptLib.h"
+
+/**
+  Checks whether the processor supports the AES-NI instructions used by
+  the InternalCryptAesNi* block functions.
+
+  @retval FALSE  The AES-NI block functions must not be called.
+
+**/
+BOOLEAN
+InternalCryptAesNiSupported (
+  VOID
+  )
+{
+  return FALSE;
+}
+
+/**
+  Checks whether the processor supports the SHA extensions used by
+  InternalCryptSha1NiTransform() and InternalCryptSha256NiTransform().
+
+  @retval FALSE  The SHA transform functions must not be called.
+
+**/
+BOOLEAN
+InternalCryptShaNiSupported (
+  VOID
+  )
+{
+  return FALSE;
+}
+
+/**
+  Encrypts whole blocks in ECB mode with the AES-NI instructions.
+
+  @param[in]   RoundKeys  The Rounds + 1 encryption round keys, in byte order.
+  @param[in]   Rounds     The number of rounds, 10, 12 or 14.
+  @param[in]   Input      Pointer to the blocks to encrypt.
+  @param[out]  Output     Pointer to a buffer that receives the encrypted blocks.
+  @param[in]   Blocks     The number of 16-byte blocks.
+
+**/
+VOID
+EFIAPI
+InternalCryptAesNiEcbEncrypt (
+  IN  CONST UINT8  *RoundKeys,
+  IN  UINTN        Rounds,
+  IN  CONST UINT8  *Input,
+  OUT UINT8        *Output,
+  IN  UINTN        Blocks
+  )
+{
+  ASSERT (FALSE);
+}
+
+/**
+  Decrypts whole blocks in ECB mode with the AES-NI instructions.
+
+  @param[in]   RoundKeys  The Rounds + 1 decryption round keys, in byte order.
+  @param[in]   Rounds     The number of rounds, 10, 12 or 14.
+  @param[in]   Input      Pointer to the blocks to decrypt.
+  @param[out]  Output     Pointer to a buffer that receives the decrypted blocks.
+  @param[in]   Blocks     The number of 16-byte blocks.
+
+**/
+VOID
+EFIAPI
+InternalCryptAesNiEcbDecrypt (
+  IN  CONST UINT8  *RoundKeys,
+  IN  UINTN        Rounds,
+  IN  CONST UINT8  *Input,
+  OUT UINT8        *Output,
+  IN  UINTN        Blocks
+  )
+{
+  ASSERT (FALSE);
+}
+
+/**
+  Encrypts whole blocks in CBC mode with the AES-NI instructions.
+
+  @param[in]   RoundKeys  The Rounds + 1 encryption round keys, in byte order.
+  @param[in]   Rounds     The number of rounds, 10, 12 or 14.
+  @param[in]   Input      Pointer to the blocks to encrypt.
+  @param[out]  Output     Pointer to a buffer that receives the encrypted blocks.
+  @param[in]   Blocks     The number of 16-byte blocks.
+  @param[in]   Ivec       Pointer to the initialization vector.
+
+**/
+VOID
+EFIAPI
+InternalCryptAesNiCbcEncrypt (
+  IN  CONST UINT8  *RoundKeys,
+  IN  UINTN        Rounds,
+  IN  CONST UINT8  *Input,
+  OUT UINT8        *Output,
+  IN  UINTN        Blocks,
+  IN  CONST UINT8  *Ivec
+  )
+{
+  ASSERT (FALSE);
+}
+
+/**
+  Decrypts whole blocks in CBC mode with the AES-NI instructions.
+
+  @param[in]   RoundKeys  The Rounds + 1 decryption round keys, in byte order.
+  @param[in]   Rounds     The number of rounds, 10, 12 or 14.
+  @param[in]   Input      Pointer to the blocks to decrypt.
+  @param[out]  Output     Pointer to a buffer that receives the decrypted blocks.
+  @param[in]   Blocks     The number of 16-byte blocks.
+  @param[in]   Ivec       Pointer to the initialization vector.
+
+**/
+VOID
+EFIAPI
+InternalCryptAesNiCbcDecrypt (
+  IN  CONST UINT8  *RoundKeys,
+  IN  UINTN        Rounds,
+  IN  CONST UINT8  *Input,
+  OUT UINT8        *Output,
+  IN  UINTN        Blocks,
+  IN  CONST UINT8  *Ivec
+  )
+{
+  ASSERT (FALSE);
+}
+
+/**
+  Hashes whole 64-byte blocks into the SHA-1 state with the SHA extensions.
+
+  @param[in, out]  State   The five SHA-1 state words.
+  @param[in]       Data    Pointer to the message blocks.
+  @param[in]       Blocks  The number of 64-byte blocks.
+
+**/
+VOID
+EFIAPI
+InternalCryptSha1NiTransform (
+  IN OUT UINT32       *State,
+  IN     CONST UINT8  *Data,
+  IN     UINTN        Blocks
+  )
+{
+  ASSERT (FALSE);
+}
+
+/**
+  Hashes whole 64-byte blocks into the SHA-256 state with the SHA extensions.
+
+  @param[in, out]  State   The eight SHA-256 state words.
+  @param[in]       Data    Pointer to the message blocks.
+  @param[in]       Blocks  The number of 64-byte blocks.
+
+**/
+VOID
+EFIAPI
+InternalCryptSha256NiTransform (
+  IN OUT UINT32       *State,
+  IN     CONST UINT8  *Data,
+  IN     UINTN        Blocks
+  )
+{
+  ASSERT (FALSE);
+}
@@ -0,0 +1,192 @@
+;------------------------------------------------------------------------------
+;
+; Copyright (c) 2015, Intel Corporation. All rights reserved.<BR>
+; This program and the accompanying materials
+; are licensed and made available under the terms and conditions of the BSD License
+; which accompanies this distribution.  The full text of the license may be found at
+; http://opensource.org/licenses/bsd-license.php.
+;
+; THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+; WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+;
+; Module Name:
+;
+;   AesNi.asm
+;
+; Abstract:
+;
+;   AES block encryption and decryption with the AES-NI instructions.
+;
+; Notes:
+;
+;   RoundKeys points to Rounds + 1 round keys of 16 bytes each, in the byte
+;   order of FIPS-197. The decryption round keys are in the order they are
+;   used, with InvMixColumns applied to all but the first and the last one.
+;
+;------------------------------------------------------------------------------
+
+    .code
+
+;------------------------------------------------------------------------------
+;  VOID
+;  EFIAPI
+;  InternalCryptAesNiEcbEncrypt (
+;    IN  CONST UINT8  *RoundKeys,
+;    IN  UINTN        Rounds,
+;    IN  CONST UINT8  *Input,
+;    OUT UINT8        *Output,
+;    IN  UINTN        Blocks
+;    )
+;------------------------------------------------------------------------------
+InternalCryptAesNiEcbEncrypt PROC
+    mov         r11, [rsp + 28h]            ; r11 = Blocks
+    test        r11, r11
+    jz          EcbEncryptDone
+EcbEncryptBlock:
+    movdqu      xmm0, [r8]
+    movdqu      xmm1, [rcx]
+    pxor        xmm0, xmm1
+    lea         rax, [rcx + 10h]
+    lea         r10, [rdx - 1]
+EcbEncryptRound:
+    movdqu      xmm1, [rax]
+    aesenc      xmm0, xmm1
+    add         rax, 10h
+    dec         r10
+    jnz         EcbEncryptRound
+    movdqu      xmm1, [rax]
+    aesenclast  xmm0, xmm1
+    movdqu      [r9], xmm0
+    add         r8, 10h
+    add         r9, 10h
+    dec         r11
+    jnz         EcbEncryptBlock
+EcbEncryptDone:
+    ret
+InternalCryptAesNiEcbEncrypt ENDP
+
+;------------------------------------------------------------------------------
+;  VOID
+;  EFIAPI
+;  InternalCryptAesNiEcbDecrypt (
+;    IN  CONST UINT8  *RoundKeys,
+;    IN  UINTN        Rounds,
+;    IN  CONST UINT8  *Input,
+;    OUT UINT8        *Output,
+;    IN  UINTN        Blocks
+;    )
+;------------------------------------------------------------------------------
+InternalCryptAesNiEcbDecrypt PROC
+    mov         r11, [rsp + 28h]            ; r11 = Blocks
+    test        r11, r11
+    jz          EcbDecryptDone
+EcbDecryptBlock:
+    movdqu      xmm0, [r8]
+    movdqu      xmm1, [rcx]
+    pxor        xmm0, xmm1
+    lea         rax, [rcx + 10h]
+    lea         r10, [rdx - 1]
+EcbDecryptRound:
+    movdqu      xmm1, [rax]
+    aesdec      xmm0, xmm1
+    add         rax, 10h
+    dec         r10
+    jnz         EcbDecryptRound
+    movdqu      xmm1, [rax]
+    aesdeclast  xmm0, xmm1
+    movdqu      [r9], xmm0
+    add         r8, 10h
+    add         r9, 10h
+    dec         r11
+    jnz         EcbDecryptBlock
+EcbDecryptDone:
+    ret
+InternalCryptAesNiEcbDecrypt ENDP
+
+;------------------------------------------------------------------------------
+;  VOID
+;  EFIAPI
+;  InternalCryptAesNiCbcEncrypt (
+;    IN  CONST UINT8  *RoundKeys,
+;    IN  UINTN        Rounds,
+;    IN  CONST UINT8  *Input,
+;    OUT UINT8        *Output,
+;    IN  UINTN        Blocks,
+;    IN  CONST UINT8  *Ivec
+;    )
+;------------------------------------------------------------------------------
+InternalCryptAesNiCbcEncrypt PROC
+    mov         r11, [rsp + 28h]            ; r11 = Blocks
+    mov         rax, [rsp + 30h]
+    movdqu      xmm0, [rax]                 ; xmm0 = Ivec
+    test        r11, r11
+    jz          CbcEncryptDone
+CbcEncryptBlock:
+    movdqu      xmm2, [r8]
+    pxor        xmm0, xmm2
+    movdqu      xmm1, [rcx]
+    pxor        xmm0, xmm1
+    lea         rax, [rcx + 10h]
+    lea         r10, [rdx - 1]
+CbcEncryptRound:
+    movdqu      xmm1, [rax]
+    aesenc      xmm0, xmm1
+    add         rax, 10h
+    dec         r10
+    jnz         CbcEncryptRound
+    movdqu      xmm1, [rax]
+    aesenclast  xmm0, xmm1
+    movdqu      [r9], xmm0                  ; the cipher block chains to the next one
+    add         r8, 10h
+    add         r9, 10h
+    dec         r11
+    jnz         CbcEncryptBlock
+CbcEncryptDone:
+    ret
+InternalCryptAesNiCbcEncrypt ENDP
+
+;------------------------------------------------------------------------------
+;  VOID
+;  EFIAPI
+;  InternalCryptAesNiCbcDecrypt (
+;    IN  CONST UINT8  *RoundKeys,
+;    IN  UINTN        Rounds,
+;    IN  CONST UINT8  *Input,
+;    OUT UINT8        *Output,
+;    IN  UINTN        Blocks,
+;    IN  CONST UINT8  *Ivec
+;    )
+;------------------------------------------------------------------------------
+InternalCryptAesNiCbcDecrypt PROC
+    mov         r11, [rsp + 28h]            ; r11 = Blocks
+    mov         rax, [rsp + 30h]
+    movdqu      xmm2, [rax]                 ; xmm2 = Ivec
+    test        r11, r11
+    jz          CbcDecryptDone
+CbcDecryptBlock:
+    movdqu      xmm0, [r8]
+    movdqa      xmm3, xmm0                  ; keep the cipher block, Input may be Output
+    movdqu      xmm1, [rcx]
+    pxor        xmm0, xmm1
+    lea         rax, [rcx + 10h]
+    lea         r10, [rdx - 1]
+CbcDecryptRound:
+    movdqu      xmm1, [rax]
+    aesdec      xmm0, xmm1
+    add         rax, 10h
+    dec         r10
+    jnz         CbcDecryptRound
+    movdqu      xmm1, [rax]
+    aesdeclast  xmm0, xmm1
+    pxor        xmm0, xmm2
+    movdqu      [r9], xmm0
+    movdqa      xmm2, xmm3
+    add         r8, 10h
+    add         r9, 10h
+    dec         r11
+    jnz         CbcDecryptBlock
+CbcDecryptDone:
+    ret
+InternalCryptAesNiCbcDecrypt ENDP
+
+    END
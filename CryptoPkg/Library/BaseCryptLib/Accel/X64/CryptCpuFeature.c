@@ -0,0 +1,100 @@
+/** @file
+  Processor feature detection for the AES-NI and SHA extension code paths.
+
+  The result of CPUID is kept in a global so that the hash and cipher
+  wrappers don't execute CPUID, which may be intercepted by a hypervisor,
+  on every call.
+
+Copyright (c) 2015, Intel Corporation. All rights reserved.<BR>
+This program and the accompanying materials
+are licensed and made available under the terms and conditions of the BSD License
+which accompanies this distribution.  The full text of the license may be found at
+http://opensource.org/licenses/bsd-license.php
+
+THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+**/
+
+#include "InternalCryptLib.h"
+
+#define CRYPT_CPU_FEATURE_DETECTED  BIT0
+#define CRYPT_CPU_FEATURE_AES_NI    BIT1
+#define CRYPT_CPU_FEATURE_SHA_NI    BIT2
+
+UINT32  mCryptCpuFeatures = 0;
+
+/**
+  Detects the processor features used by the library once.
+
+  @return The CRYPT_CPU_FEATURE_* bits of the supported features.
+
+**/
+UINT32
+CryptGetCpuFeatures (
+  VOID
+  )
+{
+  UINT32  MaxLeaf;
+  UINT32  Ebx;
+  UINT32  Ecx;
+  UINT32  Features;
+
+  if ((mCryptCpuFeatures & CRYPT_CPU_FEATURE_DETECTED) != 0) {
+    return mCryptCpuFeatures;
+  }
+
+  Features = CRYPT_CPU_FEATURE_DETECTED;
+
+  AsmCpuid (0, &MaxLeaf, NULL, NULL, NULL);
+  AsmCpuid (1, NULL, NULL, &Ecx, NULL);
+
+  if ((Ecx & BIT25) != 0) {
+    Features |= CRYPT_CPU_FEATURE_AES_NI;
+  }
+
+  //
+  // The SHA transforms also use SSSE3 and SSE4.1 instructions.
+  //
+  if (MaxLeaf >= 7 && (Ecx & (BIT9 | BIT19)) == (BIT9 | BIT19)) {
+    AsmCpuidEx (7, 0, NULL, &Ebx, NULL, NULL);
+    if ((Ebx & BIT29) != 0) {
+      Features |= CRYPT_CPU_FEATURE_SHA_NI;
+    }
+  }
+
+  mCryptCpuFeatures = Features;
+  return Features;
+}
+
+/**
+  Checks whether the processor supports the AES-NI instructions used by
+  the InternalCryptAesNi* block functions.
+
+  @retval TRUE   The AES-NI block functions can be used.
+  @retval FALSE  The AES-NI block functions must not be called.
+
+**/
+BOOLEAN
+InternalCryptAesNiSupported (
+  VOID
+  )
+{
+  return (BOOLEAN) ((CryptGetCpuFeatures () & CRYPT_CPU_FEATURE_AES_NI) != 0);
+}
+
+/**
+  Checks whether the processor supports the SHA extensions used by
+  InternalCryptSha1NiTransform() and InternalCryptSha256NiTransform().
+
+  @retval TRUE   The SHA transform functions can be used.
+  @retval FALSE  The SHA transform functions must not be called.
+
+**/
+BOOLEAN
+InternalCryptShaNiSupported (
+  VOID
+  )
+{
+  return (BOOLEAN) ((CryptGetCpuFeatures () & CRYPT_CPU_FEATURE_SHA_NI) != 0);
+}
@@ -0,0 +1,72 @@
+/** @file
+  Processor feature detection for the AES-NI and SHA extension code paths
+  in PEI phase.
+
+  A PEIM may execute in place from flash, so the result of CPUID isn't
+  kept in a global and is queried on every check.
+
+Copyright (c) 2015, Intel Corporation. All rights reserved.<BR>
+This program and the accompanying materials
+are licensed and made available under the terms and conditions of the BSD License
+which accompanies this distribution.  The full text of the license may be found at
+http://opensource.org/licenses/bsd-license.php
+
+THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+**/
+
+#include "InternalCryptLib.h"
+
+/**
+  Checks whether the processor supports the AES-NI instructions used by
+  the InternalCryptAesNi* block functions.
+
+  @retval TRUE   The AES-NI block functions can be used.
+  @retval FALSE  The AES-NI block functions must not be called.
+
+**/
+BOOLEAN
+InternalCryptAesNiSupported (
+  VOID
+  )
+{
+  UINT32  Ecx;
+
+  AsmCpuid (1, NULL, NULL, &Ecx, NULL);
+  return (BOOLEAN) ((Ecx & BIT25) != 0);
+}
+
+/**
+  Checks whether the processor supports the SHA extensions used by
+  InternalCryptSha1NiTransform() and InternalCryptSha256NiTransform().
+
+  @retval TRUE   The SHA transform functions can be used.
+  @retval FALSE  The SHA transform functions must not be called.
+
+**/
+BOOLEAN
+InternalCryptShaNiSupported (
+  VOID
+  )
+{
+  UINT32  MaxLeaf;
+  UINT32  Ebx;
+  UINT32  Ecx;
+
+  AsmCpuid (0, &MaxLeaf, NULL, NULL, NULL);
+  if (MaxLeaf < 7) {
+    return FALSE;
+  }
+
+  //
+  // The SHA transforms also use SSSE3 and SSE4.1 instructions.
+  //
+  AsmCpuid (1, NULL, NULL, &Ecx, NULL);
+  if ((Ecx & (BIT9 | BIT19)) != (BIT9 | BIT19)) {
+    return FALSE;
+  }
+
+  AsmCpuidEx (7, 0, NULL, &Ebx, NULL, NULL);
+  return (BOOLEAN) ((Ebx & BIT29) != 0);
+}
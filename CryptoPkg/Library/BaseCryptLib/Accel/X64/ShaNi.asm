@@ -0,0 +1,492 @@
+;------------------------------------------------------------------------------
+;
+; Copyright (c) 2015, Intel Corporation. All rights reserved.<BR>
+; This program and the accompanying materials
+; are licensed and made available under the terms and conditions of the BSD License
+; which accompanies this distribution.  The full text of the license may be found at
+; http://opensource.org/licenses/bsd-license.php.
+;
+; THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+; WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+;
+; Module Name:
+;
+;   ShaNi.asm
+;
+; Abstract:
+;
+;   SHA-1 and SHA-256 block transforms with the SHA extensions.
+;
+; Notes:
+;
+;   The state is the array of hash words of the OpenSSL SHA_CTX and
+;   SHA256_CTX, Data points to Blocks whole 64-byte message blocks.
+;
+;------------------------------------------------------------------------------
+
+    .const
+    ALIGN 16
+mSha1ByteFlipMask   DB      00Fh, 00Eh, 00Dh, 00Ch, 00Bh, 00Ah, 009h, 008h, 007h, 006h, 005h, 004h, 003h, 002h, 001h, 000h
+mSha256ByteFlipMask DB      003h, 002h, 001h, 000h, 007h, 006h, 005h, 004h, 00Bh, 00Ah, 009h, 008h, 00Fh, 00Eh, 00Dh, 00Ch
+mSha256K            DD      0428A2F98h, 071374491h, 0B5C0FBCFh, 0E9B5DBA5h
+                    DD      03956C25Bh, 059F111F1h, 0923F82A4h, 0AB1C5ED5h
+                    DD      0D807AA98h, 012835B01h, 0243185BEh, 0550C7DC3h
+                    DD      072BE5D74h, 080DEB1FEh, 09BDC06A7h, 0C19BF174h
+                    DD      0E49B69C1h, 0EFBE4786h, 00FC19DC6h, 0240CA1CCh
+                    DD      02DE92C6Fh, 04A7484AAh, 05CB0A9DCh, 076F988DAh
+                    DD      0983E5152h, 0A831C66Dh, 0B00327C8h, 0BF597FC7h
+                    DD      0C6E00BF3h, 0D5A79147h, 006CA6351h, 014292967h
+                    DD      027B70A85h, 02E1B2138h, 04D2C6DFCh, 053380D13h
+                    DD      0650A7354h, 0766A0ABBh, 081C2C92Eh, 092722C85h
+                    DD      0A2BFE8A1h, 0A81A664Bh, 0C24B8B70h, 0C76C51A3h
+                    DD      0D192E819h, 0D6990624h, 0F40E3585h, 0106AA070h
+                    DD      019A4C116h, 01E376C08h, 02748774Ch, 034B0BCB5h
+                    DD      0391C0CB3h, 04ED8AA4Ah, 05B9CCA4Fh, 0682E6FF3h
+                    DD      0748F82EEh, 078A5636Fh, 084C87814h, 08CC70208h
+                    DD      090BEFFFAh, 0A4506CEBh, 0BEF9A3F7h, 0C67178F2h
+
+    .code
+
+;------------------------------------------------------------------------------
+;  VOID
+;  EFIAPI
+;  InternalCryptSha1NiTransform (
+;    IN OUT UINT32       *State,
+;    IN     CONST UINT8  *Data,
+;    IN     UINTN        Blocks
+;    )
+;------------------------------------------------------------------------------
+InternalCryptSha1NiTransform PROC
+    shl         r8, 6
+    jz          Sha1Done
+    add         r8, rdx                     ; r8 = end of Data
+    sub         rsp, 048h
+    movdqa      [rsp], xmm6
+    movdqa      [rsp + 10h], xmm7
+    movdqa      [rsp + 20h], xmm8
+    movdqa      [rsp + 30h], xmm9
+
+    ; Load A-D with A in the highest dword, and E into the highest dword.
+    movdqu      xmm0, xmmword ptr [rcx]
+    pxor        xmm1, xmm1
+    pinsrd      xmm1, dword ptr [rcx+16], 3
+    pshufd      xmm0, xmm0, 01Bh
+    movdqa      xmm7, xmmword ptr mSha1ByteFlipMask
+Sha1Block:
+    movdqa      xmm8, xmm1
+    movdqa      xmm9, xmm0
+
+    ; Rounds 0-3
+    movdqu      xmm3, xmmword ptr [rdx]
+    pshufb      xmm3, xmm7
+    paddd       xmm1, xmm3
+    movdqa      xmm2, xmm0
+    sha1rnds4   xmm0, xmm1, 0
+
+    ; Rounds 4-7
+    movdqu      xmm4, xmmword ptr [rdx+16]
+    pshufb      xmm4, xmm7
+    sha1nexte   xmm2, xmm4
+    movdqa      xmm1, xmm0
+    sha1rnds4   xmm0, xmm2, 0
+    sha1msg1    xmm3, xmm4
+
+    ; Rounds 8-11
+    movdqu      xmm5, xmmword ptr [rdx+32]
+    pshufb      xmm5, xmm7
+    sha1nexte   xmm1, xmm5
+    movdqa      xmm2, xmm0
+    sha1rnds4   xmm0, xmm1, 0
+    sha1msg1    xmm4, xmm5
+    pxor        xmm3, xmm5
+
+    ; Rounds 12-15
+    movdqu      xmm6, xmmword ptr [rdx+48]
+    pshufb      xmm6, xmm7
+    sha1nexte   xmm2, xmm6
+    movdqa      xmm1, xmm0
+    sha1msg2    xmm3, xmm6
+    sha1rnds4   xmm0, xmm2, 0
+    sha1msg1    xmm5, xmm6
+    pxor        xmm4, xmm6
+
+    ; Rounds 16-19
+    sha1nexte   xmm1, xmm3
+    movdqa      xmm2, xmm0
+    sha1msg2    xmm4, xmm3
+    sha1rnds4   xmm0, xmm1, 0
+    sha1msg1    xmm6, xmm3
+    pxor        xmm5, xmm3
+
+    ; Rounds 20-23
+    sha1nexte   xmm2, xmm4
+    movdqa      xmm1, xmm0
+    sha1msg2    xmm5, xmm4
+    sha1rnds4   xmm0, xmm2, 1
+    sha1msg1    xmm3, xmm4
+    pxor        xmm6, xmm4
+
+    ; Rounds 24-27
+    sha1nexte   xmm1, xmm5
+    movdqa      xmm2, xmm0
+    sha1msg2    xmm6, xmm5
+    sha1rnds4   xmm0, xmm1, 1
+    sha1msg1    xmm4, xmm5
+    pxor        xmm3, xmm5
+
+    ; Rounds 28-31
+    sha1nexte   xmm2, xmm6
+    movdqa      xmm1, xmm0
+    sha1msg2    xmm3, xmm6
+    sha1rnds4   xmm0, xmm2, 1
+    sha1msg1    xmm5, xmm6
+    pxor        xmm4, xmm6
+
+    ; Rounds 32-35
+    sha1nexte   xmm1, xmm3
+    movdqa      xmm2, xmm0
+    sha1msg2    xmm4, xmm3
+    sha1rnds4   xmm0, xmm1, 1
+    sha1msg1    xmm6, xmm3
+    pxor        xmm5, xmm3
+
+    ; Rounds 36-39
+    sha1nexte   xmm2, xmm4
+    movdqa      xmm1, xmm0
+    sha1msg2    xmm5, xmm4
+    sha1rnds4   xmm0, xmm2, 1
+    sha1msg1    xmm3, xmm4
+    pxor        xmm6, xmm4
+
+    ; Rounds 40-43
+    sha1nexte   xmm1, xmm5
+    movdqa      xmm2, xmm0
+    sha1msg2    xmm6, xmm5
+    sha1rnds4   xmm0, xmm1, 2
+    sha1msg1    xmm4, xmm5
+    pxor        xmm3, xmm5
+
+    ; Rounds 44-47
+    sha1nexte   xmm2, xmm6
+    movdqa      xmm1, xmm0
+    sha1msg2    xmm3, xmm6
+    sha1rnds4   xmm0, xmm2, 2
+    sha1msg1    xmm5, xmm6
+    pxor        xmm4, xmm6
+
+    ; Rounds 48-51
+    sha1nexte   xmm1, xmm3
+    movdqa      xmm2, xmm0
+    sha1msg2    xmm4, xmm3
+    sha1rnds4   xmm0, xmm1, 2
+    sha1msg1    xmm6, xmm3
+    pxor        xmm5, xmm3
+
+    ; Rounds 52-55
+    sha1nexte   xmm2, xmm4
+    movdqa      xmm1, xmm0
+    sha1msg2    xmm5, xmm4
+    sha1rnds4   xmm0, xmm2, 2
+    sha1msg1    xmm3, xmm4
+    pxor        xmm6, xmm4
+
+    ; Rounds 56-59
+    sha1nexte   xmm1, xmm5
+    movdqa      xmm2, xmm0
+    sha1msg2    xmm6, xmm5
+    sha1rnds4   xmm0, xmm1, 2
+    sha1msg1    xmm4, xmm5
+    pxor        xmm3, xmm5
+
+    ; Rounds 60-63
+    sha1nexte   xmm2, xmm6
+    movdqa      xmm1, xmm0
+    sha1msg2    xmm3, xmm6
+    sha1rnds4   xmm0, xmm2, 3
+    sha1msg1    xmm5, xmm6
+    pxor        xmm4, xmm6
+
+    ; Rounds 64-67
+    sha1nexte   xmm1, xmm3
+    movdqa      xmm2, xmm0
+    sha1msg2    xmm4, xmm3
+    sha1rnds4   xmm0, xmm1, 3
+    sha1msg1    xmm6, xmm3
+    pxor        xmm5, xmm3
+
+    ; Rounds 68-71
+    sha1nexte   xmm2, xmm4
+    movdqa      xmm1, xmm0
+    sha1msg2    xmm5, xmm4
+    sha1rnds4   xmm0, xmm2, 3
+    pxor        xmm6, xmm4
+
+    ; Rounds 72-75
+    sha1nexte   xmm1, xmm5
+    movdqa      xmm2, xmm0
+    sha1msg2    xmm6, xmm5
+    sha1rnds4   xmm0, xmm1, 3
+
+    ; Rounds 76-79
+    sha1nexte   xmm2, xmm6
+    movdqa      xmm1, xmm0
+    sha1rnds4   xmm0, xmm2, 3
+    sha1nexte   xmm1, xmm8
+    paddd       xmm0, xmm9
+    add         rdx, 64
+    cmp         rdx, r8
+    jne         Sha1Block
+
+    ; Store the state.
+    pshufd      xmm0, xmm0, 01Bh
+    movdqu      xmmword ptr [rcx], xmm0
+    pextrd      dword ptr [rcx+16], xmm1, 3
+
+    movdqa      xmm6, [rsp]
+    movdqa      xmm7, [rsp + 10h]
+    movdqa      xmm8, [rsp + 20h]
+    movdqa      xmm9, [rsp + 30h]
+    add         rsp, 048h
+Sha1Done:
+    ret
+InternalCryptSha1NiTransform ENDP
+
+;------------------------------------------------------------------------------
+;  VOID
+;  EFIAPI
+;  InternalCryptSha256NiTransform (
+;    IN OUT UINT32       *State,
+;    IN     CONST UINT8  *Data,
+;    IN     UINTN        Blocks
+;    )
+;------------------------------------------------------------------------------
+InternalCryptSha256NiTransform PROC
+    shl         r8, 6
+    jz          Sha256Done
+    add         r8, rdx                     ; r8 = end of Data
+    sub         rsp, 058h
+    movdqa      [rsp], xmm6
+    movdqa      [rsp + 10h], xmm7
+    movdqa      [rsp + 20h], xmm8
+    movdqa      [rsp + 30h], xmm9
+    movdqa      [rsp + 40h], xmm10
+
+    ; Convert the state from ABCD/EFGH to ABEF/CDGH order.
+    movdqu      xmm1, xmmword ptr [rcx]
+    movdqu      xmm2, xmmword ptr [rcx+16]
+    pshufd      xmm1, xmm1, 0B1h
+    pshufd      xmm2, xmm2, 01Bh
+    movdqa      xmm7, xmm1
+    palignr     xmm1, xmm2, 8
+    pblendw     xmm2, xmm7, 0F0h
+    movdqa      xmm8, xmmword ptr mSha256ByteFlipMask
+    lea         rax, mSha256K
+Sha256Block:
+    movdqa      xmm9, xmm1
+    movdqa      xmm10, xmm2
+
+    ; Rounds 0-3
+    movdqu      xmm0, xmmword ptr [rdx]
+    pshufb      xmm0, xmm8
+    movdqa      xmm3, xmm0
+    paddd       xmm0, xmmword ptr [rax]
+    sha256rnds2 xmm2, xmm1
+    pshufd      xmm0, xmm0, 0Eh
+    sha256rnds2 xmm1, xmm2
+
+    ; Rounds 4-7
+    movdqu      xmm0, xmmword ptr [rdx+16]
+    pshufb      xmm0, xmm8
+    movdqa      xmm4, xmm0
+    paddd       xmm0, xmmword ptr [rax+16]
+    sha256rnds2 xmm2, xmm1
+    pshufd      xmm0, xmm0, 0Eh
+    sha256rnds2 xmm1, xmm2
+    sha256msg1  xmm3, xmm4
+
+    ; Rounds 8-11
+    movdqu      xmm0, xmmword ptr [rdx+32]
+    pshufb      xmm0, xmm8
+    movdqa      xmm5, xmm0
+    paddd       xmm0, xmmword ptr [rax+32]
+    sha256rnds2 xmm2, xmm1
+    pshufd      xmm0, xmm0, 0Eh
+    sha256rnds2 xmm1, xmm2
+    sha256msg1  xmm4, xmm5
+
+    ; Rounds 12-15
+    movdqu      xmm0, xmmword ptr [rdx+48]
+    pshufb      xmm0, xmm8
+    movdqa      xmm6, xmm0
+    paddd       xmm0, xmmword ptr [rax+48]
+    sha256rnds2 xmm2, xmm1
+    movdqa      xmm7, xmm6
+    palignr     xmm7, xmm5, 4
+    paddd       xmm3, xmm7
+    sha256msg2  xmm3, xmm6
+    pshufd      xmm0, xmm0, 0Eh
+    sha256rnds2 xmm1, xmm2
+    sha256msg1  xmm5, xmm6
+
+    ; Rounds 16-19
+    movdqa      xmm0, xmm3
+    paddd       xmm0, xmmword ptr [rax+64]
+    sha256rnds2 xmm2, xmm1
+    movdqa      xmm7, xmm3
+    palignr     xmm7, xmm6, 4
+    paddd       xmm4, xmm7
+    sha256msg2  xmm4, xmm3
+    pshufd      xmm0, xmm0, 0Eh
+    sha256rnds2 xmm1, xmm2
+    sha256msg1  xmm6, xmm3
+
+    ; Rounds 20-23
+    movdqa      xmm0, xmm4
+    paddd       xmm0, xmmword ptr [rax+80]
+    sha256rnds2 xmm2, xmm1
+    movdqa      xmm7, xmm4
+    palignr     xmm7, xmm3, 4
+    paddd       xmm5, xmm7
+    sha256msg2  xmm5, xmm4
+    pshufd      xmm0, xmm0, 0Eh
+    sha256rnds2 xmm1, xmm2
+    sha256msg1  xmm3, xmm4
+
+    ; Rounds 24-27
+    movdqa      xmm0, xmm5
+    paddd       xmm0, xmmword ptr [rax+96]
+    sha256rnds2 xmm2, xmm1
+    movdqa      xmm7, xmm5
+    palignr     xmm7, xmm4, 4
+    paddd       xmm6, xmm7
+    sha256msg2  xmm6, xmm5
+    pshufd      xmm0, xmm0, 0Eh
+    sha256rnds2 xmm1, xmm2
+    sha256msg1  xmm4, xmm5
+
+    ; Rounds 28-31
+    movdqa      xmm0, xmm6
+    paddd       xmm0, xmmword ptr [rax+112]
+    sha256rnds2 xmm2, xmm1
+    movdqa      xmm7, xmm6
+    palignr     xmm7, xmm5, 4
+    paddd       xmm3, xmm7
+    sha256msg2  xmm3, xmm6
+    pshufd      xmm0, xmm0, 0Eh
+    sha256rnds2 xmm1, xmm2
+    sha256msg1  xmm5, xmm6
+
+    ; Rounds 32-35
+    movdqa      xmm0, xmm3
+    paddd       xmm0, xmmword ptr [rax+128]
+    sha256rnds2 xmm2, xmm1
+    movdqa      xmm7, xmm3
+    palignr     xmm7, xmm6, 4
+    paddd       xmm4, xmm7
+    sha256msg2  xmm4, xmm3
+    pshufd      xmm0, xmm0, 0Eh
+    sha256rnds2 xmm1, xmm2
+    sha256msg1  xmm6, xmm3
+
+    ; Rounds 36-39
+    movdqa      xmm0, xmm4
+    paddd       xmm0, xmmword ptr [rax+144]
+    sha256rnds2 xmm2, xmm1
+    movdqa      xmm7, xmm4
+    palignr     xmm7, xmm3, 4
+    paddd       xmm5, xmm7
+    sha256msg2  xmm5, xmm4
+    pshufd      xmm0, xmm0, 0Eh
+    sha256rnds2 xmm1, xmm2
+    sha256msg1  xmm3, xmm4
+
+    ; Rounds 40-43
+    movdqa      xmm0, xmm5
+    paddd       xmm0, xmmword ptr [rax+160]
+    sha256rnds2 xmm2, xmm1
+    movdqa      xmm7, xmm5
+    palignr     xmm7, xmm4, 4
+    paddd       xmm6, xmm7
+    sha256msg2  xmm6, xmm5
+    pshufd      xmm0, xmm0, 0Eh
+    sha256rnds2 xmm1, xmm2
+    sha256msg1  xmm4, xmm5
+
+    ; Rounds 44-47
+    movdqa      xmm0, xmm6
+    paddd       xmm0, xmmword ptr [rax+176]
+    sha256rnds2 xmm2, xmm1
+    movdqa      xmm7, xmm6
+    palignr     xmm7, xmm5, 4
+    paddd       xmm3, xmm7
+    sha256msg2  xmm3, xmm6
+    pshufd      xmm0, xmm0, 0Eh
+    sha256rnds2 xmm1, xmm2
+    sha256msg1  xmm5, xmm6
+
+    ; Rounds 48-51
+    movdqa      xmm0, xmm3
+    paddd       xmm0, xmmword ptr [rax+192]
+    sha256rnds2 xmm2, xmm1
+    movdqa      xmm7, xmm3
+    palignr     xmm7, xmm6, 4
+    paddd       xmm4, xmm7
+    sha256msg2  xmm4, xmm3
+    pshufd      xmm0, xmm0, 0Eh
+    sha256rnds2 xmm1, xmm2
+    sha256msg1  xmm6, xmm3
+
+    ; Rounds 52-55
+    movdqa      xmm0, xmm4
+    paddd       xmm0, xmmword ptr [rax+208]
+    sha256rnds2 xmm2, xmm1
+    movdqa      xmm7, xmm4
+    palignr     xmm7, xmm3, 4
+    paddd       xmm5, xmm7
+    sha256msg2  xmm5, xmm4
+    pshufd      xmm0, xmm0, 0Eh
+    sha256rnds2 xmm1, xmm2
+
+    ; Rounds 56-59
+    movdqa      xmm0, xmm5
+    paddd       xmm0, xmmword ptr [rax+224]
+    sha256rnds2 xmm2, xmm1
+    movdqa      xmm7, xmm5
+    palignr     xmm7, xmm4, 4
+    paddd       xmm6, xmm7
+    sha256msg2  xmm6, xmm5
+    pshufd      xmm0, xmm0, 0Eh
+    sha256rnds2 xmm1, xmm2
+
+    ; Rounds 60-63
+    movdqa      xmm0, xmm6
+    paddd       xmm0, xmmword ptr [rax+240]
+    sha256rnds2 xmm2, xmm1
+    pshufd      xmm0, xmm0, 0Eh
+    sha256rnds2 xmm1, xmm2
+    paddd       xmm1, xmm9
+    paddd       xmm2, xmm10
+    add         rdx, 64
+    cmp         rdx, r8
+    jne         Sha256Block
+
+    ; Convert the state back to ABCD/EFGH order.
+    pshufd      xmm1, xmm1, 01Bh
+    pshufd      xmm2, xmm2, 0B1h
+    movdqa      xmm7, xmm1
+    pblendw     xmm1, xmm2, 0F0h
+    palignr     xmm2, xmm7, 8
+    movdqu      xmmword ptr [rcx], xmm1
+    movdqu      xmmword ptr [rcx+16], xmm2
+
+    movdqa      xmm6, [rsp]
+    movdqa      xmm7, [rsp + 10h]
+    movdqa      xmm8, [rsp + 20h]
+    movdqa      xmm9, [rsp + 30h]
+    movdqa      xmm10, [rsp + 40h]
+    add         rsp, 058h
+Sha256Done:
+    ret
+InternalCryptSha256NiTransform ENDP
+
+    END
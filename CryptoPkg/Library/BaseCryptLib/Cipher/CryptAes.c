@@ -15,6 +15,29 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #include "InternalCryptLib.h"
 #include <openssl/aes.h>
 
+/**
+  Converts a key schedule set up by OpenSSL to the byte order used by the
+  AES-NI instructions.
+
+  OpenSSL keeps each word of the round keys as a big-endian integer. Its
+  decryption key schedule is already the one of the equivalent inverse
+  cipher, which is what AESDEC expects.
+
+  @param[in, out]  AesKey  Pointer to the key schedule to convert.
+
+**/
+VOID
+AesKeyToAesNi (
+  IN OUT AES_KEY  *AesKey
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < 4 * ((UINTN) AesKey->rounds + 1); Index++) {
+    AesKey->rd_key[Index] = SwapBytes32 ((UINT32) AesKey->rd_key[Index]);
+  }
+}
+
 /**
   Retrieves the size, in bytes, of the context buffer required for AES operations.
 
@@ -41,6 +64,8 @@ AesGetContextSize (
   In addition, it sets up all AES key materials for subsequent encryption and decryption
   operations.
   There are 3 options for key length, 128 bits, 192 bits, and 256 bits.
+  The key materials are kept in the format of the AES-NI instructions if the
+  processor supports them.
 
   If AesContext is NULL, then return FALSE.
   If Key is NULL, then return FALSE.
@@ -81,6 +106,11 @@ AesInit (
   if (AES_set_decrypt_key (Key, (UINT32) KeyLength, AesKey + 1) != 0) {
     return FALSE;
   }
+
+  if (InternalCryptAesNiSupported ()) {
+    AesKeyToAesNi (AesKey);
+    AesKeyToAesNi (AesKey + 1);
+  }
   return TRUE;
 }
 
@@ -128,6 +158,17 @@ AesEcbEncrypt (
   
   AesKey = (AES_KEY *) AesContext;
 
+  if (InternalCryptAesNiSupported ()) {
+    InternalCryptAesNiEcbEncrypt (
+      (UINT8 *) AesKey->rd_key,
+      (UINTN) AesKey->rounds,
+      Input,
+      Output,
+      InputSize / AES_BLOCK_SIZE
+      );
+    return TRUE;
+  }
+
   //
   // Perform AES data encryption with ECB mode (block-by-block)
   //
@@ -185,6 +226,17 @@ AesEcbDecrypt (
 
   AesKey = (AES_KEY *) AesContext;
 
+  if (InternalCryptAesNiSupported ()) {
+    InternalCryptAesNiEcbDecrypt (
+      (UINT8 *) (AesKey + 1)->rd_key,
+      (UINTN) (AesKey + 1)->rounds,
+      Input,
+      Output,
+      InputSize / AES_BLOCK_SIZE
+      );
+    return TRUE;
+  }
+
   //
   // Perform AES data decryption with ECB mode (block-by-block)
   //
@@ -250,6 +302,19 @@ AesCbcEncrypt (
   }
 
   AesKey = (AES_KEY *) AesContext;
+
+  if (InternalCryptAesNiSupported ()) {
+    InternalCryptAesNiCbcEncrypt (
+      (UINT8 *) AesKey->rd_key,
+      (UINTN) AesKey->rounds,
+      Input,
+      Output,
+      InputSize / AES_BLOCK_SIZE,
+      Ivec
+      );
+    return TRUE;
+  }
+
   CopyMem (IvecBuffer, Ivec, AES_BLOCK_SIZE);
 
   //
@@ -312,6 +377,19 @@ AesCbcDecrypt (
   }
 
   AesKey = (AES_KEY *) AesContext;
+
+  if (InternalCryptAesNiSupported ()) {
+    InternalCryptAesNiCbcDecrypt (
+      (UINT8 *) (AesKey + 1)->rd_key,
+      (UINTN) (AesKey + 1)->rounds,
+      Input,
+      Output,
+      InputSize / AES_BLOCK_SIZE,
+      Ivec
+      );
+    return TRUE;
+  }
+
   CopyMem (IvecBuffer, Ivec, AES_BLOCK_SIZE);
 
   //
@@ -123,6 +123,10 @@ Sha1Update (
   IN      UINTN       DataSize
   )
 {
+  SHA_CTX     *Context;
+  UINTN       Length;
+  UINT64      Bits;
+
   //
   // Check input parameters.
   //
@@ -137,10 +141,42 @@ Sha1Update (
     return FALSE;
   }
 
+  Context = (SHA_CTX *) Sha1Context;
+
+  if (DataSize >= SHA_CBLOCK && InternalCryptShaNiSupported ()) {
+    //
+    // Complete the partial block buffered by OpenSSL, hash the whole blocks
+    // with the SHA extensions and leave the rest to OpenSSL.
+    //
+    if (Context->num != 0) {
+      Length = SHA_CBLOCK - Context->num;
+      if (!SHA1_Update (Context, Data, Length)) {
+        return FALSE;
+      }
+      Data      = (CONST UINT8 *) Data + Length;
+      DataSize -= Length;
+    }
+
+    Length = DataSize - DataSize % SHA_CBLOCK;
+    if (Length != 0) {
+      InternalCryptSha1NiTransform ((UINT32 *) &Context->h0, Data, Length / SHA_CBLOCK);
+
+      Bits = LShiftU64 (Length, 3);
+      if (Context->Nl + (UINT32) Bits < Context->Nl) {
+        Context->Nh++;
+      }
+      Context->Nl += (UINT32) Bits;
+      Context->Nh += (UINT32) RShiftU64 (Bits, 32);
+
+      Data      = (CONST UINT8 *) Data + Length;
+      DataSize -= Length;
+    }
+  }
+
   //
   // OpenSSL SHA-1 Hash Update
   //
-  return (BOOLEAN) (SHA1_Update ((SHA_CTX *) Sha1Context, Data, DataSize));
+  return (BOOLEAN) (SHA1_Update (Context, Data, DataSize));
 }
 
 /**
@@ -122,6 +122,10 @@ Sha256Update (
   IN      UINTN       DataSize
   )
 {
+  SHA256_CTX  *Context;
+  UINTN       Length;
+  UINT64      Bits;
+
   //
   // Check input parameters.
   //
@@ -136,10 +140,42 @@ Sha256Update (
     return FALSE;
   }
 
+  Context = (SHA256_CTX *) Sha256Context;
+
+  if (DataSize >= SHA256_CBLOCK && InternalCryptShaNiSupported ()) {
+    //
+    // Complete the partial block buffered by OpenSSL, hash the whole blocks
+    // with the SHA extensions and leave the rest to OpenSSL.
+    //
+    if (Context->num != 0) {
+      Length = SHA256_CBLOCK - Context->num;
+      if (!SHA256_Update (Context, Data, Length)) {
+        return FALSE;
+      }
+      Data      = (CONST UINT8 *) Data + Length;
+      DataSize -= Length;
+    }
+
+    Length = DataSize - DataSize % SHA256_CBLOCK;
+    if (Length != 0) {
+      InternalCryptSha256NiTransform ((UINT32 *) Context->h, Data, Length / SHA256_CBLOCK);
+
+      Bits = LShiftU64 (Length, 3);
+      if (Context->Nl + (UINT32) Bits < Context->Nl) {
+        Context->Nh++;
+      }
+      Context->Nl += (UINT32) Bits;
+      Context->Nh += (UINT32) RShiftU64 (Bits, 32);
+
+      Data      = (CONST UINT8 *) Data + Length;
+      DataSize -= Length;
+    }
+  }
+
   //
   // OpenSSL SHA-256 Hash Update
   //
-  return (BOOLEAN) (SHA256_Update ((SHA256_CTX *) Sha256Context, Data, DataSize));
+  return (BOOLEAN) (SHA256_Update (Context, Data, DataSize));
 }
 
 /**
@@ -29,7 +29,16 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #define LZMAF86_CUSTOM_DECOMPRESS_GUID  \
   { 0xD42AE6BD, 0x1352, 0x4bfb, { 0x90, 0x9A, 0xCA, 0x72, 0xA6, 0xEA, 0xE8, 0x89 } }
 
+///
+/// The Global ID used to identify a section of an FFS file of type 
+/// EFI_SECTION_GUID_DEFINED, whose contents have been compressed using LZMA
+/// in independent blocks.
+///
+#define LZMA_BLOCK_CUSTOM_DECOMPRESS_GUID  \
+  { 0x3A3C1E8B, 0x5B6D, 0x4C1F, { 0x9E, 0x27, 0x61, 0xD4, 0x0B, 0x8A, 0xC5, 0x72 } }
+
 extern GUID gLzmaCustomDecompressGuid;
 extern GUID gLzmaF86CustomDecompressGuid;
+extern GUID gLzmaBlockCustomDecompressGuid;
 
 #endif
@@ -218,3 +218,148 @@ LzmaUefiDecompress (
   }
 }
 
+/**
+  Validate the header of a source buffer in the LZMA block format.
+
+  @param  Source      The source buffer containing the compressed data.
+  @param  SourceSize  The size of source buffer.
+
+  @retval TRUE        The header is valid.
+  @retval FALSE       The source buffer is not in the LZMA block format.
+**/
+BOOLEAN
+IsValidLzmaBlockHeader (
+  IN CONST VOID  *Source,
+  IN UINTN       SourceSize
+  )
+{
+  UINT32  BlockSize;
+  UINT64  UncompressedSize;
+  UINT32  NumberOfBlocks;
+
+  if (SourceSize < sizeof (LZMA_BLOCK_HEADER) ||
+      ReadUnaligned32 (&((LZMA_BLOCK_HEADER *) Source)->Signature) != LZMA_BLOCK_SIGNATURE) {
+    return FALSE;
+  }
+
+  BlockSize        = ReadUnaligned32 (&((LZMA_BLOCK_HEADER *) Source)->BlockSize);
+  UncompressedSize = ReadUnaligned64 (&((LZMA_BLOCK_HEADER *) Source)->UncompressedSize);
+  NumberOfBlocks   = ReadUnaligned32 (&((LZMA_BLOCK_HEADER *) Source)->NumberOfBlocks);
+
+  if (BlockSize == 0 || UncompressedSize > MAX_UINT32) {
+    return FALSE;
+  }
+
+  if (DivU64x32 (UncompressedSize + BlockSize - 1, BlockSize) != NumberOfBlocks) {
+    return FALSE;
+  }
+
+  return (BOOLEAN) ((SourceSize - sizeof (LZMA_BLOCK_HEADER)) / sizeof (UINT32) >= NumberOfBlocks);
+}
+
+/**
+  Given a source buffer in the LZMA block format, this function retrieves the
+  size of the uncompressed buffer and the size of the scratch buffer required
+  to decompress the source buffer.
+
+  @param  Source          The source buffer containing the compressed data.
+  @param  SourceSize      The size, in bytes, of the source buffer.
+  @param  DestinationSize A pointer to the size, in bytes, of the uncompressed buffer.
+  @param  ScratchSize     A pointer to the size, in bytes, of the scratch buffer.
+
+  @retval  RETURN_SUCCESS           The sizes were returned.
+  @retval  RETURN_INVALID_PARAMETER The source buffer is not in the LZMA block format.
+
+**/
+RETURN_STATUS
+EFIAPI
+LzmaUefiDecompressBlocksGetInfo (
+  IN  CONST VOID  *Source,
+  IN  UINT32      SourceSize,
+  OUT UINT32      *DestinationSize,
+  OUT UINT32      *ScratchSize
+  )
+{
+  if (!IsValidLzmaBlockHeader (Source, SourceSize)) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  *DestinationSize = (UINT32) ReadUnaligned64 (&((LZMA_BLOCK_HEADER *) Source)->UncompressedSize);
+  //
+  // The blocks are decoded one after the other, reusing the scratch buffer.
+  //
+  *ScratchSize = SCRATCH_BUFFER_REQUEST_SIZE;
+  return RETURN_SUCCESS;
+}
+
+/**
+  Decompresses a source buffer in the LZMA block format, one block after the
+  other.
+
+  @param  Source      The source buffer containing the compressed data.
+  @param  SourceSize  The size of source buffer.
+  @param  Destination The destination buffer to store the decompressed data
+  @param  Scratch     A temporary scratch buffer that is used to perform the decompression.
+
+  @retval  RETURN_SUCCESS           Decompression completed successfully.
+  @retval  RETURN_INVALID_PARAMETER The source buffer is corrupted.
+**/
+RETURN_STATUS
+EFIAPI
+LzmaUefiDecompressBlocks (
+  IN CONST VOID  *Source,
+  IN UINTN       SourceSize,
+  IN OUT VOID    *Destination,
+  IN OUT VOID    *Scratch
+  )
+{
+  RETURN_STATUS  Status;
+  UINT32         BlockSize;
+  UINT32         UncompressedSize;
+  UINT32         NumberOfBlocks;
+  UINT32         *CompressedSize;
+  UINT8          *Block;
+  UINTN          Remaining;
+  UINT32         Offset;
+  UINT32         Size;
+  UINT32         Index;
+
+  if (!IsValidLzmaBlockHeader (Source, SourceSize)) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  BlockSize        = ReadUnaligned32 (&((LZMA_BLOCK_HEADER *) Source)->BlockSize);
+  UncompressedSize = (UINT32) ReadUnaligned64 (&((LZMA_BLOCK_HEADER *) Source)->UncompressedSize);
+  NumberOfBlocks   = ReadUnaligned32 (&((LZMA_BLOCK_HEADER *) Source)->NumberOfBlocks);
+  CompressedSize   = (UINT32 *) ((UINT8 *) Source + sizeof (LZMA_BLOCK_HEADER));
+
+  Block     = (UINT8 *) (CompressedSize + NumberOfBlocks);
+  Remaining = SourceSize - (Block - (UINT8 *) Source);
+  Offset    = 0;
+
+  for (Index = 0; Index < NumberOfBlocks; Index++) {
+    Size = ReadUnaligned32 (&CompressedSize[Index]);
+    if (Size < LZMA_HEADER_SIZE || Size > Remaining) {
+      return RETURN_INVALID_PARAMETER;
+    }
+
+    //
+    // Each block must decode to exactly its share of the destination.
+    //
+    if (GetDecodedSizeOfBuf (Block) != MIN (BlockSize, UncompressedSize - Offset)) {
+      return RETURN_INVALID_PARAMETER;
+    }
+
+    Status = LzmaUefiDecompress (Block, Size, (UINT8 *) Destination + Offset, Scratch);
+    if (RETURN_ERROR (Status)) {
+      return Status;
+    }
+
+    Block     += Size;
+    Remaining -= Size;
+    Offset    += MIN (BlockSize, UncompressedSize - Offset);
+  }
+
+  return RETURN_SUCCESS;
+}
+
@@ -22,6 +22,23 @@
 #include <Library/ExtractGuidedSectionLib.h>
 #include <Guid/LzmaDecompress.h>
 
+#define LZMA_BLOCK_SIGNATURE  SIGNATURE_32 (0xFF, 'Z', 'B', 'K')
+
+//
+// Header of the LZMA block format, followed by the compressed size of each
+// block and then the blocks. Each block is a complete LZMA stream with its
+// own LZMA header, and all of them but the last decode to BlockSize bytes.
+//
+#pragma pack(1)
+typedef struct {
+  UINT32  Signature;
+  UINT32  BlockSize;
+  UINT64  UncompressedSize;
+  UINT32  NumberOfBlocks;
+//UINT32  CompressedSize[NumberOfBlocks];
+} LZMA_BLOCK_HEADER;
+#pragma pack()
+
 /**
   Given a Lzma compressed source buffer, this function retrieves the size of 
   the uncompressed buffer and the size of the scratch buffer required 
@@ -92,5 +109,49 @@ LzmaUefiDecompress (
   IN OUT VOID    *Scratch
   );
 
+/**
+  Given a source buffer in the LZMA block format, this function retrieves the
+  size of the uncompressed buffer and the size of the scratch buffer required
+  to decompress the source buffer.
+
+  @param  Source          The source buffer containing the compressed data.
+  @param  SourceSize      The size, in bytes, of the source buffer.
+  @param  DestinationSize A pointer to the size, in bytes, of the uncompressed buffer.
+  @param  ScratchSize     A pointer to the size, in bytes, of the scratch buffer.
+
+  @retval  RETURN_SUCCESS           The sizes were returned.
+  @retval  RETURN_INVALID_PARAMETER The source buffer is not in the LZMA block format.
+
+**/
+RETURN_STATUS
+EFIAPI
+LzmaUefiDecompressBlocksGetInfo (
+  IN  CONST VOID  *Source,
+  IN  UINT32      SourceSize,
+  OUT UINT32      *DestinationSize,
+  OUT UINT32      *ScratchSize
+  );
+
+/**
+  Decompresses a source buffer in the LZMA block format, one block after the
+  other.
+
+  @param  Source      The source buffer containing the compressed data.
+  @param  SourceSize  The size of source buffer.
+  @param  Destination The destination buffer to store the decompressed data
+  @param  Scratch     A temporary scratch buffer that is used to perform the decompression.
+
+  @retval  RETURN_SUCCESS           Decompression completed successfully.
+  @retval  RETURN_INVALID_PARAMETER The source buffer is corrupted.
+**/
+RETURN_STATUS
+EFIAPI
+LzmaUefiDecompressBlocks (
+  IN CONST VOID  *Source,
+  IN UINTN       SourceSize,
+  IN OUT VOID    *Destination,
+  IN OUT VOID    *Scratch
+  );
+
 #endif
 
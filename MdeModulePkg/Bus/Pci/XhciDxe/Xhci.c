@@ -1181,6 +1181,13 @@ XhcBulkTransfer (
     return EFI_INVALID_PARAMETER;
   }
 
+  //
+  // The whole transfer has to fit in the transfer ring of the endpoint
+  //
+  if (*DataLength > XHC_MAX_BULK_TRANSFER_SIZE) {
+    return EFI_INVALID_PARAMETER;
+  }
+
   if ((*DataToggle != 0) && (*DataToggle != 1)) {
     return EFI_INVALID_PARAMETER;
   }
@@ -1412,6 +1419,7 @@ XhcAsyncInterruptTransfer (
   }
 
   InsertHeadList (&Xhc->AsyncIntTransfers, &Urb->UrbList);
+  XhcLinkAsyncIntUrb (Xhc, Urb);
   //
   // Ring the doorbell
   //
@@ -1788,6 +1796,7 @@ XhcCreateUsbHc (
   CopyMem (&Xhc->Usb2Hc, &gXhciUsb2HcTemplate, sizeof (EFI_USB2_HC_PROTOCOL));
 
   InitializeListHead (&Xhc->AsyncIntTransfers);
+  Xhc->PollInterval = XHC_ASYNC_TIMER_INTERVAL;
 
   //
   // Be caution that the Offset passed to XhcReadCapReg() should be Dword align
@@ -2017,7 +2026,7 @@ XhcDriverBindingStart (
   //
   // Start the asynchronous interrupt monitor
   //
-  Status = gBS->SetTimer (Xhc->PollTimer, TimerPeriodic, XHC_ASYNC_TIMER_INTERVAL);
+  Status = gBS->SetTimer (Xhc->PollTimer, TimerPeriodic, Xhc->PollInterval);
   if (EFI_ERROR (Status)) {
     DEBUG ((EFI_D_ERROR, "XhcDriverBindingStart: failed to start async interrupt monitor\n"));
     XhcHaltHC (Xhc, XHC_GENERIC_TIMEOUT);
@@ -70,6 +70,16 @@ typedef struct _USB_DEV_CONTEXT      USB_DEV_CONTEXT;
 // The unit is 100us, takes 50ms as interval.
 //
 #define XHC_ASYNC_TIMER_INTERVAL     EFI_TIMER_PERIOD_MILLISECONDS(50)
+//
+// The async transfer timer adapts its interval to the interrupt traffic.
+// Any completed transfer tightens it to the minimum so that input is
+// picked up quickly; every XHC_ASYNC_TIMER_IDLE_TICKS ticks without a
+// completion double it, up to the maximum, to cut the polling cost while
+// keyboards, mice and hubs sit idle.
+//
+#define XHC_ASYNC_TIMER_MIN_INTERVAL EFI_TIMER_PERIOD_MILLISECONDS(10)
+#define XHC_ASYNC_TIMER_MAX_INTERVAL EFI_TIMER_PERIOD_MILLISECONDS(100)
+#define XHC_ASYNC_TIMER_IDLE_TICKS   16
 
 //
 // XHC raises TPL to TPL_NOTIFY to serialize all its operations
@@ -79,9 +89,19 @@ typedef struct _USB_DEV_CONTEXT      USB_DEV_CONTEXT;
 
 #define CMD_RING_TRB_NUMBER          0x100
 #define TR_RING_TRB_NUMBER           0x100
+#define BULK_RING_TRB_NUMBER         0x400
 #define ERST_NUMBER                  0x01
 #define EVENT_RING_TRB_NUMBER        0x200
 
+//
+// A bulk transfer is queued as TDs of at most XHC_BULK_TD_TRB_NUMBER normal
+// TRBs, each TRB carrying at most 64KB without crossing a 64KB boundary. The
+// largest bulk transfer leaves room in the ring for the link TRB and the
+// free TRB the enqueue pointer rests on.
+//
+#define XHC_BULK_TD_TRB_NUMBER       4
+#define XHC_MAX_BULK_TRANSFER_SIZE   ((BULK_RING_TRB_NUMBER - 3) * SIZE_64KB)
+
 #define CMD_INTER                    0
 #define CTRL_INTER                   1
 #define BULK_INTER                   2
@@ -185,6 +205,11 @@ struct _USB_DEV_CONTEXT {
   //
   VOID                      *EndpointTransferRing[31];
   //
+  // The asynchronous interrupt URB of every endpoint. It's used to map a
+  // transfer event back to its URB without walking the async transfer list.
+  //
+  VOID                      *AsyncIntUrb[31];
+  //
   // The device descriptor which is stored to support XHCI's Evaluate_Context cmd.
   //
   EFI_USB_DEVICE_DESCRIPTOR DevDesc;
@@ -223,6 +248,15 @@ struct _USB_XHCI_INSTANCE {
   EFI_EVENT                 ExitBootServiceEvent;
   EFI_EVENT                 PollTimer;
   LIST_ENTRY                AsyncIntTransfers;
+  //
+  // Adaptive polling state and per-tick cost statistics of the
+  // asynchronous interrupt monitor.
+  //
+  UINT64                    PollInterval;
+  UINTN                     PollIdleTicks;
+  UINT64                    PollTicks;        ///< Timer ticks handled
+  UINT64                    PollUrbChecks;    ///< URBs checked in all ticks
+  UINT64                    PollCompletions;  ///< URBs completed in all ticks
 
   UINT8                     CapLength;    ///< Capability Register Length
   XHC_HCSPARAMS1            HcSParams1;   ///< Structural Parameters 1
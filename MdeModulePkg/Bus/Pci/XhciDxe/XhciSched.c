@@ -233,6 +233,8 @@ XhcCreateTransferTrb (
   UINTN                         TotalLen;
   UINTN                         Len;
   UINTN                         TrbNum;
+  UINTN                         TdTrbNum;
+  BOOLEAN                       TdEnd;
   EFI_PCI_IO_PROTOCOL_OPERATION MapOp;
   EFI_PHYSICAL_ADDRESS          PhyAddr;
   VOID                          *Map;
@@ -374,16 +376,27 @@ XhcCreateTransferTrb (
 
     case ED_BULK_OUT:
     case ED_BULK_IN:
+      //
+      // The TRBs of a TD are chained and only the last one interrupts. All
+      // the TDs are queued before the doorbell is rung, so the xHC goes from
+      // one TD to the next without waiting for software. A short packet ends
+      // a bulk IN transfer: the xHC would go on with the next TD and take
+      // the data following it (such as the CSW of a mass storage device) into
+      // this buffer, so a bulk IN transfer is a single TD.
+      //
       TotalLen = 0;
       Len      = 0;
       TrbNum   = 0;
+      TdTrbNum = 0;
       TrbStart = (TRB *)(UINTN)EPRing->RingEnqueue;
       while (TotalLen < Urb->DataLen) {
-        if ((TotalLen + 0x10000) >= Urb->DataLen) {
+        Len = 0x10000 - ((UINTN) ((UINT8 *) Urb->DataPhy + TotalLen) & 0xFFFF);
+        if (Len > Urb->DataLen - TotalLen) {
           Len = Urb->DataLen - TotalLen;
-        } else {
-          Len = 0x10000;
         }
+        TdTrbNum++;
+        TdEnd = (BOOLEAN) (((TotalLen + Len) == Urb->DataLen) ||
+                           ((EPType == ED_BULK_OUT) && (TdTrbNum == XHC_BULK_TD_TRB_NUMBER)));
         TrbStart = (TRB *)(UINTN)EPRing->RingEnqueue;
         TrbStart->TrbNormal.TRBPtrLo  = XHC_LOW_32BIT((UINT8 *) Urb->DataPhy + TotalLen);
         TrbStart->TrbNormal.TRBPtrHi  = XHC_HIGH_32BIT((UINT8 *) Urb->DataPhy + TotalLen);
@@ -391,7 +404,8 @@ XhcCreateTransferTrb (
         TrbStart->TrbNormal.TDSize    = 0;
         TrbStart->TrbNormal.IntTarget = 0;
         TrbStart->TrbNormal.ISP       = 1;
-        TrbStart->TrbNormal.IOC       = 1;
+        TrbStart->TrbNormal.CH        = TdEnd ? 0 : 1;
+        TrbStart->TrbNormal.IOC       = TdEnd ? 1 : 0;
         TrbStart->TrbNormal.Type      = TRB_TYPE_NORMAL;
         //
         // Update the cycle bit
@@ -401,6 +415,9 @@ XhcCreateTransferTrb (
         XhcSyncTrsRing (Xhc, EPRing);
         TrbNum++;
         TotalLen += Len;
+        if (TdEnd) {
+          TdTrbNum = 0;
+        }
       }
 
       Urb->TrbNum = TrbNum;
@@ -942,10 +959,72 @@ XhcFreeSched (
   }
 }
 
+/**
+  Record the URB as the asynchronous interrupt transfer of its endpoint, so
+  that its transfer events can be mapped back to it in O(1).
+
+  @param  Xhc                   The XHCI Instance.
+  @param  Urb                   The asynchronous interrupt URB.
+
+**/
+VOID
+XhcLinkAsyncIntUrb (
+  IN USB_XHCI_INSTANCE    *Xhc,
+  IN URB                  *Urb
+  )
+{
+  UINT8                   SlotId;
+  UINT8                   Dci;
+
+  SlotId = XhcBusDevAddrToSlotId (Xhc, Urb->Ep.BusAddr);
+  if (SlotId == 0) {
+    return;
+  }
+
+  Dci = XhcEndpointToDci (Urb->Ep.EpAddr, (UINT8)(Urb->Ep.Direction));
+  ASSERT ((Dci > 0) && (Dci < 32));
+
+  Xhc->UsbDevContext[SlotId].AsyncIntUrb[Dci - 1] = Urb;
+}
+
+/**
+  Remove the URB from the endpoint's asynchronous interrupt URB record.
+
+  The device slot may already be disabled when the URB is removed, so all
+  slots are checked for a reference to the URB.
+
+  @param  Xhc                   The XHCI Instance.
+  @param  Urb                   The asynchronous interrupt URB.
+
+**/
+VOID
+XhcUnlinkAsyncIntUrb (
+  IN USB_XHCI_INSTANCE    *Xhc,
+  IN URB                  *Urb
+  )
+{
+  UINTN                   Index;
+  UINT8                   Dci;
+
+  Dci = XhcEndpointToDci (Urb->Ep.EpAddr, (UINT8)(Urb->Ep.Direction));
+  ASSERT ((Dci > 0) && (Dci < 32));
+
+  for (Index = 1; Index < 256; Index++) {
+    if (Xhc->UsbDevContext[Index].AsyncIntUrb[Dci - 1] == Urb) {
+      Xhc->UsbDevContext[Index].AsyncIntUrb[Dci - 1] = NULL;
+    }
+  }
+}
+
 /**
   Check if the Trb is a transaction of the URBs in XHCI's asynchronous transfer list.
 
+  The slot id and endpoint id reported by the transfer event select the only
+  asynchronous interrupt URB which may own the Trb, so no list walk is needed.
+
   @param Xhc    The XHCI Instance.
+  @param SlotId The slot id reported by the transfer event.
+  @param Dci    The endpoint id reported by the transfer event.
   @param Trb    The TRB to be checked.
   @param Urb    The pointer to the matched Urb.
 
@@ -956,28 +1035,34 @@ XhcFreeSched (
 BOOLEAN
 IsAsyncIntTrb (
   IN  USB_XHCI_INSTANCE   *Xhc,
+  IN  UINT8               SlotId,
+  IN  UINT8               Dci,
   IN  TRB_TEMPLATE        *Trb,
   OUT URB                 **Urb
   )
 {
-  LIST_ENTRY              *Entry;
-  LIST_ENTRY              *Next;
   TRB_TEMPLATE            *CheckedTrb;
   URB                     *CheckedUrb;
   UINTN                   Index;
 
-  EFI_LIST_FOR_EACH_SAFE (Entry, Next, &Xhc->AsyncIntTransfers) {
-    CheckedUrb = EFI_LIST_CONTAINER (Entry, URB, UrbList);
-    CheckedTrb = CheckedUrb->TrbStart;
-    for (Index = 0; Index < CheckedUrb->TrbNum; Index++) {
-      if (Trb == CheckedTrb) {
-        *Urb = CheckedUrb;
-        return TRUE;
-      }
-      CheckedTrb++;
-      if ((UINTN)CheckedTrb >= ((UINTN) CheckedUrb->Ring->RingSeg0 + sizeof (TRB_TEMPLATE) * CheckedUrb->Ring->TrbNumber)) {
-        CheckedTrb = (TRB_TEMPLATE*) CheckedUrb->Ring->RingSeg0;
-      }
+  if ((SlotId == 0) || (Dci == 0) || (Dci > 31)) {
+    return FALSE;
+  }
+
+  CheckedUrb = (URB *) Xhc->UsbDevContext[SlotId].AsyncIntUrb[Dci - 1];
+  if (CheckedUrb == NULL) {
+    return FALSE;
+  }
+
+  CheckedTrb = CheckedUrb->TrbStart;
+  for (Index = 0; Index < CheckedUrb->TrbNum; Index++) {
+    if (Trb == CheckedTrb) {
+      *Urb = CheckedUrb;
+      return TRUE;
+    }
+    CheckedTrb++;
+    if ((UINTN)CheckedTrb >= ((UINTN) CheckedUrb->Ring->RingSeg0 + sizeof (TRB_TEMPLATE) * CheckedUrb->Ring->TrbNumber)) {
+      CheckedTrb = (TRB_TEMPLATE*) CheckedUrb->Ring->RingSeg0;
     }
   }
 
@@ -1000,21 +1085,39 @@ IsTransferRingTrb (
   IN  URB                 *Urb
   )
 {
-  TRB_TEMPLATE  *CheckedTrb;
-  UINTN         Index;
+  UINTN         RingStart;
+  UINTN         RingEnd;
 
-  CheckedTrb = Urb->Ring->RingSeg0;
+  ASSERT (Urb->Ring->TrbNumber == CMD_RING_TRB_NUMBER ||
+          Urb->Ring->TrbNumber == TR_RING_TRB_NUMBER ||
+          Urb->Ring->TrbNumber == BULK_RING_TRB_NUMBER);
 
-  ASSERT (Urb->Ring->TrbNumber == CMD_RING_TRB_NUMBER || Urb->Ring->TrbNumber == TR_RING_TRB_NUMBER);
+  //
+  // The ring segment is contiguous, so a range check is enough. This keeps
+  // event handling O(1) per event instead of walking the whole ring, which
+  // matters when large bulk transfers complete as a burst of events.
+  //
+  RingStart = (UINTN) Urb->Ring->RingSeg0;
+  RingEnd   = RingStart + sizeof (TRB_TEMPLATE) * Urb->Ring->TrbNumber;
 
-  for (Index = 0; Index < Urb->Ring->TrbNumber; Index++) {
-    if (Trb == CheckedTrb) {
-      return TRUE;
-    }
-    CheckedTrb++;
+  if (((UINTN) Trb < RingStart) || ((UINTN) Trb >= RingEnd)) {
+    return FALSE;
   }
 
-  return FALSE;
+  if ((((UINTN) Trb - RingStart) % sizeof (TRB_TEMPLATE)) != 0) {
+    return FALSE;
+  }
+
+  //
+  // Only the TRBs from TrbStart to TrbEnd belong to the URB. A late event of
+  // a TRB left behind by an earlier URB, such as the end TRB of a TD which
+  // completed with a short packet, must not be taken for an event of this one.
+  //
+  if ((UINTN) Urb->TrbStart <= (UINTN) Urb->TrbEnd) {
+    return (BOOLEAN) (((UINTN) Trb >= (UINTN) Urb->TrbStart) && ((UINTN) Trb <= (UINTN) Urb->TrbEnd));
+  }
+
+  return (BOOLEAN) (((UINTN) Trb >= (UINTN) Urb->TrbStart) || ((UINTN) Trb <= (UINTN) Urb->TrbEnd));
 }
 
 /**
@@ -1044,6 +1147,7 @@ XhcCheckUrbResult (
   UINT32                  High;
   UINT32                  Low;
   EFI_PHYSICAL_ADDRESS    PhyAddr;
+  EFI_PHYSICAL_ADDRESS    TrbData;
 
   ASSERT ((Xhc != NULL) && (Urb != NULL));
 
@@ -1096,11 +1200,15 @@ XhcCheckUrbResult (
     //
     if (IsTransferRingTrb (TRBPtr, Urb)) {
       CheckedUrb = Urb;
-    } else if (IsAsyncIntTrb (Xhc, TRBPtr, &AsyncUrb)) {    
+    } else if (IsAsyncIntTrb (Xhc, (UINT8) EvtTrb->SlotId, (UINT8) EvtTrb->EndpointId, TRBPtr, &AsyncUrb)) {    
       CheckedUrb = AsyncUrb;
     } else {
       continue;
     }
+
+    if (CheckedUrb->Finished) {
+      continue;
+    }
   
     switch (EvtTrb->Completecode) {
       case TRB_COMPLETION_STALL_ERROR:
@@ -1137,7 +1245,14 @@ XhcCheckUrbResult (
         if ((TRBType == TRB_TYPE_DATA_STAGE) ||
             (TRBType == TRB_TYPE_NORMAL) ||
             (TRBType == TRB_TYPE_ISOCH)) {
-          CheckedUrb->Completed += (CheckedUrb->DataLen - EvtTrb->Lenth);
+          //
+          // The event reports the residue of the TRB it points to, which may
+          // be any TRB of a multi-TRB transfer. Everything before the buffer
+          // of that TRB has been transferred.
+          //
+          TrbData = (EFI_PHYSICAL_ADDRESS) (TRBPtr->Parameter1 | LShiftU64 ((UINT64) TRBPtr->Parameter2, 32));
+          CheckedUrb->Completed = (UINTN) (TrbData - (UINTN) CheckedUrb->DataPhy) +
+                                  ((TRANSFER_TRB_NORMAL *) TRBPtr)->Lenth - EvtTrb->Lenth;
         }
 
         break;
@@ -1150,7 +1265,9 @@ XhcCheckUrbResult (
     }
 
     //
-    // Only check first and end Trb event address
+    // Only check first and end Trb event address. The chained TRBs of a bulk
+    // TD don't interrupt, so the end Trb event alone finishes the URB. A short
+    // packet also finishes a TD of normal TRBs, the xHC skips the rest of it.
     //
     if (TRBPtr == CheckedUrb->TrbStart) {
       CheckedUrb->StartDone = TRUE;
@@ -1160,7 +1277,8 @@ XhcCheckUrbResult (
       CheckedUrb->EndDone = TRUE;
     }
 
-    if (CheckedUrb->StartDone && CheckedUrb->EndDone) {
+    if (CheckedUrb->EndDone ||
+        ((EvtTrb->Completecode == TRB_COMPLETION_SHORT_PACKET) && (TRBPtr->Type == TRB_TYPE_NORMAL))) {
       CheckedUrb->Finished = TRUE;
       CheckedUrb->EvtTrb   = (TRB_TEMPLATE *)EvtTrb;
     }
@@ -1290,6 +1408,7 @@ XhciDelAsyncIntTransfer (
         (Urb->Ep.EpAddr == EpNum) &&
         (Urb->Ep.Direction == Direction)) {
       RemoveEntryList (&Urb->UrbList);
+      XhcUnlinkAsyncIntUrb (Xhc, Urb);
       FreePool (Urb->Data);
       XhcFreeUrb (Xhc, Urb);
       return EFI_SUCCESS;
@@ -1317,6 +1436,7 @@ XhciDelAllAsyncIntTransfers (
   EFI_LIST_FOR_EACH_SAFE (Entry, Next, &Xhc->AsyncIntTransfers) {
     Urb = EFI_LIST_CONTAINER (Entry, URB, UrbList);
     RemoveEntryList (&Urb->UrbList);
+    XhcUnlinkAsyncIntUrb (Xhc, Urb);
     FreePool (Urb->Data);
     XhcFreeUrb (Xhc, Urb);
   }
@@ -1404,6 +1524,50 @@ ON_ERROR:
   return EFI_DEVICE_ERROR;
 }
 
+/**
+  Adapt the interval of the asynchronous interrupt monitor to the traffic.
+
+  @param  Xhc                   The XHCI Instance.
+  @param  Active                TRUE if any asynchronous transfer completed
+                                in the current tick.
+
+**/
+VOID
+XhcUpdatePollInterval (
+  IN USB_XHCI_INSTANCE    *Xhc,
+  IN BOOLEAN              Active
+  )
+{
+  UINT64                  Interval;
+
+  Interval = Xhc->PollInterval;
+
+  if (Active) {
+    Xhc->PollIdleTicks = 0;
+    Interval           = XHC_ASYNC_TIMER_MIN_INTERVAL;
+  } else if (++Xhc->PollIdleTicks >= XHC_ASYNC_TIMER_IDLE_TICKS) {
+    Xhc->PollIdleTicks = 0;
+    Interval           = MIN (LShiftU64 (Interval, 1), XHC_ASYNC_TIMER_MAX_INTERVAL);
+  }
+
+  if (Interval == Xhc->PollInterval) {
+    return;
+  }
+
+  DEBUG ((
+    EFI_D_VERBOSE,
+    "XhcUpdatePollInterval: %ld -> %ld (ticks %ld, urb checks %ld, completions %ld)\n",
+    Xhc->PollInterval,
+    Interval,
+    Xhc->PollTicks,
+    Xhc->PollUrbChecks,
+    Xhc->PollCompletions
+    ));
+
+  Xhc->PollInterval = Interval;
+  gBS->SetTimer (Xhc->PollTimer, TimerPeriodic, Interval);
+}
+
 /**
   Interrupt transfer periodic check handler.
 
@@ -1426,10 +1590,14 @@ XhcMonitorAsyncRequests (
   UINT8                   SlotId;
   EFI_STATUS              Status;
   EFI_TPL                 OldTpl;
+  BOOLEAN                 Active;
 
   OldTpl = gBS->RaiseTPL (XHC_TPL);
 
   Xhc    = (USB_XHCI_INSTANCE*) Context;
+  Active = FALSE;
+
+  Xhc->PollTicks++;
 
   EFI_LIST_FOR_EACH_SAFE (Entry, Next, &Xhc->AsyncIntTransfers) {
     Urb = EFI_LIST_CONTAINER (Entry, URB, UrbList);
@@ -1447,11 +1615,17 @@ XhcMonitorAsyncRequests (
     // active, check the next one.
     //
     XhcCheckUrbResult (Xhc, Urb);
+    Xhc->PollUrbChecks++;
 
     if (!Urb->Finished) {
       continue;
     }
 
+    Xhc->PollCompletions++;
+    if (Urb->Result == EFI_USB_NOERROR) {
+      Active = TRUE;
+    }
+
     //
     // Flush any PCI posted write transactions from a PCI host
     // bridge to system memory.
@@ -1506,6 +1680,8 @@ XhcMonitorAsyncRequests (
 
     XhcUpdateAsyncRequest (Xhc, Urb);
   }
+
+  XhcUpdatePollInterval (Xhc, Active);
   gBS->RestoreTPL (OldTpl);
 }
 
@@ -1771,6 +1947,11 @@ XhcSyncTrsRing (
     if ((UINT8) TrsTrb->Type == TRB_TYPE_LINK) {
       ASSERT (((LINK_TRB*)TrsTrb)->TC != 0);
       //
+      // A TD running over the end of the ring goes on through the Link TRB,
+      // which then has to be chained as the TRB before it.
+      //
+      ((LINK_TRB*)TrsTrb)->CH = ((LINK_TRB*)(TrsTrb - 1))->CH;
+      //
       // set cycle bit in Link TRB as normal
       //
       ((LINK_TRB*)TrsTrb)->CycleBit = TrsRing->RingPCS & BIT0;
@@ -2374,11 +2555,12 @@ XhcDisableSlotCmd (
     if (Xhc->UsbDevContext[SlotId].EndpointTransferRing[Index] != NULL) {
       RingSeg = ((TRANSFER_RING *)(UINTN)Xhc->UsbDevContext[SlotId].EndpointTransferRing[Index])->RingSeg0;
       if (RingSeg != NULL) {
-        UsbHcFreeMem (Xhc->MemPool, RingSeg, sizeof (TRB_TEMPLATE) * TR_RING_TRB_NUMBER);
+        UsbHcFreeMem (Xhc->MemPool, RingSeg, sizeof (TRB_TEMPLATE) * ((TRANSFER_RING *)(UINTN)Xhc->UsbDevContext[SlotId].EndpointTransferRing[Index])->TrbNumber);
       }
       FreePool (Xhc->UsbDevContext[SlotId].EndpointTransferRing[Index]);
       Xhc->UsbDevContext[SlotId].EndpointTransferRing[Index] = NULL;
     }
+    Xhc->UsbDevContext[SlotId].AsyncIntUrb[Index] = NULL;
   }
 
   for (Index = 0; Index < Xhc->UsbDevContext[SlotId].DevDesc.NumConfigurations; Index++) {
@@ -2481,11 +2663,12 @@ XhcDisableSlotCmd64 (
     if (Xhc->UsbDevContext[SlotId].EndpointTransferRing[Index] != NULL) {
       RingSeg = ((TRANSFER_RING *)(UINTN)Xhc->UsbDevContext[SlotId].EndpointTransferRing[Index])->RingSeg0;
       if (RingSeg != NULL) {
-        UsbHcFreeMem (Xhc->MemPool, RingSeg, sizeof (TRB_TEMPLATE) * TR_RING_TRB_NUMBER);
+        UsbHcFreeMem (Xhc->MemPool, RingSeg, sizeof (TRB_TEMPLATE) * ((TRANSFER_RING *)(UINTN)Xhc->UsbDevContext[SlotId].EndpointTransferRing[Index])->TrbNumber);
       }
       FreePool (Xhc->UsbDevContext[SlotId].EndpointTransferRing[Index]);
       Xhc->UsbDevContext[SlotId].EndpointTransferRing[Index] = NULL;
     }
+    Xhc->UsbDevContext[SlotId].AsyncIntUrb[Index] = NULL;
   }
 
   for (Index = 0; Index < Xhc->UsbDevContext[SlotId].DevDesc.NumConfigurations; Index++) {
@@ -2594,7 +2777,7 @@ XhcInitializeEndpointContext (
         if (Xhc->UsbDevContext[SlotId].EndpointTransferRing[Dci-1] == NULL) {
           EndpointTransferRing = AllocateZeroPool(sizeof (TRANSFER_RING));
           Xhc->UsbDevContext[SlotId].EndpointTransferRing[Dci-1] = (VOID *) EndpointTransferRing;
-          CreateTransferRing(Xhc, TR_RING_TRB_NUMBER, (TRANSFER_RING *)Xhc->UsbDevContext[SlotId].EndpointTransferRing[Dci-1]);
+          CreateTransferRing(Xhc, BULK_RING_TRB_NUMBER, (TRANSFER_RING *)Xhc->UsbDevContext[SlotId].EndpointTransferRing[Dci-1]);
         }
 
         break;
@@ -2666,7 +2849,7 @@ XhcInitializeEndpointContext (
     PhyAddr = UsbHcGetPciAddrForHostAddr (
                 Xhc->MemPool,
                 ((TRANSFER_RING *)(UINTN)Xhc->UsbDevContext[SlotId].EndpointTransferRing[Dci-1])->RingSeg0,
-                sizeof (TRB_TEMPLATE) * TR_RING_TRB_NUMBER
+                sizeof (TRB_TEMPLATE) * ((TRANSFER_RING *)(UINTN)Xhc->UsbDevContext[SlotId].EndpointTransferRing[Dci-1])->TrbNumber
                 );
     PhyAddr &= ~((EFI_PHYSICAL_ADDRESS)0x0F);
     PhyAddr |= (EFI_PHYSICAL_ADDRESS)((TRANSFER_RING *)(UINTN)Xhc->UsbDevContext[SlotId].EndpointTransferRing[Dci-1])->RingPCS;
@@ -2757,7 +2940,7 @@ XhcInitializeEndpointContext64 (
         if (Xhc->UsbDevContext[SlotId].EndpointTransferRing[Dci-1] == NULL) {
           EndpointTransferRing = AllocateZeroPool(sizeof (TRANSFER_RING));
           Xhc->UsbDevContext[SlotId].EndpointTransferRing[Dci-1] = (VOID *) EndpointTransferRing;
-          CreateTransferRing(Xhc, TR_RING_TRB_NUMBER, (TRANSFER_RING *)Xhc->UsbDevContext[SlotId].EndpointTransferRing[Dci-1]);
+          CreateTransferRing(Xhc, BULK_RING_TRB_NUMBER, (TRANSFER_RING *)Xhc->UsbDevContext[SlotId].EndpointTransferRing[Dci-1]);
         }
 
         break;
@@ -2829,7 +3012,7 @@ XhcInitializeEndpointContext64 (
     PhyAddr = UsbHcGetPciAddrForHostAddr (
                 Xhc->MemPool,
                 ((TRANSFER_RING *)(UINTN)Xhc->UsbDevContext[SlotId].EndpointTransferRing[Dci-1])->RingSeg0,
-                sizeof (TRB_TEMPLATE) * TR_RING_TRB_NUMBER
+                sizeof (TRB_TEMPLATE) * ((TRANSFER_RING *)(UINTN)Xhc->UsbDevContext[SlotId].EndpointTransferRing[Dci-1])->TrbNumber
                 );
     PhyAddr &= ~((EFI_PHYSICAL_ADDRESS)0x0F);
     PhyAddr |= (EFI_PHYSICAL_ADDRESS)((TRANSFER_RING *)(UINTN)Xhc->UsbDevContext[SlotId].EndpointTransferRing[Dci-1])->RingPCS;
@@ -3188,7 +3371,7 @@ XhcSetInterface (
       if (Xhc->UsbDevContext[SlotId].EndpointTransferRing[Dci - 1] != NULL) {
         RingSeg = ((TRANSFER_RING *)(UINTN)Xhc->UsbDevContext[SlotId].EndpointTransferRing[Dci - 1])->RingSeg0;
         if (RingSeg != NULL) {
-          UsbHcFreeMem (Xhc->MemPool, RingSeg, sizeof (TRB_TEMPLATE) * TR_RING_TRB_NUMBER);
+          UsbHcFreeMem (Xhc->MemPool, RingSeg, sizeof (TRB_TEMPLATE) * ((TRANSFER_RING *)(UINTN)Xhc->UsbDevContext[SlotId].EndpointTransferRing[Dci - 1])->TrbNumber);
         }
         FreePool (Xhc->UsbDevContext[SlotId].EndpointTransferRing[Dci - 1]);
         Xhc->UsbDevContext[SlotId].EndpointTransferRing[Dci - 1] = NULL;
@@ -3385,7 +3568,7 @@ XhcSetInterface64 (
       if (Xhc->UsbDevContext[SlotId].EndpointTransferRing[Dci - 1] != NULL) {
         RingSeg = ((TRANSFER_RING *)(UINTN)Xhc->UsbDevContext[SlotId].EndpointTransferRing[Dci - 1])->RingSeg0;
         if (RingSeg != NULL) {
-          UsbHcFreeMem (Xhc->MemPool, RingSeg, sizeof (TRB_TEMPLATE) * TR_RING_TRB_NUMBER);
+          UsbHcFreeMem (Xhc->MemPool, RingSeg, sizeof (TRB_TEMPLATE) * ((TRANSFER_RING *)(UINTN)Xhc->UsbDevContext[SlotId].EndpointTransferRing[Dci - 1])->TrbNumber);
         }
         FreePool (Xhc->UsbDevContext[SlotId].EndpointTransferRing[Dci - 1]);
         Xhc->UsbDevContext[SlotId].EndpointTransferRing[Dci - 1] = NULL;
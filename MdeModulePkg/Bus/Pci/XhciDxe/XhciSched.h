@@ -921,6 +921,36 @@ XhcRingDoorBell (
   IN UINT8                Dci
   );
 
+/**
+  Record the URB as the asynchronous interrupt transfer of its endpoint, so
+  that its transfer events can be mapped back to it in O(1).
+
+  @param  Xhc                   The XHCI Instance.
+  @param  Urb                   The asynchronous interrupt URB.
+
+**/
+VOID
+XhcLinkAsyncIntUrb (
+  IN USB_XHCI_INSTANCE    *Xhc,
+  IN URB                  *Urb
+  );
+
+/**
+  Remove the URB from the endpoint's asynchronous interrupt URB record.
+
+  The device slot may already be disabled when the URB is removed, so all
+  slots are checked for a reference to the URB.
+
+  @param  Xhc                   The XHCI Instance.
+  @param  Urb                   The asynchronous interrupt URB.
+
+**/
+VOID
+XhcUnlinkAsyncIntUrb (
+  IN USB_XHCI_INSTANCE    *Xhc,
+  IN URB                  *Urb
+  );
+
 /**
   Interrupt transfer periodic check handler.
 
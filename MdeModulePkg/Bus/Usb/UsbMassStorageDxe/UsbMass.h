@@ -188,6 +188,7 @@ struct _USB_MASS_DEVICE {
   EFI_DISK_INFO_PROTOCOL    DiskInfo;
   USB_BOOT_INQUIRY_DATA     InquiryData;
   BOOLEAN                   Cdb16Byte;
+  UINTN                     MaxCarrySize; ///< Bytes per READ/WRITE, 0 to use USB_BOOT_IO_BLOCKS
 };
 
 #endif
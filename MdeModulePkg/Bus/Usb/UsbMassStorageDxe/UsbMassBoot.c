@@ -765,6 +765,38 @@ ON_ERROR:
 }
 
 
+/**
+  Get the number of blocks carried by a single READ/WRITE command.
+
+  Devices behind a SuperSpeed bulk endpoint are given a byte based limit
+  of USB_BOOT_SS_MAX_CARRY_SIZE, all others keep USB_BOOT_IO_BLOCKS.
+
+  @param  UsbMass                The USB mass storage device
+
+  @return The maximum number of blocks per READ/WRITE command.
+
+**/
+UINT16
+UsbBootGetIoBlocks (
+  IN  USB_MASS_DEVICE       *UsbMass
+  )
+{
+  UINTN                     MaxBlock;
+
+  if ((UsbMass->MaxCarrySize == 0) || (UsbMass->BlockIoMedia.BlockSize == 0)) {
+    return USB_BOOT_IO_BLOCKS;
+  }
+
+  MaxBlock = UsbMass->MaxCarrySize / UsbMass->BlockIoMedia.BlockSize;
+  if (MaxBlock == 0) {
+    MaxBlock = 1;
+  } else if (MaxBlock > MAX_UINT16) {
+    MaxBlock = MAX_UINT16;
+  }
+
+  return (UINT16) MaxBlock;
+}
+
 /**
   Read some blocks from the device.
 
@@ -788,11 +820,13 @@ UsbBootReadBlocks (
   USB_BOOT_READ10_CMD       ReadCmd;
   EFI_STATUS                Status;
   UINT16                    Count;
+  UINT16                    MaxBlock;
   UINT32                    BlockSize;
   UINT32                    ByteSize;
   UINT32                    Timeout;
 
   BlockSize = UsbMass->BlockIoMedia.BlockSize;
+  MaxBlock  = UsbBootGetIoBlocks (UsbMass);
   Status    = EFI_SUCCESS;
 
   while (TotalBlock > 0) {
@@ -801,7 +835,7 @@ UsbBootReadBlocks (
     // on the device. We must split the total block because the READ10
     // command only has 16 bit transfer length (in the unit of block).
     //
-    Count     = (UINT16)((TotalBlock < USB_BOOT_IO_BLOCKS) ? TotalBlock : USB_BOOT_IO_BLOCKS);
+    Count     = (UINT16)((TotalBlock < MaxBlock) ? TotalBlock : MaxBlock);
     ByteSize  = (UINT32)Count * BlockSize;
 
     //
@@ -864,11 +898,13 @@ UsbBootWriteBlocks (
   USB_BOOT_WRITE10_CMD  WriteCmd;
   EFI_STATUS            Status;
   UINT16                Count;
+  UINT16                MaxBlock;
   UINT32                BlockSize;
   UINT32                ByteSize;
   UINT32                Timeout;
 
   BlockSize = UsbMass->BlockIoMedia.BlockSize;
+  MaxBlock  = UsbBootGetIoBlocks (UsbMass);
   Status    = EFI_SUCCESS;
 
   while (TotalBlock > 0) {
@@ -877,7 +913,7 @@ UsbBootWriteBlocks (
     // on the device. We must split the total block because the WRITE10
     // command only has 16 bit transfer length (in the unit of block).
     //
-    Count     = (UINT16)((TotalBlock < USB_BOOT_IO_BLOCKS) ? TotalBlock : USB_BOOT_IO_BLOCKS);
+    Count     = (UINT16)((TotalBlock < MaxBlock) ? TotalBlock : MaxBlock);
     ByteSize  = (UINT32)Count * BlockSize;
 
     //
@@ -940,18 +976,20 @@ UsbBootReadBlocks16 (
   UINT8                     ReadCmd[16];
   EFI_STATUS                Status;
   UINT16                    Count;
+  UINT16                    MaxBlock;
   UINT32                    BlockSize;
   UINT32                    ByteSize;
   UINT32                    Timeout;
 
   BlockSize = UsbMass->BlockIoMedia.BlockSize;
+  MaxBlock  = UsbBootGetIoBlocks (UsbMass);
   Status    = EFI_SUCCESS;
 
   while (TotalBlock > 0) {
     //
     // Split the total blocks into smaller pieces.
     //
-    Count     = (UINT16)((TotalBlock < USB_BOOT_IO_BLOCKS) ? TotalBlock : USB_BOOT_IO_BLOCKS);
+    Count     = (UINT16)((TotalBlock < MaxBlock) ? TotalBlock : MaxBlock);
     ByteSize  = (UINT32)Count * BlockSize;
 
     //
@@ -1014,18 +1052,20 @@ UsbBootWriteBlocks16 (
   UINT8                 WriteCmd[16];
   EFI_STATUS            Status;
   UINT16                Count;
+  UINT16                MaxBlock;
   UINT32                BlockSize;
   UINT32                ByteSize;
   UINT32                Timeout;
 
   BlockSize = UsbMass->BlockIoMedia.BlockSize;
+  MaxBlock  = UsbBootGetIoBlocks (UsbMass);
   Status    = EFI_SUCCESS;
 
   while (TotalBlock > 0) {
     //
     // Split the total blocks into smaller pieces.
     //
-    Count     = (UINT16)((TotalBlock < USB_BOOT_IO_BLOCKS) ? TotalBlock : USB_BOOT_IO_BLOCKS);
+    Count     = (UINT16)((TotalBlock < MaxBlock) ? TotalBlock : MaxBlock);
     ByteSize  = (UINT32)Count * BlockSize;
 
     //
@@ -68,6 +68,14 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 //
 #define USB_BOOT_IO_BLOCKS              128
 
+//
+// SuperSpeed bulk endpoints (wMaxPacketSize 1024) can sustain much larger
+// transfers per command. Carrying 1MB per READ/WRITE amortizes the CBW/CSW
+// round trips that otherwise dominate the throughput of USB 3.0 sticks.
+//
+#define USB_BOOT_SS_MAX_PACKET_SIZE     1024
+#define USB_BOOT_SS_MAX_CARRY_SIZE      SIZE_1MB
+
 //
 // Retry mass command times, set by experience
 //
@@ -270,6 +278,19 @@ UsbBootDetectMedia (
   IN  USB_MASS_DEVICE       *UsbMass
   );
 
+/**
+  Get the number of blocks carried by a single READ/WRITE command.
+
+  @param  UsbMass                The USB mass storage device
+
+  @return The maximum number of blocks per READ/WRITE command.
+
+**/
+UINT16
+UsbBootGetIoBlocks (
+  IN  USB_MASS_DEVICE         *UsbMass
+  );
+
 /**
   Read some blocks from the device.
 
@@ -375,6 +375,8 @@ UsbMassInitMedia (
   @param  Transport       The pointer to pointer to USB_MASS_TRANSPORT.
   @param  Context         The parameter for USB_MASS_DEVICE.Context.
   @param  MaxLun          Get the MaxLun if is BOT dev.
+  @param  MaxCarrySize    Get the byte limit of one READ/WRITE command,
+                          0 if the default block count should be used.
 
   @retval EFI_SUCCESS     The initialization is successful.
   @retval EFI_UNSUPPORTED No matching transport protocol is found.
@@ -387,11 +389,13 @@ UsbMassInitTransport (
   IN  EFI_HANDLE                   Controller,
   OUT USB_MASS_TRANSPORT           **Transport,
   OUT VOID                         **Context,
-  OUT UINT8                        *MaxLun
+  OUT UINT8                        *MaxLun,
+  OUT UINTN                        *MaxCarrySize
   )
 {
   EFI_USB_IO_PROTOCOL           *UsbIo;
   EFI_USB_INTERFACE_DESCRIPTOR  Interface;
+  EFI_USB_ENDPOINT_DESCRIPTOR   EndPoint;
   UINT8                         Index;
   EFI_STATUS                    Status;
  
@@ -443,6 +447,23 @@ UsbMassInitTransport (
     (*Transport)->GetMaxLun (*Context, MaxLun);
   }
 
+  //
+  // A bulk endpoint with 1024 bytes max packet size can only be reported
+  // by a SuperSpeed device, which is able to carry far more data per
+  // command than the USB_BOOT_IO_BLOCKS default.
+  //
+  *MaxCarrySize = 0;
+  for (Index = 0; Index < Interface.NumEndpoints; Index++) {
+    if (EFI_ERROR (UsbIo->UsbGetEndpointDescriptor (UsbIo, Index, &EndPoint))) {
+      continue;
+    }
+    if (USB_IS_BULK_ENDPOINT (EndPoint.Attributes) &&
+        (EndPoint.MaxPacketSize >= USB_BOOT_SS_MAX_PACKET_SIZE)) {
+      *MaxCarrySize = USB_BOOT_SS_MAX_CARRY_SIZE;
+      break;
+    }
+  }
+
 ON_EXIT:
   gBS->CloseProtocol (
          Controller,
@@ -462,6 +483,7 @@ ON_EXIT:
   @param  Context              Parameter for USB_MASS_DEVICE.Context.
   @param  DevicePath           The remaining device path.
   @param  MaxLun               The max LUN number.
+  @param  MaxCarrySize         The byte limit of one READ/WRITE command.
 
   @retval EFI_SUCCESS          At least one LUN is initialized successfully.
   @retval EFI_NOT_FOUND        Fail to initialize any of multiple LUNs.
@@ -474,7 +496,8 @@ UsbMassInitMultiLun (
   IN USB_MASS_TRANSPORT            *Transport,
   IN VOID                          *Context,
   IN EFI_DEVICE_PATH_PROTOCOL      *DevicePath,
-  IN UINT8                         MaxLun
+  IN UINT8                         MaxLun,
+  IN UINTN                         MaxCarrySize
   )
 {
   USB_MASS_DEVICE                  *UsbMass;
@@ -506,6 +529,7 @@ UsbMassInitMultiLun (
     UsbMass->Transport            = Transport;
     UsbMass->Context              = Context;
     UsbMass->Lun                  = Index;
+    UsbMass->MaxCarrySize         = MaxCarrySize;
     
     //
     // Initialize the media parameter data for EFI_BLOCK_IO_MEDIA of Block I/O Protocol.
@@ -600,6 +624,7 @@ UsbMassInitMultiLun (
   @param  Controller      The device to initialize.
   @param  Transport       Pointer to USB_MASS_TRANSPORT.
   @param  Context         Parameter for USB_MASS_DEVICE.Context.
+  @param  MaxCarrySize    The byte limit of one READ/WRITE command.
 
   @retval EFI_SUCCESS     Initialization succeeds.
   @retval Other           Initialization fails.
@@ -610,7 +635,8 @@ UsbMassInitNonLun (
   IN EFI_DRIVER_BINDING_PROTOCOL   *This,
   IN EFI_HANDLE                    Controller,
   IN USB_MASS_TRANSPORT            *Transport,
-  IN VOID                          *Context
+  IN VOID                          *Context,
+  IN UINTN                         MaxCarrySize
   )
 {
   USB_MASS_DEVICE             *UsbMass;
@@ -646,6 +672,7 @@ UsbMassInitNonLun (
   UsbMass->OpticalStorage       = FALSE;
   UsbMass->Transport            = Transport;
   UsbMass->Context              = Context;
+  UsbMass->MaxCarrySize         = MaxCarrySize;
   
   //
   // Initialize the media parameter data for EFI_BLOCK_IO_MEDIA of Block I/O Protocol.
@@ -795,6 +822,7 @@ USBMassDriverBindingStart (
   EFI_DEVICE_PATH_PROTOCOL      *DevicePath;
   VOID                          *Context;
   UINT8                         MaxLun;
+  UINTN                         MaxCarrySize;
   EFI_STATUS                    Status;
   EFI_USB_IO_PROTOCOL           *UsbIo; 
   EFI_TPL                       OldTpl;
@@ -804,8 +832,9 @@ USBMassDriverBindingStart (
   Transport = NULL;
   Context   = NULL;
   MaxLun    = 0;
+  MaxCarrySize = 0;
 
-  Status = UsbMassInitTransport (This, Controller, &Transport, &Context, &MaxLun);
+  Status = UsbMassInitTransport (This, Controller, &Transport, &Context, &MaxLun, &MaxCarrySize);
 
   if (EFI_ERROR (Status)) {
     DEBUG ((EFI_D_ERROR, "USBMassDriverBindingStart: UsbMassInitTransport (%r)\n", Status));
@@ -815,7 +844,7 @@ USBMassDriverBindingStart (
     //
     // Initialize data for device that does not support multiple LUNSs.
     //
-    Status = UsbMassInitNonLun (This, Controller, Transport, Context);
+    Status = UsbMassInitNonLun (This, Controller, Transport, Context, MaxCarrySize);
     if (EFI_ERROR (Status)) { 
       DEBUG ((EFI_D_ERROR, "USBMassDriverBindingStart: UsbMassInitNonLun (%r)\n", Status));
     }
@@ -861,7 +890,7 @@ USBMassDriverBindingStart (
     // Initialize data for device that supports multiple LUNs.
     // EFI_SUCCESS is returned if at least 1 LUN is initialized successfully.
     //
-    Status = UsbMassInitMultiLun (This, Controller, Transport, Context, DevicePath, MaxLun);
+    Status = UsbMassInitMultiLun (This, Controller, Transport, Context, DevicePath, MaxLun, MaxCarrySize);
     if (EFI_ERROR (Status)) {
       gBS->CloseProtocol (
               Controller,
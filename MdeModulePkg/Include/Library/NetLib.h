@@ -2129,4 +2129,115 @@ NetLibGetSystemGuid (
   OUT EFI_GUID              *SystemGuid
   );
 
+//
+// Longest prefix match table, shared by the IP4 and IP6 route tables. It is a
+// path compressed binary trie of the prefixes, the prefixes and addresses are
+// byte arrays in network byte order.
+//
+#define NET_LPM_MAX_PREFIX_BYTES  16
+
+typedef struct _NET_LPM_NODE  NET_LPM_NODE;
+
+struct _NET_LPM_NODE {
+  NET_LPM_NODE        *Child[2];
+  VOID                *Value;     // NULL for a node that only joins two branches
+  UINT8               PrefixLength;
+  UINT8               Prefix[NET_LPM_MAX_PREFIX_BYTES];
+};
+
+typedef struct {
+  NET_LPM_NODE        *Root;
+  UINT32              PrefixNum;
+} NET_LPM_TABLE;
+
+/**
+  Initialize an empty longest prefix match table.
+
+  @param[out]  Table          The table to initialize.
+
+**/
+VOID
+EFIAPI
+NetLpmInit (
+  OUT NET_LPM_TABLE         *Table
+  );
+
+/**
+  Remove all the prefixes from the longest prefix match table. The values
+  stored in the table are not freed.
+
+  @param[in, out]  Table      The table to clean up.
+
+**/
+VOID
+EFIAPI
+NetLpmClean (
+  IN OUT NET_LPM_TABLE      *Table
+  );
+
+/**
+  Add a prefix to the longest prefix match table, or replace the value of the
+  prefix if it is in the table already.
+
+  @param[in, out]  Table          The table to add the prefix to.
+  @param[in]       Prefix         The prefix, in network byte order. The bits
+                                  beyond PrefixLength are ignored.
+  @param[in]       PrefixLength   The length of the prefix in bits.
+  @param[in]       Value          The value of the prefix, it must not be NULL.
+
+  @retval EFI_SUCCESS             The prefix is added or its value replaced.
+  @retval EFI_INVALID_PARAMETER   PrefixLength is too long, or Value is NULL.
+  @retval EFI_OUT_OF_RESOURCES    Failed to allocate memory for the prefix.
+
+**/
+EFI_STATUS
+EFIAPI
+NetLpmInsert (
+  IN OUT NET_LPM_TABLE      *Table,
+  IN     CONST UINT8        *Prefix,
+  IN     UINT8              PrefixLength,
+  IN     VOID               *Value
+  );
+
+/**
+  Remove a prefix from the longest prefix match table.
+
+  @param[in, out]  Table          The table to remove the prefix from.
+  @param[in]       Prefix         The prefix, in network byte order.
+  @param[in]       PrefixLength   The length of the prefix in bits.
+
+  @retval EFI_SUCCESS             The prefix is removed.
+  @retval EFI_NOT_FOUND           The prefix isn't in the table.
+
+**/
+EFI_STATUS
+EFIAPI
+NetLpmDelete (
+  IN OUT NET_LPM_TABLE      *Table,
+  IN     CONST UINT8        *Prefix,
+  IN     UINT8              PrefixLength
+  );
+
+/**
+  Find the longest prefix in the table that matches the address.
+
+  @param[in]   Table            The table to search.
+  @param[in]   Address          The address, in network byte order.
+  @param[in]   AddressLength    The length of the address in bits, 32 for IPv4
+                                and 128 for IPv6.
+  @param[out]  PrefixLength     The length of the matched prefix. Optional.
+
+  @return The value of the longest matching prefix, or NULL if no prefix in
+          the table matches the address.
+
+**/
+VOID *
+EFIAPI
+NetLpmLookup (
+  IN     NET_LPM_TABLE      *Table,
+  IN     CONST UINT8        *Address,
+  IN     UINT8              AddressLength,
+     OUT UINT8              *PrefixLength   OPTIONAL
+  );
+
 #endif
@@ -20,6 +20,208 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #include <Library/UefiBootServicesTableLib.h>
 #include <Library/MemoryAllocationLib.h>
 
+//
+// The NET_BUF, NET_VECTOR and data blocks allocated by the library are
+// recycled through free lists of power of two size classes, so that each
+// packet doesn't cost several pool operations. A block on a free list keeps
+// the link to the next free block in its first bytes.
+//
+#define NET_BUF_POOL_MIN_SHIFT  6     // The smallest size class is 64 bytes
+#define NET_BUF_POOL_CLASS_NUM  6     // The size classes are 64 to 2048 bytes
+#define NET_BUF_POOL_MAX_FREE   64    // High-water mark of each free list
+
+#define NET_BUF_POOL_CLASS_SIZE(Index) \
+  ((UINTN) 1 << (NET_BUF_POOL_MIN_SHIFT + (Index)))
+
+typedef struct _NET_BUF_POOL_ENTRY {
+  struct _NET_BUF_POOL_ENTRY  *Next;
+} NET_BUF_POOL_ENTRY;
+
+typedef struct {
+  NET_BUF_POOL_ENTRY  *FreeList;
+  UINT32              FreeNum;    // Blocks on the free list
+  UINT32              MaxFreeNum; // The most blocks ever on the free list
+  UINT64              Allocated;  // Blocks allocated from the memory pool
+  UINT64              Reused;     // Blocks taken from the free list
+  UINT64              Released;   // Blocks returned to the memory pool
+} NET_BUF_POOL_CLASS;
+
+NET_BUF_POOL_CLASS  mNetbufPool[NET_BUF_POOL_CLASS_NUM];
+
+
+/**
+  Get the size class of the net buffer pool for a block.
+
+  @param[in]  Size           The size of the block.
+
+  @return                    The index of the size class, or NET_BUF_POOL_CLASS_NUM
+                             if the block is too large to be pooled.
+
+**/
+UINT32
+NetbufPoolClass (
+  IN UINTN                  Size
+  )
+{
+  UINT32                    Index;
+
+  for (Index = 0; Index < NET_BUF_POOL_CLASS_NUM; Index++) {
+    if (Size <= NET_BUF_POOL_CLASS_SIZE (Index)) {
+      break;
+    }
+  }
+
+  return Index;
+}
+
+
+/**
+  Allocate a block from the net buffer pool. The block is taken from the
+  free list of its size class if possible.
+
+  @param[in]  Size           The size of the block.
+
+  @return                    Pointer to the allocated block, or NULL if the
+                             allocation failed due to resource limit.
+
+**/
+VOID *
+NetbufPoolAllocate (
+  IN UINTN                  Size
+  )
+{
+  NET_BUF_POOL_CLASS        *Class;
+  NET_BUF_POOL_ENTRY        *Entry;
+  EFI_TPL                   OldTpl;
+  UINT32                    Index;
+
+  Index = NetbufPoolClass (Size);
+
+  if (Index == NET_BUF_POOL_CLASS_NUM) {
+    return AllocatePool (Size);
+  }
+
+  Class  = &mNetbufPool[Index];
+  OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+
+  Entry  = Class->FreeList;
+
+  if (Entry != NULL) {
+    Class->FreeList = Entry->Next;
+    Class->FreeNum--;
+    Class->Reused++;
+  } else {
+    Class->Allocated++;
+  }
+
+  gBS->RestoreTPL (OldTpl);
+
+  if (Entry == NULL) {
+    Entry = AllocatePool (NET_BUF_POOL_CLASS_SIZE (Index));
+  }
+
+  return Entry;
+}
+
+
+/**
+  Free a block allocated by NetbufPoolAllocate. The block is kept on the
+  free list of its size class unless the list has reached its high-water mark.
+
+  @param[in]  Buffer         Pointer to the block to free.
+  @param[in]  Size           The size of the block passed to NetbufPoolAllocate.
+
+**/
+VOID
+NetbufPoolFree (
+  IN VOID                   *Buffer,
+  IN UINTN                  Size
+  )
+{
+  NET_BUF_POOL_CLASS        *Class;
+  NET_BUF_POOL_ENTRY        *Entry;
+  EFI_TPL                   OldTpl;
+  UINT32                    Index;
+
+  ASSERT (Buffer != NULL);
+
+  Index = NetbufPoolClass (Size);
+
+  if (Index == NET_BUF_POOL_CLASS_NUM) {
+    FreePool (Buffer);
+    return;
+  }
+
+  Class  = &mNetbufPool[Index];
+  Entry  = (NET_BUF_POOL_ENTRY *) Buffer;
+  OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+
+  if (Class->FreeNum < NET_BUF_POOL_MAX_FREE) {
+    Entry->Next     = Class->FreeList;
+    Class->FreeList = Entry;
+    Class->FreeNum++;
+    Class->MaxFreeNum = MAX (Class->MaxFreeNum, Class->FreeNum);
+    Entry           = NULL;
+  } else {
+    Class->Released++;
+  }
+
+  gBS->RestoreTPL (OldTpl);
+
+  if (Entry != NULL) {
+    FreePool (Entry);
+  }
+}
+
+
+/**
+  Release the blocks on the free lists of the net buffer pool when the image
+  is unloaded, and report the statistics of the pool.
+
+  @param[in]  ImageHandle    The image handle of the driver or application.
+  @param[in]  SystemTable    The system table.
+
+  @retval EFI_SUCCESS        The blocks are released.
+
+**/
+EFI_STATUS
+EFIAPI
+NetbufPoolDestructor (
+  IN EFI_HANDLE             ImageHandle,
+  IN EFI_SYSTEM_TABLE       *SystemTable
+  )
+{
+  NET_BUF_POOL_CLASS        *Class;
+  NET_BUF_POOL_ENTRY        *Entry;
+  UINT32                    Index;
+
+  for (Index = 0; Index < NET_BUF_POOL_CLASS_NUM; Index++) {
+    Class = &mNetbufPool[Index];
+
+    if (Class->Allocated != 0) {
+      DEBUG ((
+        EFI_D_INFO,
+        "NetbufPool: %d bytes, %ld allocated, %ld reused, %ld released, %d most free.\n",
+        (UINT32) NET_BUF_POOL_CLASS_SIZE (Index),
+        Class->Allocated,
+        Class->Reused,
+        Class->Released,
+        Class->MaxFreeNum
+        ));
+    }
+
+    while (Class->FreeList != NULL) {
+      Entry           = Class->FreeList;
+      Class->FreeList = Entry->Next;
+      FreePool (Entry);
+    }
+
+    Class->FreeNum = 0;
+  }
+
+  return EFI_SUCCESS;
+}
+
 
 /**
   Allocate and build up the sketch for a NET_BUF.
@@ -49,24 +251,28 @@ NetbufAllocStruct (
   //
   // Allocate three memory blocks.
   //
-  Nbuf = AllocateZeroPool (NET_BUF_SIZE (BlockOpNum));
+  Nbuf = NetbufPoolAllocate (NET_BUF_SIZE (BlockOpNum));
 
   if (Nbuf == NULL) {
     return NULL;
   }
 
+  ZeroMem (Nbuf, NET_BUF_SIZE (BlockOpNum));
+
   Nbuf->Signature           = NET_BUF_SIGNATURE;
   Nbuf->RefCnt              = 1;
   Nbuf->BlockOpNum          = BlockOpNum;
   InitializeListHead (&Nbuf->List);
 
   if (BlockNum != 0) {
-    Vector = AllocateZeroPool (NET_VECTOR_SIZE (BlockNum));
+    Vector = NetbufPoolAllocate (NET_VECTOR_SIZE (BlockNum));
 
     if (Vector == NULL) {
       goto FreeNbuf;
     }
 
+    ZeroMem (Vector, NET_VECTOR_SIZE (BlockNum));
+
     Vector->Signature = NET_VECTOR_SIGNATURE;
     Vector->RefCnt    = 1;
     Vector->BlockNum  = BlockNum;
@@ -77,7 +283,7 @@ NetbufAllocStruct (
 
 FreeNbuf:
 
-  FreePool (Nbuf);
+  NetbufPoolFree (Nbuf, NET_BUF_SIZE (BlockOpNum));
   return NULL;
 }
 
@@ -110,7 +316,7 @@ NetbufAlloc (
     return NULL;
   }
 
-  Bulk = AllocatePool (Len);
+  Bulk = NetbufPoolAllocate (Len);
 
   if (Bulk == NULL) {
     goto FreeNBuf;
@@ -132,7 +338,8 @@ NetbufAlloc (
   return Nbuf;
 
 FreeNBuf:
-  FreePool (Nbuf);
+  NetbufPoolFree (Nbuf->Vector, NET_VECTOR_SIZE (1));
+  NetbufPoolFree (Nbuf, NET_BUF_SIZE (1));
   return NULL;
 }
 
@@ -177,14 +384,15 @@ NetbufFreeVector (
 
   } else {
     //
-    // Free each memory block associated with the Vector
+    // Free each memory block associated with the Vector, they are
+    // allocated by NetbufAlloc from the net buffer pool.
     //
     for (Index = 0; Index < Vector->BlockNum; Index++) {
-      gBS->FreePool (Vector->Block[Index].Bulk);
+      NetbufPoolFree (Vector->Block[Index].Bulk, Vector->Block[Index].Len);
     }
   }
 
-  FreePool (Vector);
+  NetbufPoolFree (Vector, NET_VECTOR_SIZE (Vector->BlockNum));
 }
 
 
@@ -218,7 +426,7 @@ NetbufFree (
     // all the sharing of Nbuf increse Vector's RefCnt by one
     //
     NetbufFreeVector (Nbuf->Vector);
-    FreePool (Nbuf);
+    NetbufPoolFree (Nbuf, NET_BUF_SIZE (Nbuf->BlockOpNum));
   }
 }
 
@@ -245,7 +453,7 @@ NetbufClone (
 
   NET_CHECK_SIGNATURE (Nbuf, NET_BUF_SIGNATURE);
 
-  Clone = AllocatePool (NET_BUF_SIZE (Nbuf->BlockOpNum));
+  Clone = NetbufPoolAllocate (NET_BUF_SIZE (Nbuf->BlockOpNum));
 
   if (Clone == NULL) {
     return NULL;
@@ -685,7 +893,8 @@ NetbufGetFragment (
 
 FreeChild:
 
-  FreePool (Child);
+  NetbufPoolFree (Child->Vector, NET_VECTOR_SIZE (1));
+  NetbufPoolFree (Child, NET_BUF_SIZE (BlockOpNum));
   return NULL;
 }
 
@@ -967,7 +1176,7 @@ NetbufFromBufList (
   //
   //Allocate and copy block points
   //
-  Fragment = AllocatePool (sizeof (NET_FRAGMENT) * FragmentNum);
+  Fragment = NetbufPoolAllocate (sizeof (NET_FRAGMENT) * FragmentNum);
 
   if (Fragment == NULL) {
     return NULL;
@@ -989,7 +1198,7 @@ NetbufFromBufList (
   }
 
   Nbuf = NetbufFromExt (Fragment, Current, HeadSpace, HeaderLen, ExtFree, Arg);
-  FreePool (Fragment);
+  NetbufPoolFree (Fragment, sizeof (NET_FRAGMENT) * FragmentNum);
 
   return Nbuf;
 }
@@ -1641,6 +1850,40 @@ NetbufQueFlush (
 }
 
 
+/**
+  Fold a 64-bit ones-complement sum to 16 bits.
+
+  @param[in]   Sum                   The 64-bit sum.
+  @param[in]   Swap                  TRUE if the sum was computed with the
+                                     data shifted by one byte.
+
+  @return    The folded checksum.
+
+**/
+UINT16
+NetFoldChecksum (
+  IN UINT64                 Sum,
+  IN BOOLEAN                Swap
+  )
+{
+  UINT32                    Sum32;
+
+  Sum   = (Sum & 0xffffffff) + RShiftU64 (Sum, 32);
+  Sum   = (Sum & 0xffffffff) + RShiftU64 (Sum, 32);
+  Sum32 = (UINT32) Sum;
+
+  while ((Sum32 >> 16) != 0) {
+    Sum32 = (Sum32 & 0xffff) + (Sum32 >> 16);
+  }
+
+  if (Swap) {
+    return SwapBytes16 ((UINT16) Sum32);
+  }
+
+  return (UINT16) Sum32;
+}
+
+
 /**
   Compute the checksum for a bulk of data.
 
@@ -1657,32 +1900,68 @@ NetblockChecksum (
   IN UINT32                 Len
   )
 {
-  register UINT32           Sum;
+  UINT64                    Sum;
+  UINT32                    *Word;
+  BOOLEAN                   Odd;
 
   Sum = 0;
+  Odd = FALSE;
+
+  //
+  // The ones-complement sum is independent of the byte order, so
+  // data starting at an odd address is summed as if it were shifted
+  // by one byte, and the result is swapped back at the end.
+  //
+  if ((((UINTN) Bulk & 0x01) != 0) && (Len > 0)) {
+    Sum  = (UINT32) *Bulk << 8;
+    Bulk++;
+    Len--;
+    Odd  = TRUE;
+  }
 
-  while (Len > 1) {
-    Sum += *(UINT16 *) Bulk;
+  if ((((UINTN) Bulk & 0x02) != 0) && (Len > 1)) {
+    Sum  += *(UINT16 *) Bulk;
     Bulk += 2;
-    Len -= 2;
+    Len  -= 2;
   }
 
   //
-  // Add left-over byte, if any
+  // Sum aligned 32-bit words into a 64-bit accumulator, which
+  // cannot overflow for any UINT32 length.
   //
-  if (Len > 0) {
-    Sum += *(UINT8 *) Bulk;
+  Word = (UINT32 *) Bulk;
+
+  while (Len >= 16) {
+    Sum  += Word[0];
+    Sum  += Word[1];
+    Sum  += Word[2];
+    Sum  += Word[3];
+    Word += 4;
+    Len  -= 16;
+  }
+
+  while (Len >= 4) {
+    Sum  += *Word;
+    Word++;
+    Len  -= 4;
+  }
+
+  Bulk = (UINT8 *) Word;
+
+  if (Len > 1) {
+    Sum  += *(UINT16 *) Bulk;
+    Bulk += 2;
+    Len  -= 2;
   }
 
   //
-  // Fold 32-bit sum to 16 bits
+  // Add left-over byte, if any
   //
-  while ((Sum >> 16) != 0) {
-    Sum = (Sum & 0xffff) + (Sum >> 16);
-
+  if (Len > 0) {
+    Sum += *Bulk;
   }
 
-  return (UINT16) Sum;
+  return NetFoldChecksum (Sum, Odd);
 }
 
 
@@ -1885,8 +2164,8 @@ NetIpSecNetbufFree (
     if ((Nbuf->Vector->Flag & NET_VECTOR_OWN_FIRST) != 0) {
       FreePool (Nbuf->Vector->Block[0].Bulk);
     }
-    FreePool (Nbuf->Vector);
-    FreePool (Nbuf); 
+    NetbufPoolFree (Nbuf->Vector, NET_VECTOR_SIZE (Nbuf->Vector->BlockNum));
+    NetbufPoolFree (Nbuf, NET_BUF_SIZE (Nbuf->BlockOpNum));
   } 
 }
 
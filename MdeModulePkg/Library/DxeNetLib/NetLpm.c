@@ -0,0 +1,399 @@
+/** @file
+  Longest prefix match table for the IP4 and IP6 route tables.
+
+Copyright (c) 2015, Intel Corporation. All rights reserved.<BR>
+This program and the accompanying materials
+are licensed and made available under the terms and conditions of the BSD License
+which accompanies this distribution.  The full text of the license may be found at
+http://opensource.org/licenses/bsd-license.php
+
+THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+**/
+
+#include <Uefi.h>
+
+#include <Library/NetLib.h>
+#include <Library/BaseLib.h>
+#include <Library/DebugLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
+
+#define NET_LPM_GET_BIT(Key, Bit)  (((Key)[(Bit) >> 3] >> (7 - ((Bit) & 0x07))) & 0x01)
+
+
+/**
+  Get the position of the first bit that differs between two keys.
+
+  @param[in]  Key1           The first key.
+  @param[in]  Key2           The second key.
+  @param[in]  Start          The first bit to compare, the bits before it are
+                             known to be the same.
+  @param[in]  End            The bit to stop comparing at.
+
+  @return                    The position of the first different bit, or End if
+                             the bits from Start to End are the same.
+
+**/
+UINT8
+NetLpmMatchLength (
+  IN CONST UINT8            *Key1,
+  IN CONST UINT8            *Key2,
+  IN UINT8                  Start,
+  IN UINT8                  End
+  )
+{
+  UINTN                     Bit;
+  UINT8                     Diff;
+
+  Bit = Start;
+
+  while (Bit < End) {
+    Diff = (UINT8) ((Key1[Bit >> 3] ^ Key2[Bit >> 3]) << (Bit & 0x07));
+
+    if (Diff != 0) {
+      while ((Diff & 0x80) == 0) {
+        Diff = (UINT8) (Diff << 1);
+        Bit++;
+      }
+
+      return (UINT8) MIN (Bit, End);
+    }
+
+    Bit = (Bit | 0x07) + 1;
+  }
+
+  return End;
+}
+
+
+/**
+  Allocate a trie node for the prefix.
+
+  @param[in]  Prefix         The prefix, in network byte order.
+  @param[in]  PrefixLength   The length of the prefix in bits.
+  @param[in]  Value          The value of the prefix, or NULL for a join node.
+
+  @return                    The node created, or NULL if failed to allocate memory.
+
+**/
+NET_LPM_NODE *
+NetLpmCreateNode (
+  IN CONST UINT8            *Prefix,
+  IN UINT8                  PrefixLength,
+  IN VOID                   *Value
+  )
+{
+  NET_LPM_NODE              *Node;
+  UINTN                     Bytes;
+
+  Node = AllocateZeroPool (sizeof (NET_LPM_NODE));
+
+  if (Node == NULL) {
+    return NULL;
+  }
+
+  //
+  // Keep the prefix with the bits beyond PrefixLength cleared.
+  //
+  Bytes = (PrefixLength + 7) / 8;
+  CopyMem (Node->Prefix, Prefix, Bytes);
+
+  if ((PrefixLength & 0x07) != 0) {
+    Node->Prefix[Bytes - 1] &= (UINT8) (0xFF << (8 - (PrefixLength & 0x07)));
+  }
+
+  Node->PrefixLength = PrefixLength;
+  Node->Value        = Value;
+
+  return Node;
+}
+
+
+/**
+  Free a trie node and all the nodes below it.
+
+  @param[in]  Node           The node to free.
+
+**/
+VOID
+NetLpmFreeNode (
+  IN NET_LPM_NODE           *Node
+  )
+{
+  if (Node == NULL) {
+    return;
+  }
+
+  NetLpmFreeNode (Node->Child[0]);
+  NetLpmFreeNode (Node->Child[1]);
+  FreePool (Node);
+}
+
+
+/**
+  Initialize an empty longest prefix match table.
+
+  @param[out]  Table          The table to initialize.
+
+**/
+VOID
+EFIAPI
+NetLpmInit (
+  OUT NET_LPM_TABLE         *Table
+  )
+{
+  Table->Root      = NULL;
+  Table->PrefixNum = 0;
+}
+
+
+/**
+  Remove all the prefixes from the longest prefix match table. The values
+  stored in the table are not freed.
+
+  @param[in, out]  Table      The table to clean up.
+
+**/
+VOID
+EFIAPI
+NetLpmClean (
+  IN OUT NET_LPM_TABLE      *Table
+  )
+{
+  NetLpmFreeNode (Table->Root);
+  NetLpmInit (Table);
+}
+
+
+/**
+  Add a prefix to the longest prefix match table, or replace the value of the
+  prefix if it is in the table already.
+
+  @param[in, out]  Table          The table to add the prefix to.
+  @param[in]       Prefix         The prefix, in network byte order. The bits
+                                  beyond PrefixLength are ignored.
+  @param[in]       PrefixLength   The length of the prefix in bits.
+  @param[in]       Value          The value of the prefix, it must not be NULL.
+
+  @retval EFI_SUCCESS             The prefix is added or its value replaced.
+  @retval EFI_INVALID_PARAMETER   PrefixLength is too long, or Value is NULL.
+  @retval EFI_OUT_OF_RESOURCES    Failed to allocate memory for the prefix.
+
+**/
+EFI_STATUS
+EFIAPI
+NetLpmInsert (
+  IN OUT NET_LPM_TABLE      *Table,
+  IN     CONST UINT8        *Prefix,
+  IN     UINT8              PrefixLength,
+  IN     VOID               *Value
+  )
+{
+  NET_LPM_NODE              **Link;
+  NET_LPM_NODE              *Node;
+  NET_LPM_NODE              *Join;
+  NET_LPM_NODE              *Leaf;
+  UINT8                     Matched;
+  UINT8                     Length;
+
+  if ((PrefixLength > NET_LPM_MAX_PREFIX_BYTES * 8) || (Value == NULL)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Link    = &Table->Root;
+  Matched = 0;
+
+  while (*Link != NULL) {
+    Node   = *Link;
+    Length = NetLpmMatchLength (Node->Prefix, Prefix, Matched, MIN (Node->PrefixLength, PrefixLength));
+
+    if (Length < Node->PrefixLength) {
+      //
+      // The prefix branches off in the middle of the node's prefix. Put a
+      // node for the common part above the node.
+      //
+      Join = NetLpmCreateNode (Prefix, Length, NULL);
+
+      if (Join == NULL) {
+        return EFI_OUT_OF_RESOURCES;
+      }
+
+      Join->Child[NET_LPM_GET_BIT (Node->Prefix, Length)] = Node;
+
+      if (Length == PrefixLength) {
+        Join->Value = Value;
+      } else {
+        Leaf = NetLpmCreateNode (Prefix, PrefixLength, Value);
+
+        if (Leaf == NULL) {
+          FreePool (Join);
+          return EFI_OUT_OF_RESOURCES;
+        }
+
+        Join->Child[NET_LPM_GET_BIT (Prefix, Length)] = Leaf;
+      }
+
+      *Link = Join;
+      Table->PrefixNum++;
+      return EFI_SUCCESS;
+    }
+
+    if (Node->PrefixLength == PrefixLength) {
+      if (Node->Value == NULL) {
+        Table->PrefixNum++;
+      }
+
+      Node->Value = Value;
+      return EFI_SUCCESS;
+    }
+
+    Matched = Node->PrefixLength;
+    Link    = &Node->Child[NET_LPM_GET_BIT (Prefix, Node->PrefixLength)];
+  }
+
+  *Link = NetLpmCreateNode (Prefix, PrefixLength, Value);
+
+  if (*Link == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Table->PrefixNum++;
+  return EFI_SUCCESS;
+}
+
+
+/**
+  Remove a prefix from the longest prefix match table.
+
+  @param[in, out]  Table          The table to remove the prefix from.
+  @param[in]       Prefix         The prefix, in network byte order.
+  @param[in]       PrefixLength   The length of the prefix in bits.
+
+  @retval EFI_SUCCESS             The prefix is removed.
+  @retval EFI_NOT_FOUND           The prefix isn't in the table.
+
+**/
+EFI_STATUS
+EFIAPI
+NetLpmDelete (
+  IN OUT NET_LPM_TABLE      *Table,
+  IN     CONST UINT8        *Prefix,
+  IN     UINT8              PrefixLength
+  )
+{
+  NET_LPM_NODE              **Link;
+  NET_LPM_NODE              **ParentLink;
+  NET_LPM_NODE              *Node;
+  NET_LPM_NODE              *Parent;
+  UINT8                     Matched;
+
+  Link       = &Table->Root;
+  ParentLink = NULL;
+  Matched    = 0;
+
+  while ((Node = *Link) != NULL) {
+    if ((Node->PrefixLength > PrefixLength) ||
+        (NetLpmMatchLength (Node->Prefix, Prefix, Matched, Node->PrefixLength) < Node->PrefixLength)) {
+      return EFI_NOT_FOUND;
+    }
+
+    if (Node->PrefixLength == PrefixLength) {
+      break;
+    }
+
+    Matched    = Node->PrefixLength;
+    ParentLink = Link;
+    Link       = &Node->Child[NET_LPM_GET_BIT (Prefix, Node->PrefixLength)];
+  }
+
+  if ((Node == NULL) || (Node->Value == NULL)) {
+    return EFI_NOT_FOUND;
+  }
+
+  Node->Value = NULL;
+  Table->PrefixNum--;
+
+  if ((Node->Child[0] != NULL) && (Node->Child[1] != NULL)) {
+    //
+    // The node still joins two branches.
+    //
+    return EFI_SUCCESS;
+  }
+
+  *Link = (Node->Child[0] != NULL) ? Node->Child[0] : Node->Child[1];
+  FreePool (Node);
+
+  //
+  // A join node without a value has two children. If it has lost one,
+  // replace the join node with the other child.
+  //
+  if ((*Link == NULL) && (ParentLink != NULL)) {
+    Parent = *ParentLink;
+
+    if (Parent->Value == NULL) {
+      *ParentLink = (Parent->Child[0] != NULL) ? Parent->Child[0] : Parent->Child[1];
+      FreePool (Parent);
+    }
+  }
+
+  return EFI_SUCCESS;
+}
+
+
+/**
+  Find the longest prefix in the table that matches the address.
+
+  @param[in]   Table            The table to search.
+  @param[in]   Address          The address, in network byte order.
+  @param[in]   AddressLength    The length of the address in bits, 32 for IPv4
+                                and 128 for IPv6.
+  @param[out]  PrefixLength     The length of the matched prefix. Optional.
+
+  @return The value of the longest matching prefix, or NULL if no prefix in
+          the table matches the address.
+
+**/
+VOID *
+EFIAPI
+NetLpmLookup (
+  IN     NET_LPM_TABLE      *Table,
+  IN     CONST UINT8        *Address,
+  IN     UINT8              AddressLength,
+     OUT UINT8              *PrefixLength   OPTIONAL
+  )
+{
+  NET_LPM_NODE              *Node;
+  VOID                      *Value;
+  UINT8                     Length;
+  UINT8                     Matched;
+
+  Value   = NULL;
+  Length  = 0;
+  Matched = 0;
+  Node    = Table->Root;
+
+  while ((Node != NULL) && (Node->PrefixLength <= AddressLength)) {
+    if (NetLpmMatchLength (Node->Prefix, Address, Matched, Node->PrefixLength) < Node->PrefixLength) {
+      break;
+    }
+
+    if (Node->Value != NULL) {
+      Value  = Node->Value;
+      Length = Node->PrefixLength;
+    }
+
+    if (Node->PrefixLength == AddressLength) {
+      break;
+    }
+
+    Matched = Node->PrefixLength;
+    Node    = Node->Child[NET_LPM_GET_BIT (Address, Node->PrefixLength)];
+  }
+
+  if ((Value != NULL) && (PrefixLength != NULL)) {
+    *PrefixLength = Length;
+  }
+
+  return Value;
+}
@@ -40,23 +40,141 @@ UINTN  mDpcQueueDepth = 0;
 UINTN  mMaxDpcQueueDepth = 0;
 
 //
-// Free list of DPC entries.  As DPCs are queued, entries are removed from this
-// free list.  As DPC entries are dispatched, DPC entries are added to the free list.
-// If the free list is empty and a DPC is queued, the free list is grown by allocating
-// an additional set of DPC entries.
+// Counters of the DPC queues, and whether the performance counter counts up.
 //
-LIST_ENTRY      mDpcEntryFreeList = INITIALIZE_LIST_HEAD_VARIABLE(mDpcEntryFreeList);
+DPC_STATISTICS  mDpcStatistics;
+BOOLEAN         mDpcCounterUp = TRUE;
+
+//
+// Event signaled at ExitBootServices() to report the DPC counters.
+//
+EFI_EVENT       mDpcExitBootServicesEvent = NULL;
+
+//
+// Event signaled to dispatch the DPCs left over when PcdDpcDispatchBudget is reached.
+//
+EFI_EVENT       mDpcDispatchEvent = NULL;
 
 //
 // An array of DPC queues.  A DPC queue is allocated for every leval EFI_TPL value.
-// As DPCs are queued, they are added to the end of the linked list.
-// As DPCs are dispatched, they are removed from the beginning of the linked list.
+// As DPCs are queued, they are added to the tail of the ring.
+// As DPCs are dispatched, they are removed from the head of the ring.
 //
-LIST_ENTRY      mDpcQueue[TPL_HIGH_LEVEL + 1];
+DPC_QUEUE       mDpcQueue[TPL_HIGH_LEVEL + 1];
+
+/**
+  Get the performance counter ticks elapsed since a DPC was queued.
+
+  @param  QueueTime  The performance counter when the DPC was queued.
+  @param  Now        The current performance counter.
+
+  @return The elapsed ticks.
+
+**/
+UINT64
+DpcElapsedTicks (
+  IN UINT64  QueueTime,
+  IN UINT64  Now
+  )
+{
+  if (mDpcCounterUp) {
+    return (Now >= QueueTime) ? (Now - QueueTime) : 0;
+  }
+
+  return (QueueTime >= Now) ? (QueueTime - Now) : 0;
+}
+
+/**
+  Make room for one more DPC in a full DPC queue by doubling its size.
+
+  It must be called at TPL_HIGH_LEVEL, and the TPL is lowered to OriginalTpl
+  while the new ring is allocated.  The ring replaced, or the new ring if it
+  isn't needed any more, is returned through FreeEntries so that the caller
+  frees it after restoring the TPL.
+
+  @param  Queue        The full DPC queue.
+  @param  OriginalTpl  The TPL the caller was called at.
+  @param  FreeEntries  Returns the ring to be freed by the caller.
+
+  @retval EFI_SUCCESS           There is room for one more DPC in the queue.
+  @retval EFI_OUT_OF_RESOURCES  OriginalTpl is above TPL_NOTIFY, or the memory
+                                allocation failed.
+
+**/
+EFI_STATUS
+DpcGrowQueue (
+  IN OUT DPC_QUEUE  *Queue,
+  IN     EFI_TPL    OriginalTpl,
+  IN OUT DPC_ENTRY  **FreeEntries
+  )
+{
+  DPC_ENTRY  *Entries;
+  UINTN      Size;
+  UINTN      Index;
+
+  while (Queue->Count == Queue->Size) {
+    //
+    // If the current TPL is greater than TPL_NOTIFY, then memory allocations
+    // can not be performed, so the queue can not be expanded.  In this case
+    // return EFI_OUT_OF_RESOURCES.
+    //
+    if (OriginalTpl > TPL_NOTIFY) {
+      return EFI_OUT_OF_RESOURCES;
+    }
+
+    Size = (Queue->Size == 0) ? DPC_QUEUE_INITIAL_SIZE : (Queue->Size * 2);
+
+    //
+    // Lower the TPL level to perform a memory allocation
+    //
+    gBS->RestoreTPL (OriginalTpl);
+
+    if (*FreeEntries != NULL) {
+      FreePool (*FreeEntries);
+      *FreeEntries = NULL;
+    }
+
+    Entries = AllocatePool (Size * sizeof (DPC_ENTRY));
+
+    //
+    // Raise the TPL level back to TPL_HIGH_LEVEL for DPC queue operations
+    //
+    gBS->RaiseTPL (TPL_HIGH_LEVEL);
+
+    if (Entries == NULL) {
+      return EFI_OUT_OF_RESOURCES;
+    }
+
+    if (Size <= Queue->Size) {
+      //
+      // The queue has been expanded by a DPC queued at a higher TPL meanwhile.
+      //
+      *FreeEntries = Entries;
+      continue;
+    }
+
+    //
+    // Move the queued DPCs to the start of the new ring in order.
+    //
+    for (Index = 0; Index < Queue->Count; Index++) {
+      Entries[Index] = Queue->Entries[(Queue->Head + Index) & (Queue->Size - 1)];
+    }
+
+    *FreeEntries   = Queue->Entries;
+    Queue->Entries = Entries;
+    Queue->Size    = Size;
+    Queue->Head    = 0;
+  }
+
+  return EFI_SUCCESS;
+}
 
 /**
   Add a Deferred Procedure Call to the end of the DPC queue.
 
+  If the same DpcProcedure and DpcContext pair is among the most recently
+  queued DPCs at DpcTpl, it isn't queued again.
+
   @param  This          Protocol instance pointer.
   @param  DpcTpl        The EFI_TPL that the DPC should be invoked.
   @param  DpcProcedure  Pointer to the DPC's function.
@@ -81,8 +199,11 @@ DpcQueueDpc (
 {
   EFI_STATUS  ReturnStatus;
   EFI_TPL     OriginalTpl;
+  DPC_QUEUE   *Queue;
   DPC_ENTRY   *DpcEntry;
+  DPC_ENTRY   *FreeEntries;
   UINTN       Index;
+  UINTN       Window;
 
   //
   // Make sure DpcTpl is valid
@@ -102,6 +223,7 @@ DpcQueueDpc (
   // Assume this function will succeed
   //
   ReturnStatus = EFI_SUCCESS;
+  FreeEntries  = NULL;
 
   //
   // Raise the TPL level to TPL_HIGH_LEVEL for DPC list operation and save the
@@ -109,77 +231,49 @@ DpcQueueDpc (
   //
   OriginalTpl = gBS->RaiseTPL (TPL_HIGH_LEVEL);
 
+  Queue = &mDpcQueue[DpcTpl];
+
   //
-  // Check to see if there are any entries in the DPC free list
+  // Coalesce the DPC with the same one queued recently, such as a second
+  // timer tick or event notification before the first one is dispatched.
+  // EFI_DPC_PROTOCOL promises one invocation per QueueDpc() call, so this is
+  // only done on platforms whose DPC procedures are known to be idempotent.
   //
-  if (IsListEmpty (&mDpcEntryFreeList)) {
-    //
-    // If the current TPL is greater than TPL_NOTIFY, then memory allocations
-    // can not be performed, so the free list can not be expanded.  In this case
-    // return EFI_OUT_OF_RESOURCES.
-    //
-    if (OriginalTpl > TPL_NOTIFY) {
-      ReturnStatus = EFI_OUT_OF_RESOURCES;
-      goto Done;
-    }
-
-    //
-    // Add 64 DPC entries to the free list
-    //
-    for (Index = 0; Index < 64; Index++) {
-      //
-      // Lower the TPL level to perform a memory allocation
-      //
-      gBS->RestoreTPL (OriginalTpl);
-
-      //
-      // Allocate a new DPC entry
-      //
-      DpcEntry = AllocatePool (sizeof (DPC_ENTRY));
-
-      //
-      // Raise the TPL level back to TPL_HIGH_LEVEL for DPC list operations
-      //
-      gBS->RaiseTPL (TPL_HIGH_LEVEL);
+  Window = 0;
+  if (FeaturePcdGet (PcdDpcCoalesce)) {
+    Window = MIN (Queue->Count, DPC_COALESCE_WINDOW);
+  }
 
-      //
-      // If the allocation of a DPC entry fails, and the free list is empty,
-      // then return EFI_OUT_OF_RESOURCES.
-      //
-      if (DpcEntry == NULL) {
-        if (IsListEmpty (&mDpcEntryFreeList)) {
-          ReturnStatus = EFI_OUT_OF_RESOURCES;
-          goto Done;
-        }
-      }
+  for (Index = 1; Index <= Window; Index++) {
+    DpcEntry = &Queue->Entries[(Queue->Head + Queue->Count - Index) & (Queue->Size - 1)];
 
-      //
-      // Add the newly allocated DPC entry to the DPC free list
-      //
-      InsertTailList (&mDpcEntryFreeList, &DpcEntry->ListEntry);
+    if ((DpcEntry->DpcProcedure == DpcProcedure) && (DpcEntry->DpcContext == DpcContext)) {
+      mDpcStatistics.Coalesced++;
+      goto Done;
     }
   }
 
   //
-  // Retrieve the first node from the free list of DPCs
+  // Check to see if there is room in the DPC queue
   //
-  DpcEntry = (DPC_ENTRY *)(GetFirstNode (&mDpcEntryFreeList));
+  if (Queue->Count == Queue->Size) {
+    ReturnStatus = DpcGrowQueue (Queue, OriginalTpl, &FreeEntries);
 
-  //
-  // Remove the first node from the free list of DPCs
-  //
-  RemoveEntryList (&DpcEntry->ListEntry);
+    if (EFI_ERROR (ReturnStatus)) {
+      goto Done;
+    }
+  }
 
   //
-  // Fill in the DPC entry with the DpcProcedure and DpcContext
+  // Fill in the DPC entry at the tail of the DPC queue for the specified DplTpl.
   //
+  DpcEntry = &Queue->Entries[(Queue->Head + Queue->Count) & (Queue->Size - 1)];
   DpcEntry->DpcProcedure = DpcProcedure;
   DpcEntry->DpcContext   = DpcContext;
+  DpcEntry->QueueTime    = GetPerformanceCounter ();
+  Queue->Count++;
 
-  //
-  // Add the DPC entry to the end of the list for the specified DplTpl.
-  //
-  InsertTailList (&mDpcQueue[DpcTpl], &DpcEntry->ListEntry);
+  mDpcStatistics.Queued++;
 
   //
   // Increment the measured DPC queue depth across all TPLs
@@ -199,6 +293,10 @@ Done:
   //
   gBS->RestoreTPL (OriginalTpl);
 
+  if (FreeEntries != NULL) {
+    FreePool (FreeEntries);
+  }
+
   return ReturnStatus;
 }
 
@@ -208,6 +306,12 @@ Done:
   they were queued.  DPCs with higher DpcTpl values are invoked before DPCs with
   lower DpcTpl values.
 
+  Each DPC is invoked as soon as it is taken off its queue, so that a DPC
+  dispatching DPCs itself keeps the queue order.  Only the counters are
+  updated once per call.  If PcdDpcDispatchBudget isn't 0, at most that many
+  DPCs are invoked at each TPL, and mDpcDispatchEvent is signaled to invoke
+  the rest.
+
   @param  This  Protocol instance pointer.
 
   @retval EFI_SUCCESS    One or more DPCs were invoked.
@@ -223,13 +327,29 @@ DpcDispatchDpc (
   EFI_STATUS  ReturnStatus;
   EFI_TPL     OriginalTpl;
   EFI_TPL     Tpl;
-  DPC_ENTRY   *DpcEntry;
+  DPC_QUEUE   *Queue;
+  DPC_ENTRY   DpcEntry;
+  UINTN       Budget;
+  UINTN       Dispatched;
+  UINT64      TotalDispatched;
+  UINT64      TotalLatency;
+  UINT64      MaxLatency;
+  UINT64      Latency;
 
   //
   // Assume that no DPCs will be invoked
   //
   ReturnStatus = EFI_NOT_FOUND;
 
+  Budget = PcdGet32 (PcdDpcDispatchBudget);
+  if (Budget == 0) {
+    Budget = MAX_UINTN;
+  }
+
+  TotalDispatched = 0;
+  TotalLatency    = 0;
+  MaxLatency      = 0;
+
   //
   // Raise the TPL level to TPL_HIGH_LEVEL for DPC list operation and save the
   // current TPL value so it can be restored when this function returns.
@@ -244,19 +364,34 @@ DpcDispatchDpc (
     // Loop from TPL_HIGH_LEVEL down to the current TPL value
     //
     for (Tpl = TPL_HIGH_LEVEL; Tpl >= OriginalTpl; Tpl--) {
+      Queue      = &mDpcQueue[Tpl];
+      Dispatched = 0;
+
       //
       // Check to see if the DPC queue is empty
       //
-      while (!IsListEmpty (&mDpcQueue[Tpl])) {
-        //
-        // Retrieve the first DPC entry from the DPC queue specified by Tpl
-        //
-        DpcEntry = (DPC_ENTRY *)(GetFirstNode (&mDpcQueue[Tpl]));
+      while (Queue->Count > 0) {
+        if (Dispatched == Budget) {
+          //
+          // Leave the rest to a later dispatch, which nothing else may trigger.
+          //
+          mDpcStatistics.Deferred++;
+          gBS->SignalEvent (mDpcDispatchEvent);
+          break;
+        }
 
         //
-        // Remove the first DPC entry from the DPC queue specified by Tpl
+        // Take the DPC entry off the head of the DPC queue specified by Tpl
         //
-        RemoveEntryList (&DpcEntry->ListEntry);
+        DpcEntry    = Queue->Entries[Queue->Head];
+        Queue->Head = (Queue->Head + 1) & (Queue->Size - 1);
+        Queue->Count--;
+        Dispatched++;
+
+        Latency       = DpcElapsedTicks (DpcEntry.QueueTime, GetPerformanceCounter ());
+        TotalLatency += Latency;
+        MaxLatency    = MAX (MaxLatency, Latency);
+        TotalDispatched++;
 
         //
         // Decrement the measured DPC Queue Depth across all TPLs
@@ -271,7 +406,7 @@ DpcDispatchDpc (
         //
         // Invoke the DPC passing in its context
         //
-        (DpcEntry->DpcProcedure) (DpcEntry->DpcContext);
+        (DpcEntry.DpcProcedure) (DpcEntry.DpcContext);
 
         //
         // At least one DPC has been invoked, so set the return status to EFI_SUCCESS
@@ -282,15 +417,17 @@ DpcDispatchDpc (
         // Raise the TPL level back to TPL_HIGH_LEVEL for DPC list operations
         //
         gBS->RaiseTPL (TPL_HIGH_LEVEL);
-
-        //
-        // Add the invoked DPC entry to the DPC free list
-        //
-        InsertTailList (&mDpcEntryFreeList, &DpcEntry->ListEntry);
       }
     }
   }
 
+  if (TotalDispatched != 0) {
+    mDpcStatistics.Dispatched   += TotalDispatched;
+    mDpcStatistics.Calls++;
+    mDpcStatistics.TotalLatency += TotalLatency;
+    mDpcStatistics.MaxLatency    = MAX (mDpcStatistics.MaxLatency, MaxLatency);
+  }
+
   //
   // Restore the original TPL level when this function was called
   //
@@ -299,6 +436,59 @@ DpcDispatchDpc (
   return ReturnStatus;
 }
 
+/**
+  Dispatch the DPCs left over by a DispatchDpc() call that reached
+  PcdDpcDispatchBudget.
+
+  @param  Event    The event signaled.
+  @param  Context  Not used.
+
+**/
+VOID
+EFIAPI
+DpcOnDispatchEvent (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  DpcDispatchDpc (&mDpc);
+}
+
+/**
+  Report the counters of the DPC queues at ExitBootServices().
+
+  @param  Event    The event signaled.
+  @param  Context  Not used.
+
+**/
+VOID
+EFIAPI
+DpcOnExitBootServices (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  UINT64  AverageLatency;
+
+  AverageLatency = 0;
+  if (mDpcStatistics.Dispatched != 0) {
+    AverageLatency = DivU64x64Remainder (mDpcStatistics.TotalLatency, mDpcStatistics.Dispatched, NULL);
+  }
+
+  DEBUG ((
+    EFI_D_INFO,
+    "DPC: %ld queued, %ld coalesced, %ld dispatched in %ld calls, %ld deferred, max depth %d, latency avg %ld ns max %ld ns\n",
+    mDpcStatistics.Queued,
+    mDpcStatistics.Coalesced,
+    mDpcStatistics.Dispatched,
+    mDpcStatistics.Calls,
+    mDpcStatistics.Deferred,
+    mMaxDpcQueueDepth,
+    GetTimeInNanoSecond (AverageLatency),
+    GetTimeInNanoSecond (mDpcStatistics.MaxLatency)
+    ));
+}
+
 /**
   The entry point for DPC driver which installs the EFI_DPC_PROTOCOL onto a new handle.
 
@@ -318,7 +508,8 @@ DpcDriverEntryPoint (
   )
 {
   EFI_STATUS  Status;
-  UINTN       Index;
+  UINT64      StartValue;
+  UINT64      EndValue;
 
   //
   // ASSERT() if the EFI_DPC_PROTOCOL is already present in the handle database
@@ -326,12 +517,49 @@ DpcDriverEntryPoint (
   ASSERT_PROTOCOL_ALREADY_INSTALLED (NULL, &gEfiDpcProtocolGuid);
 
   //
-  // Initialize the DPC queue for all possible TPL values
+  // The DPC queues for all possible TPL values are empty rings.  Set up the
+  // ones of TPL_CALLBACK and TPL_NOTIFY, which the network stack uses, now
+  // so that DPCs can be queued above TPL_NOTIFY too.
   //
-  for (Index = 0; Index <= TPL_HIGH_LEVEL; Index++) {
-    InitializeListHead (&mDpcQueue[Index]);
+  mDpcQueue[TPL_CALLBACK].Entries = AllocatePool (DPC_QUEUE_INITIAL_SIZE * sizeof (DPC_ENTRY));
+  mDpcQueue[TPL_NOTIFY].Entries   = AllocatePool (DPC_QUEUE_INITIAL_SIZE * sizeof (DPC_ENTRY));
+  if ((mDpcQueue[TPL_CALLBACK].Entries == NULL) || (mDpcQueue[TPL_NOTIFY].Entries == NULL)) {
+    if (mDpcQueue[TPL_CALLBACK].Entries != NULL) {
+      FreePool (mDpcQueue[TPL_CALLBACK].Entries);
+      mDpcQueue[TPL_CALLBACK].Entries = NULL;
+    }
+    if (mDpcQueue[TPL_NOTIFY].Entries != NULL) {
+      FreePool (mDpcQueue[TPL_NOTIFY].Entries);
+      mDpcQueue[TPL_NOTIFY].Entries = NULL;
+    }
+    return EFI_OUT_OF_RESOURCES;
   }
 
+  mDpcQueue[TPL_CALLBACK].Size = DPC_QUEUE_INITIAL_SIZE;
+  mDpcQueue[TPL_NOTIFY].Size   = DPC_QUEUE_INITIAL_SIZE;
+
+  GetPerformanceCounterProperties (&StartValue, &EndValue);
+  mDpcCounterUp = (BOOLEAN) (EndValue >= StartValue);
+
+  Status = gBS->CreateEventEx (
+                  EVT_NOTIFY_SIGNAL,
+                  TPL_CALLBACK,
+                  DpcOnExitBootServices,
+                  NULL,
+                  &gEfiEventExitBootServicesGuid,
+                  &mDpcExitBootServicesEvent
+                  );
+  ASSERT_EFI_ERROR (Status);
+
+  Status = gBS->CreateEvent (
+                  EVT_NOTIFY_SIGNAL,
+                  TPL_CALLBACK,
+                  DpcOnDispatchEvent,
+                  NULL,
+                  &mDpcDispatchEvent
+                  );
+  ASSERT_EFI_ERROR (Status);
+
   //
   // Install the EFI_DPC_PROTOCOL instance onto a new handle
   //
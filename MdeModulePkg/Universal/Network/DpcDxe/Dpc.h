@@ -27,18 +27,57 @@ Abstract:
 #include <Library/UefiDriverEntryPoint.h>
 #include <Library/UefiBootServicesTableLib.h>
 #include <Library/MemoryAllocationLib.h>
+#include <Library/TimerLib.h>
+#include <Library/PcdLib.h>
 #include <Protocol/Dpc.h>
+#include <Guid/EventGroup.h>
 
 //
-// Internal data struture for managing DPCs.  A DPC entry is either on the free
-// list or on a DPC queue at a specific EFI_TPL.
+// Number of entries the DPC queues of TPL_CALLBACK and TPL_NOTIFY start with.
+// A full queue is doubled in size.
+//
+#define DPC_QUEUE_INITIAL_SIZE  64
+
+//
+// Number of the most recently queued DPCs checked for a duplicate of a new DPC,
+// if PcdDpcCoalesce is TRUE.
+//
+#define DPC_COALESCE_WINDOW     16
+
+//
+// Internal data struture for managing DPCs.  A DPC entry is a slot of the DPC
+// queue at a specific EFI_TPL.
 //
 typedef struct {
-  LIST_ENTRY             ListEntry;
   EFI_DPC_PROCEDURE  DpcProcedure;
   VOID               *DpcContext;
+  UINT64             QueueTime;     // Performance counter when it was queued
 } DPC_ENTRY;
 
+//
+// The ring of the DPCs queued at one EFI_TPL.  Head is the slot of the oldest
+// DPC and Count is the number of DPCs in the ring.  Size is 0 or a power of 2.
+//
+typedef struct {
+  DPC_ENTRY          *Entries;
+  UINTN              Size;
+  UINTN              Head;
+  UINTN              Count;
+} DPC_QUEUE;
+
+//
+// Counters of the DPC queues, reported at ExitBootServices().
+//
+typedef struct {
+  UINT64             Queued;        // DPCs added to the queues
+  UINT64             Coalesced;     // DPCs dropped since they were already queued
+  UINT64             Dispatched;    // DPCs invoked
+  UINT64             Calls;         // DispatchDpc() calls that invoked DPCs
+  UINT64             Deferred;      // DispatchDpc() calls that reached the budget
+  UINT64             TotalLatency;  // Performance counter ticks from queue to dispatch
+  UINT64             MaxLatency;
+} DPC_STATISTICS;
+
 /**
   Add a Deferred Procedure Call to the end of the DPC queue.
 
@@ -214,6 +214,11 @@ Ip4CreateService (
   IpSb->ReconfigEvent               = NULL;
   IpSb->ActiveEvent                 = NULL;
 
+  IpSb->RxFrames                    = 0;
+  IpSb->RxCopies                    = 0;
+  IpSb->RxCopiedBytes               = 0;
+  IpSb->RxWrapAllocs                = 0;
+
   //
   // Create various resources. First create the route table, timer
   // event and MNP child. IGMP, interface's initialization depend
@@ -328,6 +333,15 @@ Ip4CleanService (
 {
   EFI_STATUS                Status;
 
+  DEBUG ((
+    EFI_D_INFO,
+    "Ip4CleanService: Rx %ld frames, %ld copies (%ld bytes), %ld wrap allocs.\n",
+    IpSb->RxFrames,
+    IpSb->RxCopies,
+    IpSb->RxCopiedBytes,
+    IpSb->RxWrapAllocs
+    ));
+
   if (IpSb->DefaultInterface != NULL) {
     Status = Ip4FreeInterface (IpSb->DefaultInterface, NULL);
 
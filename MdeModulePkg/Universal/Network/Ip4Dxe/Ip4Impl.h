@@ -204,6 +204,14 @@ struct _IP4_SERVICE {
 
   UINT32                          MaxPacketSize;
   UINT32                          OldMaxPacketSize; ///< The MTU before IPsec enable.
+
+  //
+  // Receive path counters
+  //
+  UINT64                          RxFrames;       ///< Frames accepted from MNP.
+  UINT64                          RxCopies;       ///< Packets duplicated for a sharing instance.
+  UINT64                          RxCopiedBytes;  ///< Bytes copied by those duplications.
+  UINT64                          RxWrapAllocs;   ///< IP4_RXDATA_WRAPs allocated.
 };
 
 #define IP4_INSTANCE_FROM_PROTOCOL(Ip4) \
@@ -849,6 +849,8 @@ Ip4AccpetFrame (
     goto DROP;
   }
 
+  IpSb->RxFrames++;
+
   Head      = (IP4_HEAD *) NetbufGetByte (Packet, 0, NULL);
   ASSERT (Head != NULL);
   OptionLen = (Head->HeadLen << 2) - IP4_MIN_HEADLEN;
@@ -1175,6 +1177,7 @@ Ip4WrapRxData (
     return NULL;
   }
 
+  IpInstance->Service->RxWrapAllocs++;
   InitializeListHead (&Wrap->Link);
 
   Wrap->IpInstance  = IpInstance;
@@ -1289,6 +1292,9 @@ Ip4InstanceDeliverPacket (
         return EFI_OUT_OF_RESOURCES;
       }
 
+      IpInstance->Service->RxCopies++;
+      IpInstance->Service->RxCopiedBytes += Dup->TotalSize;
+
       if (!IpInstance->ConfigData.RawData) {
         //
         // Copy the IP head over. The packet to deliver up is
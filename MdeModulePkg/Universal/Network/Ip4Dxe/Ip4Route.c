@@ -103,11 +103,12 @@ Ip4CreateRouteCacheEntry (
 
   InitializeListHead (&RtCacheEntry->Link);
 
-  RtCacheEntry->RefCnt  = 1;
-  RtCacheEntry->Dest    = Dst;
-  RtCacheEntry->Src     = Src;
-  RtCacheEntry->NextHop = GateWay;
-  RtCacheEntry->Tag     = Tag;
+  RtCacheEntry->RefCnt     = 1;
+  RtCacheEntry->Dest       = Dst;
+  RtCacheEntry->Src        = Src;
+  RtCacheEntry->NextHop    = GateWay;
+  RtCacheEntry->Tag        = Tag;
+  RtCacheEntry->Generation = 0;
 
   return RtCacheEntry;
 }
@@ -201,13 +202,16 @@ Ip4CreateRouteTable (
     return NULL;
   }
 
-  RtTable->RefCnt   = 1;
-  RtTable->TotalNum = 0;
+  RtTable->RefCnt     = 1;
+  RtTable->TotalNum   = 0;
+  RtTable->Generation = 0;
 
   for (Index = 0; Index < IP4_MASK_NUM; Index++) {
     InitializeListHead (&(RtTable->RouteArea[Index]));
   }
 
+  NetLpmInit (&RtTable->Lpm);
+
   RtTable->Next = NULL;
 
   Ip4InitRouteCache (&RtTable->Cache);
@@ -250,6 +254,7 @@ Ip4FreeRouteTable (
     }
   }
 
+  NetLpmClean (&RtTable->Lpm);
   Ip4CleanRouteCache (&RtTable->Cache);
 
   FreePool (RtTable);
@@ -292,6 +297,77 @@ Ip4PurgeRouteCache (
 }
 
 
+/**
+  Get the generation of the route table and the default route table
+  chained to it. A route cache entry tagged with another generation
+  is stale.
+
+  @param[in]  RtTable               The route table
+
+  @return The generation of the route tables.
+
+**/
+UINT32
+Ip4GetRouteGeneration (
+  IN IP4_ROUTE_TABLE        *RtTable
+  )
+{
+  UINT32                    Generation;
+
+  Generation = 0;
+
+  for (; RtTable != NULL; RtTable = RtTable->Next) {
+    Generation += RtTable->Generation;
+  }
+
+  return Generation;
+}
+
+
+/**
+  Point the longest prefix match table at the first route entry of
+  the Dest/Netmask network in its route area, or remove the network
+  from it if there is no such route entry any more. It is called
+  after a route entry of the network is added or removed.
+
+  @param[in, out]  RtTable      The route table
+  @param[in]       Dest         The destination network
+  @param[in]       Netmask      The netmask of the destination
+
+  @retval EFI_SUCCESS           The longest prefix match table is updated.
+  @retval EFI_OUT_OF_RESOURCES  Failed to allocate memory for the network.
+
+**/
+EFI_STATUS
+Ip4UpdateRouteLpm (
+  IN OUT IP4_ROUTE_TABLE        *RtTable,
+  IN     IP4_ADDR               Dest,
+  IN     IP4_ADDR               Netmask
+  )
+{
+  LIST_ENTRY                *Entry;
+  IP4_ROUTE_ENTRY           *RtEntry;
+  IP4_ADDR                  Prefix;
+  UINT8                     Len;
+
+  Len    = (UINT8) NetGetMaskLength (Netmask);
+  Prefix = HTONL (Dest & Netmask);
+
+  RtTable->Generation++;
+
+  NET_LIST_FOR_EACH (Entry, &(RtTable->RouteArea[Len])) {
+    RtEntry = NET_LIST_USER_STRUCT (Entry, IP4_ROUTE_ENTRY, Link);
+
+    if (IP4_NET_EQUAL (RtEntry->Dest, Dest, Netmask)) {
+      return NetLpmInsert (&RtTable->Lpm, (UINT8 *) &Prefix, Len, RtEntry);
+    }
+  }
+
+  NetLpmDelete (&RtTable->Lpm, (UINT8 *) &Prefix, Len);
+  return EFI_SUCCESS;
+}
+
+
 /**
   Add a route entry to the route table. All the IP4_ADDRs are in
   host byte order.
@@ -349,6 +425,13 @@ Ip4AddRoute (
   }
 
   InsertHeadList (Head, &RtEntry->Link);
+
+  if (EFI_ERROR (Ip4UpdateRouteLpm (RtTable, Dest, Netmask))) {
+    RemoveEntryList (&RtEntry->Link);
+    Ip4FreeRouteEntry (RtEntry);
+    return EFI_OUT_OF_RESOURCES;
+  }
+
   RtTable->TotalNum++;
 
   return EFI_SUCCESS;
@@ -391,6 +474,8 @@ Ip4DelRoute (
       RemoveEntryList (Entry);
       Ip4FreeRouteEntry  (RtEntry);
 
+      Ip4UpdateRouteLpm (RtTable, Dest, Netmask);
+
       RtTable->TotalNum--;
       return EFI_SUCCESS;
     }
@@ -406,6 +491,9 @@ Ip4DelRoute (
   host redirect according to RFC1122. So, only route cache entries
   are modified according to the ICMP redirect message.
 
+  A stale route cache entry, created before the route tables changed,
+  is removed rather than returned.
+
   @param[in]  RtTable               The route table to search the cache for
   @param[in]  Dest                  The destination address
   @param[in]  Src                   The source address
@@ -431,6 +519,12 @@ Ip4FindRouteCache (
     RtCacheEntry = NET_LIST_USER_STRUCT (Entry, IP4_ROUTE_CACHE_ENTRY, Link);
 
     if ((RtCacheEntry->Dest == Dest) && (RtCacheEntry->Src == Src)) {
+      if (RtCacheEntry->Generation != Ip4GetRouteGeneration (RtTable)) {
+        RemoveEntryList (Entry);
+        Ip4FreeRouteCacheEntry (RtCacheEntry);
+        return NULL;
+      }
+
       NET_GET_REF (RtCacheEntry);
       return RtCacheEntry;
     }
@@ -441,11 +535,10 @@ Ip4FindRouteCache (
 
 
 /**
-  Search the route table for a most specific match to the Dst. It searches
-  from the longest route area (mask length == 32) to the shortest route area
-  (default routes). In each route area, it will first search the instance's
-  route table, then the default route table. This is required by the following
-  requirements:
+  Search the route table for a most specific match to the Dst. It looks up
+  the longest prefix match table of the instance's route table, then that of
+  the default route table, and a match in the default route table is used
+  only if it is longer. This is required by the following requirements:
   1. IP search the route table for a most specific match
   2. The local route entries have precedence over the default route entry.
 
@@ -462,28 +555,31 @@ Ip4FindRouteEntry (
   IN IP4_ADDR               Dst
   )
 {
-  LIST_ENTRY                *Entry;
   IP4_ROUTE_ENTRY           *RtEntry;
+  IP4_ROUTE_ENTRY           *Match;
   IP4_ROUTE_TABLE           *Table;
-  INTN                      Index;
+  IP4_ADDR                  Address;
+  UINT8                     Len;
+  UINT8                     MatchLen;
 
-  RtEntry = NULL;
+  RtEntry  = NULL;
+  MatchLen = 0;
+  Address  = HTONL (Dst);
 
-  for (Index = IP4_MASK_NUM - 1; Index >= 0; Index--) {
-    for (Table = RtTable; Table != NULL; Table = Table->Next) {
-      NET_LIST_FOR_EACH (Entry, &Table->RouteArea[Index]) {
-        RtEntry = NET_LIST_USER_STRUCT (Entry, IP4_ROUTE_ENTRY, Link);
+  for (Table = RtTable; Table != NULL; Table = Table->Next) {
+    Match = NetLpmLookup (&Table->Lpm, (UINT8 *) &Address, IP4_MASK_NUM - 1, &Len);
 
-        if (IP4_NET_EQUAL (RtEntry->Dest, Dst, RtEntry->Netmask)) {
-          NET_GET_REF (RtEntry);
-          return RtEntry;
-        }
-      }
+    if ((Match != NULL) && ((RtEntry == NULL) || (Len > MatchLen))) {
+      RtEntry  = Match;
+      MatchLen = Len;
     }
   }
 
+  if (RtEntry != NULL) {
+    NET_GET_REF (RtEntry);
+  }
 
-  return NULL;
+  return RtEntry;
 }
 
 
@@ -561,6 +657,8 @@ Ip4Route (
     return NULL;
   }
 
+  RtCacheEntry->Generation = Ip4GetRouteGeneration (RtTable);
+
   InsertHeadList (Head, &RtCacheEntry->Link);
   NET_GET_REF (RtCacheEntry);
 
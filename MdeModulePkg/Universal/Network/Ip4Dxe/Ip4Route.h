@@ -57,6 +57,7 @@ typedef struct {
   IP4_ADDR                  Src;
   IP4_ADDR                  NextHop;
   UINTN                     Tag;
+  UINT32                    Generation;
 } IP4_ROUTE_CACHE_ENTRY;
 
 ///
@@ -78,12 +79,19 @@ typedef struct {
 /// together in one route area. For example, RouteArea[0] contains
 /// the default routes. A route table also contains a route cache.
 ///
+/// The route areas are indexed by a longest prefix match table,
+/// which maps each destination network to the first route entry
+/// of it in the route area. Generation is increased whenever the
+/// routes change, a route cache entry created before that is stale.
+///
 typedef struct _IP4_ROUTE_TABLE IP4_ROUTE_TABLE;
 
 struct _IP4_ROUTE_TABLE {
   INTN                      RefCnt;
   UINT32                    TotalNum;
   LIST_ENTRY                RouteArea[IP4_MASK_NUM];
+  NET_LPM_TABLE             Lpm;
+  UINT32                    Generation;
   IP4_ROUTE_TABLE           *Next;
   IP4_ROUTE_CACHE           Cache;
 };
@@ -92,6 +92,7 @@ MnpAddFreeNbuf (
   }
 
   MnpDeviceData->NbufCnt += Index;
+  MnpDeviceData->RxStats.NbufAllocs += Index;
   return Status;
 }
 
@@ -268,6 +269,7 @@ MnpInitializeDeviceData (
   //
   InitializeListHead (&MnpDeviceData->ServiceList);
   InitializeListHead (&MnpDeviceData->GroupAddressList);
+  InitializeListHead (&MnpDeviceData->FreeRxDataWrapList);
 
   //
   // Get the buffer length used to allocate NET_BUF to hold data received
@@ -445,8 +447,21 @@ MnpDestroyDeviceData (
   IN     EFI_HANDLE        ImageHandle
   )
 {
+  MNP_RXDATA_WRAP *RxDataWrap;
+
   NET_CHECK_SIGNATURE (MnpDeviceData, MNP_DEVICE_DATA_SIGNATURE);
 
+  DEBUG ((
+    EFI_D_INFO,
+    "MnpDestroyDeviceData: Rx %ld frames, %ld copies (%ld bytes), %ld NET_BUF allocs, %ld/%ld wrap allocs/reuses.\n",
+    MnpDeviceData->RxStats.Frames,
+    MnpDeviceData->RxStats.Copies,
+    MnpDeviceData->RxStats.CopiedBytes,
+    MnpDeviceData->RxStats.NbufAllocs,
+    MnpDeviceData->RxStats.WrapAllocs,
+    MnpDeviceData->RxStats.WrapReuses
+    ));
+
   //
   // Free Vlan Config variable name string
   //
@@ -483,6 +498,18 @@ MnpDestroyDeviceData (
   MnpDeviceData->NbufCnt -= MnpDeviceData->FreeNbufQue.BufNum;
   NetbufQueFlush (&MnpDeviceData->FreeNbufQue);
 
+  //
+  // Free the cached RxDataWraps together with their recycle events.
+  //
+  while (!IsListEmpty (&MnpDeviceData->FreeRxDataWrapList)) {
+    RxDataWrap = NET_LIST_HEAD (&MnpDeviceData->FreeRxDataWrapList, MNP_RXDATA_WRAP, WrapEntry);
+    RemoveEntryList (&RxDataWrap->WrapEntry);
+
+    gBS->CloseEvent (RxDataWrap->RxData.RecycleEvent);
+    FreePool (RxDataWrap);
+  }
+  MnpDeviceData->FreeRxDataWrapCount = 0;
+
   //
   // Close the Simple Network Protocol.
   //
@@ -39,6 +39,18 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 
 #define MNP_DEVICE_DATA_SIGNATURE  SIGNATURE_32 ('M', 'n', 'p', 'D')
 
+//
+// Receive path counters of a MNP device.
+//
+typedef struct {
+  UINT64                        Frames;       ///< Frames received from SNP.
+  UINT64                        Copies;       ///< Frames duplicated for a sharing instance.
+  UINT64                        CopiedBytes;  ///< Bytes copied by those duplications.
+  UINT64                        NbufAllocs;   ///< NET_BUFs allocated into FreeNbufQue.
+  UINT64                        WrapAllocs;   ///< MNP_RXDATA_WRAPs allocated.
+  UINT64                        WrapReuses;   ///< MNP_RXDATA_WRAPs taken from FreeRxDataWrapList.
+} MNP_RX_STATS;
+
 //
 // Global Variables
 //
@@ -91,6 +103,15 @@ typedef struct {
   UINT32                        PaddingSize;
   NET_BUF                       *RxNbufCache;
   UINT8                         *TxBuf;
+
+  //
+  // Recycled MNP_RXDATA_WRAPs, each still owning its recycle event, so that
+  // delivering a packet doesn't cost a pool allocation and an event creation.
+  //
+  LIST_ENTRY                    FreeRxDataWrapList;
+  UINT32                        FreeRxDataWrapCount;
+
+  MNP_RX_STATS                  RxStats;
 } MNP_DEVICE_DATA;
 
 #define MNP_DEVICE_DATA_FROM_THIS(a) \
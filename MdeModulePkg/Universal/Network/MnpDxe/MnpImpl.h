@@ -29,6 +29,7 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #define MNP_MAX_NET_BUFFER_NUM        65536
 
 #define MNP_MAX_RCVD_PACKET_QUE_SIZE  256
+#define MNP_MAX_FREE_RXDATA_WRAP      64
 
 #define MNP_RECEIVE_UNICAST           0x01
 #define MNP_RECEIVE_BROADCAST         0x02
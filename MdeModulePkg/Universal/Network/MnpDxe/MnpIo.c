@@ -371,6 +371,8 @@ MnpInstanceDeliverPacket (
     // Duplicate the net buffer.
     //
     NetbufDuplicate (RxDataWrap->Nbuf, DupNbuf, 0);
+    MnpDeviceData->RxStats.Copies++;
+    MnpDeviceData->RxStats.CopiedBytes += DupNbuf->TotalSize;
     MnpFreeNbuf (MnpDeviceData, RxDataWrap->Nbuf);
     RxDataWrap->Nbuf = DupNbuf;
   }
@@ -458,6 +460,7 @@ MnpRecycleRxData (
 {
   MNP_RXDATA_WRAP *RxDataWrap;
   MNP_DEVICE_DATA *MnpDeviceData;
+  EFI_TPL         OldTpl;
 
   ASSERT (Context != NULL);
 
@@ -476,16 +479,31 @@ MnpRecycleRxData (
   RxDataWrap->Nbuf = NULL;
 
   //
-  // Close the recycle event.
+  // Remove this Wrap entry from the list.
   //
-  gBS->CloseEvent (RxDataWrap->RxData.RecycleEvent);
+  RemoveEntryList (&RxDataWrap->WrapEntry);
 
   //
-  // Remove this Wrap entry from the list.
+  // Keep the Wrap and its recycle event for the next received packet, unless
+  // enough of them are cached already.
   //
-  RemoveEntryList (&RxDataWrap->WrapEntry);
+  OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+  if (MnpDeviceData->FreeRxDataWrapCount < MNP_MAX_FREE_RXDATA_WRAP) {
+    RxDataWrap->Instance = NULL;
+    InsertHeadList (&MnpDeviceData->FreeRxDataWrapList, &RxDataWrap->WrapEntry);
+    MnpDeviceData->FreeRxDataWrapCount++;
+    RxDataWrap = NULL;
+  }
+  gBS->RestoreTPL (OldTpl);
 
-  FreePool (RxDataWrap);
+  if (RxDataWrap != NULL) {
+    //
+    // Close the recycle event.
+    //
+    gBS->CloseEvent (RxDataWrap->RxData.RecycleEvent);
+
+    FreePool (RxDataWrap);
+  }
 }
 
 
@@ -742,6 +760,34 @@ MnpWrapRxData (
 {
   EFI_STATUS      Status;
   MNP_RXDATA_WRAP *RxDataWrap;
+  MNP_DEVICE_DATA *MnpDeviceData;
+  EFI_EVENT       RecycleEvent;
+  EFI_TPL         OldTpl;
+
+  MnpDeviceData = Instance->MnpServiceData->MnpDeviceData;
+
+  //
+  // Reuse a recycled Wrap if there is one, its recycle event is still open.
+  //
+  RxDataWrap = NULL;
+  OldTpl     = gBS->RaiseTPL (TPL_NOTIFY);
+  if (!IsListEmpty (&MnpDeviceData->FreeRxDataWrapList)) {
+    RxDataWrap = NET_LIST_HEAD (&MnpDeviceData->FreeRxDataWrapList, MNP_RXDATA_WRAP, WrapEntry);
+    RemoveEntryList (&RxDataWrap->WrapEntry);
+    MnpDeviceData->FreeRxDataWrapCount--;
+  }
+  gBS->RestoreTPL (OldTpl);
+
+  if (RxDataWrap != NULL) {
+    MnpDeviceData->RxStats.WrapReuses++;
+
+    RxDataWrap->Instance = Instance;
+    RecycleEvent         = RxDataWrap->RxData.RecycleEvent;
+    CopyMem (&RxDataWrap->RxData, RxData, sizeof (RxDataWrap->RxData));
+    RxDataWrap->RxData.RecycleEvent = RecycleEvent;
+
+    return RxDataWrap;
+  }
 
   //
   // Allocate memory.
@@ -752,6 +798,7 @@ MnpWrapRxData (
     return NULL;
   }
 
+  MnpDeviceData->RxStats.WrapAllocs++;
   RxDataWrap->Instance = Instance;
 
   //
@@ -944,6 +991,8 @@ MnpReceivePacket (
     return EFI_DEVICE_ERROR;
   }
 
+  MnpDeviceData->RxStats.Frames++;
+
   Trimmed = 0;
   if (Nbuf->TotalSize != BufLen) {
     //
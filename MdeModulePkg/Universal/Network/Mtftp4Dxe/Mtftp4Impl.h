@@ -8,6 +8,7 @@
   RFC2347 - TFTP Option Extension
   RFC2348 - TFTP Blocksize Option
   RFC2349 - TFTP Timeout Interval and Transfer Size Options
+  RFC7440 - TFTP Windowsize Option
   
 Copyright (c) 2006 - 2012, Intel Corporation. All rights reserved.<BR>
 This program and the accompanying materials
@@ -56,6 +57,7 @@ typedef struct _MTFTP4_PROTOCOL MTFTP4_PROTOCOL;
 #define MTFTP4_DEFAULT_TIMEOUT      3
 #define MTFTP4_DEFAULT_RETRY        5
 #define MTFTP4_DEFAULT_BLKSIZE      512
+#define MTFTP4_DEFAULT_WINDOWSIZE   1
 #define MTFTP4_TIME_TO_GETMAP       5
 
 #define MTFTP4_STATE_UNCONFIGED     0
@@ -120,6 +122,15 @@ struct _MTFTP4_PROTOCOL {
   UINT16                        LastBlock;
   LIST_ENTRY                    Blocks;
 
+  //
+  // The download is acknowledged once per WindowSize blocks. AckedBlock
+  // is the block number of the last ACK sent, GapAcked is set when the
+  // last in-order block has been ACKed again to report a lost block.
+  //
+  UINT16                        WindowSize;
+  UINT16                        AckedBlock;
+  BOOLEAN                       GapAcked;
+
   //
   // The server's communication end point: IP and two ports. one for
   // initial request, one for its selected port.
@@ -115,6 +115,8 @@ Mtftp4RrqSendAck (
   Ack->Ack.OpCode   = HTONS (EFI_MTFTP4_OPCODE_ACK);
   Ack->Ack.Block[0] = HTONS (BlkNo);
 
+  Instance->AckedBlock = BlkNo;
+
   return Mtftp4SendPacket (Instance, Packet);
 }
 
@@ -230,7 +232,10 @@ Mtftp4RrqSaveBlock (
 /**
   Function to process the received data packets. 
   
-  It will save the block then send back an ACK if it is active.
+  It will save the block then send back an ACK if it is active. If a window
+  size is negotiated, only the last block of each window is ACKed. The blocks
+  ahead of a lost one are kept, and the last in-order block is ACKed again on
+  a duplicated or a lost block to make the server restart the window.
 
   @param  Instance              The downloading MTFTP session
   @param  Packet                The packet received
@@ -255,6 +260,7 @@ Mtftp4RrqHandleData (
   EFI_STATUS                Status;
   UINT16                    BlockNum;
   INTN                      Expected;
+  INT16                     Distance;
 
   *Completed  = FALSE;
   BlockNum    = NTOHS (Packet->Data.Block);
@@ -268,7 +274,43 @@ Mtftp4RrqHandleData (
   // the block.
   //
   if (Instance->Master && (Expected != BlockNum)) {
-    Mtftp4Retransmit (Instance);
+    if (Instance->WindowSize == 1) {
+      Mtftp4Retransmit (Instance);
+      return EFI_SUCCESS;
+    }
+
+    //
+    // Compare the block numbers modulo 65536 so that the blocks just after
+    // a roll-over aren't taken as old ones. The blocks after the hole are
+    // only saved if the user provides a buffer, CheckPacket consumers may
+    // rely on receiving the blocks in order. They must also be in the same
+    // round as the hole, the block range list can't split a hole across a
+    // roll-over. The server resends them after the hole is reported.
+    //
+    Distance = (INT16) (BlockNum - (UINT16) Expected);
+
+    if ((Distance > 0) &&
+        (Distance < Instance->WindowSize) &&
+        (BlockNum > Expected) &&
+        (Instance->Token->Buffer != NULL)) {
+      Status = Mtftp4RrqSaveBlock (Instance, Packet, Len);
+
+      if (EFI_ERROR (Status)) {
+        return Status;
+      }
+    }
+
+    //
+    // A duplicated block means the server restarted the window, most likely
+    // because the last ACK is lost. Both it and a hole are reported by
+    // ACKing the last in-order block again, once until the next in-order
+    // block is received.
+    //
+    if (!Instance->GapAcked) {
+      Instance->GapAcked = TRUE;
+      Mtftp4RrqSendAck (Instance, (UINT16) (Expected - 1));
+    }
+
     return EFI_SUCCESS;
   }
 
@@ -279,12 +321,12 @@ Mtftp4RrqHandleData (
   }
 
   //
-  // Reset the passive client's timer whenever it received a
-  // valid data packet.
+  // Reset the timer whenever a valid data packet is received, the
+  // active client doesn't ACK every block if a window is used. The
+  // next hole, if any, may be reported again.
   //
-  if (!Instance->Master) {
-    Mtftp4SetTimeout (Instance);
-  }
+  Mtftp4SetTimeout (Instance);
+  Instance->GapAcked = FALSE;
 
   //
   // Check whether we have received all the blocks. Send the ACK if we
@@ -307,6 +349,13 @@ Mtftp4RrqHandleData (
 
     } else {
       BlockNum = (UINT16) (Expected - 1);
+
+      //
+      // Wait for the rest of the window before sending the ACK.
+      //
+      if ((UINT16) (BlockNum - Instance->AckedBlock) < Instance->WindowSize) {
+        return EFI_SUCCESS;
+      }
     }
 
     Mtftp4RrqSendAck (Instance, BlockNum);
@@ -323,7 +372,8 @@ Mtftp4RrqHandleData (
   1. The server doesn't include options not requested by us
   2. The server can only use smaller blksize than that is requested
   3. The server can only use the same timeout as requested
-  4. The server doesn't change its multicast channel.
+  4. The server doesn't change its multicast channel
+  5. The server can only use smaller windowsize than that is requested.
 
   @param  This                  The downloading Mtftp session
   @param  Reply                 The options in the OACK packet
@@ -357,6 +407,10 @@ Mtftp4RrqOackValid (
     return FALSE;
   }
 
+  if (((Reply->Exist & MTFTP4_WINDOWSIZE_EXIST) != 0) && (Reply->WindowSize > Request->WindowSize)) {
+    return FALSE;
+  }
+
   //
   // The server can send ",,master" to client to change its master
   // setting. But if it use the specific multicast channel, it can't
@@ -614,6 +668,14 @@ Mtftp4RrqHandleOack (
     if (Reply.Timeout != 0) {
       Instance->Timeout = Reply.Timeout;
     }
+
+    //
+    // The window is only used by the unicast download, the multicast
+    // clients still ACK each block.
+    //
+    if (Reply.WindowSize != 0) {
+      Instance->WindowSize = Reply.WindowSize;
+    }
   }
   
   //
@@ -239,6 +239,16 @@ Mtftp4RemoveBlockNum (
       return EFI_SUCCESS;
 
     } else {
+      //
+      // The block is received out of order, it belongs to the same
+      // round as the hole it is removed from.
+      //
+      *TotalBlock  = Num;
+
+      if (Range->Round > 0) {
+        *TotalBlock += Range->Bound +  MultU64x32 ((UINTN) (Range->Round -1), (UINT32) (Range->Bound + 1)) + 1;
+      }
+
       if (Range->End == Num) {
         Range->End--;
       } else {
@@ -248,6 +258,9 @@ Mtftp4RemoveBlockNum (
           return EFI_OUT_OF_RESOURCES;
         }
 
+        NewRange->Round = Range->Round;
+        NewRange->Bound = Range->Bound;
+
         Range->End = Num - 1;
         NetListInsertAfter (&Range->Link, &NewRange->Link);
       }
@@ -235,6 +235,13 @@ Mtftp4WrqOackValid (
     return FALSE;
   }
 
+  //
+  // The upload sends one block at a time, it can't accept a window.
+  //
+  if (((Reply->Exist & MTFTP4_WINDOWSIZE_EXIST) != 0) && (Reply->WindowSize != 1)) {
+    return FALSE;
+  }
+
   return TRUE;
 }
 
@@ -827,6 +827,7 @@ IScsiStop (
   ISCSI_DRIVER_DATA               *Private;
   EFI_EXT_SCSI_PASS_THRU_PROTOCOL *PassThru;
   ISCSI_CONNECTION                *Conn;
+  LIST_ENTRY                      *Entry;
   EFI_GUID                        *ProtocolGuid;
   EFI_GUID                        *TcpServiceBindingGuid;
   EFI_GUID                        *TcpProtocolGuid;
@@ -849,7 +850,6 @@ IScsiStop (
     }
 
     Private = ISCSI_DRIVER_DATA_FROM_EXT_SCSI_PASS_THRU (PassThru);
-    Conn    = NET_LIST_HEAD (&Private->Session->Conns, ISCSI_CONNECTION, Link);
 
     //
     // Previously the TCP protocol is opened BY_CHILD_CONTROLLER. Just close
@@ -868,13 +868,20 @@ IScsiStop (
            Private->Image,
            Private->ExtScsiPassThruHandle
            );
-    
-    gBS->CloseProtocol (
-           Conn->TcpIo.Handle,
-           ProtocolGuid,
-           Private->Image,
-           Private->ExtScsiPassThruHandle
-           );
+
+    //
+    // The TCP child of every connection in the session is opened BY_CHILD_CONTROLLER.
+    //
+    NET_LIST_FOR_EACH (Entry, &Private->Session->Conns) {
+      Conn = NET_LIST_USER_STRUCT (Entry, ISCSI_CONNECTION, Link);
+
+      gBS->CloseProtocol (
+             Conn->TcpIo.Handle,
+             ProtocolGuid,
+             Private->Image,
+             Private->ExtScsiPassThruHandle
+             );
+    }
 
     return EFI_SUCCESS;
   }
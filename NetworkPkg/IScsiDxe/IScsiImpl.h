@@ -75,6 +75,20 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 ///
 #define ISCSI_WAIT_IPSEC_TIMEOUT  30000000U
 
+//
+// Data transfer counters of an iSCSI session.
+//
+typedef struct {
+  UINT64                      Commands;         ///< SCSI commands executed.
+  UINT64                      BytesIn;          ///< Bytes received in Data-In PDUs.
+  UINT64                      BytesOut;         ///< Bytes sent, immediate and Data-Out.
+  UINT64                      ImmediateBytes;   ///< Bytes sent as immediate data.
+  UINT64                      UnsolicitedBytes; ///< Bytes sent in unsolicited Data-Out PDUs.
+  UINT64                      R2Ts;             ///< R2T PDUs received.
+  UINT64                      PduAllocs;        ///< PDU receive buffers allocated.
+  UINT64                      PduReuses;        ///< PDU receive buffers taken from the pool.
+} ISCSI_SESSION_STATS;
+
 struct _ISCSI_SESSION {
   UINT32                      Signature;
 
@@ -100,6 +114,7 @@ struct _ISCSI_SESSION {
 
   LIST_ENTRY                  Conns;
   UINT32                      NumConns;
+  UINT32                      NextConn;     ///< Round robin index of the connection for the next command.
 
   LIST_ENTRY                  TcbList;
 
@@ -118,6 +133,8 @@ struct _ISCSI_SESSION {
   BOOLEAN                     DataPDUInOrder;
   BOOLEAN                     DataSequenceInOrder;
   UINT8                       ErrorRecoveryLevel;
+
+  ISCSI_SESSION_STATS         Stats;
 };
 
 #define ISCSI_CONNECTION_SIGNATURE  SIGNATURE_32 ('I', 'S', 'C', 'N')
@@ -150,6 +167,13 @@ struct _ISCSI_CONNECTION {
   //
   NET_BUF_QUEUE     RspQue;
 
+  //
+  // Recycled ISCSI_PDU_BUFFERs, so that receiving a PDU doesn't allocate
+  // the header buffer every time.
+  //
+  LIST_ENTRY        FreePduBufferList;
+  UINT32            FreePduBufferCount;
+
   BOOLEAN           Ipv6Flag;
   TCP_IO            TcpIo;
 
@@ -243,6 +243,7 @@ IScsiCreateConnection (
   }
 
   NetbufQueInit (&Conn->RspQue);
+  InitializeListHead (&Conn->FreePduBufferList);
 
   //
   // Set the default connection-only parameters.
@@ -302,9 +303,19 @@ IScsiDestroyConnection (
   IN ISCSI_CONNECTION  *Conn
   )
 {
+  ISCSI_PDU_BUFFER  *PduBuffer;
+
   TcpIoDestroySocket (&Conn->TcpIo);
 
   NetbufQueFlush (&Conn->RspQue);
+
+  while (!IsListEmpty (&Conn->FreePduBufferList)) {
+    PduBuffer = NET_LIST_HEAD (&Conn->FreePduBufferList, ISCSI_PDU_BUFFER, Link);
+    RemoveEntryList (&PduBuffer->Link);
+    NetbufFree (PduBuffer->Header);
+    FreePool (PduBuffer);
+  }
+
   gBS->CloseEvent (Conn->TimeoutEvent);
   FreePool (Conn);
 }
@@ -469,13 +480,57 @@ IScsiSessionLogin (
     RetryCount++;
   } while (RetryCount <= Session->ConfigData->SessionConfigData.ConnectRetryCount);
 
-  if (!EFI_ERROR (Status)) {
-    Session->State = SESSION_STATE_LOGGED_IN;
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
 
-    if (!Conn->Ipv6Flag) {
-      ProtocolGuid = &gEfiTcp4ProtocolGuid;      
-    } else {
-      ProtocolGuid = &gEfiTcp6ProtocolGuid;
+  Session->State = SESSION_STATE_LOGGED_IN;
+
+  if (!Conn->Ipv6Flag) {
+    ProtocolGuid = &gEfiTcp4ProtocolGuid;      
+  } else {
+    ProtocolGuid = &gEfiTcp6ProtocolGuid;
+  }
+
+  Status = gBS->OpenProtocol (
+                  Conn->TcpIo.Handle,
+                  ProtocolGuid,
+                  (VOID **) &Tcp,
+                  Session->Private->Image,
+                  Session->Private->ExtScsiPassThruHandle,
+                  EFI_OPEN_PROTOCOL_BY_CHILD_CONTROLLER                    
+                  );
+
+  ASSERT_EFI_ERROR (Status);
+
+  if (Conn->Ipv6Flag) {
+    Status = IScsiGetIp6NicInfo (Conn);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+  }
+
+  //
+  // Add connections to the session, up to the MaxConnections negotiated on
+  // the leading connection. The commands are spread over them in turn. It's
+  // not fatal if the target refuses one, the session just keeps the
+  // connections it has.
+  //
+  while (Session->NumConns < Session->MaxConnections) {
+    Conn = IScsiCreateConnection (Session);
+    if (Conn == NULL) {
+      break;
+    }
+
+    IScsiAttatchConnection (Session, Conn);
+
+    Status = IScsiConnLogin (Conn, Session->ConfigData->SessionConfigData.ConnectTimeout);
+    if (EFI_ERROR (Status)) {
+      DEBUG ((EFI_D_WARN, "IScsiSessionLogin: connection %d login failed, %r.\n", Conn->Cid, Status));
+      IScsiConnReset (Conn);
+      IScsiDetatchConnection (Conn);
+      IScsiDestroyConnection (Conn);
+      break;
     }
 
     Status = gBS->OpenProtocol (
@@ -484,17 +539,13 @@ IScsiSessionLogin (
                     (VOID **) &Tcp,
                     Session->Private->Image,
                     Session->Private->ExtScsiPassThruHandle,
-                    EFI_OPEN_PROTOCOL_BY_CHILD_CONTROLLER                    
+                    EFI_OPEN_PROTOCOL_BY_CHILD_CONTROLLER
                     );
 
     ASSERT_EFI_ERROR (Status);
-
-    if (Conn->Ipv6Flag) {
-      Status = IScsiGetIp6NicInfo (Conn);
-    }
   }
 
-  return Status;
+  return EFI_SUCCESS;
 }
 
 
@@ -939,17 +990,23 @@ IScsiProcessLoginRsp (
     // If the Login Request is a leading Login Request, the target MUST use
     // the value presented in CmdSN as the target value for ExpCmdSN.
     //
-    if ((Session->State == SESSION_STATE_FREE) && (Session->CmdSN != LoginRsp->ExpCmdSN)) {
+    if ((Session->Tsih == 0) && (Session->CmdSN != LoginRsp->ExpCmdSN)) {
       return EFI_PROTOCOL_ERROR;     
     }
 
     //
     // It's the initial Login Response, initialize the local ExpStatSN, MaxCmdSN
-    // and ExpCmdSN.
+    // and ExpCmdSN. A connection added to a logged in session only updates
+    // the session-wide MaxCmdSN and ExpCmdSN. The TSIH is zero until the
+    // leading login of a new or reinstated session completes.
     //
     Conn->ExpStatSN   = LoginRsp->StatSN + 1;
-    Session->MaxCmdSN = LoginRsp->MaxCmdSN;
-    Session->ExpCmdSN = LoginRsp->ExpCmdSN;
+    if (Session->Tsih == 0) {
+      Session->MaxCmdSN = LoginRsp->MaxCmdSN;
+      Session->ExpCmdSN = LoginRsp->ExpCmdSN;
+    } else {
+      IScsiUpdateCmdSN (Session, LoginRsp->MaxCmdSN, LoginRsp->ExpCmdSN);
+    }
   } else {
     //
     // Check the StatSN of this PDU.
@@ -1185,6 +1242,94 @@ IScsiNbufExtFree (
 }
 
 
+/**
+  Get a receive buffer for a PDU from the pool of the connection, or allocate
+  a new one if the pool is empty.
+
+  @param[in]  Conn       The iSCSI connection to receive the PDU from.
+  @param[in]  HeaderLen  The length of the BHS and the header digest, if any.
+
+  @return The PDU buffer with HeaderLen bytes of space in its header buffer.
+  @retval NULL Failed to allocate memory.
+
+**/
+ISCSI_PDU_BUFFER *
+IScsiGetPduBuffer (
+  IN ISCSI_CONNECTION  *Conn,
+  IN UINT32            HeaderLen
+  )
+{
+  ISCSI_PDU_BUFFER  *PduBuffer;
+
+  if (!IsListEmpty (&Conn->FreePduBufferList)) {
+    PduBuffer = NET_LIST_HEAD (&Conn->FreePduBufferList, ISCSI_PDU_BUFFER, Link);
+    RemoveEntryList (&PduBuffer->Link);
+    Conn->FreePduBufferCount--;
+    Conn->Session->Stats.PduReuses++;
+  } else {
+    PduBuffer = AllocatePool (sizeof (ISCSI_PDU_BUFFER));
+    if (PduBuffer == NULL) {
+      return NULL;
+    }
+
+    PduBuffer->Header = NetbufAlloc (sizeof (ISCSI_BASIC_HEADER) + sizeof (UINT32));
+    if (PduBuffer->Header == NULL) {
+      FreePool (PduBuffer);
+      return NULL;
+    }
+
+    PduBuffer->Conn = Conn;
+    Conn->Session->Stats.PduAllocs++;
+  }
+
+  InitializeListHead (&PduBuffer->NbufList);
+  InsertTailList (&PduBuffer->NbufList, &PduBuffer->Header->List);
+  NetbufAllocSpace (PduBuffer->Header, HeaderLen, NET_BUF_TAIL);
+
+  return PduBuffer;
+}
+
+
+/**
+  The callback function to free a received PDU. The data segment is freed,
+  the header buffer is returned to the pool of the connection if it isn't full.
+
+  @param[in]  Arg  The ISCSI_PDU_BUFFER of the PDU.
+
+**/
+VOID
+EFIAPI
+IScsiFreePduBuffer (
+  VOID *Arg
+  )
+{
+  ISCSI_PDU_BUFFER  *PduBuffer;
+  ISCSI_CONNECTION  *Conn;
+  NET_BUF           *Header;
+
+  ASSERT (Arg != NULL);
+
+  PduBuffer = (ISCSI_PDU_BUFFER *) Arg;
+  Conn      = PduBuffer->Conn;
+  Header    = PduBuffer->Header;
+
+  RemoveEntryList (&Header->List);
+  NetbufFreeList (&PduBuffer->NbufList);
+
+  if (Conn->FreePduBufferCount < ISCSI_MAX_FREE_PDU_BUFFER) {
+    if (Header->TotalSize != 0) {
+      NetbufTrim (Header, Header->TotalSize, NET_BUF_TAIL);
+    }
+
+    InsertTailList (&Conn->FreePduBufferList, &PduBuffer->Link);
+    Conn->FreePduBufferCount++;
+  } else {
+    NetbufFree (Header);
+    FreePool (PduBuffer);
+  }
+}
+
+
 /**
   Receive an iSCSI response PDU. An iSCSI response PDU contains an iSCSI PDU header and
   an optional data segment. The two parts will be put into two blocks of buffers in the
@@ -1215,7 +1360,7 @@ IScsiReceivePdu (
   IN EFI_EVENT                             TimeoutEvent OPTIONAL
   )
 {
-  LIST_ENTRY      *NbufList;
+  ISCSI_PDU_BUFFER *PduBuffer;
   UINT32          Len;
   NET_BUF         *PduHdr;
   UINT8           *Header;
@@ -1227,26 +1372,18 @@ IScsiReceivePdu (
   NET_BUF         *DataSeg;
   UINT32          PadAndCRC32[2];
 
-  NbufList = AllocatePool (sizeof (LIST_ENTRY));
-  if (NbufList == NULL) {
-    return EFI_OUT_OF_RESOURCES;
-  }
-
-  InitializeListHead (NbufList);
-
   //
   // The header digest will be received together with the PDU header, if exists.
   //
-  Len     = sizeof (ISCSI_BASIC_HEADER) + (HeaderDigest ? sizeof (UINT32) : 0);
-  PduHdr  = NetbufAlloc (Len);
-  if (PduHdr == NULL) {
-    Status = EFI_OUT_OF_RESOURCES;
-    goto ON_EXIT;
+  Len       = sizeof (ISCSI_BASIC_HEADER) + (HeaderDigest ? sizeof (UINT32) : 0);
+  PduBuffer = IScsiGetPduBuffer (Conn, Len);
+  if (PduBuffer == NULL) {
+    return EFI_OUT_OF_RESOURCES;
   }
 
-  Header = NetbufAllocSpace (PduHdr, Len, NET_BUF_TAIL);
+  PduHdr = PduBuffer->Header;
+  Header = NetbufGetByte (PduHdr, 0, NULL);
   ASSERT (Header != NULL);
-  InsertTailList (NbufList, &PduHdr->List);
 
   //
   // First step, receive the BHS of the PDU.
@@ -1342,7 +1479,7 @@ IScsiReceivePdu (
     goto ON_EXIT;
   }
 
-  InsertTailList (NbufList, &DataSeg->List);
+  InsertTailList (&PduBuffer->NbufList, &DataSeg->List);
 
   //
   // Receive the data segment with the data digest, if any.
@@ -1371,7 +1508,7 @@ FORM_PDU:
   //
   // Form the pdu from a list of pdu segments.
   //
-  *Pdu = NetbufFromBufList (NbufList, 0, 0, IScsiFreeNbufList, NbufList);
+  *Pdu = NetbufFromBufList (&PduBuffer->NbufList, 0, 0, IScsiFreePduBuffer, PduBuffer);
   if (*Pdu == NULL) {
     Status = EFI_OUT_OF_RESOURCES;
   }
@@ -1380,9 +1517,9 @@ ON_EXIT:
 
   if (EFI_ERROR (Status)) {
     //
-    // Free the Nbufs in this NbufList and the NbufList itself.
+    // Free the data segment and recycle the header buffer.
     //
-    IScsiFreeNbufList (NbufList);
+    IScsiFreePduBuffer (PduBuffer);
   }
 
   return Status;
@@ -1390,95 +1527,36 @@ ON_EXIT:
 
 
 /**
-  Check and get the result of the parameter negotiation.
+  Check and get the result of the negotiation on the session-wide parameters.
 
-  @param[in, out]  Conn          The connection in iSCSI login.
+  @param[in, out]  Session       The iSCSI session.
+  @param[in, out]  KeyValueList  The key-value list of the login response. The keys
+                                 checked are removed from it.
 
-  @retval EFI_SUCCESS          The parmeter check is passed and negotiation is finished.
+  @retval EFI_SUCCESS          The parmeter check is passed.
   @retval EFI_PROTOCOL_ERROR   Some kind of iSCSI protocol error occurred.
-  @retval EFI_OUT_OF_RESOURCES Failed to allocate memory.
 
 **/
 EFI_STATUS
-IScsiCheckOpParams (
-  IN OUT ISCSI_CONNECTION  *Conn
+IScsiCheckSessionOpParams (
+  IN OUT ISCSI_SESSION  *Session,
+  IN OUT LIST_ENTRY     *KeyValueList
   )
 {
-  EFI_STATUS      Status;
-  LIST_ENTRY      *KeyValueList;
-  CHAR8           *Data;
-  UINT32          Len;
-  ISCSI_SESSION   *Session;
   CHAR8           *Value;
   UINTN           NumericValue;
 
-  ASSERT (Conn->RspQue.BufNum != 0);
-
-  Session = Conn->Session;
-
-  Len     = Conn->RspQue.BufSize;
-  Data    = AllocatePool (Len);
-  if (Data == NULL) {
-    return EFI_OUT_OF_RESOURCES;
-  }
-
-  NetbufQueCopy (&Conn->RspQue, 0, Len, (UINT8 *) Data);
-
-  Status = EFI_PROTOCOL_ERROR;
-
-  //
-  // Extract the Key-Value pairs into a list.
-  //
-  KeyValueList = IScsiBuildKeyValueList (Data, Len);
-  if (KeyValueList == NULL) {
-    FreePool (Data);
-    return Status;
-  }
-  //
-  // HeaderDigest
-  //
-  Value = IScsiGetValueByKeyFromList (KeyValueList, ISCSI_KEY_HEADER_DIGEST);
-  if (Value == NULL) {
-    goto ON_ERROR;
-  }
-
-  if (AsciiStrCmp (Value, "CRC32") == 0) {
-    if (Conn->HeaderDigest != IScsiDigestCRC32) {
-      goto ON_ERROR;
-    }
-  } else if (AsciiStrCmp (Value, ISCSI_KEY_VALUE_NONE) == 0) {
-    Conn->HeaderDigest = IScsiDigestNone;
-  } else {
-    goto ON_ERROR;
-  }
-  //
-  // DataDigest
-  //
-  Value = IScsiGetValueByKeyFromList (KeyValueList, ISCSI_KEY_DATA_DIGEST);
-  if (Value == NULL) {
-    goto ON_ERROR;
-  }
-
-  if (AsciiStrCmp (Value, "CRC32") == 0) {
-    if (Conn->DataDigest != IScsiDigestCRC32) {
-      goto ON_ERROR;
-    }
-  } else if (AsciiStrCmp (Value, ISCSI_KEY_VALUE_NONE) == 0) {
-    Conn->DataDigest = IScsiDigestNone;
-  } else {
-    goto ON_ERROR;
-  }
   //
   // ErrorRecoveryLevel: result fuction is Minimum.
   //
   Value = IScsiGetValueByKeyFromList (KeyValueList, ISCSI_KEY_ERROR_RECOVERY_LEVEL);
   if (Value == NULL) {
-    goto ON_ERROR;
+    return EFI_PROTOCOL_ERROR;
   }
 
   NumericValue = IScsiNetNtoi (Value);
   if (NumericValue > 2) {
-    goto ON_ERROR;
+    return EFI_PROTOCOL_ERROR;
   }
 
   Session->ErrorRecoveryLevel = (UINT8) MIN (Session->ErrorRecoveryLevel, NumericValue);
@@ -1489,7 +1567,7 @@ IScsiCheckOpParams (
   if (!Session->InitialR2T) {
     Value = IScsiGetValueByKeyFromList (KeyValueList, ISCSI_KEY_INITIAL_R2T);
     if (Value == NULL) {
-      goto ON_ERROR;
+      return EFI_PROTOCOL_ERROR;
     }
 
     Session->InitialR2T = (BOOLEAN) (AsciiStrCmp (Value, "Yes") == 0);
@@ -1500,24 +1578,17 @@ IScsiCheckOpParams (
   //
   Value = IScsiGetValueByKeyFromList (KeyValueList, ISCSI_KEY_IMMEDIATE_DATA);
   if (Value == NULL) {
-    goto ON_ERROR;
+    return EFI_PROTOCOL_ERROR;
   }
 
   Session->ImmediateData = (BOOLEAN) (Session->ImmediateData && (BOOLEAN) (AsciiStrCmp (Value, "Yes") == 0));
 
-  //
-  // MaxRecvDataSegmentLength is declarative.
-  //
-  Value = IScsiGetValueByKeyFromList (KeyValueList, ISCSI_KEY_MAX_RECV_DATA_SEGMENT_LENGTH);
-  if (Value != NULL) {
-    Conn->MaxRecvDataSegmentLength = (UINT32) IScsiNetNtoi (Value);
-  }
   //
   // MaxBurstLength: result funtion is Mininum.
   //
   Value = IScsiGetValueByKeyFromList (KeyValueList, ISCSI_KEY_MAX_BURST_LENGTH);
   if (Value == NULL) {
-    goto ON_ERROR;
+    return EFI_PROTOCOL_ERROR;
   }
 
   NumericValue            = IScsiNetNtoi (Value);
@@ -1530,7 +1601,7 @@ IScsiCheckOpParams (
   if (!(Session->InitialR2T && !Session->ImmediateData)) {
     Value = IScsiGetValueByKeyFromList (KeyValueList, ISCSI_KEY_FIRST_BURST_LENGTH);
     if (Value == NULL) {
-      goto ON_ERROR;
+      return EFI_PROTOCOL_ERROR;
     }
 
     NumericValue              = IScsiNetNtoi (Value);
@@ -1542,12 +1613,12 @@ IScsiCheckOpParams (
   //
   Value = IScsiGetValueByKeyFromList (KeyValueList, ISCSI_KEY_MAX_CONNECTIONS);
   if (Value == NULL) {
-    goto ON_ERROR;
+    return EFI_PROTOCOL_ERROR;
   }
 
   NumericValue = IScsiNetNtoi (Value);
   if ((NumericValue == 0) || (NumericValue > 65535)) {
-    goto ON_ERROR;
+    return EFI_PROTOCOL_ERROR;
   }
 
   Session->MaxConnections = (UINT32) MIN (Session->MaxConnections, NumericValue);
@@ -1558,7 +1629,7 @@ IScsiCheckOpParams (
   if (!Session->DataPDUInOrder) {
     Value = IScsiGetValueByKeyFromList (KeyValueList, ISCSI_KEY_DATA_PDU_IN_ORDER);
     if (Value == NULL) {
-      goto ON_ERROR;
+      return EFI_PROTOCOL_ERROR;
     }
 
     Session->DataPDUInOrder = (BOOLEAN) (AsciiStrCmp (Value, "Yes") == 0);
@@ -1570,7 +1641,7 @@ IScsiCheckOpParams (
   if (!Session->DataSequenceInOrder) {
     Value = IScsiGetValueByKeyFromList (KeyValueList, ISCSI_KEY_DATA_SEQUENCE_IN_ORDER);
     if (Value == NULL) {
-      goto ON_ERROR;
+      return EFI_PROTOCOL_ERROR;
     }
 
     Session->DataSequenceInOrder = (BOOLEAN) (AsciiStrCmp (Value, "Yes") == 0);
@@ -1581,14 +1652,14 @@ IScsiCheckOpParams (
   //
   Value = IScsiGetValueByKeyFromList (KeyValueList, ISCSI_KEY_DEFAULT_TIME2WAIT);
   if (Value == NULL) {
-    goto ON_ERROR;
+    return EFI_PROTOCOL_ERROR;
   }
 
   NumericValue = IScsiNetNtoi (Value);
   if (NumericValue == 0) {
     Session->DefaultTime2Wait = 0;
   } else if (NumericValue > 3600) {
-    goto ON_ERROR;
+    return EFI_PROTOCOL_ERROR;
   } else {
     Session->DefaultTime2Wait = (UINT32) MAX (Session->DefaultTime2Wait, NumericValue);
   }
@@ -1597,14 +1668,14 @@ IScsiCheckOpParams (
   //
   Value = IScsiGetValueByKeyFromList (KeyValueList, ISCSI_KEY_DEFAULT_TIME2RETAIN);
   if (Value == NULL) {
-    goto ON_ERROR;
+    return EFI_PROTOCOL_ERROR;
   }
 
   NumericValue = IScsiNetNtoi (Value);
   if (NumericValue == 0) {
     Session->DefaultTime2Retain = 0;
   } else if (NumericValue > 3600) {
-    goto ON_ERROR;
+    return EFI_PROTOCOL_ERROR;
   } else {
     Session->DefaultTime2Retain = (UINT32) MIN (Session->DefaultTime2Retain, NumericValue);
   }
@@ -1613,16 +1684,115 @@ IScsiCheckOpParams (
   //
   Value = IScsiGetValueByKeyFromList (KeyValueList, ISCSI_KEY_MAX_OUTSTANDING_R2T);
   if (Value == NULL) {
-    goto ON_ERROR;
+    return EFI_PROTOCOL_ERROR;
   }
 
   NumericValue = IScsiNetNtoi (Value);
   if ((NumericValue == 0) || (NumericValue > 65535)) {
-    goto ON_ERROR;
+    return EFI_PROTOCOL_ERROR;
   }
 
   Session->MaxOutstandingR2T = (UINT16) MIN (Session->MaxOutstandingR2T, NumericValue);
 
+  return EFI_SUCCESS;
+}
+
+
+/**
+  Check and get the result of the parameter negotiation.
+
+  @param[in, out]  Conn          The connection in iSCSI login.
+
+  @retval EFI_SUCCESS          The parmeter check is passed and negotiation is finished.
+  @retval EFI_PROTOCOL_ERROR   Some kind of iSCSI protocol error occurred.
+  @retval EFI_OUT_OF_RESOURCES Failed to allocate memory.
+
+**/
+EFI_STATUS
+IScsiCheckOpParams (
+  IN OUT ISCSI_CONNECTION  *Conn
+  )
+{
+  EFI_STATUS      Status;
+  LIST_ENTRY      *KeyValueList;
+  CHAR8           *Data;
+  UINT32          Len;
+  ISCSI_SESSION   *Session;
+  CHAR8           *Value;
+
+  ASSERT (Conn->RspQue.BufNum != 0);
+
+  Session = Conn->Session;
+
+  Len     = Conn->RspQue.BufSize;
+  Data    = AllocatePool (Len);
+  if (Data == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  NetbufQueCopy (&Conn->RspQue, 0, Len, (UINT8 *) Data);
+
+  Status = EFI_PROTOCOL_ERROR;
+
+  //
+  // Extract the Key-Value pairs into a list.
+  //
+  KeyValueList = IScsiBuildKeyValueList (Data, Len);
+  if (KeyValueList == NULL) {
+    FreePool (Data);
+    return Status;
+  }
+  //
+  // HeaderDigest
+  //
+  Value = IScsiGetValueByKeyFromList (KeyValueList, ISCSI_KEY_HEADER_DIGEST);
+  if (Value == NULL) {
+    goto ON_ERROR;
+  }
+
+  if (AsciiStrCmp (Value, "CRC32") == 0) {
+    if (Conn->HeaderDigest != IScsiDigestCRC32) {
+      goto ON_ERROR;
+    }
+  } else if (AsciiStrCmp (Value, ISCSI_KEY_VALUE_NONE) == 0) {
+    Conn->HeaderDigest = IScsiDigestNone;
+  } else {
+    goto ON_ERROR;
+  }
+  //
+  // DataDigest
+  //
+  Value = IScsiGetValueByKeyFromList (KeyValueList, ISCSI_KEY_DATA_DIGEST);
+  if (Value == NULL) {
+    goto ON_ERROR;
+  }
+
+  if (AsciiStrCmp (Value, "CRC32") == 0) {
+    if (Conn->DataDigest != IScsiDigestCRC32) {
+      goto ON_ERROR;
+    }
+  } else if (AsciiStrCmp (Value, ISCSI_KEY_VALUE_NONE) == 0) {
+    Conn->DataDigest = IScsiDigestNone;
+  } else {
+    goto ON_ERROR;
+  }
+  //
+  // MaxRecvDataSegmentLength is declarative.
+  //
+  Value = IScsiGetValueByKeyFromList (KeyValueList, ISCSI_KEY_MAX_RECV_DATA_SEGMENT_LENGTH);
+  if (Value != NULL) {
+    Conn->MaxRecvDataSegmentLength = (UINT32) IScsiNetNtoi (Value);
+  }
+
+  if (Session->Tsih == 0) {
+    //
+    // The session-wide keys are only negotiated on the leading connection.
+    //
+    if (EFI_ERROR (IScsiCheckSessionOpParams (Session, KeyValueList))) {
+      goto ON_ERROR;
+    }
+  }
+
   //
   // Remove declarative key-value pairs, if any.
   //
@@ -1686,6 +1856,17 @@ IScsiFillOpParams (
   AsciiSPrint (Value, sizeof (Value), "%a", (Conn->DataDigest == IScsiDigestCRC32) ? "None,CRC32" : "None");
   IScsiAddKeyValuePair (Pdu, ISCSI_KEY_DATA_DIGEST, Value);
 
+  AsciiSPrint (Value, sizeof (Value), "%d", MAX_RECV_DATA_SEG_LEN_IN_FFP);
+  IScsiAddKeyValuePair (Pdu, ISCSI_KEY_MAX_RECV_DATA_SEGMENT_LENGTH, Value);
+
+  if (Session->Tsih != 0) {
+    //
+    // The session-wide keys are leading only, a connection added to the
+    // session only negotiates the connection-only ones.
+    //
+    return ;
+  }
+
   AsciiSPrint (Value, sizeof (Value), "%d", Session->ErrorRecoveryLevel);
   IScsiAddKeyValuePair (Pdu, ISCSI_KEY_ERROR_RECOVERY_LEVEL, Value);
 
@@ -1695,9 +1876,6 @@ IScsiFillOpParams (
   AsciiSPrint (Value, sizeof (Value), "%a", Session->ImmediateData ? "Yes" : "No");
   IScsiAddKeyValuePair (Pdu, ISCSI_KEY_IMMEDIATE_DATA, Value);
 
-  AsciiSPrint (Value, sizeof (Value), "%d", MAX_RECV_DATA_SEG_LEN_IN_FFP);
-  IScsiAddKeyValuePair (Pdu, ISCSI_KEY_MAX_RECV_DATA_SEGMENT_LENGTH, Value);
-
   AsciiSPrint (Value, sizeof (Value), "%d", Session->MaxBurstLength);
   IScsiAddKeyValuePair (Pdu, ISCSI_KEY_MAX_BURST_LENGTH, Value);
 
@@ -2543,6 +2721,8 @@ IScsiOnDataInRcvd (
   //
   IScsiUpdateCmdSN (Tcb->Conn->Session, DataInHdr->MaxCmdSN, DataInHdr->ExpCmdSN);
 
+  Tcb->Conn->Session->Stats.BytesIn += ISCSI_GET_DATASEG_LEN (DataInHdr);
+
   if (ISCSI_FLAG_ON (DataInHdr, SCSI_DATA_IN_PDU_FLAG_STATUS_VALID)) {
     if (!ISCSI_FLAG_ON (DataInHdr, ISCSI_BHS_FLAG_FINAL)) {
       //
@@ -2643,6 +2823,9 @@ IScsiOnR2TRcvd (
       ) {
     return EFI_PROTOCOL_ERROR;
   }
+  Tcb->Conn->Session->Stats.R2Ts++;
+  Tcb->Conn->Session->Stats.BytesOut += XferContext->DesiredLength;
+
   //
   // Send the data solicited by this R2T.
   //
@@ -2846,6 +3029,8 @@ IScsiExecuteScsiCommand (
   ISCSI_IN_BUFFER_CONTEXT InBufferContext;
   UINT64                  Timeout;
   UINT8                   *PduHdr;
+  LIST_ENTRY              *Entry;
+  UINT32                  Index;
 
   Private       = ISCSI_DRIVER_DATA_FROM_EXT_SCSI_PASS_THRU (PassThru);
   Session       = Private->Session;
@@ -2859,8 +3044,18 @@ IScsiExecuteScsiCommand (
     goto ON_EXIT;
   }
 
+  //
+  // Stripe the commands over the connections of the session in turn.
+  //
+  Entry = Session->Conns.ForwardLink;
+  for (Index = Session->NextConn % Session->NumConns; Index > 0; Index--) {
+    Entry = Entry->ForwardLink;
+  }
+
+  Session->NextConn++;
+
   Conn = NET_LIST_USER_STRUCT_S (
-           Session->Conns.ForwardLink,
+           Entry,
            ISCSI_CONNECTION,
            Link,
            ISCSI_CONNECTION_SIGNATURE
@@ -2903,20 +3098,28 @@ IScsiExecuteScsiCommand (
     goto ON_EXIT;
   }
 
+  Session->Stats.Commands++;
+  Session->Stats.ImmediateBytes += XferContext->Offset;
+  Session->Stats.BytesOut       += XferContext->Offset;
+
   if (!Session->InitialR2T &&
       (XferContext->Offset < Session->FirstBurstLength) &&
       (XferContext->Offset < Packet->OutTransferLength)
       ) {
     //
     // Unsolicited Data-Out sequence is allowed. There is remaining SCSI
-    // OUT data, and the limit of FirstBurstLength is not reached.
+    // OUT data, and the limit of FirstBurstLength is not reached. The
+    // immediate data counts against FirstBurstLength too.
     //
     XferContext->TargetTransferTag = ISCSI_RESERVED_TAG;
     XferContext->DesiredLength = MIN (
-                                   Session->FirstBurstLength,
+                                   Session->FirstBurstLength - XferContext->Offset,
                                    Packet->OutTransferLength - XferContext->Offset
                                    );
 
+    Session->Stats.UnsolicitedBytes += XferContext->DesiredLength;
+    Session->Stats.BytesOut         += XferContext->DesiredLength;
+
     Data    = (UINT8 *) Packet->OutDataBuffer + XferContext->Offset;
     Status  = IScsiSendDataOutPduSequence (Data, Lun, Tcb);
     if (EFI_ERROR (Status)) {
@@ -3057,6 +3260,8 @@ IScsiSessionInit (
 
     InitializeListHead (&Session->Conns);
     InitializeListHead (&Session->TcbList);
+
+    ZeroMem (&Session->Stats, sizeof (ISCSI_SESSION_STATS));
   }
 
   Session->Tsih                 = 0;
@@ -3065,12 +3270,14 @@ IScsiSessionInit (
   Session->InitiatorTaskTag     = 1;
   Session->NextCid              = 1;
 
+  Session->NextConn             = 0;
+
   Session->TargetPortalGroupTag = 0;
   Session->MaxConnections       = ISCSI_MAX_CONNS_PER_SESSION;
   Session->InitialR2T           = FALSE;
   Session->ImmediateData        = TRUE;
-  Session->MaxBurstLength       = 262144;
-  Session->FirstBurstLength     = MAX_RECV_DATA_SEG_LEN_IN_FFP;
+  Session->MaxBurstLength       = ISCSI_MAX_BURST_LEN;
+  Session->FirstBurstLength     = ISCSI_FIRST_BURST_LEN;
   Session->DefaultTime2Wait     = 2;
   Session->DefaultTime2Retain   = 20;
   Session->MaxOutstandingR2T    = DEFAULT_MAX_OUTSTANDING_R2T;
@@ -3101,6 +3308,20 @@ IScsiSessionAbort (
 
   ASSERT (!IsListEmpty (&Session->Conns));
 
+  DEBUG ((
+    EFI_D_INFO,
+    "IScsiSessionAbort: %d connections, %ld commands, %ld bytes in, %ld bytes out (%ld immediate, %ld unsolicited), %ld R2Ts, %ld/%ld PDU buffer allocs/reuses.\n",
+    Session->NumConns,
+    Session->Stats.Commands,
+    Session->Stats.BytesIn,
+    Session->Stats.BytesOut,
+    Session->Stats.ImmediateBytes,
+    Session->Stats.UnsolicitedBytes,
+    Session->Stats.R2Ts,
+    Session->Stats.PduAllocs,
+    Session->Stats.PduReuses
+    ));
+
   while (!IsListEmpty (&Session->Conns)) {
     Conn = NET_LIST_USER_STRUCT_S (
              Session->Conns.ForwardLink,
@@ -31,12 +31,25 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
     )
 
 #define ISCSI_WELL_KNOWN_PORT                   3260
-#define ISCSI_MAX_CONNS_PER_SESSION             1
+#define ISCSI_MAX_CONNS_PER_SESSION             4
 
 #define DEFAULT_MAX_RECV_DATA_SEG_LEN           8192
-#define MAX_RECV_DATA_SEG_LEN_IN_FFP            65536
+#define MAX_RECV_DATA_SEG_LEN_IN_FFP            262144
 #define DEFAULT_MAX_OUTSTANDING_R2T             1
 
+//
+// Offered burst lengths. A write up to FirstBurstLength goes out with the
+// SCSI Command PDU as immediate and unsolicited data, without waiting for
+// an R2T from the target.
+//
+#define ISCSI_FIRST_BURST_LEN                   262144
+#define ISCSI_MAX_BURST_LEN                     1048576
+
+//
+// Receive buffers of the PDU headers kept on each connection for reuse.
+//
+#define ISCSI_MAX_FREE_PDU_BUFFER               8
+
 #define ISCSI_VERSION_MAX                       0x00
 #define ISCSI_VERSION_MIN                       0x00
 
@@ -594,6 +607,18 @@ typedef struct _ISCSI_IN_BUFFER_CONTEXT {
   UINT32  InDataLen;
 } ISCSI_IN_BUFFER_CONTEXT;
 
+///
+/// The receive buffer of a PDU. Header holds the BHS and the header digest,
+/// it's allocated once and recycled through the pool of the connection
+/// together with this structure.
+///
+typedef struct _ISCSI_PDU_BUFFER {
+  LIST_ENTRY          Link;
+  LIST_ENTRY          NbufList;
+  NET_BUF             *Header;
+  ISCSI_CONNECTION    *Conn;
+} ISCSI_PDU_BUFFER;
+
 typedef struct _ISCSI_TCB {
   LIST_ENTRY          Link;
 
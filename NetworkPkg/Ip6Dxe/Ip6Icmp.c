@@ -251,8 +251,11 @@ Ip6ProcessPacketTooBig (
       }
 
       RouteEntry->Flag = IP6_DIRECT_ROUTE | IP6_PACKET_TOO_BIG;
-      InsertHeadList (&IpSb->RouteTable->RouteArea[128], &RouteEntry->Link);
-      IpSb->RouteTable->TotalNum++;
+      if (EFI_ERROR (Ip6InsertRouteEntry (IpSb->RouteTable, RouteEntry))) {
+        Ip6FreeRouteEntry (RouteEntry);
+        NetbufFree (Packet);
+        return EFI_OUT_OF_RESOURCES;
+      }
     } else {
       RouteEntry = Ip6FindRouteEntry (IpSb->RouteTable, DestAddress, NULL);
       if (RouteEntry == NULL) {
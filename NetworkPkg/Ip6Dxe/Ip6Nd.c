@@ -239,8 +239,11 @@ Ip6CreatePrefixListEntry (
     }
 
     RtEntry->Flag = IP6_DIRECT_ROUTE;
-    InsertHeadList (&IpSb->RouteTable->RouteArea[PrefixLength], &RtEntry->Link);
-    IpSb->RouteTable->TotalNum++;
+    if (EFI_ERROR (Ip6InsertRouteEntry (IpSb->RouteTable, RtEntry))) {
+      Ip6FreeRouteEntry (RtEntry);
+      FreePool (PrefixEntry);
+      return NULL;
+    }
   }
 
   //
@@ -713,8 +716,11 @@ Ip6CreateDefaultRouter (
     return NULL;
   }
 
-  InsertHeadList (&IpSb->RouteTable->RouteArea[0], &RtEntry->Link);
-  IpSb->RouteTable->TotalNum++;
+  if (EFI_ERROR (Ip6InsertRouteEntry (IpSb->RouteTable, RtEntry))) {
+    Ip6FreeRouteEntry (RtEntry);
+    FreePool (Entry);
+    return NULL;
+  }
 
   InsertTailList (&IpSb->DefaultRouterList, &Entry->Link);
 
@@ -2569,6 +2575,8 @@ Ip6ProcessRedirect (
       goto Exit;
     }
 
+    RouteCache->Generation = IpSb->RouteTable->Generation;
+
     //
     // Insert the newly created route cache entry.
     //
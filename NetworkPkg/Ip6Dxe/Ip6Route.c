@@ -102,13 +102,10 @@ Ip6FreeRouteEntry (
 }
 
 /**
-  Search the route table for a most specific match to the Dst. It searches
-  from the longest route area (prefix length == 128) to the shortest route area
-  (default routes). In each route area, it will first search the instance's
-  route table, then the default route table. This is required per the following
-  requirements:
-  1. IP search the route table for a most specific match.
-  2. The local route entries have precedence over the default route entry.
+  Search the route table for a most specific match to the Dst. The Destination
+  is looked up in the longest prefix match table. The NextHop is searched from
+  the longest route area (prefix length == 128) to the shortest route area
+  (default routes).
 
   @param[in]  RtTable       The route table to search from.
   @param[in]  Destination   The destionation address to search. If NULL, search
@@ -133,24 +130,23 @@ Ip6FindRouteEntry (
 
   ASSERT (Destination != NULL || NextHop != NULL);
 
-  RtEntry = NULL;
+  if (Destination != NULL) {
+    RtEntry = NetLpmLookup (&RtTable->Lpm, Destination->Addr, IP6_PREFIX_NUM - 1, NULL);
+    if (RtEntry != NULL) {
+      NET_GET_REF (RtEntry);
+    }
+
+    return RtEntry;
+  }
 
   for (Index = IP6_PREFIX_NUM - 1; Index >= 0; Index--) {
     NET_LIST_FOR_EACH (Entry, &RtTable->RouteArea[Index]) {
       RtEntry = NET_LIST_USER_STRUCT (Entry, IP6_ROUTE_ENTRY, Link);
 
-      if (Destination != NULL) {
-        if (NetIp6IsNetEqual (Destination, &RtEntry->Destination, RtEntry->PrefixLength)) {
-          NET_GET_REF (RtEntry);
-          return RtEntry;
-        }
-      } else if (NextHop != NULL) {
-        if (NetIp6IsNetEqual (NextHop, &RtEntry->NextHop, RtEntry->PrefixLength)) {
-          NET_GET_REF (RtEntry);
-          return RtEntry;
-        }
+      if (NetIp6IsNetEqual (NextHop, &RtEntry->NextHop, RtEntry->PrefixLength)) {
+        NET_GET_REF (RtEntry);
+        return RtEntry;
       }
-
     }
   }
 
@@ -186,8 +182,9 @@ Ip6CreateRouteCacheEntry (
     return NULL;
   }
 
-  RtCacheEntry->RefCnt = 1;
-  RtCacheEntry->Tag    = Tag;
+  RtCacheEntry->RefCnt     = 1;
+  RtCacheEntry->Tag        = Tag;
+  RtCacheEntry->Generation = 0;
 
   IP6_COPY_ADDRESS (&RtCacheEntry->Destination, Dst);
   IP6_COPY_ADDRESS (&RtCacheEntry->Source, Src);
@@ -216,7 +213,8 @@ Ip6FreeRouteCacheEntry (
 
 /**
   Find a route cache with the destination and source address. This is
-  used by the ICMPv6 redirect messasge process.
+  used by the ICMPv6 redirect messasge process. A stale route cache entry,
+  created before the route table changed, is removed rather than returned.
 
   @param[in]  RtTable       The route table to search the cache for.
   @param[in]  Dest          The destination address.
@@ -243,6 +241,15 @@ Ip6FindRouteCache (
     RtCacheEntry = NET_LIST_USER_STRUCT (Entry, IP6_ROUTE_CACHE_ENTRY, Link);
 
     if (EFI_IP6_EQUAL (Dest, &RtCacheEntry->Destination)&& EFI_IP6_EQUAL (Src, &RtCacheEntry->Source)) {
+      if (RtCacheEntry->Generation != RtTable->Generation) {
+        RemoveEntryList (Entry);
+        Ip6FreeRouteCacheEntry (RtCacheEntry);
+        if (RtTable->Cache.CacheNum[Index] > 0) {
+          RtTable->Cache.CacheNum[Index]--;
+        }
+        return NULL;
+      }
+
       NET_GET_REF (RtCacheEntry);
       return RtCacheEntry;
     }
@@ -343,13 +350,16 @@ Ip6CreateRouteTable (
     return NULL;
   }
 
-  RtTable->RefCnt   = 1;
-  RtTable->TotalNum = 0;
+  RtTable->RefCnt     = 1;
+  RtTable->TotalNum   = 0;
+  RtTable->Generation = 0;
 
   for (Index = 0; Index < IP6_PREFIX_NUM; Index++) {
     InitializeListHead (&RtTable->RouteArea[Index]);
   }
 
+  NetLpmInit (&RtTable->Lpm);
+
   for (Index = 0; Index < IP6_ROUTE_CACHE_HASH_SIZE; Index++) {
     InitializeListHead (&RtTable->Cache.CacheBucket[Index]);
     RtTable->Cache.CacheNum[Index] = 0;
@@ -393,6 +403,8 @@ Ip6CleanRouteTable (
     }
   }
 
+  NetLpmClean (&RtTable->Lpm);
+
   for (Index = 0; Index < IP6_ROUTE_CACHE_HASH_SIZE; Index++) {
     NET_LIST_FOR_EACH_SAFE (Entry, Next, &RtTable->Cache.CacheBucket[Index]) {
       RtCacheEntry = NET_LIST_USER_STRUCT (Entry, IP6_ROUTE_CACHE_ENTRY, Link);
@@ -438,6 +450,72 @@ Ip6PurgeRouteCache (
   }
 }
 
+/**
+  Point the longest prefix match table at the first route entry of the
+  Destination/PrefixLength prefix in its route area, or remove the prefix
+  from it if there is no such route entry any more. It is called after a
+  route entry of the prefix is added or removed.
+
+  @param[in, out]  RtTable        The route table.
+  @param[in]       Destination    The destination prefix.
+  @param[in]       PrefixLength   The PrefixLength of the destination.
+
+  @retval EFI_OUT_OF_RESOURCES  Failed to allocate memory for the prefix.
+  @retval EFI_SUCCESS           The longest prefix match table is updated.
+
+**/
+EFI_STATUS
+Ip6UpdateRouteLpm (
+  IN OUT IP6_ROUTE_TABLE    *RtTable,
+  IN EFI_IPv6_ADDRESS       *Destination,
+  IN UINT8                  PrefixLength
+  )
+{
+  LIST_ENTRY                *Entry;
+  IP6_ROUTE_ENTRY           *Route;
+
+  RtTable->Generation++;
+
+  NET_LIST_FOR_EACH (Entry, &RtTable->RouteArea[PrefixLength]) {
+    Route = NET_LIST_USER_STRUCT (Entry, IP6_ROUTE_ENTRY, Link);
+
+    if (NetIp6IsNetEqual (Destination, &Route->Destination, PrefixLength)) {
+      return NetLpmInsert (&RtTable->Lpm, Route->Destination.Addr, PrefixLength, Route);
+    }
+  }
+
+  NetLpmDelete (&RtTable->Lpm, Destination->Addr, PrefixLength);
+  return EFI_SUCCESS;
+}
+
+/**
+  Insert a route entry to the head of its route area in the route table,
+  and index it in the longest prefix match table.
+
+  @param[in, out]  RtTable        Route table to add route to.
+  @param[in]       RtEntry        The route entry to insert.
+
+  @retval EFI_OUT_OF_RESOURCES  Failed to allocate memory for the index.
+  @retval EFI_SUCCESS           The route entry was inserted successfully.
+
+**/
+EFI_STATUS
+Ip6InsertRouteEntry (
+  IN OUT IP6_ROUTE_TABLE    *RtTable,
+  IN     IP6_ROUTE_ENTRY    *RtEntry
+  )
+{
+  InsertHeadList (&RtTable->RouteArea[RtEntry->PrefixLength], &RtEntry->Link);
+
+  if (EFI_ERROR (Ip6UpdateRouteLpm (RtTable, &RtEntry->Destination, RtEntry->PrefixLength))) {
+    RemoveEntryList (&RtEntry->Link);
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  RtTable->TotalNum++;
+  return EFI_SUCCESS;
+}
+
 /**
   Add a route entry to the route table. It is the help function for EfiIp6Routes.
 
@@ -490,8 +568,10 @@ Ip6AddRoute (
     Route->Flag = IP6_DIRECT_ROUTE;
   }
 
-  InsertHeadList (ListHead, &Route->Link);
-  RtTable->TotalNum++;
+  if (EFI_ERROR (Ip6InsertRouteEntry (RtTable, Route))) {
+    Ip6FreeRouteEntry (Route);
+    return EFI_OUT_OF_RESOURCES;
+  }
 
   return EFI_SUCCESS;
 }
@@ -539,6 +619,7 @@ Ip6DelRoute (
 
     Ip6PurgeRouteCache (&RtTable->Cache, (UINTN) Route);
     RemoveEntryList (Entry);
+    Ip6UpdateRouteLpm (RtTable, &Route->Destination, PrefixLength);
     Ip6FreeRouteEntry (Route);
 
     ASSERT (RtTable->TotalNum > 0);
@@ -626,6 +707,8 @@ Ip6Route (
     return NULL;
   }
 
+  RtCacheEntry->Generation = RtTable->Generation;
+
   InsertHeadList (ListHead, &RtCacheEntry->Link);
   NET_GET_REF (RtCacheEntry);
   RtTable->Cache.CacheNum[Index]++;
@@ -40,6 +40,7 @@ typedef struct {
   LIST_ENTRY                Link;
   INTN                      RefCnt;
   UINTN                     Tag;
+  UINT32                    Generation;
   EFI_IPv6_ADDRESS          Destination;
   EFI_IPv6_ADDRESS          Source;
   EFI_IPv6_ADDRESS          NextHop;
@@ -58,11 +59,18 @@ typedef struct {
 // together in one route area. For example, RouteArea[0] contains
 // the default routes. A route table also contains a route cache.
 //
+// The route areas are indexed by a longest prefix match table, which maps
+// each destination prefix to the first route entry of it in the route area.
+// Generation is increased whenever the routes change, a route cache entry
+// created before that is stale.
+//
 
 typedef struct _IP6_ROUTE_TABLE {
   INTN                      RefCnt;
   UINT32                    TotalNum;
   LIST_ENTRY                RouteArea[IP6_PREFIX_NUM];
+  NET_LPM_TABLE             Lpm;
+  UINT32                    Generation;
   IP6_ROUTE_CACHE           Cache;
 } IP6_ROUTE_TABLE;
 
@@ -198,13 +206,10 @@ Ip6CreateRouteEntry (
   );
 
 /**
-  Search the route table for a most specific match to the Dst. It searches
-  from the longest route area (prefix length == 128) to the shortest route area
-  (default routes). In each route area, it will first search the instance's
-  route table, then the default route table. This is required per the following
-  requirements:
-  1. IP search the route table for a most specific match.
-  2. The local route entries have precedence over the default route entry.
+  Search the route table for a most specific match to the Dst. The Destination
+  is looked up in the longest prefix match table. The NextHop is searched from
+  the longest route area (prefix length == 128) to the shortest route area
+  (default routes).
 
   @param[in]  RtTable       The route table to search from.
   @param[in]  Destination   The destionation address to search. If NULL, search
@@ -234,6 +239,23 @@ Ip6FreeRouteEntry (
   IN OUT IP6_ROUTE_ENTRY    *RtEntry
   );
 
+/**
+  Insert a route entry to the head of its route area in the route table,
+  and index it in the longest prefix match table.
+
+  @param[in, out]  RtTable        Route table to add route to.
+  @param[in]       RtEntry        The route entry to insert.
+
+  @retval EFI_OUT_OF_RESOURCES  Failed to allocate memory for the index.
+  @retval EFI_SUCCESS           The route entry was inserted successfully.
+
+**/
+EFI_STATUS
+Ip6InsertRouteEntry (
+  IN OUT IP6_ROUTE_TABLE    *RtTable,
+  IN     IP6_ROUTE_ENTRY    *RtEntry
+  );
+
 /**
   Add a route entry to the route table. It is the help function for EfiIp6Routes.
 
@@ -55,6 +55,8 @@ Mtftp6RrqSendAck (
   Ack->Ack.OpCode    = HTONS (EFI_MTFTP6_OPCODE_ACK);
   Ack->Ack.Block[0]  = HTONS (BlockNum);
 
+  Instance->AckedBlk = BlockNum;
+
   //
   // Reset current retry count of the instance.
   //
@@ -196,7 +198,10 @@ Mtftp6RrqSaveBlock (
 
 /**
   Process the received data packets. It will save the block
-  then send back an ACK if it is active.
+  then send back an ACK if it is active. If a window size is
+  negotiated, only the last block of each window is ACKed, and
+  the last in-order block is ACKed again on a duplicated or a
+  lost block to make the server restart the window.
 
   @param[in]  Instance              The pointer to the Mtftp6 instance.
   @param[in]  Packet                The pointer to the received packet.
@@ -222,6 +227,7 @@ Mtftp6RrqHandleData (
   EFI_STATUS                Status;
   UINT16                    BlockNum;
   INTN                      Expected;
+  INT16                     Distance;
 
   *IsCompleted = FALSE;
   BlockNum     = NTOHS (Packet->Data.Block);
@@ -235,6 +241,27 @@ Mtftp6RrqHandleData (
   // the block.
   //
   if (Instance->IsMaster && (Expected != BlockNum)) {
+    //
+    // With a window, the block numbers are compared modulo 65536 so that
+    // the blocks just after a roll-over aren't taken as old ones. A block
+    // after the hole is saved if the user provides a buffer and it is in
+    // the same round as the hole, the block range list can't split a hole
+    // across a roll-over. The server resends it after the hole is reported.
+    //
+    Distance = (INT16) (BlockNum - (UINT16) Expected);
+
+    if ((Instance->WindowSize > 1) &&
+        (Distance > 0) &&
+        (Distance < Instance->WindowSize) &&
+        (BlockNum > Expected) &&
+        (Instance->Token->Buffer != NULL)) {
+      Status = Mtftp6RrqSaveBlock (Instance, Packet, Len, UdpPacket);
+
+      if (EFI_ERROR (Status)) {
+        return Status;
+      }
+    }
+
     //
     // Free the received packet before send new packet in ReceiveNotify,
     // since the udpio might need to be reconfigured.
@@ -242,7 +269,19 @@ Mtftp6RrqHandleData (
     NetbufFree (*UdpPacket);
     *UdpPacket = NULL;
 
-    Mtftp6TransmitPacket (Instance, Instance->LastPacket);
+    //
+    // A duplicated block means the server restarted the window, most likely
+    // because the last ACK is lost. Both it and a hole are reported by
+    // ACKing the last in-order block again, once until the next in-order
+    // block is received.
+    //
+    if (Instance->WindowSize == 1) {
+      Mtftp6TransmitPacket (Instance, Instance->LastPacket);
+    } else if (!Instance->IsGapAcked) {
+      Instance->IsGapAcked = TRUE;
+      Mtftp6RrqSendAck (Instance, (UINT16) (Expected - 1));
+    }
+
     return EFI_SUCCESS;
   }
 
@@ -253,11 +292,11 @@ Mtftp6RrqHandleData (
   }
 
   //
-  // Reset the passive client's timer whenever it received a valid data packet.
+  // Reset the timer whenever a valid data packet is received, the active
+  // client doesn't ACK every block if a window is used.
   //
-  if (!Instance->IsMaster) {
-    Instance->PacketToLive = Instance->Timeout * 2;
-  }
+  Instance->PacketToLive = Instance->IsMaster ? Instance->Timeout : (Instance->Timeout * 2);
+  Instance->IsGapAcked   = FALSE;
 
   //
   // Check whether we have received all the blocks. Send the ACK if we
@@ -280,6 +319,13 @@ Mtftp6RrqHandleData (
 
     } else {
       BlockNum     = (UINT16) (Expected - 1);
+
+      //
+      // Wait for the rest of the window before sending the ACK.
+      //
+      if ((UINT16) (BlockNum - Instance->AckedBlk) < Instance->WindowSize) {
+        return EFI_SUCCESS;
+      }
     }
     //
     // Free the received packet before send new packet in ReceiveNotify,
@@ -302,6 +348,7 @@ Mtftp6RrqHandleData (
   2. The server can only use smaller blksize than that is requested.
   3. The server can only use the same timeout as requested.
   4. The server doesn't change its multicast channel.
+  5. The server can only use smaller windowsize than that is requested.
 
   @param[in]  Instance              The pointer to the Mtftp6 instance.
   @param[in]  ReplyInfo             The pointer to options information in reply packet.
@@ -335,6 +382,10 @@ Mtftp6RrqOackValid (
     return FALSE;
   }
 
+  if (((ReplyInfo->BitMap & MTFTP6_OPT_WINDOWSIZE_BIT) != 0) && (ReplyInfo->WindowSize > RequestInfo->WindowSize)) {
+    return FALSE;
+  }
+
   //
   // The server can send ",,master" to client to change its master
   // setting. But if it use the specific multicast channel, it can't
@@ -628,6 +679,14 @@ Mtftp6RrqHandleOack (
     if (ExtInfo.Timeout != 0) {
       Instance->Timeout = ExtInfo.Timeout;
     }
+
+    //
+    // Only the unicast download uses the window, the multicast clients
+    // still ACK each block.
+    //
+    if (ExtInfo.WindowSize != 0) {
+      Instance->WindowSize = ExtInfo.WindowSize;
+    }
   }
 
   //
@@ -239,6 +239,16 @@ Mtftp6RemoveBlockNum (
       return EFI_SUCCESS;
 
     } else {
+      //
+      // The block is received out of order, it belongs to the same
+      // round as the hole it is removed from.
+      //
+      *TotalBlock  = Num;
+
+      if (Range->Round > 0) {
+        *TotalBlock += Range->Bound +  MultU64x32 ((UINT64) (Range->Round -1), (UINT32)(Range->Bound + 1)) + 1;
+      }
+
       if (Range->End == Num) {
         Range->End--;
       } else {
@@ -248,6 +258,9 @@ Mtftp6RemoveBlockNum (
           return EFI_OUT_OF_RESOURCES;
         }
 
+        NewRange->Round = Range->Round;
+        NewRange->Bound = Range->Bound;
+
         Range->End = Num - 1;
         NetListInsertAfter (&Range->Link, &NewRange->Link);
       }
@@ -939,6 +952,9 @@ Mtftp6OperationClean (
   Instance->McastPort      = 0;
   Instance->BlkSize        = 0;
   Instance->LastBlk        = 0;
+  Instance->WindowSize     = 0;
+  Instance->AckedBlk       = 0;
+  Instance->IsGapAcked     = FALSE;
   Instance->PacketToLive   = 0;
   Instance->MaxRetry       = 0;
   Instance->CurRetry       = 0;
@@ -1064,6 +1080,9 @@ Mtftp6OperationStart (
   if (Instance->BlkSize == 0) {
     Instance->BlkSize = MTFTP6_DEFAULT_BLK_SIZE;
   }
+  if (Instance->WindowSize == 0) {
+    Instance->WindowSize = MTFTP6_DEFAULT_WINDOW_SIZE;
+  }
   if (Instance->MaxRetry == 0) {
     Instance->MaxRetry = MTFTP6_DEFAULT_MAX_RETRY;
   }
@@ -259,6 +259,13 @@ Mtftp6WrqOackValid (
     return FALSE;
   }
 
+  //
+  // The upload sends one block at a time, it can't accept a window.
+  //
+  if (((ReplyInfo->BitMap & MTFTP6_OPT_WINDOWSIZE_BIT) != 0) && (ReplyInfo->WindowSize != 1)) {
+    return FALSE;
+  }
+
   return TRUE;
 }
 
@@ -0,0 +1,278 @@
+/** @file
+  TCP congestion avoidance algorithms: NewReno and CUBIC.
+
+  Copyright (c) 2015, Intel Corporation. All rights reserved.<BR>
+
+  This program and the accompanying materials
+  are licensed and made available under the terms and conditions of the BSD License
+  which accompanies this distribution.  The full text of the license may be found at
+  http://opensource.org/licenses/bsd-license.php.
+
+  THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+  WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+**/
+
+#include "TcpMain.h"
+
+//
+// CUBIC parameters of RFC8312. Beta is scaled by 1024, C is 0.4.
+// The Reno friendly increase factor 3 * (1 - Beta) / (1 + Beta)
+// is also scaled by 1024.
+//
+#define TCP_CUBIC_BETA          717
+#define TCP_CUBIC_RENO_FACTOR   542
+#define TCP_CUBIC_MAX_OFFSET    60000   ///< Cap of |t - K| in ms.
+
+/**
+  Initialize the NewReno congestion control state. Nothing to do.
+
+  @param[in, out]  Tcb      Pointer to the TCP_CB of this TCP instance.
+
+**/
+VOID
+TcpRenoInit (
+  IN OUT TCP_CB *Tcb
+  )
+{
+}
+
+/**
+  NewReno congestion avoidance: increase CWnd by about one SMSS per RTT.
+
+  @param[in, out]  Tcb      Pointer to the TCP_CB of this TCP instance.
+
+**/
+VOID
+TcpRenoCongAvoid (
+  IN OUT TCP_CB *Tcb
+  )
+{
+  Tcb->CWnd += MAX (Tcb->SndMss * Tcb->SndMss / Tcb->CWnd, 1);
+}
+
+/**
+  NewReno slow start threshold after a loss, half of the FlightSize.
+
+  @param[in, out]  Tcb      Pointer to the TCP_CB of this TCP instance.
+
+  @return The new slow start threshold, in bytes.
+
+**/
+UINT32
+TcpRenoSsthresh (
+  IN OUT TCP_CB *Tcb
+  )
+{
+  UINT32  FlightSize;
+
+  FlightSize = TCP_SUB_SEQ (Tcb->SndNxt, Tcb->SndUna);
+
+  return MAX (FlightSize >> 1, (UINT32) (2 * Tcb->SndMss));
+}
+
+/**
+  Compute the integer cube root.
+
+  @param[in]  Value   The value to compute the cube root of.
+
+  @return The largest integer whose cube is not bigger than Value.
+
+**/
+UINT32
+TcpCubeRoot (
+  IN UINT64 Value
+  )
+{
+  UINT64  Root;
+  UINT64  Bit;
+  INTN    Shift;
+
+  Root = 0;
+
+  for (Shift = 63; Shift >= 0; Shift -= 3) {
+    Root = LShiftU64 (Root, 1);
+    Bit  = MultU64x64 (MultU64x32 (Root, 3), Root + 1) + 1;
+
+    if (RShiftU64 (Value, Shift) >= Bit) {
+      Value -= LShiftU64 (Bit, Shift);
+      Root++;
+    }
+  }
+
+  return (UINT32) Root;
+}
+
+/**
+  Initialize the CUBIC congestion control state.
+
+  @param[in, out]  Tcb      Pointer to the TCP_CB of this TCP instance.
+
+**/
+VOID
+TcpCubicInit (
+  IN OUT TCP_CB *Tcb
+  )
+{
+  ZeroMem (&Tcb->Cubic, sizeof (TCP_CUBIC));
+}
+
+/**
+  CUBIC congestion avoidance. The window follows
+  W(t) = C * (t - K)^3 + WMax, but never grows slower than Reno.
+
+  @param[in, out]  Tcb      Pointer to the TCP_CB of this TCP instance.
+
+**/
+VOID
+TcpCubicCongAvoid (
+  IN OUT TCP_CB *Tcb
+  )
+{
+  TCP_CUBIC *Cubic;
+  UINT32    Now;
+  UINT32    Time;
+  UINT32    Offset;
+  UINT64    Delta;
+  UINT32    Target;
+  UINT32    Increase;
+
+  Cubic = &Tcb->Cubic;
+  Now   = mTcpTick;
+
+  //
+  // Start a new epoch on the first ACK after a loss.
+  //
+  if (Cubic->Epoch == 0) {
+    Cubic->Epoch = (Now == 0) ? 1 : Now;
+    Cubic->WEst  = Tcb->CWnd;
+
+    if (Tcb->CWnd < Cubic->WMax) {
+      //
+      // K = cubic_root ((WMax - CWnd) / C), in segments and seconds.
+      //
+      Cubic->K = TcpCubeRoot (
+                   DivU64x32 (
+                     MultU64x32 (Cubic->WMax - Tcb->CWnd, 2500000000U),
+                     Tcb->SndMss
+                     )
+                   );
+    } else {
+      Cubic->K    = 0;
+      Cubic->WMax = Tcb->CWnd;
+    }
+  }
+
+  //
+  // Compute the target for one RTT ahead, all in milliseconds.
+  //
+  Time = (TCP_SUB_TIME (Now, Cubic->Epoch) + (Tcb->SRtt >> 3)) * TCP_TICK;
+
+  if (Time > Cubic->K) {
+    Offset = Time - Cubic->K;
+  } else {
+    Offset = Cubic->K - Time;
+  }
+
+  Offset = MIN (Offset, TCP_CUBIC_MAX_OFFSET);
+  Delta  = DivU64x32 (MultU64x32 (MultU64x32 (Offset, Offset), Offset), 1000000);
+  Delta  = DivU64x32 (MultU64x32 (Delta, 4 * Tcb->SndMss), 10000);
+
+  if (Time > Cubic->K) {
+    Target = (UINT32) MIN (Cubic->WMax + Delta, TCP_MAX_WIN << TCP_OPTION_MAX_WS);
+  } else if (Delta < Cubic->WMax) {
+    Target = (UINT32) (Cubic->WMax - Delta);
+  } else {
+    Target = 0;
+  }
+
+  //
+  // Reno friendly region, RFC8312 section 4.2.
+  //
+  Increase = (UINT32) RShiftU64 (
+                        DivU64x32 (
+                          MultU64x32 ((UINT32) Tcb->SndMss * Tcb->SndMss, TCP_CUBIC_RENO_FACTOR),
+                          Cubic->WEst
+                          ),
+                        10
+                        );
+  Cubic->WEst += MAX (Increase, 1);
+
+  Target = MAX (Target, Cubic->WEst);
+
+  if (Target > Tcb->CWnd) {
+    Increase = (UINT32) DivU64x32 (MultU64x32 (Target - Tcb->CWnd, Tcb->SndMss), Tcb->CWnd);
+    Increase = MIN (Increase, (UINT32) (Tcb->SndMss >> 1));
+  } else {
+    Increase = (UINT32) Tcb->SndMss * Tcb->SndMss / (100 * Tcb->CWnd);
+  }
+
+  Tcb->CWnd += MAX (Increase, 1);
+}
+
+/**
+  CUBIC slow start threshold after a loss, Beta times the FlightSize.
+  It also records WMax with fast convergence and ends the epoch.
+
+  @param[in, out]  Tcb      Pointer to the TCP_CB of this TCP instance.
+
+  @return The new slow start threshold, in bytes.
+
+**/
+UINT32
+TcpCubicSsthresh (
+  IN OUT TCP_CB *Tcb
+  )
+{
+  TCP_CUBIC *Cubic;
+  UINT32    FlightSize;
+
+  Cubic      = &Tcb->Cubic;
+  FlightSize = TCP_SUB_SEQ (Tcb->SndNxt, Tcb->SndUna);
+
+  if (FlightSize < Cubic->WLastMax) {
+    Cubic->WMax = (UINT32) DivU64x32 (MultU64x32 (FlightSize, 1024 + TCP_CUBIC_BETA), 2048);
+  } else {
+    Cubic->WMax = FlightSize;
+  }
+
+  Cubic->WLastMax = FlightSize;
+  Cubic->Epoch    = 0;
+
+  return MAX (
+           (UINT32) DivU64x32 (MultU64x32 (FlightSize, TCP_CUBIC_BETA), 1024),
+           (UINT32) (2 * Tcb->SndMss)
+           );
+}
+
+TCP_CONGESTION_OPS  mTcpRenoOps = {
+  "NewReno",
+  TcpRenoInit,
+  TcpRenoCongAvoid,
+  TcpRenoSsthresh
+};
+
+TCP_CONGESTION_OPS  mTcpCubicOps = {
+  "CUBIC",
+  TcpCubicInit,
+  TcpCubicCongAvoid,
+  TcpCubicSsthresh
+};
+
+/**
+  Get the congestion control operations selected by the platform.
+
+  @return Pointer to the congestion control operations.
+
+**/
+TCP_CONGESTION_OPS *
+TcpGetCongestionOps (
+  VOID
+  )
+{
+  if (PcdGet8 (PcdTcpCongestionControl) == TCP_CC_CUBIC) {
+    return &mTcpCubicOps;
+  }
+
+  return &mTcpRenoOps;
+}
@@ -308,6 +308,19 @@ TcpRcvWinOld (
   IN TCP_CB *Tcb
   );
 
+/**
+  Grow the receive buffer when the peer sends more than half of it in
+  one round trip time, that is, when the throughput is limited by the
+  receive window rather than by the application.
+
+  @param[in, out]  Tcb     Pointer to the TCP_CB of this TCP instance.
+
+**/
+VOID
+TcpRcvAutoTune (
+  IN OUT TCP_CB *Tcb
+  );
+
 /**
   Compute the current receive window.
 
@@ -669,6 +682,21 @@ Tcp6RefreshNeighbor (
   IN UINT32          Timeout
   );
 
+//
+// Functions in TcpCongestion.c
+//
+
+/**
+  Get the congestion control operations selected by the platform.
+
+  @return Pointer to the congestion control operations.
+
+**/
+TCP_CONGESTION_OPS *
+TcpGetCongestionOps (
+  VOID
+  );
+
 //
 // Functions in TcpDispatcher.c
 //
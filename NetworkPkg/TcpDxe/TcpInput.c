@@ -35,6 +35,97 @@ TcpSeqAcceptable (
           TCP_SEQ_LT (Seg->Seq, Tcb->RcvWl2 + Tcb->RcvWnd));
 }
 
+/**
+  Update the SACK scoreboard with the blocks reported by the peer.
+  The blocks are kept sorted and merged, data below the cumulative
+  ACK is removed from the scoreboard.
+
+  @param[in, out]  Tcb      Pointer to the TCP_CB of this TCP instance.
+  @param[in]       Ack      The cumulative ACK of the incoming segment.
+  @param[in]       Option   The options of the incoming segment.
+
+**/
+VOID
+TcpSackUpdate (
+  IN OUT TCP_CB     *Tcb,
+  IN     TCP_SEQNO  Ack,
+  IN     TCP_OPTION *Option
+  )
+{
+  TCP_SACK_BLOCK  Blocks[TCP_SACK_MAX_BLOCK + TCP_OPTION_MAX_SACK];
+  TCP_SACK_BLOCK  Block;
+  UINT8           Num;
+  UINT8           Index;
+  UINT8           Next;
+
+  Num = 0;
+
+  for (Index = 0; Index < Tcb->SackNum; Index++) {
+    if (TCP_SEQ_LEQ (Tcb->SackBlock[Index].Right, Ack)) {
+      continue;
+    }
+
+    Blocks[Num] = Tcb->SackBlock[Index];
+    if (TCP_SEQ_LT (Blocks[Num].Left, Ack)) {
+      Blocks[Num].Left = Ack;
+    }
+
+    Num++;
+  }
+
+  if (TCP_FLG_ON (Option->Flag, TCP_OPTION_RCVD_SACK)) {
+    for (Index = 0; Index < Option->SackNum; Index++) {
+      Block = Option->Sack[Index];
+
+      //
+      // Ignore the blocks that are below the cumulative ACK, such as
+      // D-SACK, or beyond the data sent.
+      //
+      if (TCP_SEQ_GEQ (Block.Left, Block.Right) ||
+          TCP_SEQ_LT (Block.Left, Ack) ||
+          TCP_SEQ_GT (Block.Right, Tcb->SndNxt)
+          ) {
+        continue;
+      }
+
+      //
+      // Insertion sort by the left edge.
+      //
+      for (Next = Num; (Next > 0) && TCP_SEQ_GT (Blocks[Next - 1].Left, Block.Left); Next--) {
+        Blocks[Next] = Blocks[Next - 1];
+      }
+
+      Blocks[Next] = Block;
+      Num++;
+    }
+  }
+
+  //
+  // Merge the overlapped or adjacent blocks, keep the lowest ones
+  // since the holes near SND.UNA are the ones to be repaired first.
+  //
+  Tcb->SackNum = 0;
+
+  for (Index = 0; Index < Num; Index++) {
+    Next = Tcb->SackNum;
+
+    if ((Next > 0) && TCP_SEQ_LEQ (Blocks[Index].Left, Tcb->SackBlock[Next - 1].Right)) {
+      if (TCP_SEQ_GT (Blocks[Index].Right, Tcb->SackBlock[Next - 1].Right)) {
+        Tcb->SackBlock[Next - 1].Right = Blocks[Index].Right;
+      }
+
+      continue;
+    }
+
+    if (Next == TCP_SACK_MAX_BLOCK) {
+      break;
+    }
+
+    Tcb->SackBlock[Next] = Blocks[Index];
+    Tcb->SackNum++;
+  }
+}
+
 /**
   NewReno fast recovery defined in RFC3782.
 
@@ -48,8 +139,9 @@ TcpFastRecover (
   IN     TCP_SEG *Seg
   )
 {
-  UINT32  FlightSize;
-  UINT32  Acked;
+  UINT32    FlightSize;
+  UINT32    Acked;
+  TCP_SEQNO Seq;
 
   //
   // Step 1: Three duplicate ACKs and not in fast recovery
@@ -59,10 +151,9 @@ TcpFastRecover (
     //
     // Step 1A: Invoking fast retransmission.
     //
-    FlightSize        = TCP_SUB_SEQ (Tcb->SndNxt, Tcb->SndUna);
-
-    Tcb->Ssthresh     = MAX (FlightSize >> 1, (UINT32) (2 * Tcb->SndMss));
+    Tcb->Ssthresh     = Tcb->CongestOps->Ssthresh (Tcb);
     Tcb->Recover      = Tcb->SndNxt;
+    Tcb->SackRexmit   = Tcb->SndUna;
 
     Tcb->CongestState = TCP_CONGEST_RECOVER;
     TCP_CLEAR_FLG (Tcb->CtrlFlag, TCP_CTRL_RTT_ON);
@@ -96,6 +187,23 @@ TcpFastRecover (
     // by TcpToSendData
     //
     Tcb->CWnd += Tcb->SndMss;
+
+    //
+    // With SACK, the peer tells which data are missing. Repair
+    // the next hole below the highest SACKed data instead of
+    // waiting for a partial ACK for each of them.
+    //
+    if (TCP_FLG_ON (Tcb->CtrlFlag, TCP_CTRL_SACK) && (Tcb->SackNum > 0)) {
+      Seq = Tcb->SackRexmit;
+      if (TCP_SEQ_LT (Seq, Tcb->SndUna)) {
+        Seq = Tcb->SndUna;
+      }
+
+      if (TCP_SEQ_LT (Seq, Tcb->SackBlock[Tcb->SackNum - 1].Left)) {
+        TcpRetransmit (Tcb, Seq);
+      }
+    }
+
     DEBUG (
       (EFI_D_INFO,
       "TcpFastRecover: received another duplicated ACK (%d) for TCB %p\n",
@@ -581,6 +689,12 @@ TcpQueueData (
   Seg   = TCPSEG_NETBUF (Nbuf);
   Head  = &Tcb->RcvQue;
 
+  //
+  // Remember the latest segment, it is reported
+  // by the first block of the SACK option.
+  //
+  Tcb->RcvSackSeq = Seg->Seq;
+
   //
   // Fast path to process normal case. That is,
   // no out-of-order segments are received.
@@ -1200,6 +1314,10 @@ TcpInput (
     TcpSetTimer (Tcb, TCP_TIMER_REXMIT, Tcb->Rto);
   }
 
+  if (TCP_FLG_ON (Tcb->CtrlFlag, TCP_CTRL_SACK)) {
+    TcpSackUpdate (Tcb, Seg->Ack, &Option);
+  }
+
   //
   // Count duplicate acks.
   //
@@ -1229,7 +1347,7 @@ TcpInput (
         Tcb->CWnd += Tcb->SndMss;
       } else {
 
-        Tcb->CWnd += MAX (Tcb->SndMss * Tcb->SndMss / Tcb->CWnd, 1);
+        Tcb->CongestOps->CongAvoid (Tcb);
       }
 
       Tcb->CWnd = MIN (Tcb->CWnd, TCP_MAX_WIN << Tcb->SndWndScale);
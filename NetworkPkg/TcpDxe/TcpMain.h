@@ -22,6 +22,7 @@
 #include <Library/IpIoLib.h>
 #include <Library/DevicePathLib.h>
 #include <Library/PrintLib.h>
+#include <Library/PcdLib.h>
 
 #include "Socket.h"
 #include "TcpProto.h"
@@ -88,6 +88,9 @@ TcpInitTcbLocal (
   Tcb->RcvWndScale  = 0;
 
   Tcb->ProbeTimerOn = FALSE;
+
+  Tcb->CongestOps   = TcpGetCongestionOps ();
+  Tcb->CongestOps->Init (Tcb);
 }
 
 /**
@@ -168,6 +171,26 @@ TcpInitTcbPeer (
     //
     Tcb->SndMss -= TCP_OPTION_TS_ALIGNED_LEN;
   }
+
+  if (TCP_FLG_ON (Opt->Flag, TCP_OPTION_RCVD_SACK_PERM) && !TCP_FLG_ON (Tcb->CtrlFlag, TCP_CTRL_NO_SACK)) {
+
+    TCP_SET_FLG (Tcb->CtrlFlag, TCP_CTRL_SACK);
+  } else {
+
+    TCP_CLEAR_FLG (Tcb->CtrlFlag, TCP_CTRL_SACK);
+  }
+
+  Tcb->SackNum      = 0;
+  Tcb->SackRexmit   = Tcb->SndUna;
+  Tcb->RcvSackSeq   = Tcb->RcvNxt;
+
+  Tcb->RcvSpaceSeq  = Tcb->RcvNxt;
+  Tcb->RcvSpaceTime = mTcpTick;
+
+  //
+  // Forget what the congestion control learned from SYN timeouts.
+  //
+  Tcb->CongestOps->Init (Tcb);
 }
 
 /**
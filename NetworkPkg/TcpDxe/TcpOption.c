@@ -86,7 +86,11 @@ TcpComputeScale (
 
   ASSERT ((Tcb != NULL) && (Tcb->Sk != NULL));
 
-  BufSize = GET_RCV_BUFFSIZE (Tcb->Sk);
+  //
+  // The receive buffer may be grown by auto-tuning after the
+  // connection is established, so size the scale for the ceiling.
+  //
+  BufSize = MAX (GET_RCV_BUFFSIZE (Tcb->Sk), TCP_RCV_BUF_SIZE);
 
   Scale   = 0;
   while ((Scale < TCP_OPTION_MAX_WS) && ((UINT32) (TCP_OPTION_MAX_WIN << Scale) < BufSize)) {
@@ -165,6 +169,28 @@ TcpSynBuildOption (
     TcpPutUint32 (Data, TCP_OPTION_WS_FAST | TcpComputeScale (Tcb));
   }
 
+  //
+  // Build SACK permitted option, only when configured to
+  // use SACK, and either we are doing active open or we
+  // have received SACK permitted option from peer.
+  //
+  if (!TCP_FLG_ON (Tcb->CtrlFlag, TCP_CTRL_NO_SACK) &&
+      (!TCP_FLG_ON (TCPSEG_NETBUF (Nbuf)->Flag, TCP_FLG_ACK) ||
+        TCP_FLG_ON (Tcb->CtrlFlag, TCP_CTRL_SACK))
+      ) {
+
+    Data = NetbufAllocSpace (
+             Nbuf,
+             TCP_OPTION_SACK_PERM_ALIGNED_LEN,
+             NET_BUF_HEAD
+             );
+
+    ASSERT (Data != NULL);
+
+    Len += TCP_OPTION_SACK_PERM_ALIGNED_LEN;
+    TcpPutUint32 (Data, TCP_OPTION_SACK_PERM_FAST);
+  }
+
   //
   // Build the MSS option.
   //
@@ -177,6 +203,84 @@ TcpSynBuildOption (
   return Len;
 }
 
+/**
+  Collect the out-of-order data in the reassemble queue as SACK blocks.
+  The block holding the most recently received segment is reported
+  first, as required by RFC2018 section 4.
+
+  @param[in]   Tcb     Pointer to the TCP_CB of this TCP instance.
+  @param[out]  Blocks  Array to receive the SACK blocks.
+  @param[in]   Max     The maximum number of blocks to return.
+
+  @return              The number of blocks stored in Blocks.
+
+**/
+UINT8
+TcpBuildSackBlocks (
+  IN     TCP_CB         *Tcb,
+     OUT TCP_SACK_BLOCK *Blocks,
+  IN     UINT8          Max
+  )
+{
+  TCP_SACK_BLOCK  All[TCP_SACK_MAX_BLOCK];
+  LIST_ENTRY      *Entry;
+  TCP_SEG         *Seg;
+  UINT8           Num;
+  UINT8           Latest;
+  UINT8           Index;
+  UINT8           Count;
+
+  Num = 0;
+
+  NET_LIST_FOR_EACH (Entry, &Tcb->RcvQue) {
+    Seg = TCPSEG_NETBUF (NET_LIST_USER_STRUCT (Entry, NET_BUF, List));
+
+    if (TCP_SEQ_LEQ (Seg->End, Tcb->RcvNxt)) {
+      continue;
+    }
+
+    if ((Num > 0) && TCP_SEQ_LEQ (Seg->Seq, All[Num - 1].Right)) {
+      if (TCP_SEQ_GT (Seg->End, All[Num - 1].Right)) {
+        All[Num - 1].Right = Seg->End;
+      }
+
+      continue;
+    }
+
+    if (Num == TCP_SACK_MAX_BLOCK) {
+      break;
+    }
+
+    All[Num].Left  = Seg->Seq;
+    All[Num].Right = Seg->End;
+    Num++;
+  }
+
+  Latest = 0;
+  for (Index = 0; Index < Num; Index++) {
+    if (TCP_SEQ_LEQ (All[Index].Left, Tcb->RcvSackSeq) &&
+        TCP_SEQ_LT (Tcb->RcvSackSeq, All[Index].Right)
+        ) {
+
+      Latest = Index;
+      break;
+    }
+  }
+
+  Count = 0;
+  if (Num > 0) {
+    Blocks[Count++] = All[Latest];
+  }
+
+  for (Index = 0; (Index < Num) && (Count < Max); Index++) {
+    if (Index != Latest) {
+      Blocks[Count++] = All[Index];
+    }
+  }
+
+  return Count;
+}
+
 /**
   Build the TCP option in synchronized states.
 
@@ -195,9 +299,48 @@ TcpBuildOption (
   UINT8   *Data;
   UINT16  Len;
 
+  TCP_SACK_BLOCK  Blocks[TCP_OPTION_MAX_SACK];
+  UINT8           Num;
+  UINT8           Index;
+
   ASSERT ((Tcb != NULL) && (Nbuf != NULL) && (Nbuf->Tcp == NULL));
   Len = 0;
 
+  //
+  // Build the SACK option if there is out-of-order data queued.
+  // It is only carried by pure ACKs so that data segments never
+  // grow beyond the MSS.
+  //
+  if (TCP_FLG_ON (Tcb->CtrlFlag, TCP_CTRL_SACK) &&
+      !TCP_FLG_ON (TCPSEG_NETBUF (Nbuf)->Flag, TCP_FLG_RST) &&
+      (Nbuf->TotalSize == 0) &&
+      !IsListEmpty (&Tcb->RcvQue)
+      ) {
+
+    Num = TcpBuildSackBlocks (
+            Tcb,
+            Blocks,
+            (UINT8) (TCP_FLG_ON (Tcb->CtrlFlag, TCP_CTRL_SND_TS) ? TCP_OPTION_MAX_SACK_TS : TCP_OPTION_MAX_SACK)
+            );
+
+    if (Num > 0) {
+      Data = NetbufAllocSpace (
+               Nbuf,
+               (UINT32) (4 + Num * TCP_OPTION_SACK_BLOCK_LEN),
+               NET_BUF_HEAD
+               );
+
+      ASSERT (Data != NULL);
+      Len = (UINT16) (Len + 4 + Num * TCP_OPTION_SACK_BLOCK_LEN);
+
+      TcpPutUint32 (Data, TCP_OPTION_SACK_FAST | (2 + Num * TCP_OPTION_SACK_BLOCK_LEN));
+      for (Index = 0; Index < Num; Index++) {
+        TcpPutUint32 (Data + 4 + Index * TCP_OPTION_SACK_BLOCK_LEN, Blocks[Index].Left);
+        TcpPutUint32 (Data + 8 + Index * TCP_OPTION_SACK_BLOCK_LEN, Blocks[Index].Right);
+      }
+    }
+  }
+
   //
   // Build the Timestamp option.
   //
@@ -244,10 +387,12 @@ TcpParseOption (
   UINT8 Cur;
   UINT8 Type;
   UINT8 Len;
+  UINT8 Index;
 
   ASSERT ((Tcp != NULL) && (Option != NULL));
 
-  Option->Flag  = 0;
+  Option->Flag    = 0;
+  Option->SackNum = 0;
 
   TotalLen      = (UINT8) ((Tcp->HeadLen << 2) - sizeof (TCP_HEAD));
   if (TotalLen <= 0) {
@@ -319,6 +464,42 @@ TcpParseOption (
       Cur += TCP_OPTION_TS_LEN;
       break;
 
+    case TCP_OPTION_SACK_PERM:
+      Len = Head[Cur + 1];
+
+      if ((Len != TCP_OPTION_SACK_PERM_LEN) || (TotalLen - Cur < TCP_OPTION_SACK_PERM_LEN)) {
+
+        return -1;
+      }
+
+      TCP_SET_FLG (Option->Flag, TCP_OPTION_RCVD_SACK_PERM);
+
+      Cur += TCP_OPTION_SACK_PERM_LEN;
+      break;
+
+    case TCP_OPTION_SACK:
+      Len = Head[Cur + 1];
+
+      if ((Len < 2 + TCP_OPTION_SACK_BLOCK_LEN) ||
+          (Len > 2 + TCP_OPTION_MAX_SACK * TCP_OPTION_SACK_BLOCK_LEN) ||
+          ((Len - 2) % TCP_OPTION_SACK_BLOCK_LEN != 0) ||
+          (TotalLen - Cur < Len)
+          ) {
+
+        return -1;
+      }
+
+      Option->SackNum = (UINT8) ((Len - 2) / TCP_OPTION_SACK_BLOCK_LEN);
+      for (Index = 0; Index < Option->SackNum; Index++) {
+        Option->Sack[Index].Left  = TcpGetUint32 (&Head[Cur + 2 + Index * TCP_OPTION_SACK_BLOCK_LEN]);
+        Option->Sack[Index].Right = TcpGetUint32 (&Head[Cur + 6 + Index * TCP_OPTION_SACK_BLOCK_LEN]);
+      }
+
+      TCP_SET_FLG (Option->Flag, TCP_OPTION_RCVD_SACK);
+
+      Cur = (UINT8) (Cur + Len);
+      break;
+
     case TCP_OPTION_NOP:
       Cur++;
       break;
@@ -23,11 +23,16 @@
 #define TCP_OPTION_NOP             1  ///< No-Option.
 #define TCP_OPTION_MSS             2  ///< Maximum Segment Size
 #define TCP_OPTION_WS              3  ///< Window scale
+#define TCP_OPTION_SACK_PERM       4  ///< SACK permitted
+#define TCP_OPTION_SACK            5  ///< Selective acknowledgement
 #define TCP_OPTION_TS              8  ///< Timestamp
 #define TCP_OPTION_MSS_LEN         4  ///< Length of MSS option
 #define TCP_OPTION_WS_LEN          3  ///< Length of window scale option
+#define TCP_OPTION_SACK_PERM_LEN   2  ///< Length of SACK permitted option
+#define TCP_OPTION_SACK_BLOCK_LEN  8  ///< Length of each block in SACK option
 #define TCP_OPTION_TS_LEN          10 ///< Length of timestamp option
 #define TCP_OPTION_WS_ALIGNED_LEN  4  ///< Length of window scale option, aligned
+#define TCP_OPTION_SACK_PERM_ALIGNED_LEN 4  ///< Length of SACK permitted option, aligned
 #define TCP_OPTION_TS_ALIGNED_LEN  12 ///< Length of timestamp option, aligned
 
 //
@@ -45,14 +50,31 @@
 
 #define TCP_OPTION_MSS_FAST  ((TCP_OPTION_MSS << 24) | (TCP_OPTION_MSS_LEN << 16))
 
+#define TCP_OPTION_SACK_PERM_FAST ((TCP_OPTION_NOP << 24)       | \
+                                   (TCP_OPTION_NOP << 16)       | \
+                                   (TCP_OPTION_SACK_PERM << 8)  | \
+                                   (TCP_OPTION_SACK_PERM_LEN))
+
+//
+// Two NOPs, the kind and length precede the SACK blocks.
+// The length is OR'ed in when the option is built.
+//
+#define TCP_OPTION_SACK_FAST ((TCP_OPTION_NOP << 24) | \
+                              (TCP_OPTION_NOP << 16) | \
+                              (TCP_OPTION_SACK << 8))
+
 //
 // Other misc definations
 //
 #define TCP_OPTION_RCVD_MSS        0x01
 #define TCP_OPTION_RCVD_WS         0x02
 #define TCP_OPTION_RCVD_TS         0x04
+#define TCP_OPTION_RCVD_SACK_PERM  0x08
+#define TCP_OPTION_RCVD_SACK       0x10
 #define TCP_OPTION_MAX_WS          14      ///< Maxium window scale value
 #define TCP_OPTION_MAX_WIN         0xffff  ///< Max window size in TCP header
+#define TCP_OPTION_MAX_SACK        4       ///< Max blocks in a SACK option
+#define TCP_OPTION_MAX_SACK_TS     3       ///< Max SACK blocks along with timestamp
 
 ///
 /// The structure to store the parse option value.
@@ -64,6 +86,8 @@ typedef struct _TCP_OPTION {
   UINT16  Mss;      ///< The Mss received
   UINT32  TSVal;    ///< The TSVal field in a timestamp option
   UINT32  TSEcr;    ///< The TSEcr field in a timestamp option
+  UINT8   SackNum;  ///< The number of blocks in a SACK option
+  TCP_SACK_BLOCK Sack[TCP_OPTION_MAX_SACK]; ///< The blocks in a SACK option
 } TCP_OPTION;
 
 /**
@@ -57,6 +57,63 @@ TcpRcvWinOld (
   return OldWin;
 }
 
+/**
+  Grow the receive buffer when the peer sends more than half of it in
+  one round trip time, that is, when the throughput is limited by the
+  receive window rather than by the application. The buffer is never
+  shrunk, and never grows beyond what the window scale can advertise
+  or TCP_RCV_BUF_SIZE.
+
+  @param[in, out]  Tcb     Pointer to the TCP_CB of this TCP instance.
+
+**/
+VOID
+TcpRcvAutoTune (
+  IN OUT TCP_CB *Tcb
+  )
+{
+  SOCKET  *Sk;
+  UINT32  BufSize;
+  UINT32  Ceiling;
+  UINT32  Interval;
+  UINT32  Elapsed;
+  UINT32  Received;
+
+  Sk      = Tcb->Sk;
+  BufSize = GET_RCV_BUFFSIZE (Sk);
+  Ceiling = MIN (TCP_RCV_BUF_SIZE, TCP_MAX_WIN << Tcb->RcvWndScale);
+
+  if (!TCP_CONNECTED (Tcb->State) || (BufSize >= Ceiling)) {
+    return;
+  }
+
+  Interval = MAX (Tcb->SRtt >> 3, 1);
+  Elapsed  = TCP_SUB_TIME (mTcpTick, Tcb->RcvSpaceTime);
+
+  if (Elapsed < Interval) {
+    return;
+  }
+
+  //
+  // The amount of data received in one round trip time.
+  //
+  Received = TCP_SUB_SEQ (Tcb->RcvNxt, Tcb->RcvSpaceSeq) / Elapsed * Interval;
+
+  if (Received >= BufSize / 2) {
+    SET_RCV_BUFFSIZE (Sk, MIN (2 * BufSize, Ceiling));
+
+    DEBUG (
+      (EFI_D_NET,
+      "TcpRcvAutoTune: grow the receive buffer to %d for TCB %p\n",
+      GET_RCV_BUFFSIZE (Sk),
+      Tcb)
+      );
+  }
+
+  Tcb->RcvSpaceSeq  = Tcb->RcvNxt;
+  Tcb->RcvSpaceTime = mTcpTick;
+}
+
 /**
   Compute the current receive window.
 
@@ -78,6 +135,8 @@ TcpRcvWinNow (
   Sk = Tcb->Sk;
   ASSERT (Sk != NULL);
 
+  TcpRcvAutoTune (Tcb);
+
   OldWin    = TcpRcvWinOld (Tcb);
 
   Win       = SockGetFreeSpace (Sk, SOCK_RCV_BUF);
@@ -654,15 +713,47 @@ TcpRetransmit (
   IN TCP_SEQNO Seq
   )
 {
-  NET_BUF *Nbuf;
-  UINT32  Len;
+  NET_BUF         *Nbuf;
+  UINT32          Len;
+  UINT32          Limit;
+  TCP_SACK_BLOCK  *Block;
+  UINT8           Index;
+
+  //
+  // Skip the data SACKed by the peer, and stop before
+  // the next SACKed block.
+  //
+  Limit = Tcb->SndMss;
+
+  if (TCP_FLG_ON (Tcb->CtrlFlag, TCP_CTRL_SACK)) {
+    for (Index = 0; Index < Tcb->SackNum; Index++) {
+      Block = &Tcb->SackBlock[Index];
+
+      if (TCP_SEQ_LEQ (Block->Right, Seq)) {
+        continue;
+      }
+
+      if (TCP_SEQ_LEQ (Block->Left, Seq)) {
+        Seq = Block->Right;
+        continue;
+      }
+
+      Limit = MIN (Limit, TCP_SUB_SEQ (Block->Left, Seq));
+      break;
+    }
+
+    if (TCP_SEQ_GEQ (Seq, Tcb->SndNxt)) {
+      return 0;
+    }
+  }
 
   //
   // Compute the maxium length of retransmission. It is
-  // limited by three factors:
+  // limited by four factors:
   // 1. Less than SndMss
   // 2. Must in the current send window
   // 3. Will not change the boundaries of queued segments.
+  // 4. Will not resend the data SACKed by the peer.
   //
   if (TCP_SEQ_LT (Tcb->SndWl2 + Tcb->SndWnd, Seq)) {
     DEBUG (
@@ -675,7 +766,7 @@ TcpRetransmit (
   }
 
   Len   = TCP_SUB_SEQ (Tcb->SndWl2 + Tcb->SndWnd, Seq);
-  Len   = MIN (Len, Tcb->SndMss);
+  Len   = MIN (Len, Limit);
 
   Nbuf  = TcpGetSegmentSndQue (Tcb, Seq, Len);
   if (Nbuf == NULL) {
@@ -688,6 +779,10 @@ TcpRetransmit (
     goto OnError;
   }
 
+  if (TCP_SEQ_GT (TCPSEG_NETBUF (Nbuf)->End, Tcb->SackRexmit)) {
+    Tcb->SackRexmit = TCPSEG_NETBUF (Nbuf)->End;
+  }
+
   //
   // The retransmitted buffer may be on the SndQue,
   // trim TCP head because all the buffers on SndQue
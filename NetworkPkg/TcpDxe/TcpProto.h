@@ -78,6 +78,8 @@
 #define TCP_CTRL_TIMER_ON        0x1000 ///< At least one of the timer is on.
 #define TCP_CTRL_RTT_ON          0x2000 ///< The RTT measurement is on.
 #define TCP_CTRL_ACK_NOW         0x4000 ///< Send the ACK now, don't delay.
+#define TCP_CTRL_NO_SACK         0x8000 ///< Disable SACK option.
+#define TCP_CTRL_SACK            0x10000 ///< SACK is negotiated with the peer.
 
 //
 // Timer related values
@@ -131,6 +133,17 @@
 #define TCP_FIN_WAIT2_TIME_MAX   (4 * TCP_TICK_HZ)
 #define TCP_TIME_WAIT_TIME_MAX   (60 * TCP_TICK_HZ)
 
+//
+// Number of blocks kept in the SACK scoreboard of the sender.
+//
+#define TCP_SACK_MAX_BLOCK       8
+
+//
+// Congestion control algorithms, selected by PcdTcpCongestionControl.
+//
+#define TCP_CC_RENO              0  ///< NewReno, RFC5681 and RFC3782.
+#define TCP_CC_CUBIC             1  ///< CUBIC, RFC8312.
+
 ///
 /// TCP_CONNECTED: both ends have synchronized their ISN.
 ///
@@ -233,8 +246,77 @@ typedef struct _TCP_PEER {
   TCP_PORTNO      Port;   ///< Port number, in network byte order.
 } TCP_PEER;
 
+///
+/// A block of contiguous sequence space, [Left, Right).
+///
+typedef struct _TCP_SACK_BLOCK {
+  TCP_SEQNO Left;   ///< The first sequence number of the block.
+  TCP_SEQNO Right;  ///< The sequence number following the block.
+} TCP_SACK_BLOCK;
+
 typedef struct _TCP_CONTROL_BLOCK  TCP_CB;
 
+/**
+  Initialize the congestion control state of a connection.
+
+  @param[in, out]  Tcb      Pointer to the TCP_CB of this TCP instance.
+
+**/
+typedef
+VOID
+(*TCP_CC_INIT) (
+  IN OUT TCP_CB *Tcb
+  );
+
+/**
+  Grow the congestion window in congestion avoidance when new data is ACKed.
+
+  @param[in, out]  Tcb      Pointer to the TCP_CB of this TCP instance.
+
+**/
+typedef
+VOID
+(*TCP_CC_CONG_AVOID) (
+  IN OUT TCP_CB *Tcb
+  );
+
+/**
+  Compute the slow start threshold after a loss is detected.
+
+  @param[in, out]  Tcb      Pointer to the TCP_CB of this TCP instance.
+
+  @return The new slow start threshold, in bytes.
+
+**/
+typedef
+UINT32
+(*TCP_CC_SSTHRESH) (
+  IN OUT TCP_CB *Tcb
+  );
+
+///
+/// Congestion control operations. Slow start, fast retransmit and
+/// NewReno fast recovery are common, the operations only decide how
+/// the window grows in congestion avoidance and shrinks on loss.
+///
+typedef struct _TCP_CONGESTION_OPS {
+  CHAR8             *Name;
+  TCP_CC_INIT       Init;
+  TCP_CC_CONG_AVOID CongAvoid;
+  TCP_CC_SSTHRESH   Ssthresh;
+} TCP_CONGESTION_OPS;
+
+///
+/// Per connection state of CUBIC.
+///
+typedef struct _TCP_CUBIC {
+  UINT32            WMax;        ///< Window before the last reduction, in bytes.
+  UINT32            WLastMax;    ///< WMax before the last reduction, for fast convergence.
+  UINT32            Epoch;       ///< Tick when the current epoch started, 0 if none.
+  UINT32            K;           ///< Time to reach WMax from the epoch start, in ms.
+  UINT32            WEst;        ///< The window Reno would have, in bytes.
+} TCP_CUBIC;
+
 ///
 /// TCP control block: it includes various states.
 ///
@@ -314,6 +396,22 @@ struct _TCP_CONTROL_BLOCK {
   UINT8             CongestState; ///< The current congestion state(RFC3782).
   UINT8             LossTimes;    ///< Number of retxmit timeouts in a row.
   TCP_SEQNO         LossRecover;  ///< Recover point for retxmit.
+  TCP_CONGESTION_OPS *CongestOps; ///< Congestion avoidance algorithm.
+  TCP_CUBIC         Cubic;        ///< State of CUBIC congestion avoidance.
+
+  //
+  // RFC2018 and RFC6675 variables, selective acknowledgement.
+  //
+  TCP_SACK_BLOCK    SackBlock[TCP_SACK_MAX_BLOCK]; ///< Data SACKed by the peer, sorted.
+  UINT8             SackNum;      ///< Number of valid blocks in SackBlock.
+  TCP_SEQNO         SackRexmit;   ///< Highest seq retransmitted in SACK recovery.
+  TCP_SEQNO         RcvSackSeq;   ///< Seq of the latest out-of-order segment queued.
+
+  //
+  // Receive buffer auto-tuning.
+  //
+  TCP_SEQNO         RcvSpaceSeq;  ///< RcvNxt when the measurement started.
+  UINT32            RcvSpaceTime; ///< Tick when the measurement started.
 
   //
   // configuration parameters, for EFI_TCP4_PROTOCOL specification
@@ -470,6 +470,7 @@ PxeBcDhcp4BootInfo (
   UINT16                      Value;
   PXEBC_VENDOR_OPTION         *VendorOpt;
   PXEBC_BOOT_SVR_ENTRY        *Entry;
+  PXEBC_HTTP_URL              Url;
   
   PxeBc       = &Private->PxeBc;
   Mode        = PxeBc->Mode;
@@ -533,6 +534,18 @@ PxeBcDhcp4BootInfo (
   //
   Private->BootFileName = Cache4->OptList[PXEBC_DHCP4_TAG_INDEX_BOOTFILE]->Data;
 
+  if (PxeBcIsHttpUrl (Private->BootFileName)) {
+    //
+    // The boot file is an HTTP URL, the boot server is the host in it.
+    //
+    Status = PxeBcHttpParseUrl ((CHAR8 *) Private->BootFileName, FALSE, &Url);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+
+    CopyMem (&Private->ServerIp, &Url.ServerIp, sizeof (EFI_IPv4_ADDRESS));
+  }
+
   if (Cache4->OptList[PXEBC_DHCP4_TAG_INDEX_BOOTFILE_LEN] != NULL) {
     //
     // Parse the boot file size by option.
@@ -543,6 +556,11 @@ PxeBcDhcp4BootInfo (
     // The field of boot file size is 512 bytes in unit.
     //
     *BufferSize = 512 * Value;
+  } else if (PxeBcIsHttpUrl (Private->BootFileName)) {
+    //
+    // Get the bootfile size by http HEAD request if no option available.
+    //
+    Status = PxeBcHttpGetFileSize (Private, Private->BootFileName, BufferSize);
   } else {
     //
     // Get the bootfile size by tftp command if no option available.
@@ -599,6 +617,8 @@ PxeBcDhcp6BootInfo (
   EFI_PXE_BASE_CODE_MODE      *Mode;
   EFI_STATUS                  Status;
   PXEBC_DHCP6_PACKET_CACHE    *Cache6;
+  EFI_DHCP6_PACKET_OPTION     *BootFileUrl;
+  PXEBC_HTTP_URL              Url;
   UINT16                      Value;
 
   PxeBc       = &Private->PxeBc;
@@ -618,18 +638,39 @@ PxeBcDhcp6BootInfo (
   }
 
   ASSERT (Cache6->OptList[PXEBC_DHCP6_IDX_BOOT_FILE_URL] != NULL);
+  BootFileUrl = Cache6->OptList[PXEBC_DHCP6_IDX_BOOT_FILE_URL];
 
-  //
-  // Parse (m)tftp server ip address and bootfile name.
-  //
-  Status = PxeBcExtractBootFileUrl (
-             &Private->BootFileName,
-             &Private->ServerIp.v6,
-             (CHAR8 *) (Cache6->OptList[PXEBC_DHCP6_IDX_BOOT_FILE_URL]->Data),
-             NTOHS (Cache6->OptList[PXEBC_DHCP6_IDX_BOOT_FILE_URL]->OpLen)
-             );
-  if (EFI_ERROR (Status)) {
-    return Status;
+  if (NTOHS (BootFileUrl->OpLen) > AsciiStrLen (PXEBC_HTTP_URL_PREFIX) &&
+      CompareMem (BootFileUrl->Data, PXEBC_HTTP_URL_PREFIX, AsciiStrLen (PXEBC_HTTP_URL_PREFIX)) == 0) {
+    //
+    // Parse http server ip address, and keep the whole URL as bootfile name.
+    //
+    Private->BootFileName = AllocateZeroPool (NTOHS (BootFileUrl->OpLen) + 1);
+    if (Private->BootFileName == NULL) {
+      return EFI_OUT_OF_RESOURCES;
+    }
+
+    CopyMem (Private->BootFileName, BootFileUrl->Data, NTOHS (BootFileUrl->OpLen));
+
+    Status = PxeBcHttpParseUrl ((CHAR8 *) Private->BootFileName, TRUE, &Url);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+
+    IP6_COPY_ADDRESS (&Private->ServerIp.v6, &Url.ServerIp.v6);
+  } else {
+    //
+    // Parse (m)tftp server ip address and bootfile name.
+    //
+    Status = PxeBcExtractBootFileUrl (
+               &Private->BootFileName,
+               &Private->ServerIp.v6,
+               (CHAR8 *) BootFileUrl->Data,
+               NTOHS (BootFileUrl->OpLen)
+               );
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
   }
 
   //
@@ -655,6 +696,11 @@ PxeBcDhcp6BootInfo (
     // The field of boot file size is 512 bytes in unit.
     //
     *BufferSize = 512 * Value;
+  } else if (PxeBcIsHttpUrl (Private->BootFileName)) {
+    //
+    // Send http HEAD request if option unavailable.
+    //
+    Status = PxeBcHttpGetFileSize (Private, Private->BootFileName, BufferSize);
   } else {
     //
     // Send get file size command by tftp if option unavailable.
@@ -1088,7 +1134,9 @@ PxeBcReadBootFileList (
   //
   // Try to download the boot file if everything is ready.
   //
-  if (Buffer != NULL) {
+  if (Buffer != NULL && PxeBcIsHttpUrl (Private->BootFileName)) {
+    Status = PxeBcHttpReadFile (Private, Private->BootFileName, Buffer, BufferSize);
+  } else if (Buffer != NULL) {
     Status = PxeBc->Mtftp (
                       PxeBc,
                       EFI_PXE_BASE_CODE_TFTP_READ_FILE,
@@ -1208,6 +1256,8 @@ PxeBcLoadBootFile (
                &CurrentSize,
                Buffer
                );
+  } else if (PxeBcIsHttpUrl (Private->BootFileName)) {
+    Status = PxeBcHttpReadFile (Private, Private->BootFileName, Buffer, &CurrentSize);
   } else {
     Status = PxeBc->Mtftp (
                       PxeBc,
@@ -0,0 +1,1007 @@
+/** @file
+  Functions implementation related with HTTP for UefiPxeBc Driver.
+
+  The boot file is downloaded over persistent HTTP/1.1 connections. The
+  file is split into ranges which are requested in turn on several
+  connections, with a few requests pipelined on each of them. While one
+  connection is being drained, the responses on the others are queued by
+  TCP, so the server keeps sending on all of them.
+
+  Copyright (c) 2015, Intel Corporation. All rights reserved.<BR>
+
+  This program and the accompanying materials
+  are licensed and made available under the terms and conditions of the BSD License
+  which accompanies this distribution.  The full text of the license may be found at
+  http://opensource.org/licenses/bsd-license.php.
+
+  THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+  WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+**/
+
+#include "PxeBcImpl.h"
+
+
+/**
+  Check whether the boot file name is an HTTP URL.
+
+  @param[in]  BootFileName   Pointer to the boot file name.
+
+  @retval TRUE               The boot file is to be downloaded by HTTP.
+  @retval FALSE              The boot file is to be downloaded by TFTP.
+
+**/
+BOOLEAN
+PxeBcIsHttpUrl (
+  IN CONST UINT8              *BootFileName
+  )
+{
+  if (BootFileName == NULL) {
+    return FALSE;
+  }
+
+  return (BOOLEAN) (AsciiStrnCmp (
+                      (CHAR8 *) BootFileName,
+                      PXEBC_HTTP_URL_PREFIX,
+                      AsciiStrLen (PXEBC_HTTP_URL_PREFIX)
+                      ) == 0);
+}
+
+
+/**
+  Parse the server address, port and path out of an HTTP URL.
+
+  @param[in]  UrlStr         Pointer to the Null-terminated URL string.
+  @param[in]  UsingIpv6      Whether the host is expected to be an IPv6 address.
+  @param[out] Url            Pointer to the parsed URL. Url->Path points into UrlStr.
+
+  @retval EFI_SUCCESS            Successfully parsed the URL.
+  @retval EFI_INVALID_PARAMETER  The URL is malformatted.
+  @retval EFI_UNSUPPORTED        The host isn't an IP address literal.
+
+**/
+EFI_STATUS
+PxeBcHttpParseUrl (
+  IN     CHAR8                *UrlStr,
+  IN     BOOLEAN              UsingIpv6,
+     OUT PXEBC_HTTP_URL       *Url
+  )
+{
+  CHAR8                       Address[PXEBC_HTTP_MAX_HOST_LEN];
+  CHAR8                       *Host;
+  CHAR8                       *Cur;
+  UINTN                       Len;
+  UINTN                       Port;
+  EFI_STATUS                  Status;
+
+  if (!PxeBcIsHttpUrl ((UINT8 *) UrlStr)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  ZeroMem (Url, sizeof (PXEBC_HTTP_URL));
+  Url->Port = PXEBC_HTTP_DEFAULT_PORT;
+  Host      = UrlStr + AsciiStrLen (PXEBC_HTTP_URL_PREFIX);
+
+  //
+  // The host is either a dotted IPv4 address or an IPv6 address enclosed
+  // in brackets, such as http://[2001:db8::1]:8080/boot.efi
+  //
+  if (*Host == PXEBC_ADDR_START_DELIMITER) {
+    Host++;
+    Cur = Host;
+    while (*Cur != '\0' && *Cur != PXEBC_ADDR_END_DELIMITER) {
+      Cur++;
+    }
+
+    if (*Cur != PXEBC_ADDR_END_DELIMITER) {
+      return EFI_INVALID_PARAMETER;
+    }
+  } else {
+    Cur = Host;
+    while (*Cur != '\0' && *Cur != ':' && *Cur != PXEBC_TFTP_URL_SEPARATOR) {
+      Cur++;
+    }
+  }
+
+  Len = Cur - Host;
+  if ((Len == 0) || (Len >= PXEBC_HTTP_MAX_HOST_LEN)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  CopyMem (Address, Host, Len);
+  Address[Len] = '\0';
+
+  if (UsingIpv6) {
+    if (*Cur != PXEBC_ADDR_END_DELIMITER) {
+      return EFI_UNSUPPORTED;
+    }
+
+    Status = NetLibAsciiStrToIp6 (Address, &Url->ServerIp.v6);
+    Host--;
+    Cur++;
+  } else {
+    Status = NetLibAsciiStrToIp4 (Address, &Url->ServerIp.v4);
+  }
+
+  if (EFI_ERROR (Status)) {
+    //
+    // There is no DNS client to resolve a host name.
+    //
+    return EFI_UNSUPPORTED;
+  }
+
+  if (*Cur == ':') {
+    Cur++;
+    Port = 0;
+    while (*Cur >= '0' && *Cur <= '9') {
+      Port = Port * 10 + (*Cur - '0');
+      if (Port > 0xFFFF) {
+        return EFI_INVALID_PARAMETER;
+      }
+      Cur++;
+    }
+
+    if (Port == 0) {
+      return EFI_INVALID_PARAMETER;
+    }
+
+    Url->Port = (UINT16) Port;
+  }
+
+  //
+  // The host and port are sent as is in the Host header field.
+  //
+  Len = Cur - Host;
+  if (Len >= PXEBC_HTTP_MAX_HOST_LEN) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  CopyMem (Url->Host, Host, Len);
+  Url->Host[Len] = '\0';
+
+  if (*Cur == '\0') {
+    Url->Path = "/";
+  } else if (*Cur == PXEBC_TFTP_URL_SEPARATOR) {
+    Url->Path = Cur;
+  } else {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  return EFI_SUCCESS;
+}
+
+
+/**
+  The callback function of NetbufFromExt. The buffer belongs to the caller.
+
+  @param[in]  Arg            The opaque parameter.
+
+**/
+VOID
+EFIAPI
+PxeBcHttpNbufExtFree (
+  IN VOID                     *Arg
+  )
+{
+}
+
+
+/**
+  Create a TCP connection to the HTTP server.
+
+  @param[in]      Private        Pointer to PxeBc private data.
+  @param[in]      Url            Pointer to the parsed URL.
+  @param[in, out] Conn           Pointer to the HTTP connection.
+  @param[in]      TimeoutEvent   The timer event used for the connection timeout.
+
+  @retval EFI_SUCCESS            The connection is established.
+  @retval Others                 Failed to connect to the server.
+
+**/
+EFI_STATUS
+PxeBcHttpConnect (
+  IN     PXEBC_PRIVATE_DATA   *Private,
+  IN     PXEBC_HTTP_URL       *Url,
+  IN OUT PXEBC_HTTP_CONNECTION *Conn,
+  IN     EFI_EVENT            TimeoutEvent
+  )
+{
+  TCP_IO_CONFIG_DATA          ConfigData;
+  TCP4_IO_CONFIG_DATA         *Tcp4Config;
+  TCP6_IO_CONFIG_DATA         *Tcp6Config;
+  UINT8                       TcpVersion;
+  EFI_STATUS                  Status;
+
+  ZeroMem (&ConfigData, sizeof (TCP_IO_CONFIG_DATA));
+
+  if (Private->Mode.UsingIpv6) {
+    TcpVersion             = TCP_VERSION_6;
+    Tcp6Config             = &ConfigData.Tcp6IoConfigData;
+    Tcp6Config->RemotePort = Url->Port;
+    Tcp6Config->ActiveFlag = TRUE;
+    IP6_COPY_ADDRESS (&Tcp6Config->RemoteIp, &Url->ServerIp.v6);
+  } else {
+    TcpVersion             = TCP_VERSION_4;
+    Tcp4Config             = &ConfigData.Tcp4IoConfigData;
+    Tcp4Config->RemotePort = Url->Port;
+    Tcp4Config->ActiveFlag = TRUE;
+    IP4_COPY_ADDRESS (&Tcp4Config->LocalIp, &Private->StationIp.v4);
+    IP4_COPY_ADDRESS (&Tcp4Config->SubnetMask, &Private->SubnetMask.v4);
+    IP4_COPY_ADDRESS (&Tcp4Config->Gateway, &Private->GatewayIp.v4);
+    IP4_COPY_ADDRESS (&Tcp4Config->RemoteIp, &Url->ServerIp.v4);
+  }
+
+  Status = TcpIoCreateSocket (
+             Private->Image,
+             Private->Controller,
+             TcpVersion,
+             &ConfigData,
+             &Conn->TcpIo
+             );
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  gBS->SetTimer (TimeoutEvent, TimerRelative, PXEBC_HTTP_TIMEOUT);
+  Status = TcpIoConnect (&Conn->TcpIo, TimeoutEvent);
+  gBS->SetTimer (TimeoutEvent, TimerCancel, 0);
+
+  if (EFI_ERROR (Status)) {
+    TcpIoDestroySocket (&Conn->TcpIo);
+    return Status;
+  }
+
+  Conn->IsConnected = TRUE;
+  Conn->Pending     = 0;
+  Conn->RxStart     = 0;
+  Conn->RxEnd       = 0;
+
+  return EFI_SUCCESS;
+}
+
+
+/**
+  Close the TCP connection to the HTTP server if it is open.
+
+  @param[in, out] Conn           Pointer to the HTTP connection.
+
+**/
+VOID
+PxeBcHttpClose (
+  IN OUT PXEBC_HTTP_CONNECTION *Conn
+  )
+{
+  if (Conn->IsConnected) {
+    TcpIoDestroySocket (&Conn->TcpIo);
+    Conn->IsConnected = FALSE;
+    Conn->Pending     = 0;
+  }
+}
+
+
+/**
+  Send an HTTP request for the file, optionally for a byte range of it.
+
+  @param[in]  Conn           Pointer to the HTTP connection.
+  @param[in]  Url            Pointer to the parsed URL.
+  @param[in]  Method         The request method, "GET" or "HEAD".
+  @param[in]  Offset         The first byte of the range.
+  @param[in]  Length         The length of the range, 0 requests the whole file.
+
+  @retval EFI_SUCCESS            The request is sent.
+  @retval EFI_OUT_OF_RESOURCES   Failed to allocate the request.
+  @retval Others                 Failed to send the request.
+
+**/
+EFI_STATUS
+PxeBcHttpSendRequest (
+  IN PXEBC_HTTP_CONNECTION    *Conn,
+  IN PXEBC_HTTP_URL           *Url,
+  IN CHAR8                    *Method,
+  IN UINT64                   Offset,
+  IN UINT64                   Length
+  )
+{
+  NET_BUF                     *Nbuf;
+  CHAR8                       *Request;
+  UINTN                       Size;
+  UINTN                       Len;
+  EFI_STATUS                  Status;
+
+  Size = AsciiStrLen (Url->Path) + AsciiStrLen (Url->Host) + 128;
+  Nbuf = NetbufAlloc ((UINT32) Size);
+  if (Nbuf == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Request = (CHAR8 *) NetbufAllocSpace (Nbuf, (UINT32) Size, NET_BUF_TAIL);
+  ASSERT (Request != NULL);
+
+  if (Length != 0) {
+    Len = AsciiSPrint (
+            Request,
+            Size,
+            "%a %a HTTP/1.1\r\nHost: %a\r\nRange: bytes=%Ld-%Ld\r\n\r\n",
+            Method,
+            Url->Path,
+            Url->Host,
+            Offset,
+            Offset + Length - 1
+            );
+  } else {
+    Len = AsciiSPrint (
+            Request,
+            Size,
+            "%a %a HTTP/1.1\r\nHost: %a\r\n\r\n",
+            Method,
+            Url->Path,
+            Url->Host
+            );
+  }
+
+  NetbufTrim (Nbuf, (UINT32) (Size - Len), NET_BUF_TAIL);
+
+  Status = TcpIoTransmit (&Conn->TcpIo, Nbuf);
+  NetbufFree (Nbuf);
+
+  return Status;
+}
+
+
+/**
+  Receive exactly Length bytes from the connection into Buffer.
+
+  The bytes left in the connection's block buffer by PxeBcHttpReceiveHeader()
+  are copied first, the rest is received directly into Buffer in pieces, each
+  of which has to arrive within PXEBC_HTTP_TIMEOUT.
+
+  @param[in]  Conn           Pointer to the HTTP connection.
+  @param[in]  Buffer         Pointer to the buffer to receive into.
+  @param[in]  Length         The number of bytes to receive.
+  @param[in]  TimeoutEvent   The timer event used for the receive timeout.
+
+  @retval EFI_SUCCESS            All the data is received.
+  @retval EFI_TIMEOUT            The server didn't send the data in time.
+  @retval Others                 Failed to receive the data.
+
+**/
+EFI_STATUS
+PxeBcHttpReceive (
+  IN PXEBC_HTTP_CONNECTION    *Conn,
+  IN UINT8                    *Buffer,
+  IN UINTN                    Length,
+  IN EFI_EVENT                TimeoutEvent
+  )
+{
+  NET_FRAGMENT                Fragment;
+  NET_BUF                     *Nbuf;
+  UINTN                       Copied;
+  EFI_STATUS                  Status;
+
+  Copied = MIN (Length, Conn->RxEnd - Conn->RxStart);
+  if (Copied > 0) {
+    CopyMem (Buffer, &Conn->RxBuf[Conn->RxStart], Copied);
+    Conn->RxStart += Copied;
+    Buffer        += Copied;
+    Length        -= Copied;
+  }
+
+  while (Length > 0) {
+    Fragment.Len  = (UINT32) MIN (Length, PXEBC_HTTP_RECEIVE_SIZE);
+    Fragment.Bulk = Buffer;
+
+    Nbuf = NetbufFromExt (&Fragment, 1, 0, 0, PxeBcHttpNbufExtFree, NULL);
+    if (Nbuf == NULL) {
+      return EFI_OUT_OF_RESOURCES;
+    }
+
+    gBS->SetTimer (TimeoutEvent, TimerRelative, PXEBC_HTTP_TIMEOUT);
+    Status = TcpIoReceive (&Conn->TcpIo, Nbuf, FALSE, TimeoutEvent);
+    gBS->SetTimer (TimeoutEvent, TimerCancel, 0);
+
+    NetbufFree (Nbuf);
+
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+
+    Buffer += Fragment.Len;
+    Length -= Fragment.Len;
+  }
+
+  return EFI_SUCCESS;
+}
+
+
+/**
+  Receive the data available on the connection, at most Length bytes, into
+  Buffer. At least one byte has to arrive within PXEBC_HTTP_TIMEOUT.
+
+  TcpIoReceive() only returns once its buffer is full, which would wait for
+  data that may never come after a response header.
+
+  @param[in]  Conn           Pointer to the HTTP connection.
+  @param[in]  Buffer         Pointer to the buffer to receive into.
+  @param[in]  Length         The size of the buffer.
+  @param[in]  TimeoutEvent   The timer event used for the receive timeout.
+  @param[out] Received       The number of bytes received.
+
+  @retval EFI_SUCCESS            Some data is received.
+  @retval EFI_TIMEOUT            The server didn't send any data in time.
+  @retval Others                 Failed to receive the data.
+
+**/
+EFI_STATUS
+PxeBcHttpReceiveBlock (
+  IN     PXEBC_HTTP_CONNECTION *Conn,
+  IN     UINT8                *Buffer,
+  IN     UINTN                Length,
+  IN     EFI_EVENT            TimeoutEvent,
+     OUT UINTN                *Received
+  )
+{
+  TCP_IO                      *TcpIo;
+  EFI_TCP4_RECEIVE_DATA       *RxData;
+  EFI_STATUS                  Status;
+
+  TcpIo  = &Conn->TcpIo;
+  RxData = TcpIo->RxToken.Tcp4Token.Packet.RxData;
+  ASSERT (RxData != NULL);
+
+  RxData->DataLength                      = (UINT32) Length;
+  RxData->FragmentCount                   = 1;
+  RxData->FragmentTable[0].FragmentLength = (UINT32) Length;
+  RxData->FragmentTable[0].FragmentBuffer = Buffer;
+
+  gBS->SetTimer (TimeoutEvent, TimerRelative, PXEBC_HTTP_TIMEOUT);
+
+  if (TcpIo->TcpVersion == TCP_VERSION_4) {
+    Status = TcpIo->Tcp.Tcp4->Receive (TcpIo->Tcp.Tcp4, &TcpIo->RxToken.Tcp4Token);
+  } else {
+    Status = TcpIo->Tcp.Tcp6->Receive (TcpIo->Tcp.Tcp6, &TcpIo->RxToken.Tcp6Token);
+  }
+
+  if (EFI_ERROR (Status)) {
+    gBS->SetTimer (TimeoutEvent, TimerCancel, 0);
+    return Status;
+  }
+
+  while (!TcpIo->IsRxDone && EFI_ERROR (gBS->CheckEvent (TimeoutEvent))) {
+    if (TcpIo->TcpVersion == TCP_VERSION_4) {
+      TcpIo->Tcp.Tcp4->Poll (TcpIo->Tcp.Tcp4);
+    } else {
+      TcpIo->Tcp.Tcp6->Poll (TcpIo->Tcp.Tcp6);
+    }
+  }
+
+  gBS->SetTimer (TimeoutEvent, TimerCancel, 0);
+
+  if (!TcpIo->IsRxDone) {
+    if (TcpIo->TcpVersion == TCP_VERSION_4) {
+      TcpIo->Tcp.Tcp4->Cancel (TcpIo->Tcp.Tcp4, &TcpIo->RxToken.Tcp4Token.CompletionToken);
+    } else {
+      TcpIo->Tcp.Tcp6->Cancel (TcpIo->Tcp.Tcp6, &TcpIo->RxToken.Tcp6Token.CompletionToken);
+    }
+
+    return EFI_TIMEOUT;
+  }
+
+  TcpIo->IsRxDone = FALSE;
+
+  Status = TcpIo->RxToken.Tcp4Token.CompletionToken.Status;
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  *Received = RxData->FragmentTable[0].FragmentLength;
+  return EFI_SUCCESS;
+}
+
+
+/**
+  Parse the status line and the header fields of an HTTP response.
+
+  @param[in]  Header         Pointer to the Null-terminated response header.
+  @param[out] Response       Pointer to the parsed response.
+
+  @retval EFI_SUCCESS            Successfully parsed the response.
+  @retval EFI_PROTOCOL_ERROR     The response isn't a valid HTTP/1.x response.
+  @retval EFI_UNSUPPORTED        The response body uses a transfer coding.
+
+**/
+EFI_STATUS
+PxeBcHttpParseResponse (
+  IN     CHAR8                *Header,
+     OUT PXEBC_HTTP_RESPONSE  *Response
+  )
+{
+  CHAR8                       *Line;
+  CHAR8                       *End;
+  CHAR8                       *Value;
+
+  ZeroMem (Response, sizeof (PXEBC_HTTP_RESPONSE));
+
+  //
+  // The status line is like "HTTP/1.1 206 Partial Content". HTTP/1.1
+  // connections are persistent unless the server says otherwise.
+  //
+  if (AsciiStrnCmp (Header, "HTTP/1.", 7) != 0) {
+    return EFI_PROTOCOL_ERROR;
+  }
+
+  Response->KeepAlive  = (BOOLEAN) (Header[7] == '1');
+  Response->StatusCode = AsciiStrDecimalToUintn (Header + 8);
+
+  Line = AsciiStrStr (Header, "\r\n");
+  ASSERT (Line != NULL);
+  Line += 2;
+
+  while (*Line != '\r' && *Line != '\0') {
+    End = AsciiStrStr (Line, "\r\n");
+    ASSERT (End != NULL);
+    *End = '\0';
+
+    Value = AsciiStrStr (Line, ":");
+    if (Value != NULL) {
+      *Value = '\0';
+      Value++;
+      while (*Value == ' ' || *Value == '\t') {
+        Value++;
+      }
+
+      if (AsciiStriCmp (Line, "Content-Length") == 0) {
+        Response->ContentLength    = AsciiStrDecimalToUint64 (Value);
+        Response->HasContentLength = TRUE;
+
+      } else if (AsciiStriCmp (Line, "Content-Range") == 0) {
+        //
+        // Content-Range: bytes 1048576-2097151/209715200
+        //
+        if (AsciiStrnCmp (Value, "bytes ", 6) == 0) {
+          Response->RangeStart = AsciiStrDecimalToUint64 (Value + 6);
+          Value = AsciiStrStr (Value, "/");
+          if ((Value != NULL) && (Value[1] >= '0') && (Value[1] <= '9')) {
+            Response->TotalLength     = AsciiStrDecimalToUint64 (Value + 1);
+            Response->HasContentRange = TRUE;
+          }
+        }
+
+      } else if (AsciiStriCmp (Line, "Connection") == 0) {
+        if (AsciiStriCmp (Value, "close") == 0) {
+          Response->KeepAlive = FALSE;
+        } else if (AsciiStriCmp (Value, "keep-alive") == 0) {
+          Response->KeepAlive = TRUE;
+        }
+
+      } else if (AsciiStriCmp (Line, "Transfer-Encoding") == 0) {
+        if (AsciiStriCmp (Value, "identity") != 0) {
+          return EFI_UNSUPPORTED;
+        }
+      }
+    }
+
+    Line = End + 2;
+  }
+
+  return EFI_SUCCESS;
+}
+
+
+/**
+  Receive and parse the header of the next HTTP response on the connection.
+
+  @param[in]  Conn           Pointer to the HTTP connection.
+  @param[out] Response       Pointer to the parsed response.
+  @param[in]  TimeoutEvent   The timer event used for the receive timeout.
+
+  @retval EFI_SUCCESS            Successfully received the response header.
+  @retval EFI_PROTOCOL_ERROR     The response header is invalid or too long.
+  @retval Others                 Failed to receive the response header.
+
+**/
+EFI_STATUS
+PxeBcHttpReceiveHeader (
+  IN     PXEBC_HTTP_CONNECTION *Conn,
+     OUT PXEBC_HTTP_RESPONSE  *Response,
+  IN     EFI_EVENT            TimeoutEvent
+  )
+{
+  CHAR8                       Header[PXEBC_HTTP_MAX_HEADER_LEN + 1];
+  UINTN                       Len;
+  EFI_STATUS                  Status;
+
+  //
+  // Receive the header in blocks and scan them for the empty line ending
+  // it. The body follows the header immediately, so the rest of the last
+  // block stays in the connection for PxeBcHttpReceive().
+  //
+  Len = 0;
+  for (;;) {
+    if (Conn->RxStart == Conn->RxEnd) {
+      Conn->RxStart = 0;
+      Conn->RxEnd   = 0;
+      Status = PxeBcHttpReceiveBlock (
+                 Conn,
+                 Conn->RxBuf,
+                 sizeof (Conn->RxBuf),
+                 TimeoutEvent,
+                 &Conn->RxEnd
+                 );
+      if (EFI_ERROR (Status)) {
+        return Status;
+      }
+    }
+
+    while (Conn->RxStart < Conn->RxEnd) {
+      if (Len == PXEBC_HTTP_MAX_HEADER_LEN) {
+        return EFI_PROTOCOL_ERROR;
+      }
+
+      Header[Len++] = (CHAR8) Conn->RxBuf[Conn->RxStart++];
+      if (Len >= 4 && CompareMem (&Header[Len - 4], "\r\n\r\n", 4) == 0) {
+        Header[Len] = '\0';
+        return PxeBcHttpParseResponse (Header, Response);
+      }
+    }
+  }
+}
+
+
+/**
+  Convert the status code of an HTTP response to EFI_STATUS.
+
+  @param[in]  StatusCode     The status code of the response.
+
+  @return The EFI_STATUS for the status code.
+
+**/
+EFI_STATUS
+PxeBcHttpStatusToEfi (
+  IN UINTN                    StatusCode
+  )
+{
+  switch (StatusCode) {
+  case 200:
+  case 206:
+    return EFI_SUCCESS;
+
+  case 401:
+  case 403:
+    return EFI_ACCESS_DENIED;
+
+  case 404:
+  case 410:
+    return EFI_NOT_FOUND;
+
+  default:
+    return EFI_PROTOCOL_ERROR;
+  }
+}
+
+
+/**
+  Send range requests on the connection until its pipeline is full or
+  all the ranges assigned to it are requested.
+
+  @param[in, out] Conn           Pointer to the HTTP connection.
+  @param[in]      Url            Pointer to the parsed URL.
+  @param[in]      FileSize       The size of the file.
+  @param[in]      RangeNum       The number of ranges of the file.
+  @param[in]      ConnNum        The number of connections in use.
+
+  @retval EFI_SUCCESS            The requests are sent.
+  @retval Others                 Failed to send a request.
+
+**/
+EFI_STATUS
+PxeBcHttpFillPipeline (
+  IN OUT PXEBC_HTTP_CONNECTION *Conn,
+  IN     PXEBC_HTTP_URL       *Url,
+  IN     UINT64               FileSize,
+  IN     UINTN                RangeNum,
+  IN     UINTN                ConnNum
+  )
+{
+  UINT64                      Offset;
+  EFI_STATUS                  Status;
+
+  while ((Conn->Pending < PXEBC_HTTP_PIPELINE_DEPTH) && (Conn->NextRange < RangeNum)) {
+    Offset = MultU64x32 (Conn->NextRange, PXEBC_HTTP_RANGE_SIZE);
+    Status = PxeBcHttpSendRequest (
+               Conn,
+               Url,
+               "GET",
+               Offset,
+               MIN (FileSize - Offset, PXEBC_HTTP_RANGE_SIZE)
+               );
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+
+    Conn->NextRange += ConnNum;
+    Conn->Pending++;
+  }
+
+  return EFI_SUCCESS;
+}
+
+
+/**
+  Get the size of the boot file by an HTTP HEAD request.
+
+  @param[in]  Private        Pointer to PxeBc private data.
+  @param[in]  UrlStr         Pointer to the URL of the boot file.
+  @param[out] BufferSize     Pointer to the size of the boot file.
+
+  @retval EFI_SUCCESS        Successfully obtained the size of the file.
+  @retval EFI_NOT_FOUND      The server didn't find the file.
+  @retval EFI_TIMEOUT        The server didn't respond in time.
+  @retval Others             Did not obtain the size of the file.
+
+**/
+EFI_STATUS
+PxeBcHttpGetFileSize (
+  IN     PXEBC_PRIVATE_DATA   *Private,
+  IN     UINT8                *UrlStr,
+     OUT UINT64               *BufferSize
+  )
+{
+  PXEBC_HTTP_URL              Url;
+  PXEBC_HTTP_CONNECTION       Conn;
+  PXEBC_HTTP_RESPONSE         Response;
+  EFI_EVENT                   TimeoutEvent;
+  EFI_STATUS                  Status;
+
+  *BufferSize = 0;
+
+  Status = PxeBcHttpParseUrl ((CHAR8 *) UrlStr, Private->Mode.UsingIpv6, &Url);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Status = gBS->CreateEvent (EVT_TIMER, TPL_CALLBACK, NULL, NULL, &TimeoutEvent);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  ZeroMem (&Conn, sizeof (PXEBC_HTTP_CONNECTION));
+
+  Status = PxeBcHttpConnect (Private, &Url, &Conn, TimeoutEvent);
+  if (EFI_ERROR (Status)) {
+    goto ON_EXIT;
+  }
+
+  Status = PxeBcHttpSendRequest (&Conn, &Url, "HEAD", 0, 0);
+  if (EFI_ERROR (Status)) {
+    goto ON_EXIT;
+  }
+
+  Status = PxeBcHttpReceiveHeader (&Conn, &Response, TimeoutEvent);
+  if (EFI_ERROR (Status)) {
+    goto ON_EXIT;
+  }
+
+  Status = PxeBcHttpStatusToEfi (Response.StatusCode);
+  if (!EFI_ERROR (Status)) {
+    if (Response.HasContentLength) {
+      *BufferSize = Response.ContentLength;
+    } else {
+      Status = EFI_NOT_FOUND;
+    }
+  }
+
+ON_EXIT:
+  PxeBcHttpClose (&Conn);
+  gBS->CloseEvent (TimeoutEvent);
+
+  return Status;
+}
+
+
+/**
+  Download the boot file by HTTP into the user buffer.
+
+  The file is split into ranges requested over several persistent
+  connections, and each response is received directly into its place
+  in the buffer.
+
+  @param[in]      Private        Pointer to PxeBc private data.
+  @param[in]      UrlStr         Pointer to the URL of the boot file.
+  @param[in]      Buffer         Pointer to the user buffer.
+  @param[in, out] BufferSize     Size of user buffer for input;
+                                 size of the boot file for output.
+
+  @retval EFI_SUCCESS            Successfully downloaded the file.
+  @retval EFI_BUFFER_TOO_SMALL   The buffer size is not enough for the file.
+  @retval EFI_NOT_FOUND          The server didn't find the file.
+  @retval EFI_TIMEOUT            The server didn't respond in time.
+  @retval Others                 Failed to download the file.
+
+**/
+EFI_STATUS
+PxeBcHttpReadFile (
+  IN     PXEBC_PRIVATE_DATA   *Private,
+  IN     UINT8                *UrlStr,
+  IN     UINT8                *Buffer,
+  IN OUT UINT64               *BufferSize
+  )
+{
+  PXEBC_HTTP_URL              Url;
+  PXEBC_HTTP_CONNECTION       *Connections;
+  PXEBC_HTTP_CONNECTION       *Conn;
+  PXEBC_HTTP_RESPONSE         Response;
+  EFI_EVENT                   TimeoutEvent;
+  UINT64                      FileSize;
+  UINT64                      Offset;
+  UINTN                       Length;
+  UINTN                       RangeNum;
+  UINTN                       ConnNum;
+  UINTN                       Range;
+  UINTN                       Index;
+  EFI_STATUS                  Status;
+
+  Status = PxeBcHttpParseUrl ((CHAR8 *) UrlStr, Private->Mode.UsingIpv6, &Url);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Connections = AllocateZeroPool (PXEBC_HTTP_MAX_CONNECTION * sizeof (PXEBC_HTTP_CONNECTION));
+  if (Connections == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Status = gBS->CreateEvent (EVT_TIMER, TPL_CALLBACK, NULL, NULL, &TimeoutEvent);
+  if (EFI_ERROR (Status)) {
+    FreePool (Connections);
+    return Status;
+  }
+
+  //
+  // Request the first range on the first connection. Its response tells
+  // the size of the file and whether the server supports range requests.
+  //
+  Conn   = &Connections[0];
+  Status = PxeBcHttpConnect (Private, &Url, Conn, TimeoutEvent);
+  if (EFI_ERROR (Status)) {
+    goto ON_EXIT;
+  }
+
+  Status = PxeBcHttpSendRequest (Conn, &Url, "GET", 0, PXEBC_HTTP_RANGE_SIZE);
+  if (EFI_ERROR (Status)) {
+    goto ON_EXIT;
+  }
+
+  Status = PxeBcHttpReceiveHeader (Conn, &Response, TimeoutEvent);
+  if (EFI_ERROR (Status)) {
+    goto ON_EXIT;
+  }
+
+  if ((Response.StatusCode == 200) && Response.HasContentLength) {
+    //
+    // The server ignored the range, the whole file follows.
+    //
+    if (Response.ContentLength > *BufferSize) {
+      *BufferSize = Response.ContentLength;
+      Status      = EFI_BUFFER_TOO_SMALL;
+      goto ON_EXIT;
+    }
+
+    *BufferSize = Response.ContentLength;
+    Status      = PxeBcHttpReceive (Conn, Buffer, (UINTN) Response.ContentLength, TimeoutEvent);
+    goto ON_EXIT;
+  }
+
+  if ((Response.StatusCode != 206) || !Response.HasContentRange) {
+    Status = PxeBcHttpStatusToEfi (Response.StatusCode);
+    if (!EFI_ERROR (Status)) {
+      Status = EFI_PROTOCOL_ERROR;
+    }
+    goto ON_EXIT;
+  }
+
+  FileSize = Response.TotalLength;
+  if (FileSize > *BufferSize) {
+    *BufferSize = FileSize;
+    Status      = EFI_BUFFER_TOO_SMALL;
+    goto ON_EXIT;
+  }
+
+  *BufferSize = FileSize;
+  RangeNum    = (UINTN) DivU64x32 (FileSize + PXEBC_HTTP_RANGE_SIZE - 1, PXEBC_HTTP_RANGE_SIZE);
+  ConnNum     = MIN (RangeNum, PXEBC_HTTP_MAX_CONNECTION);
+
+  //
+  // Open the other connections. The server may limit the connections
+  // per client, just use the ones which succeed.
+  //
+  for (Index = 1; Index < ConnNum; Index++) {
+    Status = PxeBcHttpConnect (Private, &Url, &Connections[Index], TimeoutEvent);
+    if (EFI_ERROR (Status)) {
+      ConnNum = Index;
+      break;
+    }
+  }
+
+  //
+  // Range N is requested on connection (N % ConnNum), and range 0 has
+  // been requested on the first connection already.
+  //
+  Connections[0].NextRange = ConnNum;
+  Connections[0].Pending   = 1;
+  for (Index = 1; Index < ConnNum; Index++) {
+    Connections[Index].NextRange = Index;
+  }
+
+  for (Index = 0; Index < ConnNum; Index++) {
+    Status = PxeBcHttpFillPipeline (&Connections[Index], &Url, FileSize, RangeNum, ConnNum);
+    if (EFI_ERROR (Status)) {
+      goto ON_EXIT;
+    }
+  }
+
+  //
+  // Receive the ranges in order, each one directly into its place in
+  // the user buffer.
+  //
+  for (Range = 0; Range < RangeNum; Range++) {
+    Conn   = &Connections[Range % ConnNum];
+    Offset = MultU64x32 (Range, PXEBC_HTTP_RANGE_SIZE);
+    Length = (UINTN) MIN (FileSize - Offset, PXEBC_HTTP_RANGE_SIZE);
+
+    if (Range != 0) {
+      Status = PxeBcHttpReceiveHeader (Conn, &Response, TimeoutEvent);
+      if (EFI_ERROR (Status)) {
+        goto ON_EXIT;
+      }
+    }
+
+    if ((Response.StatusCode != 206) ||
+        !Response.HasContentRange ||
+        (Response.RangeStart != Offset) ||
+        (Response.HasContentLength && (Response.ContentLength != Length))) {
+      Status = EFI_PROTOCOL_ERROR;
+      goto ON_EXIT;
+    }
+
+    Status = PxeBcHttpReceive (Conn, Buffer + (UINTN) Offset, Length, TimeoutEvent);
+    if (EFI_ERROR (Status)) {
+      goto ON_EXIT;
+    }
+
+    Conn->Pending--;
+
+    if (!Response.KeepAlive) {
+      //
+      // The server closes the connection after this response, so the
+      // requests pipelined behind it are lost. Request them again on a
+      // new connection.
+      //
+      PxeBcHttpClose (Conn);
+      Conn->NextRange = Range + ConnNum;
+
+      if (Conn->NextRange < RangeNum) {
+        Status = PxeBcHttpConnect (Private, &Url, Conn, TimeoutEvent);
+        if (EFI_ERROR (Status)) {
+          goto ON_EXIT;
+        }
+      }
+    }
+
+    if (Conn->IsConnected) {
+      Status = PxeBcHttpFillPipeline (Conn, &Url, FileSize, RangeNum, ConnNum);
+      if (EFI_ERROR (Status)) {
+        goto ON_EXIT;
+      }
+    }
+  }
+
+ON_EXIT:
+  for (Index = 0; Index < PXEBC_HTTP_MAX_CONNECTION; Index++) {
+    PxeBcHttpClose (&Connections[Index]);
+  }
+
+  FreePool (Connections);
+  gBS->CloseEvent (TimeoutEvent);
+
+  return Status;
+}
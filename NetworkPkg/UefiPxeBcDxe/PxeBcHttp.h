@@ -0,0 +1,157 @@
+/** @file
+  Functions declaration related with HTTP for UefiPxeBc Driver.
+
+  Copyright (c) 2015, Intel Corporation. All rights reserved.<BR>
+
+  This program and the accompanying materials
+  are licensed and made available under the terms and conditions of the BSD License
+  which accompanies this distribution.  The full text of the license may be found at
+  http://opensource.org/licenses/bsd-license.php.
+
+  THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+  WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+**/
+
+#ifndef __EFI_PXEBC_HTTP_H__
+#define __EFI_PXEBC_HTTP_H__
+
+#define PXEBC_HTTP_URL_PREFIX           "http://"
+#define PXEBC_HTTP_DEFAULT_PORT         80
+#define PXEBC_HTTP_MAX_HOST_LEN         64
+#define PXEBC_HTTP_MAX_HEADER_LEN       4096
+#define PXEBC_HTTP_MAX_CONNECTION       4          // parallel connections to the server.
+#define PXEBC_HTTP_PIPELINE_DEPTH       2          // requests in flight per connection.
+#define PXEBC_HTTP_RANGE_SIZE           SIZE_1MB   // bytes requested by each range request.
+#define PXEBC_HTTP_RECEIVE_SIZE         SIZE_64KB  // bytes received per timeout period.
+#define PXEBC_HTTP_HEADER_BLOCK_SIZE    2048       // bytes received per block while reading a header.
+#define PXEBC_HTTP_TIMEOUT              50000000   // 5 seconds, unit is 100nanosecond
+
+//
+// The HTTP URL of the boot file, only IP address literals are supported
+// for the host since there is no DNS client.
+//
+typedef struct {
+  EFI_IP_ADDRESS          ServerIp;
+  UINT16                  Port;
+  CHAR8                   Host[PXEBC_HTTP_MAX_HOST_LEN];
+  CHAR8                   *Path;
+} PXEBC_HTTP_URL;
+
+//
+// The persistent connection to the HTTP server. The range requests of
+// the file are assigned to the connections in turn, NextRange is the
+// next range to request on this connection and Pending is the number
+// of requests sent but not yet answered. Response headers are received
+// in blocks, the bytes of a block following a header are kept from
+// RxBuf[RxStart] to RxBuf[RxEnd] for the body.
+//
+typedef struct {
+  TCP_IO                  TcpIo;
+  BOOLEAN                 IsConnected;
+  UINTN                   NextRange;
+  UINTN                   Pending;
+  UINT8                   RxBuf[PXEBC_HTTP_HEADER_BLOCK_SIZE];
+  UINTN                   RxStart;
+  UINTN                   RxEnd;
+} PXEBC_HTTP_CONNECTION;
+
+//
+// The parsed HTTP response header.
+//
+typedef struct {
+  UINTN                   StatusCode;
+  UINT64                  ContentLength;
+  UINT64                  RangeStart;
+  UINT64                  TotalLength;
+  BOOLEAN                 HasContentLength;
+  BOOLEAN                 HasContentRange;
+  BOOLEAN                 KeepAlive;
+} PXEBC_HTTP_RESPONSE;
+
+
+/**
+  Check whether the boot file name is an HTTP URL.
+
+  @param[in]  BootFileName   Pointer to the boot file name.
+
+  @retval TRUE               The boot file is to be downloaded by HTTP.
+  @retval FALSE              The boot file is to be downloaded by TFTP.
+
+**/
+BOOLEAN
+PxeBcIsHttpUrl (
+  IN CONST UINT8              *BootFileName
+  );
+
+
+/**
+  Parse the server address, port and path out of an HTTP URL.
+
+  @param[in]  UrlStr         Pointer to the Null-terminated URL string.
+  @param[in]  UsingIpv6      Whether the host is expected to be an IPv6 address.
+  @param[out] Url            Pointer to the parsed URL. Url->Path points into UrlStr.
+
+  @retval EFI_SUCCESS            Successfully parsed the URL.
+  @retval EFI_INVALID_PARAMETER  The URL is malformatted.
+  @retval EFI_UNSUPPORTED        The host isn't an IP address literal.
+
+**/
+EFI_STATUS
+PxeBcHttpParseUrl (
+  IN     CHAR8                *UrlStr,
+  IN     BOOLEAN              UsingIpv6,
+     OUT PXEBC_HTTP_URL       *Url
+  );
+
+
+/**
+  Get the size of the boot file by an HTTP HEAD request.
+
+  @param[in]  Private        Pointer to PxeBc private data.
+  @param[in]  UrlStr         Pointer to the URL of the boot file.
+  @param[out] BufferSize     Pointer to the size of the boot file.
+
+  @retval EFI_SUCCESS        Successfully obtained the size of the file.
+  @retval EFI_NOT_FOUND      The server didn't find the file.
+  @retval EFI_TIMEOUT        The server didn't respond in time.
+  @retval Others             Did not obtain the size of the file.
+
+**/
+EFI_STATUS
+PxeBcHttpGetFileSize (
+  IN     PXEBC_PRIVATE_DATA   *Private,
+  IN     UINT8                *UrlStr,
+     OUT UINT64               *BufferSize
+  );
+
+
+/**
+  Download the boot file by HTTP into the user buffer.
+
+  The file is split into ranges requested over several persistent
+  connections, and each response is received directly into its place
+  in the buffer.
+
+  @param[in]      Private        Pointer to PxeBc private data.
+  @param[in]      UrlStr         Pointer to the URL of the boot file.
+  @param[in]      Buffer         Pointer to the user buffer.
+  @param[in, out] BufferSize     Size of user buffer for input;
+                                 size of the boot file for output.
+
+  @retval EFI_SUCCESS            Successfully downloaded the file.
+  @retval EFI_BUFFER_TOO_SMALL   The buffer size is not enough for the file.
+  @retval EFI_NOT_FOUND          The server didn't find the file.
+  @retval EFI_TIMEOUT            The server didn't respond in time.
+  @retval Others                 Failed to download the file.
+
+**/
+EFI_STATUS
+PxeBcHttpReadFile (
+  IN     PXEBC_PRIVATE_DATA   *Private,
+  IN     UINT8                *UrlStr,
+  IN     UINT8                *Buffer,
+  IN OUT UINT64               *BufferSize
+  );
+
+#endif
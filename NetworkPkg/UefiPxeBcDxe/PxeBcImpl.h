@@ -50,6 +50,8 @@
 #include <Library/DpcLib.h>
 #include <Library/DevicePathLib.h>
 #include <Library/PcdLib.h>
+#include <Library/PrintLib.h>
+#include <Library/TcpIoLib.h>
 
 typedef struct _PXEBC_PRIVATE_DATA  PXEBC_PRIVATE_DATA;
 typedef struct _PXEBC_PRIVATE_PROTOCOL PXEBC_PRIVATE_PROTOCOL;
@@ -59,6 +61,7 @@ typedef struct _PXEBC_VIRTUAL_NIC   PXEBC_VIRTUAL_NIC;
 #include "PxeBcDhcp4.h"
 #include "PxeBcDhcp6.h"
 #include "PxeBcMtftp.h"
+#include "PxeBcHttp.h"
 #include "PxeBcBoot.h"
 #include "PxeBcSupport.h"
 
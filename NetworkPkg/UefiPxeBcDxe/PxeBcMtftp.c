@@ -19,7 +19,8 @@ CHAR8 *mMtftpOptions[PXE_MTFTP_OPTION_MAXIMUM_INDEX] = {
   "blksize",
   "timeout",
   "tsize",
-  "multicast"
+  "multicast",
+  "windowsize"
 };
 
 
@@ -255,7 +256,7 @@ PxeBcMtftp6ReadFile (
 {
   EFI_MTFTP6_PROTOCOL                 *Mtftp6;
   EFI_MTFTP6_TOKEN                    Token;
-  EFI_MTFTP6_OPTION                   ReqOpt[1];
+  EFI_MTFTP6_OPTION                   ReqOpt[2];
   UINT32                              OptCnt;
   UINT8                               OptBuf[128];
   EFI_STATUS                          Status;
@@ -277,6 +278,15 @@ PxeBcMtftp6ReadFile (
     OptCnt++;
   }
 
+  //
+  // Ask the server to send a window of blocks per ACK. The server ignores
+  // the option if it doesn't support it.
+  //
+  ReqOpt[OptCnt].OptionStr = (UINT8 *) mMtftpOptions[PXE_MTFTP_OPTION_WINDOWSIZE_INDEX];
+  ReqOpt[OptCnt].ValueStr  = (OptCnt == 0) ? OptBuf : (UINT8 *) (OptBuf + AsciiStrLen ((CHAR8 *) OptBuf) + 1);
+  PxeBcUintnToAscDec (PXE_MTFTP_DEFAULT_WINDOW_SIZE, ReqOpt[OptCnt].ValueStr);
+  OptCnt++;
+
   Token.Event         = NULL;
   Token.OverrideData  = NULL;
   Token.Filename      = Filename;
@@ -699,7 +709,7 @@ PxeBcMtftp4ReadFile (
 {
   EFI_MTFTP4_PROTOCOL *Mtftp4;
   EFI_MTFTP4_TOKEN    Token;
-  EFI_MTFTP4_OPTION   ReqOpt[1];
+  EFI_MTFTP4_OPTION   ReqOpt[2];
   UINT32              OptCnt;
   UINT8               OptBuf[128];
   EFI_STATUS          Status;
@@ -721,6 +731,15 @@ PxeBcMtftp4ReadFile (
     OptCnt++;
   }
 
+  //
+  // Ask the server to send a window of blocks per ACK. The server ignores
+  // the option if it doesn't support it.
+  //
+  ReqOpt[OptCnt].OptionStr = (UINT8 *) mMtftpOptions[PXE_MTFTP_OPTION_WINDOWSIZE_INDEX];
+  ReqOpt[OptCnt].ValueStr  = (OptCnt == 0) ? OptBuf : (UINT8 *) (OptBuf + AsciiStrLen ((CHAR8 *) OptBuf) + 1);
+  PxeBcUintnToAscDec (PXE_MTFTP_DEFAULT_WINDOW_SIZE, ReqOpt[OptCnt].ValueStr);
+  OptCnt++;
+
   Token.Event         = NULL;
   Token.OverrideData  = NULL;
   Token.Filename      = Filename;
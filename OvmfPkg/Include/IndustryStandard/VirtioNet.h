@@ -72,6 +72,15 @@ typedef struct {
   UINT16 CsumStart;
   UINT16 CsumOffset;
 } VIRTIO_NET_REQ;
+
+//
+// Packet Header when VIRTIO_NET_F_MRG_RXBUF has been negotiated (in both
+// directions)
+//
+typedef struct {
+  VIRTIO_NET_REQ V0_9_5;
+  UINT16         NumBuffers;
+} VIRTIO_NET_MRG_REQ;
 #pragma pack()
 
 //
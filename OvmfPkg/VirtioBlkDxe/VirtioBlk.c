@@ -6,9 +6,9 @@
 
   - No attach/detach (ie. removable media).
 
-  - Although the non-blocking interfaces of EFI_BLOCK_IO2_PROTOCOL could be a
-    good match for multiple in-flight virtio-blk requests, we stick to
-    synchronous requests and EFI_BLOCK_IO_PROTOCOL for now.
+  - EFI_BLOCK_IO2_PROTOCOL is provided next to EFI_BLOCK_IO_PROTOCOL. Its
+    non-blocking requests are kept in flight on the virtio ring concurrently
+    (up to VBLK_MAX_PENDING of them), and completed from a timer event.
 
   Copyright (C) 2012, Red Hat, Inc.
   Copyright (c) 2012 - 2014, Intel Corporation. All rights reserved.<BR>
@@ -183,73 +183,206 @@ VerifyReadWriteRequest (
 
 /**
 
-  Format a read / write / flush request as three consecutive virtio
-  descriptors, push them to the host, and poll for the response.
+  Process the descriptor chains the host has returned since the last call.
 
-  This is the main workhorse function. Two use cases are supported, read/write
-  and flush. The function may only be called after the request parameters have
-  been verified by
-  - specific checks in ReadBlocks() / WriteBlocks() / FlushBlocks(), and
-  - VerifyReadWriteRequest() (for read/write only).
+  Blocking requests are only marked as done; their submitter releases the
+  request slot. Non-blocking requests are completed here: the transaction
+  status is stored in the token, the token's event is signaled, and the
+  request slot is released. Orphaned requests, whose host notification
+  failed, only release their request slot.
 
-  Parameters handled commonly:
+  When the last write a deferred non-blocking flush waits for is returned, the
+  flush is started.
 
-    @param[in] Dev             The virtio-blk device the request is targeted
-                               at.
+  The caller is responsible for running at TPL_CALLBACK.
 
-  Flush request:
+  @param[in,out] Dev  The virtio-blk device whose ring should be processed.
 
-    @param[in] Lba             Must be zero.
+**/
 
-    @param[in] BufferSize      Must be zero.
+STATIC
+EFI_STATUS
+VirtioBlkStartFlush (
+  IN OUT VBLK_DEV *Dev
+  );
 
-    @param[in out] Buffer      Ignored by the function.
+STATIC
+VOID
+VirtioBlkReapRequests (
+  IN OUT VBLK_DEV *Dev
+  )
+{
+  UINT16              UsedIdx;
+  UINT16              ReqIdx;
+  VBLK_REQ            *Req;
+  EFI_BLOCK_IO2_TOKEN *FlushToken;
 
-    @param[in] RequestIsWrite  Must be TRUE.
+  //
+  // virtio-0.9.5, 2.4.2 Receiving Used Buffers From the Device
+  //
+  MemoryFence ();
+  UsedIdx = *Dev->Ring.Used.Idx;
+  MemoryFence ();
+
+  while (Dev->LastUsed != UsedIdx) {
+    ReqIdx = (UINT16) (Dev->Ring.Used.UsedElem[
+                         Dev->LastUsed++ % Dev->Ring.QueueSize].Id /
+                       VBLK_DESC_PER_REQ);
+    ASSERT (ReqIdx < Dev->MaxPending);
+
+    Req = &Dev->Requests[ReqIdx];
+    ASSERT (!Req->Done);
+    Req->Done = TRUE;
+
+    if (Req->FlushWait) {
+      Req->FlushWait = FALSE;
+      ASSERT (Dev->FlushWaitCount > 0);
+      --Dev->FlushWaitCount;
+    }
 
-  Read/Write request:
+    if (Req->Orphaned) {
+      Req->Orphaned = FALSE;
+      Dev->FreeStack[--Dev->CurPending] = ReqIdx;
+    } else if (Req->Token != NULL) {
+      Req->Token->TransactionStatus = (Req->HostStatus == VIRTIO_BLK_S_OK) ?
+                                      EFI_SUCCESS : EFI_DEVICE_ERROR;
+      gBS->SignalEvent (Req->Token->Event);
+      Req->Token = NULL;
+
+      Dev->FreeStack[--Dev->CurPending] = ReqIdx;
+
+      ASSERT (Dev->AsyncPending > 0);
+      if (--Dev->AsyncPending == 0) {
+        gBS->SetTimer (Dev->PollTimer, TimerCancel, 0);
+      }
+    }
+  }
 
-    @param[in] Lba             Logical Block Address: number of logical blocks
-                               to skip from the beginning of the device.
+  if (Dev->FlushToken != NULL && Dev->FlushWaitCount == 0) {
+    FlushToken = Dev->FlushToken;
+    if (EFI_ERROR (VirtioBlkStartFlush (Dev))) {
+      FlushToken->TransactionStatus = EFI_DEVICE_ERROR;
+      gBS->SignalEvent (FlushToken->Event);
+    }
+  }
+}
 
-    @param[in] BufferSize      Size of buffer to transfer, in bytes. The caller
-                               is responsible to ensure this parameter is
-                               positive.
 
-    @param[in out] Buffer      The guest side area to read data from the device
-                               into, or write data to the device from.
+/**
 
-    @param[in] RequestIsWrite  TRUE iff data transfer goes from guest to
-                               device.
+  Timer notification function completing non-blocking requests.
 
-  Return values are common to both use cases, and are appropriate to be
-  forwarded by the EFI_BLOCK_IO_PROTOCOL functions (ReadBlocks(),
-  WriteBlocks(), FlushBlocks()).
+  @param[in] Event    The poll timer event.
 
+  @param[in] Context  Pointer to the VBLK_DEV structure.
 
-  @retval EFI_SUCCESS          Transfer complete.
+**/
 
-  @retval EFI_DEVICE_ERROR     Failed to notify host side via VirtIo write, or
-                               unable to parse host response, or host response
-                               is not VIRTIO_BLK_S_OK.
+STATIC
+VOID
+EFIAPI
+VirtioBlkPoll (
+  IN EFI_EVENT Event,
+  IN VOID      *Context
+  )
+{
+  VirtioBlkReapRequests ((VBLK_DEV *) Context);
+}
+
+
+/**
+
+  Wait until the host has returned all descriptor chains we submitted.
+
+  The caller is responsible for running at TPL_CALLBACK.
+
+  @param[in,out] Dev  The virtio-blk device to drain.
+
+**/
+
+STATIC
+VOID
+VirtioBlkDrainRequests (
+  IN OUT VBLK_DEV *Dev
+  )
+{
+  UINTN PollPeriodUsecs;
+
+  PollPeriodUsecs = 1;
+  for (;;) {
+    VirtioBlkReapRequests (Dev);
+    if (Dev->AsyncPending == 0) {
+      break;
+    }
+    gBS->Stall (PollPeriodUsecs);
+    if (PollPeriodUsecs < 1024) {
+      PollPeriodUsecs *= 2;
+    }
+  }
+}
+
+
+/**
+
+  Format a read / write / flush request as two or three consecutive virtio
+  descriptors in a free request slot, and push them to the host. The function
+  doesn't wait for the host to process the request.
+
+  If all request slots are busy, the function polls until one is freed, for at
+  most VBLK_SLOT_TIMEOUT microseconds.
+
+  The caller is responsible for running at TPL_CALLBACK, and for verifying the
+  request parameters; see SynchronousRequest() for the latter.
+
+  @param[in] Dev             The virtio-blk device the request is targeted at.
+
+  @param[in] Lba             Logical Block Address, zero for flush.
+
+  @param[in] BufferSize      Size of buffer to transfer, zero for flush.
+
+  @param[in out] Buffer      The guest side area to transfer data from / to.
+
+  @param[in] RequestIsWrite  TRUE iff data transfer goes from guest to device,
+                             or this is a flush.
+
+  @param[in] Token           The token to complete from VirtioBlkReapRequests()
+                             for a non-blocking request, NULL otherwise.
+
+  @param[out] ReqIdx         The request slot used.
+
+
+  @retval EFI_SUCCESS       The request has been submitted.
+
+  @retval EFI_DEVICE_ERROR  No request slot was freed in time. Nothing has
+                            been submitted.
+
+  @return                   Error code from VirtIo->SetQueueNotify(). The
+                            request slot is orphaned: the host may still
+                            process the chain, and VirtioBlkReapRequests()
+                            releases the slot when it is returned. Token is
+                            not completed.
 
 **/
 
 STATIC
 EFI_STATUS
-EFIAPI
-SynchronousRequest (
-  IN              VBLK_DEV *Dev,
-  IN              EFI_LBA  Lba,
-  IN              UINTN    BufferSize,
-  IN OUT volatile VOID     *Buffer,
-  IN              BOOLEAN  RequestIsWrite
+VirtioBlkSubmitRequest (
+  IN              VBLK_DEV            *Dev,
+  IN              EFI_LBA             Lba,
+  IN              UINTN               BufferSize,
+  IN OUT volatile VOID                *Buffer,
+  IN              BOOLEAN             RequestIsWrite,
+  IN              EFI_BLOCK_IO2_TOKEN *Token,
+  OUT             UINT16              *ReqIdx
   )
 {
-  UINT32                  BlockSize;
-  volatile VIRTIO_BLK_REQ Request;
-  volatile UINT8          HostStatus;
-  DESC_INDICES            Indices;
+  UINT32       BlockSize;
+  VBLK_REQ     *Req;
+  DESC_INDICES Indices;
+  UINT16       AvailIdx;
+  UINTN        PollPeriodUsecs;
+  UINTN        WaitUsecs;
+  EFI_STATUS   Status;
 
   BlockSize = Dev->BlockIoMedia.BlockSize;
 
@@ -264,33 +397,61 @@ SynchronousRequest (
   //
   ASSERT (BufferSize % BlockSize == 0);
 
+  //
+  // Find a free request slot.
+  //
+  PollPeriodUsecs = 1;
+  WaitUsecs       = 0;
+  for (;;) {
+    VirtioBlkReapRequests (Dev);
+    if (Dev->CurPending < Dev->MaxPending) {
+      break;
+    }
+    if (WaitUsecs >= VBLK_SLOT_TIMEOUT) {
+      DEBUG ((DEBUG_ERROR, "%a: no request slot freed by the host\n",
+        __FUNCTION__));
+      return EFI_DEVICE_ERROR;
+    }
+    gBS->Stall (PollPeriodUsecs);
+    WaitUsecs += PollPeriodUsecs;
+    if (PollPeriodUsecs < 1024) {
+      PollPeriodUsecs *= 2;
+    }
+  }
+  *ReqIdx = Dev->FreeStack[Dev->CurPending++];
+  Req     = &Dev->Requests[*ReqIdx];
+
   //
   // Prepare virtio-blk request header, setting zero size for flush.
   // IO Priority is homogeneously 0.
   //
-  Request.Type   = RequestIsWrite ?
-                   (BufferSize == 0 ? VIRTIO_BLK_T_FLUSH : VIRTIO_BLK_T_OUT) :
-                   VIRTIO_BLK_T_IN;
-  Request.IoPrio = 0;
-  Request.Sector = MultU64x32(Lba, BlockSize / 512);
-
-  VirtioPrepare (&Dev->Ring, &Indices);
+  Req->Header.Type   = RequestIsWrite ?
+                       (BufferSize == 0 ? VIRTIO_BLK_T_FLUSH : VIRTIO_BLK_T_OUT) :
+                       VIRTIO_BLK_T_IN;
+  Req->Header.IoPrio = 0;
+  Req->Header.Sector = MultU64x32(Lba, BlockSize / 512);
 
   //
   // preset a host status for ourselves that we do not accept as success
   //
-  HostStatus = VIRTIO_BLK_S_IOERR;
+  Req->HostStatus = VIRTIO_BLK_S_IOERR;
+  Req->Done       = FALSE;
+  Req->Orphaned   = FALSE;
+  Req->FlushWait  = FALSE;
+  Req->Token      = Token;
 
   //
-  // ensured by VirtioBlkInit() -- this predicate, in combination with the
-  // lock-step progress, ensures we don't have to track free descriptors.
+  // Every request slot owns VBLK_DESC_PER_REQ consecutive descriptors, which
+  // spares us from tracking free descriptors while several requests are in
+  // flight.
   //
-  ASSERT (Dev->Ring.QueueSize >= 3);
+  Indices.HeadDescIdx = (UINT16) (*ReqIdx * VBLK_DESC_PER_REQ);
+  Indices.NextDescIdx = Indices.HeadDescIdx;
 
   //
   // virtio-blk header in first desc
   //
-  VirtioAppendDesc (&Dev->Ring, (UINTN) &Request, sizeof Request,
+  VirtioAppendDesc (&Dev->Ring, (UINTN) &Req->Header, sizeof Req->Header,
     VRING_DESC_F_NEXT, &Indices);
 
   //
@@ -318,18 +479,243 @@ SynchronousRequest (
   //
   // host status in last (second or third) desc
   //
-  VirtioAppendDesc (&Dev->Ring, (UINTN) &HostStatus, sizeof HostStatus,
-    VRING_DESC_F_WRITE, &Indices);
+  VirtioAppendDesc (&Dev->Ring, (UINTN) &Req->HostStatus,
+    sizeof Req->HostStatus, VRING_DESC_F_WRITE, &Indices);
+
+  if (Token != NULL) {
+    if (Dev->AsyncPending++ == 0) {
+      gBS->SetTimer (Dev->PollTimer, TimerPeriodic, VBLK_POLL_INTERVAL);
+    }
+  }
+
+  //
+  // virtio-0.9.5, 2.4.1.2 Updating the Available Ring. The available index
+  // is never written by the host, we can read it back without a barrier.
+  //
+  AvailIdx = *Dev->Ring.Avail.Idx;
+  Dev->Ring.Avail.Ring[AvailIdx++ % Dev->Ring.QueueSize] =
+    Indices.HeadDescIdx;
+
+  MemoryFence ();
+  *Dev->Ring.Avail.Idx = AvailIdx;
 
   //
   // virtio-blk's only virtqueue is #0, called "requestq" (see Appendix D).
   //
-  if (VirtioFlush (Dev->VirtIo, 0, &Dev->Ring, &Indices) == EFI_SUCCESS &&
-      HostStatus == VIRTIO_BLK_S_OK) {
+  MemoryFence ();
+  Status = Dev->VirtIo->SetQueueNotify (Dev->VirtIo, 0);
+  if (EFI_ERROR (Status)) {
+    //
+    // The chain is on the available ring already and the host may still
+    // process it, so the slot can't be reused until the host returns it.
+    //
+    Req->Orphaned = TRUE;
+    if (Token != NULL) {
+      Req->Token = NULL;
+      if (--Dev->AsyncPending == 0) {
+        gBS->SetTimer (Dev->PollTimer, TimerCancel, 0);
+      }
+    }
+  }
+  return Status;
+}
+
+
+/**
+
+  Push a read / write / flush request to the host, and poll for the response.
+
+  This is the main workhorse function. Two use cases are supported, read/write
+  and flush. The function may only be called after the request parameters have
+  been verified by
+  - specific checks in ReadBlocks() / WriteBlocks() / FlushBlocks(), and
+  - VerifyReadWriteRequest() (for read/write only).
+
+  Non-blocking requests submitted earlier through EFI_BLOCK_IO2_PROTOCOL may
+  still be in flight while this function waits; they are completed on the way.
+
+  Parameters handled commonly:
+
+    @param[in] Dev             The virtio-blk device the request is targeted
+                               at.
+
+  Flush request:
+
+    @param[in] Lba             Must be zero.
+
+    @param[in] BufferSize      Must be zero.
+
+    @param[in out] Buffer      Ignored by the function.
+
+    @param[in] RequestIsWrite  Must be TRUE.
+
+  Read/Write request:
+
+    @param[in] Lba             Logical Block Address: number of logical blocks
+                               to skip from the beginning of the device.
+
+    @param[in] BufferSize      Size of buffer to transfer, in bytes. The caller
+                               is responsible to ensure this parameter is
+                               positive.
+
+    @param[in out] Buffer      The guest side area to read data from the device
+                               into, or write data to the device from.
+
+    @param[in] RequestIsWrite  TRUE iff data transfer goes from guest to
+                               device.
+
+  Return values are common to both use cases, and are appropriate to be
+  forwarded by the EFI_BLOCK_IO_PROTOCOL functions (ReadBlocks(),
+  WriteBlocks(), FlushBlocks()).
+
+
+  @retval EFI_SUCCESS          Transfer complete.
+
+  @retval EFI_DEVICE_ERROR     Failed to notify host side via VirtIo write, or
+                               unable to parse host response, or host response
+                               is not VIRTIO_BLK_S_OK.
+
+**/
+
+STATIC
+EFI_STATUS
+EFIAPI
+SynchronousRequest (
+  IN              VBLK_DEV *Dev,
+  IN              EFI_LBA  Lba,
+  IN              UINTN    BufferSize,
+  IN OUT volatile VOID     *Buffer,
+  IN              BOOLEAN  RequestIsWrite
+  )
+{
+  EFI_TPL    OldTpl;
+  EFI_STATUS Status;
+  UINT16     ReqIdx;
+  VBLK_REQ   *Req;
+  UINTN      PollPeriodUsecs;
+
+  OldTpl = gBS->RaiseTPL (TPL_CALLBACK);
+
+  Status = VirtioBlkSubmitRequest (Dev, Lba, BufferSize, Buffer,
+             RequestIsWrite, NULL, &ReqIdx);
+  if (EFI_ERROR (Status)) {
+    //
+    // Either nothing was submitted, or the request slot is orphaned and
+    // VirtioBlkReapRequests() releases it.
+    //
+    gBS->RestoreTPL (OldTpl);
+    return EFI_DEVICE_ERROR;
+  }
+  Req = &Dev->Requests[ReqIdx];
+
+  //
+  // Wait until the host processes and acknowledges our descriptor chain.
+  // Keep slowing down until we reach a poll period of slightly above 1 ms.
+  //
+  PollPeriodUsecs = 1;
+  for (;;) {
+    VirtioBlkReapRequests (Dev);
+    if (Req->Done) {
+      break;
+    }
+    gBS->Stall (PollPeriodUsecs); // calls AcpiTimerLib::MicroSecondDelay
+
+    if (PollPeriodUsecs < 1024) {
+      PollPeriodUsecs *= 2;
+    }
+  }
+
+  Dev->FreeStack[--Dev->CurPending] = ReqIdx;
+  if (Req->HostStatus != VIRTIO_BLK_S_OK) {
+    Status = EFI_DEVICE_ERROR;
+  }
+
+  gBS->RestoreTPL (OldTpl);
+  return Status;
+}
+
+
+/**
+
+  Push a read / write / flush request to the host for EFI_BLOCK_IO2_PROTOCOL.
+
+  Parameters are identical to SynchronousRequest(), plus the Token of the
+  EFI_BLOCK_IO2_PROTOCOL call. If Token or Token->Event is NULL, the request
+  is blocking. Otherwise the function returns as soon as the request is on the
+  ring, and VirtioBlkReapRequests() completes Token later.
+
+  A zero BufferSize on a read/write request (ie. a request not reaching this
+  function) must be completed by the caller.
+
+**/
+
+STATIC
+EFI_STATUS
+AsynchronousRequest (
+  IN              VBLK_DEV            *Dev,
+  IN              EFI_LBA             Lba,
+  IN              UINTN               BufferSize,
+  IN OUT volatile VOID                *Buffer,
+  IN              BOOLEAN             RequestIsWrite,
+  IN OUT          EFI_BLOCK_IO2_TOKEN *Token
+  )
+{
+  EFI_TPL    OldTpl;
+  EFI_STATUS Status;
+  UINT16     ReqIdx;
+
+  if (Token == NULL || Token->Event == NULL) {
+    return SynchronousRequest (Dev, Lba, BufferSize, Buffer, RequestIsWrite);
+  }
+
+  OldTpl = gBS->RaiseTPL (TPL_CALLBACK);
+  Token->TransactionStatus = EFI_NOT_READY;
+  Status = VirtioBlkSubmitRequest (Dev, Lba, BufferSize, Buffer,
+             RequestIsWrite, Token, &ReqIdx);
+  gBS->RestoreTPL (OldTpl);
+
+  return EFI_ERROR (Status) ? EFI_DEVICE_ERROR : EFI_SUCCESS;
+}
+
+
+/**
+
+  Start the non-blocking flush deferred in Dev->FlushToken, whose writes have
+  all been returned by the host. Without write caching, the writes are on the
+  medium already and the token is completed at once.
+
+  The caller is responsible for running at TPL_CALLBACK.
+
+  @param[in,out] Dev  The virtio-blk device to flush.
+
+  @retval EFI_SUCCESS       The flush has been submitted, or completed.
+
+  @retval EFI_DEVICE_ERROR  The flush couldn't be submitted. The token is not
+                            completed.
+
+**/
+
+STATIC
+EFI_STATUS
+VirtioBlkStartFlush (
+  IN OUT VBLK_DEV *Dev
+  )
+{
+  EFI_BLOCK_IO2_TOKEN *Token;
+  EFI_STATUS          Status;
+  UINT16              ReqIdx;
+
+  Token           = Dev->FlushToken;
+  Dev->FlushToken = NULL;
+
+  if (!Dev->BlockIoMedia.WriteCaching) {
+    Token->TransactionStatus = EFI_SUCCESS;
+    gBS->SignalEvent (Token->Event);
     return EFI_SUCCESS;
   }
 
-  return EFI_DEVICE_ERROR;
+  Status = VirtioBlkSubmitRequest (Dev, 0, 0, NULL, TRUE, Token, &ReqIdx);
+  return EFI_ERROR (Status) ? EFI_DEVICE_ERROR : EFI_SUCCESS;
 }
 
 
@@ -459,6 +845,9 @@ VirtioBlkWriteBlocks (
   according to EFI_BLOCK_IO_MEDIA characteristics set in VirtioBlkInit().
   Should they do nonetheless, we do nothing, successfully.
 
+  A virtio-blk flush only covers the writes the host has completed, so the
+  non-blocking requests in flight are waited for first.
+
 **/
 
 EFI_STATUS
@@ -467,18 +856,226 @@ VirtioBlkFlushBlocks (
   IN EFI_BLOCK_IO_PROTOCOL *This
   )
 {
-  VBLK_DEV *Dev;
+  VBLK_DEV   *Dev;
+  EFI_TPL    OldTpl;
+  EFI_STATUS Status;
 
   Dev = VIRTIO_BLK_FROM_BLOCK_IO (This);
-  return Dev->BlockIoMedia.WriteCaching ?
-           SynchronousRequest (
-             Dev,
-             0,    // Lba
-             0,    // BufferSize
-             NULL, // Buffer
-             TRUE  // RequestIsWrite
-             ) :
-           EFI_SUCCESS;
+  OldTpl = gBS->RaiseTPL (TPL_CALLBACK);
+  VirtioBlkDrainRequests (Dev);
+  Status = Dev->BlockIoMedia.WriteCaching ?
+             SynchronousRequest (
+               Dev,
+               0,    // Lba
+               0,    // BufferSize
+               NULL, // Buffer
+               TRUE  // RequestIsWrite
+               ) :
+             EFI_SUCCESS;
+  gBS->RestoreTPL (OldTpl);
+  return Status;
+}
+
+
+/**
+
+  Validate the MediaId and request parameters of ReadBlocksEx() and
+  WriteBlocksEx(), and submit the request.
+
+**/
+
+STATIC
+EFI_STATUS
+ReadWriteBlocksEx (
+  IN     EFI_BLOCK_IO2_PROTOCOL *This,
+  IN     UINT32                 MediaId,
+  IN     EFI_LBA                Lba,
+  IN OUT EFI_BLOCK_IO2_TOKEN    *Token,
+  IN     UINTN                  BufferSize,
+  IN OUT VOID                   *Buffer,
+  IN     BOOLEAN                RequestIsWrite
+  )
+{
+  VBLK_DEV   *Dev;
+  EFI_STATUS Status;
+
+  Dev = VIRTIO_BLK_FROM_BLOCK_IO2 (This);
+  if (MediaId != Dev->BlockIoMedia.MediaId) {
+    return EFI_MEDIA_CHANGED;
+  }
+  if (Buffer == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (BufferSize == 0) {
+    if (Token != NULL && Token->Event != NULL) {
+      Token->TransactionStatus = EFI_SUCCESS;
+      gBS->SignalEvent (Token->Event);
+    }
+    return EFI_SUCCESS;
+  }
+
+  Status = VerifyReadWriteRequest (
+             &Dev->BlockIoMedia,
+             Lba,
+             BufferSize,
+             RequestIsWrite
+             );
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  return AsynchronousRequest (
+           Dev,
+           Lba,
+           BufferSize,
+           Buffer,
+           RequestIsWrite,
+           Token
+           );
+}
+
+
+//
+// UEFI Spec 2.4, 12.9 EFI Block I/O 2 Protocol
+//
+EFI_STATUS
+EFIAPI
+VirtioBlkResetEx (
+  IN EFI_BLOCK_IO2_PROTOCOL *This,
+  IN BOOLEAN                ExtendedVerification
+  )
+{
+  VBLK_DEV *Dev;
+  EFI_TPL  OldTpl;
+
+  //
+  // Requests in flight cannot be aborted without resetting the virtio device,
+  // so let them complete.
+  //
+  Dev = VIRTIO_BLK_FROM_BLOCK_IO2 (This);
+  OldTpl = gBS->RaiseTPL (TPL_CALLBACK);
+  VirtioBlkDrainRequests (Dev);
+  gBS->RestoreTPL (OldTpl);
+  return EFI_SUCCESS;
+}
+
+
+/**
+
+  ReadBlocksEx() operation for virtio-blk.
+
+  See
+  - UEFI Spec 2.4, 12.9 EFI Block I/O 2 Protocol,
+    EFI_BLOCK_IO2_PROTOCOL.ReadBlocksEx().
+  - Driver Writer's Guide for UEFI 2.3.1 v1.01, 24.2.2. ReadBlocks() and
+    ReadBlocksEx() Implementation.
+
+**/
+
+EFI_STATUS
+EFIAPI
+VirtioBlkReadBlocksEx (
+  IN     EFI_BLOCK_IO2_PROTOCOL *This,
+  IN     UINT32                 MediaId,
+  IN     EFI_LBA                Lba,
+  IN OUT EFI_BLOCK_IO2_TOKEN    *Token,
+  IN     UINTN                  BufferSize,
+  OUT    VOID                   *Buffer
+  )
+{
+  return ReadWriteBlocksEx (This, MediaId, Lba, Token, BufferSize, Buffer,
+           FALSE);
+}
+
+
+/**
+
+  WriteBlocksEx() operation for virtio-blk.
+
+  See
+  - UEFI Spec 2.4, 12.9 EFI Block I/O 2 Protocol,
+    EFI_BLOCK_IO2_PROTOCOL.WriteBlocksEx().
+  - Driver Writer's Guide for UEFI 2.3.1 v1.01, 24.2.3 WriteBlocks() and
+    WriteBlockEx() Implementation.
+
+**/
+
+EFI_STATUS
+EFIAPI
+VirtioBlkWriteBlocksEx (
+  IN     EFI_BLOCK_IO2_PROTOCOL *This,
+  IN     UINT32                 MediaId,
+  IN     EFI_LBA                Lba,
+  IN OUT EFI_BLOCK_IO2_TOKEN    *Token,
+  IN     UINTN                  BufferSize,
+  IN     VOID                   *Buffer
+  )
+{
+  return ReadWriteBlocksEx (This, MediaId, Lba, Token, BufferSize, Buffer,
+           TRUE);
+}
+
+
+/**
+
+  FlushBlocksEx() operation for virtio-blk.
+
+  See
+  - UEFI Spec 2.4, 12.9 EFI Block I/O 2 Protocol,
+    EFI_BLOCK_IO2_PROTOCOL.FlushBlocksEx().
+  - Driver Writer's Guide for UEFI 2.3.1 v1.01, 24.2.4 FlushBlocks() and
+    FlushBlocksEx() Implementation.
+
+  A virtio-blk flush only covers the writes the host has completed. A
+  non-blocking flush is therefore deferred until the non-blocking writes in
+  flight have been returned by the host; VirtioBlkReapRequests() starts it
+  then. Only one flush is deferred at a time, a second one waits for the
+  first to complete.
+
+**/
+
+EFI_STATUS
+EFIAPI
+VirtioBlkFlushBlocksEx (
+  IN     EFI_BLOCK_IO2_PROTOCOL *This,
+  IN OUT EFI_BLOCK_IO2_TOKEN    *Token
+  )
+{
+  VBLK_DEV   *Dev;
+  EFI_TPL    OldTpl;
+  EFI_STATUS Status;
+  UINT16     ReqIdx;
+  VBLK_REQ   *Req;
+
+  Dev = VIRTIO_BLK_FROM_BLOCK_IO2 (This);
+  if (Token == NULL || Token->Event == NULL) {
+    return VirtioBlkFlushBlocks (&Dev->BlockIo);
+  }
+
+  OldTpl = gBS->RaiseTPL (TPL_CALLBACK);
+  if (Dev->FlushToken != NULL) {
+    VirtioBlkDrainRequests (Dev);
+  }
+  ASSERT (Dev->FlushToken == NULL);
+
+  Token->TransactionStatus = EFI_NOT_READY;
+  Dev->FlushWaitCount = 0;
+  for (ReqIdx = 0; ReqIdx < Dev->MaxPending; ++ReqIdx) {
+    Req = &Dev->Requests[ReqIdx];
+    if (Req->Token != NULL && Req->Header.Type == VIRTIO_BLK_T_OUT) {
+      Req->FlushWait = TRUE;
+      ++Dev->FlushWaitCount;
+    }
+  }
+  Dev->FlushToken = Token;
+
+  Status = EFI_SUCCESS;
+  if (Dev->FlushWaitCount == 0) {
+    Status = VirtioBlkStartFlush (Dev);
+  }
+  gBS->RestoreTPL (OldTpl);
+  return Status;
 }
 
 
@@ -563,6 +1160,40 @@ VirtioBlkDriverBindingSupported (
 }
 
 
+/**
+
+  Exit Boot Services notification function for a virtio-blk device.
+
+  The requests in flight are completed, so that their tokens are signaled and
+  the host is done with the buffers, and then the device is reset; see
+  DWG-2.3.1, "25.5.1 Exit Boot Services Event".
+
+  @param[in] Event    The Exit Boot Services event.
+
+  @param[in] Context  Pointer to the VBLK_DEV structure.
+
+**/
+
+STATIC
+VOID
+EFIAPI
+VirtioBlkExitBoot (
+  IN EFI_EVENT Event,
+  IN VOID      *Context
+  )
+{
+  VBLK_DEV *Dev;
+
+  //
+  // This callback has been enqueued by ExitBootServices() and is running at
+  // TPL_CALLBACK already.
+  //
+  Dev = Context;
+  VirtioBlkDrainRequests (Dev);
+  Dev->VirtIo->SetDeviceStatus (Dev->VirtIo, 0);
+}
+
+
 /**
 
   Set up all BlockIo and virtio-blk aspects of this driver for the specified
@@ -599,6 +1230,7 @@ VirtioBlkInit (
   UINT8      AlignmentOffset;
   UINT32     OptIoSize;
   UINT16     QueueSize;
+  UINT16     ReqIdx;
 
   PhysicalBlockExp = 0;
   AlignmentOffset = 0;
@@ -702,7 +1334,7 @@ VirtioBlkInit (
   if (EFI_ERROR (Status)) {
     goto Failed;
   }
-  if (QueueSize < 3) { // SynchronousRequest() uses at most three descriptors
+  if (QueueSize < VBLK_DESC_PER_REQ) { // one request uses up to three descs
     Status = EFI_UNSUPPORTED;
     goto Failed;
   }
@@ -747,13 +1379,50 @@ VirtioBlkInit (
     goto ReleaseQueue;
   }
 
+  //
+  // Carve the request slots out of the descriptor table, and create the timer
+  // that completes non-blocking requests.
+  //
+  Dev->MaxPending = MIN (QueueSize / VBLK_DESC_PER_REQ, VBLK_MAX_PENDING);
+  Dev->CurPending = 0;
+  Dev->AsyncPending = 0;
+  Dev->FlushWaitCount = 0;
+  Dev->FlushToken = NULL;
+  for (ReqIdx = 0; ReqIdx < Dev->MaxPending; ++ReqIdx) {
+    Dev->FreeStack[ReqIdx] = ReqIdx;
+  }
+  Dev->LastUsed = *Dev->Ring.Used.Idx;
+  ASSERT (Dev->LastUsed == 0);
+
+  //
+  // We're going to poll the answers, the host should not send interrupts.
+  //
+  *Dev->Ring.Avail.Flags = (UINT16) VRING_AVAIL_F_NO_INTERRUPT;
+
+  Status = gBS->CreateEvent (EVT_TIMER | EVT_NOTIFY_SIGNAL, TPL_CALLBACK,
+                  &VirtioBlkPoll, Dev, &Dev->PollTimer);
+  if (EFI_ERROR (Status)) {
+    goto ReleaseQueue;
+  }
+
   //
   // step 6 -- initialization complete
   //
   NextDevStat |= VSTAT_DRIVER_OK;
   Status = Dev->VirtIo->SetDeviceStatus (Dev->VirtIo, NextDevStat);
   if (EFI_ERROR (Status)) {
-    goto ReleaseQueue;
+    goto CloseTimer;
+  }
+
+  //
+  // VirtioBlkExitBoot() completes the requests in flight and resets the
+  // device when ExitBootServices() is called. The device is working at this
+  // point, so the event may be signaled as soon as it exists.
+  //
+  Status = gBS->CreateEvent (EVT_SIGNAL_EXIT_BOOT_SERVICES, TPL_CALLBACK,
+                  &VirtioBlkExitBoot, Dev, &Dev->ExitBoot);
+  if (EFI_ERROR (Status)) {
+    goto CloseTimer;
   }
 
   //
@@ -777,6 +1446,12 @@ VirtioBlkInit (
   Dev->BlockIoMedia.LastBlock        = DivU64x32 (NumSectors,
                                          BlockSize / 512) - 1;
 
+  Dev->BlockIo2.Media                = &Dev->BlockIoMedia;
+  Dev->BlockIo2.Reset                = &VirtioBlkResetEx;
+  Dev->BlockIo2.ReadBlocksEx         = &VirtioBlkReadBlocksEx;
+  Dev->BlockIo2.WriteBlocksEx        = &VirtioBlkWriteBlocksEx;
+  Dev->BlockIo2.FlushBlocksEx        = &VirtioBlkFlushBlocksEx;
+
   DEBUG ((DEBUG_INFO, "%a: LbaSize=0x%x[B] NumBlocks=0x%Lx[Lba]\n",
     __FUNCTION__, Dev->BlockIoMedia.BlockSize,
     Dev->BlockIoMedia.LastBlock + 1));
@@ -796,6 +1471,9 @@ VirtioBlkInit (
   }
   return EFI_SUCCESS;
 
+CloseTimer:
+  gBS->CloseEvent (Dev->PollTimer);
+
 ReleaseQueue:
   VirtioRingUninit (&Dev->Ring);
 
@@ -827,6 +1505,19 @@ VirtioBlkUninit (
   IN OUT VBLK_DEV *Dev
   )
 {
+  EFI_TPL OldTpl;
+
+  gBS->CloseEvent (Dev->ExitBoot);
+
+  //
+  // Let the non-blocking requests in flight complete, so that their tokens
+  // are signaled and the host is done with the caller's buffers.
+  //
+  OldTpl = gBS->RaiseTPL (TPL_CALLBACK);
+  VirtioBlkDrainRequests (Dev);
+  gBS->RestoreTPL (OldTpl);
+  gBS->CloseEvent (Dev->PollTimer);
+
   //
   // Reset the virtual device -- see virtio-0.9.5, 2.2.2.1 Device Status. When
   // VIRTIO_CFG_WRITE() returns, the host will have learned to stay away from
@@ -838,6 +1529,7 @@ VirtioBlkUninit (
 
   SetMem (&Dev->BlockIo,      sizeof Dev->BlockIo,      0x00);
   SetMem (&Dev->BlockIoMedia, sizeof Dev->BlockIoMedia, 0x00);
+  SetMem (&Dev->BlockIo2,     sizeof Dev->BlockIo2,     0x00);
 }
 
 
@@ -902,12 +1594,14 @@ VirtioBlkDriverBindingStart (
   }
 
   //
-  // Setup complete, attempt to export the driver instance's BlockIo interface.
+  // Setup complete, attempt to export the driver instance's BlockIo and
+  // BlockIo2 interfaces.
   //
   Dev->Signature = VBLK_SIG;
-  Status = gBS->InstallProtocolInterface (&DeviceHandle,
-                  &gEfiBlockIoProtocolGuid, EFI_NATIVE_INTERFACE,
-                  &Dev->BlockIo);
+  Status = gBS->InstallMultipleProtocolInterfaces (&DeviceHandle,
+                  &gEfiBlockIoProtocolGuid, &Dev->BlockIo,
+                  &gEfiBlockIo2ProtocolGuid, &Dev->BlockIo2,
+                  NULL);
   if (EFI_ERROR (Status)) {
     goto UninitDev;
   }
@@ -930,7 +1624,8 @@ FreeVirtioBlk:
 
 /**
 
-  Stop driving a virtio-blk device and remove its BlockIo interface.
+  Stop driving a virtio-blk device and remove its BlockIo and BlockIo2
+  interfaces.
 
   This function replays the success path of DriverBindingStart() in reverse.
   The host side virtio-blk device is reset, so that the OS boot loader or the
@@ -981,8 +1676,10 @@ VirtioBlkDriverBindingStop (
   //
   // Handle Stop() requests for in-use driver instances gracefully.
   //
-  Status = gBS->UninstallProtocolInterface (DeviceHandle,
-                  &gEfiBlockIoProtocolGuid, &Dev->BlockIo);
+  Status = gBS->UninstallMultipleProtocolInterfaces (DeviceHandle,
+                  &gEfiBlockIoProtocolGuid, &Dev->BlockIo,
+                  &gEfiBlockIo2ProtocolGuid, &Dev->BlockIo2,
+                  NULL);
   if (EFI_ERROR (Status)) {
     return Status;
   }
@@ -19,14 +19,47 @@
 #define _VIRTIO_BLK_DXE_H_
 
 #include <Protocol/BlockIo.h>
+#include <Protocol/BlockIo2.h>
 #include <Protocol/ComponentName.h>
 #include <Protocol/DriverBinding.h>
 
-#include <IndustryStandard/Virtio.h>
+#include <IndustryStandard/VirtioBlk.h>
 
 
 #define VBLK_SIG SIGNATURE_32 ('V', 'B', 'L', 'K')
 
+//
+// Upper limit on the number of requests in flight on the virtio ring. Every
+// request occupies VBLK_DESC_PER_REQ descriptors at a fixed position of the
+// descriptor table, so the actual limit also depends on the queue size.
+//
+#define VBLK_MAX_PENDING  32
+#define VBLK_DESC_PER_REQ 3
+
+//
+// Period of the timer that completes EFI_BLOCK_IO2_PROTOCOL requests.
+//
+#define VBLK_POLL_INTERVAL EFI_TIMER_PERIOD_MILLISECONDS (1)
+
+//
+// How long a new request waits for a request slot before failing, in
+// microseconds.
+//
+#define VBLK_SLOT_TIMEOUT (30 * 1000 * 1000)
+
+//
+// A request slot. The header and the status byte are shared with the host,
+// the rest is private to the driver.
+//
+typedef struct {
+  volatile VIRTIO_BLK_REQ Header;     // read by the host
+  volatile UINT8          HostStatus; // written by the host
+  BOOLEAN                 Done;       // host returned the descriptor chain
+  BOOLEAN                 Orphaned;   // released when the host returns it
+  BOOLEAN                 FlushWait;  // the deferred flush waits for it
+  EFI_BLOCK_IO2_TOKEN     *Token;     // NULL for blocking requests
+} VBLK_REQ;
+
 typedef struct {
   //
   // Parts of this structure are initialized / torn down in various functions
@@ -40,11 +73,25 @@ typedef struct {
   VRING                  Ring;                 // VirtioRingInit      2
   EFI_BLOCK_IO_PROTOCOL  BlockIo;              // VirtioBlkInit       1
   EFI_BLOCK_IO_MEDIA     BlockIoMedia;         // VirtioBlkInit       1
+  EFI_BLOCK_IO2_PROTOCOL BlockIo2;             // VirtioBlkInit       1
+  EFI_EVENT              PollTimer;            // VirtioBlkInit       1
+  EFI_EVENT              ExitBoot;             // VirtioBlkInit       1
+  UINT16                 MaxPending;           // VirtioBlkInit       1
+  UINT16                 CurPending;           // VirtioBlkInit       1
+  UINT16                 AsyncPending;         // VirtioBlkInit       1
+  UINT16                 LastUsed;             // VirtioBlkInit       1
+  UINT16                 FlushWaitCount;       // VirtioBlkInit       1
+  EFI_BLOCK_IO2_TOKEN    *FlushToken;          // VirtioBlkInit       1
+  UINT16                 FreeStack[VBLK_MAX_PENDING]; // VirtioBlkInit 1
+  VBLK_REQ               Requests[VBLK_MAX_PENDING];  // VirtioBlkInit 1
 } VBLK_DEV;
 
 #define VIRTIO_BLK_FROM_BLOCK_IO(BlockIoPointer) \
         CR (BlockIoPointer, VBLK_DEV, BlockIo, VBLK_SIG)
 
+#define VIRTIO_BLK_FROM_BLOCK_IO2(BlockIo2Pointer) \
+        CR (BlockIo2Pointer, VBLK_DEV, BlockIo2, VBLK_SIG)
+
 
 /**
 
@@ -257,6 +304,76 @@ VirtioBlkFlushBlocks (
   );
 
 
+//
+// UEFI Spec 2.4, 12.9 EFI Block I/O 2 Protocol
+// Driver Writer's Guide for UEFI 2.3.1 v1.01,
+//   24.2 Block I/O Protocol Implementations
+//
+EFI_STATUS
+EFIAPI
+VirtioBlkResetEx (
+  IN EFI_BLOCK_IO2_PROTOCOL *This,
+  IN BOOLEAN                ExtendedVerification
+  );
+
+
+/**
+
+  ReadBlocksEx() operation for virtio-blk.
+
+  If Token is NULL or Token->Event is NULL, the request is blocking, and
+  behaves like ReadBlocks(). Otherwise the request is put on the virtio ring
+  and the function returns immediately; Token->Event is signaled when the host
+  completes the request. Several such requests may be in flight at a time.
+
+**/
+
+EFI_STATUS
+EFIAPI
+VirtioBlkReadBlocksEx (
+  IN     EFI_BLOCK_IO2_PROTOCOL *This,
+  IN     UINT32                 MediaId,
+  IN     EFI_LBA                Lba,
+  IN OUT EFI_BLOCK_IO2_TOKEN    *Token,
+  IN     UINTN                  BufferSize,
+  OUT    VOID                   *Buffer
+  );
+
+
+/**
+
+  WriteBlocksEx() operation for virtio-blk. See ReadBlocksEx() for the
+  handling of Token.
+
+**/
+
+EFI_STATUS
+EFIAPI
+VirtioBlkWriteBlocksEx (
+  IN     EFI_BLOCK_IO2_PROTOCOL *This,
+  IN     UINT32                 MediaId,
+  IN     EFI_LBA                Lba,
+  IN OUT EFI_BLOCK_IO2_TOKEN    *Token,
+  IN     UINTN                  BufferSize,
+  IN     VOID                   *Buffer
+  );
+
+
+/**
+
+  FlushBlocksEx() operation for virtio-blk. See ReadBlocksEx() for the
+  handling of Token.
+
+**/
+
+EFI_STATUS
+EFIAPI
+VirtioBlkFlushBlocksEx (
+  IN     EFI_BLOCK_IO2_PROTOCOL *This,
+  IN OUT EFI_BLOCK_IO2_TOKEN    *Token
+  );
+
+
 //
 // The purpose of the following scaffolding (EFI_COMPONENT_NAME_PROTOCOL and
 // EFI_COMPONENT_NAME2_PROTOCOL implementation) is to format the driver's name
@@ -17,6 +17,7 @@
 **/
 
 #include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
 #include <Library/MemoryAllocationLib.h>
 #include <Library/UefiBootServicesTableLib.h>
 
@@ -121,7 +122,7 @@ ReleaseQueue:
     chains,
   - tracking of heads of free descriptor chains from the above,
   - one common virtio-net request header (never modified by the host) for all
-    pending TX packets,
+    pending TX packets, sized according to the negotiated features,
   - select polling over TX interrupt.
 
   @param[in,out] Dev       The VNET_DEV driver instance about to enter the
@@ -161,7 +162,7 @@ VirtioNetInitTx (
     // (unmodified by the host) virtio-net request header.
     //
     Dev->TxRing.Desc[DescIdx].Addr  = (UINTN) &Dev->TxSharedReq;
-    Dev->TxRing.Desc[DescIdx].Len   = sizeof Dev->TxSharedReq;
+    Dev->TxRing.Desc[DescIdx].Len   = Dev->HdrSize;
     Dev->TxRing.Desc[DescIdx].Flags = VRING_DESC_F_NEXT;
     Dev->TxRing.Desc[DescIdx].Next  = (UINT16) (DescIdx + 1);
 
@@ -175,8 +176,9 @@ VirtioNetInitTx (
   //
   // virtio-0.9.5, Appendix C, Packet Transmission
   //
-  Dev->TxSharedReq.Flags   = 0;
-  Dev->TxSharedReq.GsoType = VIRTIO_NET_HDR_GSO_NONE;
+  ZeroMem (&Dev->TxSharedReq, sizeof Dev->TxSharedReq);
+  Dev->TxSharedReq.V0_9_5.GsoType = VIRTIO_NET_HDR_GSO_NONE;
+  ZeroMem (&Dev->TxStats, sizeof Dev->TxStats);
 
   //
   // virtio-0.9.5, 2.4.2 Receiving Used Buffers From the Device
@@ -204,8 +206,10 @@ VirtioNetInitTx (
   - destination area for the host to write virtio-net request headers and
     packet data into,
   - select polling over RX interrupt,
-  - fully populate the RX queue with a static pattern of virtio descriptor
-    chains.
+  - fully populate the RX queue (up to VNET_MAX_RX_PENDING packets) with a
+    static pattern of virtio descriptor chains; with VIRTIO_NET_F_MRG_RXBUF, a
+    single descriptor per packet covers both the request header and the packet
+    data, so twice as many packets fit in the queue.
 
   @param[in,out] Dev       The VNET_DEV driver instance about to enter the
                            EfiSimpleNetworkInitialized state.
@@ -225,25 +229,32 @@ VirtioNetInitRx (
 {
   EFI_STATUS Status;
   UINTN      RxBufSize;
+  UINT16     RxDescPerPkt;
   UINT16     RxAlwaysPending;
   UINTN      PktIdx;
   UINT16     DescIdx;
   UINT8      *RxPtr;
 
   //
-  // For each incoming packet we must supply two descriptors:
-  // - the recipient for the virtio-net request header, plus
-  // - the recipient for the network data (which consists of Ethernet header
-  //   and Ethernet payload).
+  // For each incoming packet we must supply room for:
+  // - the virtio-net request header, plus
+  // - the network data (which consists of Ethernet header and Ethernet
+  //   payload).
   //
-  RxBufSize = sizeof (VIRTIO_NET_REQ) +
+  // The header and the data are laid out contiguously in both cases. Without
+  // VIRTIO_NET_F_MRG_RXBUF the host expects the header in a separate
+  // descriptor.
+  //
+  RxBufSize = Dev->HdrSize +
               (Dev->Snm.MediaHeaderSize + Dev->Snm.MaxPacketSize);
+  RxDescPerPkt = (UINT16) (
+                   ((Dev->Features & VIRTIO_NET_F_MRG_RXBUF) != 0) ? 1 : 2);
 
   //
-  // Limit the number of pending RX packets if the queue is big. The division
-  // by two is due to the above "two descriptors per packet" trait.
+  // Limit the number of pending RX packets if the queue is big.
   //
-  RxAlwaysPending = (UINT16) MIN (Dev->RxRing.QueueSize / 2, VNET_MAX_PENDING);
+  RxAlwaysPending = (UINT16) MIN (Dev->RxRing.QueueSize / RxDescPerPkt,
+                               VNET_MAX_RX_PENDING);
 
   Dev->RxBuf = AllocatePool (RxAlwaysPending * RxBufSize);
   if (Dev->RxBuf == NULL) {
@@ -256,6 +267,8 @@ VirtioNetInitRx (
   MemoryFence ();
   Dev->RxLastUsed = *Dev->RxRing.Used.Idx;
   ASSERT (Dev->RxLastUsed == 0);
+  Dev->RxUnkicked = 0;
+  ZeroMem (&Dev->RxStats, sizeof Dev->RxStats);
 
   //
   // virtio-0.9.5, 2.4.2 Receiving Used Buffers From the Device:
@@ -265,8 +278,8 @@ VirtioNetInitRx (
   *Dev->RxRing.Avail.Flags = (UINT16) VRING_AVAIL_F_NO_INTERRUPT;
 
   //
-  // now set up a separate, two-part descriptor chain for each RX packet, and
-  // link each chain into (from) the available ring as well
+  // now set up a separate descriptor chain for each RX packet, and link each
+  // chain into (from) the available ring as well
   //
   DescIdx = 0;
   RxPtr = Dev->RxBuf;
@@ -280,15 +293,22 @@ VirtioNetInitRx (
     //
     // virtio-0.9.5, 2.4.1.1 Placing Buffers into the Descriptor Table
     //
+    if (RxDescPerPkt == 1) {
+      Dev->RxRing.Desc[DescIdx].Addr  = (UINTN) RxPtr;
+      Dev->RxRing.Desc[DescIdx].Len   = (UINT32) RxBufSize;
+      Dev->RxRing.Desc[DescIdx].Flags = VRING_DESC_F_WRITE;
+      RxPtr += Dev->RxRing.Desc[DescIdx++].Len;
+      continue;
+    }
+
     Dev->RxRing.Desc[DescIdx].Addr  = (UINTN) RxPtr;
-    Dev->RxRing.Desc[DescIdx].Len   = sizeof (VIRTIO_NET_REQ);
+    Dev->RxRing.Desc[DescIdx].Len   = Dev->HdrSize;
     Dev->RxRing.Desc[DescIdx].Flags = VRING_DESC_F_WRITE | VRING_DESC_F_NEXT;
     Dev->RxRing.Desc[DescIdx].Next  = (UINT16) (DescIdx + 1);
     RxPtr += Dev->RxRing.Desc[DescIdx++].Len;
 
     Dev->RxRing.Desc[DescIdx].Addr  = (UINTN) RxPtr;
-    Dev->RxRing.Desc[DescIdx].Len   = (UINT32) (RxBufSize -
-                                                sizeof (VIRTIO_NET_REQ));
+    Dev->RxRing.Desc[DescIdx].Len   = (UINT32) (RxBufSize - Dev->HdrSize);
     Dev->RxRing.Desc[DescIdx].Flags = VRING_DESC_F_WRITE;
     RxPtr += Dev->RxRing.Desc[DescIdx++].Len;
   }
@@ -308,6 +328,7 @@ VirtioNetInitRx (
   // virtio-0.9.5, 2.4.1.4 Notifying the Device
   //
   MemoryFence ();
+  ++Dev->RxStats.Kicks;
   Status = Dev->VirtIo->SetQueueNotify (Dev->VirtIo, VIRTIO_NET_Q_RX);
   if (EFI_ERROR (Status)) {
     Dev->VirtIo->SetDeviceStatus (Dev->VirtIo, 0);
@@ -434,11 +455,23 @@ VirtioNetInitialize (
   //
   // step 5 -- keep only the features we want
   //
-  Features &= VIRTIO_NET_F_MAC | VIRTIO_NET_F_STATUS;
+  // VIRTIO_NET_F_MRG_RXBUF lets us post a single descriptor per RX packet.
+  // VIRTIO_NET_F_GUEST_CSUM lets the host skip checksumming packets it has
+  // originated itself; VirtioNetReceive() completes such checksums, because
+  // the SNP interface cannot pass "checksum pending" packets up to MNP.
+  // VIRTIO_NET_F_CSUM is not requested for the same reason: MNP always hands
+  // down fully checksummed frames.
+  //
+  Features &= VIRTIO_NET_F_MAC | VIRTIO_NET_F_STATUS |
+              VIRTIO_NET_F_MRG_RXBUF | VIRTIO_NET_F_GUEST_CSUM;
   Status = Dev->VirtIo->SetGuestFeatures (Dev->VirtIo, Features);
   if (EFI_ERROR (Status)) {
     goto ReleaseTxRing;
   }
+  Dev->Features = Features;
+  Dev->HdrSize  = (UINT16) (((Features & VIRTIO_NET_F_MRG_RXBUF) != 0) ?
+                            sizeof (VIRTIO_NET_MRG_REQ) :
+                            sizeof (VIRTIO_NET_REQ));
 
   //
   // step 6 -- virtio-net initialization complete
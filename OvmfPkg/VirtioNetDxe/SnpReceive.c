@@ -21,6 +21,64 @@
 
 #include "VirtioNet.h"
 
+/**
+  Complete the partial checksum of a packet that the host delivered with
+  VIRTIO_NET_HDR_F_NEEDS_CSUM set.
+
+  The host has stored the folded pseudo-header sum at CsumStart + CsumOffset;
+  the ones' complement sum from CsumStart to the end of the frame, inverted,
+  must replace it.
+
+  @param[in,out] Frame       The Ethernet frame, starting with the media
+                             header.
+  @param[in]     FrameLen    The number of bytes in Frame.
+  @param[in]     CsumStart   Offset in Frame where checksumming starts.
+  @param[in]     CsumOffset  Offset from CsumStart where the checksum is
+                             stored.
+
+  @retval TRUE   The checksum has been completed.
+  @retval FALSE  The offsets reported by the host are out of range.
+**/
+STATIC
+BOOLEAN
+VirtioNetCompleteChecksum (
+  IN OUT UINT8  *Frame,
+  IN     UINTN  FrameLen,
+  IN     UINT16 CsumStart,
+  IN     UINT16 CsumOffset
+  )
+{
+  UINT32 Sum;
+  UINTN  Idx;
+  UINT16 Csum;
+
+  if ((UINTN) CsumStart + CsumOffset + sizeof (UINT16) > FrameLen) {
+    return FALSE;
+  }
+
+  Sum = 0;
+  for (Idx = CsumStart; Idx + 1 < FrameLen; Idx += 2) {
+    Sum += (UINT32) ((Frame[Idx] << 8) | Frame[Idx + 1]);
+  }
+  if (Idx < FrameLen) {
+    Sum += (UINT32) (Frame[Idx] << 8);
+  }
+  while ((Sum >> 16) != 0) {
+    Sum = (Sum & 0xFFFF) + (Sum >> 16);
+  }
+
+  //
+  // a zero UDP checksum means "no checksum"; 0xFFFF is equivalent otherwise
+  //
+  Csum = (UINT16) ~Sum;
+  if (Csum == 0) {
+    Csum = 0xFFFF;
+  }
+  Frame[CsumStart + CsumOffset]     = (UINT8) (Csum >> 8);
+  Frame[CsumStart + CsumOffset + 1] = (UINT8) Csum;
+  return TRUE;
+}
+
 /**
   Receives a packet from a network interface.
 
@@ -71,17 +129,20 @@ VirtioNetReceive (
   OUT UINT16                     *Protocol   OPTIONAL
   )
 {
-  VNET_DEV   *Dev;
-  EFI_TPL    OldTpl;
-  EFI_STATUS Status;
-  UINT16     RxCurUsed;
-  UINT16     UsedElemIdx;
-  UINT32     DescIdx;
-  UINT32     RxLen;
-  UINTN      OrigBufferSize;
-  UINT8      *RxPtr;
-  UINT16     AvailIdx;
-  EFI_STATUS NotifyStatus;
+  VNET_DEV       *Dev;
+  EFI_TPL        OldTpl;
+  EFI_STATUS     Status;
+  UINT16         RxCurUsed;
+  UINT16         UsedElemIdx;
+  UINT32         DescIdx;
+  UINT32         RxLen;
+  UINTN          OrigBufferSize;
+  UINT8          *RxPtr;
+  UINT16         AvailIdx;
+  UINT16         NumBuffers;
+  UINT16         Recycle;
+  EFI_STATUS     NotifyStatus;
+  VIRTIO_NET_REQ *RxHdr;
 
   if (This == NULL || BufferSize == NULL || Buffer == NULL) {
     return EFI_INVALID_PARAMETER;
@@ -108,23 +169,56 @@ VirtioNetReceive (
   MemoryFence ();
 
   if (Dev->RxLastUsed == RxCurUsed) {
+    //
+    // The caller has drained the queue. Make sure the host learns about any
+    // buffers we've returned since the last notification, in case it has run
+    // out of them.
+    //
     Status = EFI_NOT_READY;
+    if (Dev->RxUnkicked > 0) {
+      Dev->RxUnkicked = 0;
+      NotifyStatus = VirtioNetKick (Dev, &Dev->RxRing, VIRTIO_NET_Q_RX,
+                       &Dev->RxStats);
+      if (EFI_ERROR (NotifyStatus)) {
+        Status = NotifyStatus;
+      }
+    }
     goto Exit;
   }
 
   UsedElemIdx = Dev->RxLastUsed % Dev->RxRing.QueueSize;
   DescIdx = Dev->RxRing.Used.UsedElem[UsedElemIdx].Id;
   RxLen   = Dev->RxRing.Used.UsedElem[UsedElemIdx].Len;
+  Recycle = 1;
 
   //
-  // the virtio-net request header must be complete; we skip it
+  // The virtio-net request header must be complete; we skip it. The packet
+  // data follows the header contiguously, independently of how many
+  // descriptors VirtioNetInitRx() used per packet.
   //
-  ASSERT (RxLen >= Dev->RxRing.Desc[DescIdx].Len);
-  RxLen -= Dev->RxRing.Desc[DescIdx].Len;
+  RxHdr = (VIRTIO_NET_REQ *)(UINTN) Dev->RxRing.Desc[DescIdx].Addr;
+  ASSERT (RxLen >= Dev->HdrSize);
+  RxLen -= Dev->HdrSize;
   //
   // the host must not have filled in more data than requested
   //
-  ASSERT (RxLen <= Dev->RxRing.Desc[DescIdx + 1].Len);
+  ASSERT (RxLen <= (UINT32) (Dev->Snm.MediaHeaderSize +
+                             Dev->Snm.MaxPacketSize));
+
+  if ((Dev->Features & VIRTIO_NET_F_MRG_RXBUF) != 0) {
+    //
+    // Each of our buffers accommodates the largest frame, hence the host
+    // should never merge buffers. If it still does, drop the packet together
+    // with all of its buffers.
+    //
+    NumBuffers = ((VIRTIO_NET_MRG_REQ *) RxHdr)->NumBuffers;
+    if (NumBuffers != 1) {
+      Recycle = (UINT16) MIN (MAX (NumBuffers, 1),
+                           (UINT16) (RxCurUsed - Dev->RxLastUsed));
+      Status = EFI_DEVICE_ERROR;
+      goto RecycleDesc;
+    }
+  }
 
   OrigBufferSize = *BufferSize;
   *BufferSize = RxLen;
@@ -143,7 +237,13 @@ VirtioNetReceive (
     *HeaderSize = Dev->Snm.MediaHeaderSize;
   }
 
-  RxPtr = (UINT8 *)(UINTN) Dev->RxRing.Desc[DescIdx + 1].Addr;
+  RxPtr = (UINT8 *) RxHdr + Dev->HdrSize;
+  if ((RxHdr->Flags & VIRTIO_NET_HDR_F_NEEDS_CSUM) != 0 &&
+      !VirtioNetCompleteChecksum (RxPtr, RxLen, RxHdr->CsumStart,
+         RxHdr->CsumOffset)) {
+    Status = EFI_DEVICE_ERROR;
+    goto RecycleDesc; // drop packet with bogus checksum offsets
+  }
   CopyMem (Buffer, RxPtr, RxLen);
 
   if (DestAddr != NULL) {
@@ -161,25 +261,42 @@ VirtioNetReceive (
   }
   RxPtr += sizeof (UINT16);
 
+  ++Dev->RxStats.Packets;
+  Dev->RxStats.Bytes += RxLen;
   Status = EFI_SUCCESS;
 
 RecycleDesc:
-  ++Dev->RxLastUsed;
+  if (EFI_ERROR (Status)) {
+    ++Dev->RxStats.Dropped;
+  }
 
   //
   // virtio-0.9.5, 2.4.1 Supplying Buffers to The Device
   //
   AvailIdx = *Dev->RxRing.Avail.Idx;
-  Dev->RxRing.Avail.Ring[AvailIdx++ % Dev->RxRing.QueueSize] =
-    (UINT16) DescIdx;
+  while (Recycle > 0) {
+    UsedElemIdx = Dev->RxLastUsed++ % Dev->RxRing.QueueSize;
+    Dev->RxRing.Avail.Ring[AvailIdx++ % Dev->RxRing.QueueSize] =
+      (UINT16) Dev->RxRing.Used.UsedElem[UsedElemIdx].Id;
+    ++Dev->RxUnkicked;
+    --Recycle;
+  }
 
   MemoryFence ();
   *Dev->RxRing.Avail.Idx = AvailIdx;
 
-  MemoryFence ();
-  NotifyStatus = Dev->VirtIo->SetQueueNotify (Dev->VirtIo, VIRTIO_NET_Q_RX);
-  if (!EFI_ERROR (Status)) { // earlier error takes precedence
-    Status = NotifyStatus;
+  //
+  // The host picks up returned buffers on its own as long as it has some
+  // left. Notify it only once per batch; VirtioNetReceive() flushes the rest
+  // when it finds the used ring empty.
+  //
+  if (Dev->RxUnkicked >= VNET_RX_KICK_BATCH) {
+    Dev->RxUnkicked = 0;
+    NotifyStatus = VirtioNetKick (Dev, &Dev->RxRing, VIRTIO_NET_Q_RX,
+                     &Dev->RxStats);
+    if (!EFI_ERROR (Status)) { // earlier error takes precedence
+      Status = NotifyStatus;
+    }
   }
 
 Exit:
@@ -14,6 +14,7 @@
 
 **/
 
+#include <Library/BaseLib.h>
 #include <Library/MemoryAllocationLib.h>
 
 #include "VirtioNet.h"
@@ -51,3 +52,46 @@ VirtioNetShutdownTx (
 {
   FreePool (Dev->TxFreeStack);
 }
+
+
+/**
+  Notify the host about new buffers placed in the available ring of a virtio
+  queue, unless the host has asked not to be notified.
+
+  This function is only callable in the EfiSimpleNetworkInitialized state, by
+  the SNP methods that supply buffers to the device.
+
+  @param[in,out] Dev       The VNET_DEV driver instance.
+  @param[in]     Ring      The virtio ring whose available index has just been
+                           updated.
+  @param[in]     Selector  Identifies the virtio queue corresponding to Ring.
+  @param[in,out] Stats     The counters of the queue to account the
+                           notification (or its suppression) in.
+
+  @return  Status codes from VirtIo->SetQueueNotify().
+*/
+
+EFI_STATUS
+EFIAPI
+VirtioNetKick (
+  IN OUT VNET_DEV         *Dev,
+  IN     VRING            *Ring,
+  IN     UINT16           Selector,
+  IN OUT VNET_QUEUE_STATS *Stats
+  )
+{
+  //
+  // virtio-0.9.5, 2.4.1.4 Notifying the Device: the available index must be
+  // visible to the host before we look at its notification flag. While the
+  // host is processing the queue anyway, it sets VRING_USED_F_NO_NOTIFY, and
+  // the expensive VM exit can be saved.
+  //
+  MemoryFence ();
+  if ((*Ring->Used.Flags & VRING_USED_F_NO_NOTIFY) != 0) {
+    ++Stats->KicksSuppressed;
+    return EFI_SUCCESS;
+  }
+
+  ++Stats->Kicks;
+  return Dev->VirtIo->SetQueueNotify (Dev->VirtIo, Selector);
+}
@@ -63,6 +63,14 @@ VirtioNetShutdown (
     break;
   }
 
+  DEBUG ((EFI_D_INFO,
+    "%a: RX packets=%Ld dropped=%Ld kicks=%Ld suppressed=%Ld\n",
+    __FUNCTION__, Dev->RxStats.Packets, Dev->RxStats.Dropped,
+    Dev->RxStats.Kicks, Dev->RxStats.KicksSuppressed));
+  DEBUG ((EFI_D_INFO, "%a: TX packets=%Ld kicks=%Ld suppressed=%Ld\n",
+    __FUNCTION__, Dev->TxStats.Packets, Dev->TxStats.Kicks,
+    Dev->TxStats.KicksSuppressed));
+
   Dev->VirtIo->SetDeviceStatus (Dev->VirtIo, 0);
   VirtioNetShutdownRx (Dev);
   VirtioNetShutdownTx (Dev);
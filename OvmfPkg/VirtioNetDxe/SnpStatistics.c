@@ -0,0 +1,117 @@
+/** @file
+
+  Implementation of the SNP.Statistics() function.
+
+  Copyright (c) 2015, Intel Corporation. All rights reserved.<BR>
+
+  This program and the accompanying materials are licensed and made available
+  under the terms and conditions of the BSD License which accompanies this
+  distribution. The full text of the license may be found at
+  http://opensource.org/licenses/bsd-license.php
+
+  THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS, WITHOUT
+  WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+**/
+
+#include <Library/BaseMemoryLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+
+#include "VirtioNet.h"
+
+/**
+  Resets or collects the statistics on a network interface.
+
+  @param  This            Protocol instance pointer.
+  @param  Reset           Set to TRUE to reset the statistics for the network
+                          interface.
+  @param  StatisticsSize  On input the size, in bytes, of StatisticsTable. On
+                          output the size, in bytes, of the resulting table of
+                          statistics.
+  @param  StatisticsTable A pointer to the EFI_NETWORK_STATISTICS structure
+                          that contains the statistics.
+
+  @retval EFI_SUCCESS           The statistics were collected from the network
+                                interface.
+  @retval EFI_NOT_STARTED       The network interface has not been started.
+  @retval EFI_BUFFER_TOO_SMALL  The Statistics buffer was too small. The
+                                current buffer size needed to hold the
+                                statistics is returned in StatisticsSize.
+  @retval EFI_INVALID_PARAMETER One or more of the parameters has an
+                                unsupported value.
+  @retval EFI_DEVICE_ERROR      The command could not be sent to the network
+                                interface.
+  @retval EFI_UNSUPPORTED       This function is not supported by the network
+                                interface.
+
+**/
+
+EFI_STATUS
+EFIAPI
+VirtioNetStatistics (
+  IN EFI_SIMPLE_NETWORK_PROTOCOL *This,
+  IN BOOLEAN                     Reset,
+  IN OUT UINTN                   *StatisticsSize   OPTIONAL,
+  OUT EFI_NETWORK_STATISTICS     *StatisticsTable  OPTIONAL
+  )
+{
+  VNET_DEV               *Dev;
+  EFI_TPL                OldTpl;
+  EFI_STATUS             Status;
+  EFI_NETWORK_STATISTICS Stats;
+
+  if (This == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Dev = VIRTIO_NET_FROM_SNP (This);
+  OldTpl = gBS->RaiseTPL (TPL_CALLBACK);
+  switch (Dev->Snm.State) {
+  case EfiSimpleNetworkStopped:
+    Status = EFI_NOT_STARTED;
+    goto Exit;
+  case EfiSimpleNetworkStarted:
+    Status = EFI_DEVICE_ERROR;
+    goto Exit;
+  default:
+    break;
+  }
+
+  if (StatisticsSize == NULL) {
+    if (StatisticsTable != NULL) {
+      Status = EFI_INVALID_PARAMETER;
+      goto Exit;
+    }
+  } else {
+    if (*StatisticsSize < sizeof Stats || StatisticsTable == NULL) {
+      *StatisticsSize = sizeof Stats;
+      Status = EFI_BUFFER_TOO_SMALL;
+      goto Exit;
+    }
+
+    //
+    // Statistics that we don't track must be set to all bits one.
+    //
+    SetMem (&Stats, sizeof Stats, 0xFF);
+    Stats.RxTotalFrames   = Dev->RxStats.Packets + Dev->RxStats.Dropped;
+    Stats.RxGoodFrames    = Dev->RxStats.Packets;
+    Stats.RxDroppedFrames = Dev->RxStats.Dropped;
+    Stats.RxTotalBytes    = Dev->RxStats.Bytes;
+    Stats.TxTotalFrames   = Dev->TxStats.Packets;
+    Stats.TxGoodFrames    = Dev->TxStats.Packets;
+    Stats.TxTotalBytes    = Dev->TxStats.Bytes;
+
+    *StatisticsSize = sizeof Stats;
+    CopyMem (StatisticsTable, &Stats, sizeof Stats);
+  }
+
+  if (Reset) {
+    ZeroMem (&Dev->RxStats, sizeof Dev->RxStats);
+    ZeroMem (&Dev->TxStats, sizeof Dev->TxStats);
+  }
+  Status = EFI_SUCCESS;
+
+Exit:
+  gBS->RestoreTPL (OldTpl);
+  return Status;
+}
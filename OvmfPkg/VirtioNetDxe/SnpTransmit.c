@@ -160,8 +160,14 @@ VirtioNetTransmit (
   MemoryFence ();
   *Dev->TxRing.Avail.Idx = AvailIdx;
 
-  MemoryFence ();
-  Status = Dev->VirtIo->SetQueueNotify (Dev->VirtIo, VIRTIO_NET_Q_TX);
+  ++Dev->TxStats.Packets;
+  Dev->TxStats.Bytes += BufferSize;
+
+  //
+  // Back-to-back transmissions are batched by the host: while it is still
+  // working through the queue, it suppresses further notifications.
+  //
+  Status = VirtioNetKick (Dev, &Dev->TxRing, VIRTIO_NET_Q_TX, &Dev->TxStats);
 
 Exit:
   gBS->RestoreTPL (OldTpl);
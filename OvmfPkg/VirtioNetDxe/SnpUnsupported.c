@@ -82,46 +82,6 @@ VirtioNetStationAddress (
 }
 
 
-/**
-  Resets or collects the statistics on a network interface.
-
-  @param  This            Protocol instance pointer.
-  @param  Reset           Set to TRUE to reset the statistics for the network
-                          interface.
-  @param  StatisticsSize  On input the size, in bytes, of StatisticsTable. On
-                          output the size, in bytes, of the resulting table of
-                          statistics.
-  @param  StatisticsTable A pointer to the EFI_NETWORK_STATISTICS structure
-                          that contains the statistics.
-
-  @retval EFI_SUCCESS           The statistics were collected from the network
-                                interface.
-  @retval EFI_NOT_STARTED       The network interface has not been started.
-  @retval EFI_BUFFER_TOO_SMALL  The Statistics buffer was too small. The
-                                current buffer size needed to hold the
-                                statistics is returned in StatisticsSize.
-  @retval EFI_INVALID_PARAMETER One or more of the parameters has an
-                                unsupported value.
-  @retval EFI_DEVICE_ERROR      The command could not be sent to the network
-                                interface.
-  @retval EFI_UNSUPPORTED       This function is not supported by the network
-                                interface.
-
-**/
-
-EFI_STATUS
-EFIAPI
-VirtioNetStatistics (
-  IN EFI_SIMPLE_NETWORK_PROTOCOL *This,
-  IN BOOLEAN                     Reset,
-  IN OUT UINTN                   *StatisticsSize   OPTIONAL,
-  OUT EFI_NETWORK_STATISTICS     *StatisticsTable  OPTIONAL
-  )
-{
-  return EFI_UNSUPPORTED;
-}
-
-
 /**
   Performs read and write operations on the NVRAM device attached to a  network
   interface.
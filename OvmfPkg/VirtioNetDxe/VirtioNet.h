@@ -31,7 +31,26 @@
 //
 // maximum number of pending packets, separately for each direction
 //
-#define VNET_MAX_PENDING 64
+#define VNET_MAX_PENDING    64
+#define VNET_MAX_RX_PENDING 256
+
+//
+// minimum number of RX buffers to return to the host before notifying it,
+// unless the receive queue runs dry first
+//
+#define VNET_RX_KICK_BATCH 8
+
+//
+// per-queue counters, reported by SNP.Statistics() and dumped on
+// SNP.Shutdown()
+//
+typedef struct {
+  UINT64 Packets;
+  UINT64 Bytes;
+  UINT64 Dropped;
+  UINT64 Kicks;
+  UINT64 KicksSuppressed;
+} VNET_QUEUE_STATS;
 
 //
 // State diagram:
@@ -81,16 +100,22 @@ typedef struct {
   EFI_DEVICE_PATH_PROTOCOL    *MacDevicePath;    // VirtioNetDriverBindingStart
   EFI_HANDLE                  MacHandle;         // VirtioNetDriverBindingStart
 
+  UINT32                      Features;          // VirtioNetInitialize
+  UINT16                      HdrSize;           // VirtioNetInitialize
+
   VRING                       RxRing;            // VirtioNetInitRing
   UINT8                       *RxBuf;            // VirtioNetInitRx
   UINT16                      RxLastUsed;        // VirtioNetInitRx
+  UINT16                      RxUnkicked;        // VirtioNetInitRx
+  VNET_QUEUE_STATS            RxStats;           // VirtioNetInitRx
 
   VRING                       TxRing;            // VirtioNetInitRing
   UINT16                      TxMaxPending;      // VirtioNetInitTx
   UINT16                      TxCurPending;      // VirtioNetInitTx
   UINT16                      *TxFreeStack;      // VirtioNetInitTx
-  VIRTIO_NET_REQ              TxSharedReq;       // VirtioNetInitTx
+  VIRTIO_NET_MRG_REQ          TxSharedReq;       // VirtioNetInitTx
   UINT16                      TxLastUsed;        // VirtioNetInitTx
+  VNET_QUEUE_STATS            TxStats;           // VirtioNetInitTx
 } VNET_DEV;
 
 
@@ -263,6 +288,15 @@ VirtioNetShutdownTx (
   IN OUT VNET_DEV *Dev
   );
 
+EFI_STATUS
+EFIAPI
+VirtioNetKick (
+  IN OUT VNET_DEV         *Dev,
+  IN     VRING            *Ring,
+  IN     UINT16           Selector,
+  IN OUT VNET_QUEUE_STATS *Stats
+  );
+
 //
 // event callbacks
 //
@@ -41,6 +41,14 @@ UINT8                               *mImageBase       = NULL;
 UINT8                               mImageDigest[MAX_DIGEST_SIZE];
 UINTN                               mImageDigestSize;
 
+//
+// Digests of the current PE/COFF image already calculated, one for each hash
+// algorithm, so that the image isn't hashed again for every certificate or
+// database checked with the same algorithm.
+//
+UINT8                               mImageDigestCache[HASHALG_MAX][MAX_DIGEST_SIZE];
+BOOLEAN                             mImageDigestCached[HASHALG_MAX];
+
 //
 // Notify string for authorization UI.
 //
@@ -340,6 +348,11 @@ HashPeImage (
     return FALSE;
   }
 
+  if (mImageDigestCached[HashAlg]) {
+    CopyMem (mImageDigest, mImageDigestCache[HashAlg], mImageDigestSize);
+    return TRUE;
+  }
+
   CtxSize   = mHash[HashAlg].GetContextSize();
 
   HashCtx = AllocatePool (CtxSize);
@@ -597,6 +610,10 @@ HashPeImage (
   }
 
   Status  = mHash[HashAlg].HashFinal(HashCtx, mImageDigest);
+  if (Status) {
+    CopyMem (mImageDigestCache[HashAlg], mImageDigest, mImageDigestSize);
+    mImageDigestCached[HashAlg] = TRUE;
+  }
 
 Done:
   if (HashCtx != NULL) {
@@ -1648,6 +1665,7 @@ DxeImageVerificationHandler (
 
   mImageBase  = (UINT8 *) FileBuffer;
   mImageSize  = FileSize;
+  ZeroMem (mImageDigestCached, sizeof (mImageDigestCached));
 
   ZeroMem (&ImageContext, sizeof (ImageContext));
   ImageContext.Handle    = (VOID *) FileBuffer;
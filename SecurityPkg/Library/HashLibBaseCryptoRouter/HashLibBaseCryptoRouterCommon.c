@@ -18,9 +18,15 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #include <Library/Tpm2CommandLib.h>
 #include <Library/DebugLib.h>
 #include <Library/MemoryAllocationLib.h>
+#include <Library/TimerLib.h>
 #include <Library/HashLib.h>
 #include <Protocol/TrEEProtocol.h>
 
+#include "HashLibBaseCryptoRouterCommon.h"
+
+EFI_GUID mHashLibPeiRouterGuid = HASH_LIB_PEI_ROUTER_GUID;
+EFI_GUID mHashLibPeiRouterStatisticsGuid = HASH_LIB_PEI_ROUTER_STATISTICS_GUID;
+
 typedef struct {
   EFI_GUID  Guid;
   UINT32    Mask;
@@ -75,3 +81,97 @@ Tpm2SetHashToDigestList (
     );
   DigestList->count ++;
 }
+
+/**
+  Get the time elapsed since a performance counter value.
+
+  @param StartTick  The performance counter value at the start.
+
+  @return The elapsed time in nanoseconds.
+**/
+UINT64
+InternalHashGetElapsedTime (
+  IN UINT64  StartTick
+  )
+{
+  UINT64  EndTick;
+  UINT64  StartValue;
+  UINT64  EndValue;
+  UINT64  Ticks;
+
+  EndTick = GetPerformanceCounter ();
+  GetPerformanceCounterProperties (&StartValue, &EndValue);
+
+  if (StartValue < EndValue) {
+    if (EndTick >= StartTick) {
+      Ticks = EndTick - StartTick;
+    } else {
+      Ticks = (EndValue - StartTick) + (EndTick - StartValue);
+    }
+  } else {
+    if (StartTick >= EndTick) {
+      Ticks = StartTick - EndTick;
+    } else {
+      Ticks = (StartValue - EndTick) + (StartTick - EndValue);
+    }
+  }
+
+  return GetTimeInNanoSecond (Ticks);
+}
+
+/**
+  Update the hash sequence of every hash interface with the data.
+
+  The data is processed in chunks of HASH_UPDATE_CHUNK_SIZE, so that all the
+  digests are computed in one pass over the data.
+
+  @param HashInterface      Hash interfaces.
+  @param HashInterfaceCount Number of hash interfaces.
+  @param HashCtx            Hash contexts, one for each hash interface.
+  @param DataToHash         Data to be hashed.
+  @param DataToHashLen      Data size.
+  @param Statistics         Statistics to account the data and time to.
+**/
+VOID
+EFIAPI
+InternalHashUpdateInterfaces (
+  IN     HASH_INTERFACE   *HashInterface,
+  IN     UINTN            HashInterfaceCount,
+  IN     HASH_HANDLE      *HashCtx,
+  IN     VOID             *DataToHash,
+  IN     UINTN            DataToHashLen,
+  IN OUT HASH_STATISTICS  *Statistics
+  )
+{
+  UINT8   *Data;
+  UINTN   Size;
+  UINTN   Index;
+  UINT64  StartTick;
+
+  if (DataToHashLen == 0) {
+    return;
+  }
+
+  StartTick = GetPerformanceCounter ();
+  Data      = (UINT8 *) DataToHash;
+
+  Statistics->HashedBytes += DataToHashLen;
+
+  //
+  // With a single interface there is nothing to share the chunk with.
+  //
+  if (HashInterfaceCount == 1) {
+    HashInterface[0].HashUpdate (HashCtx[0], Data, DataToHashLen);
+  } else {
+    while (DataToHashLen > 0) {
+      Size = MIN (DataToHashLen, HASH_UPDATE_CHUNK_SIZE);
+      for (Index = 0; Index < HashInterfaceCount; Index++) {
+        HashInterface[Index].HashUpdate (HashCtx[Index], Data, Size);
+      }
+      Data          += Size;
+      DataToHashLen -= Size;
+    }
+  }
+
+  Statistics->HashTime += InternalHashGetElapsedTime (StartTick);
+}
@@ -15,6 +15,41 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #ifndef _HASH_LIB_BASE_CRYPTO_ROUTER_COMMON_H_
 #define _HASH_LIB_BASE_CRYPTO_ROUTER_COMMON_H_
 
+#define HASH_LIB_PEI_ROUTER_GUID \
+  { 0x84681c08, 0x6873, 0x46f3, { 0x8b, 0xb7, 0xab, 0x66, 0x18, 0x95, 0xa1, 0xb3 } }
+
+#define HASH_LIB_PEI_ROUTER_STATISTICS_GUID \
+  { 0x3c1a7e5d, 0x92b4, 0x4f0e, { 0xa6, 0x1d, 0x58, 0xe2, 0x0b, 0x7c, 0x94, 0x3f } }
+
+//
+// The data is fed to the hash interfaces in chunks of this size, every
+// registered interface hashes one chunk before moving on to the next one.
+// So the data is read from memory once, and the other banks hash it from
+// the cache.
+//
+#define HASH_UPDATE_CHUNK_SIZE  SIZE_16KB
+
+typedef struct {
+  UINT64           HashedBytes;  ///< Bytes passed to HashUpdate or HashCompleteAndExtend.
+  UINT64           HashTime;     ///< Time spent hashing them, in nanoseconds.
+} HASH_STATISTICS;
+
+//
+// The PEI router keeps its registered interfaces in a GUIDed HOB.
+//
+typedef struct {
+  UINTN            HashInterfaceCount;
+  HASH_INTERFACE   HashInterface[HASH_COUNT];
+} HASH_INTERFACE_HOB;
+
+//
+// The PEI statistics are kept in a GUIDed HOB of their own, holding only the
+// HASH_STATISTICS, so that the DXE router can report them whatever the
+// architecture of PEI.
+//
+extern EFI_GUID mHashLibPeiRouterGuid;
+extern EFI_GUID mHashLibPeiRouterStatisticsGuid;
+
 /**
   The function get hash mask info from algorithm.
 
@@ -41,4 +76,28 @@ Tpm2SetHashToDigestList (
   IN TPML_DIGEST_VALUES     *Digest
   );
 
+/**
+  Update the hash sequence of every hash interface with the data.
+
+  The data is processed in chunks of HASH_UPDATE_CHUNK_SIZE, so that all the
+  digests are computed in one pass over the data.
+
+  @param HashInterface      Hash interfaces.
+  @param HashInterfaceCount Number of hash interfaces.
+  @param HashCtx            Hash contexts, one for each hash interface.
+  @param DataToHash         Data to be hashed.
+  @param DataToHashLen      Data size.
+  @param Statistics         Statistics to account the data and time to.
+**/
+VOID
+EFIAPI
+InternalHashUpdateInterfaces (
+  IN     HASH_INTERFACE   *HashInterface,
+  IN     UINTN            HashInterfaceCount,
+  IN     HASH_HANDLE      *HashCtx,
+  IN     VOID             *DataToHash,
+  IN     UINTN            DataToHashLen,
+  IN OUT HASH_STATISTICS  *Statistics
+  );
+
 #endif
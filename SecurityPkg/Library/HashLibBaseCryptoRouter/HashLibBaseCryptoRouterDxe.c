@@ -21,13 +21,19 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #include <Library/DebugLib.h>
 #include <Library/MemoryAllocationLib.h>
 #include <Library/PcdLib.h>
+#include <Library/HobLib.h>
+#include <Library/UefiBootServicesTableLib.h>
 #include <Library/HashLib.h>
+#include <Protocol/SmmBase2.h>
 
 #include "HashLibBaseCryptoRouterCommon.h"
 
 HASH_INTERFACE   mHashInterface[HASH_COUNT] = {{{0}, NULL, NULL, NULL}};
 UINTN            mHashInterfaceCount = 0;
 
+HASH_STATISTICS  mHashStatistics;
+EFI_EVENT        mHashExitBootServicesEvent = NULL;
+
 /**
   Start hash sequence.
 
@@ -79,7 +85,6 @@ HashUpdate (
   )
 {
   HASH_HANDLE  *HashCtx;
-  UINTN        Index;
 
   if (mHashInterfaceCount == 0) {
     return EFI_UNSUPPORTED;
@@ -87,9 +92,14 @@ HashUpdate (
 
   HashCtx = (HASH_HANDLE *)HashHandle;
 
-  for (Index = 0; Index < mHashInterfaceCount; Index++) {
-    mHashInterface[Index].HashUpdate (HashCtx[Index], DataToHash, DataToHashLen);
-  }
+  InternalHashUpdateInterfaces (
+    mHashInterface,
+    mHashInterfaceCount,
+    HashCtx,
+    DataToHash,
+    DataToHashLen,
+    &mHashStatistics
+    );
 
   return EFI_SUCCESS;
 }
@@ -127,8 +137,16 @@ HashCompleteAndExtend (
   HashCtx = (HASH_HANDLE *)HashHandle;
   ZeroMem (DigestList, sizeof(*DigestList));
 
+  InternalHashUpdateInterfaces (
+    mHashInterface,
+    mHashInterfaceCount,
+    HashCtx,
+    DataToHash,
+    DataToHashLen,
+    &mHashStatistics
+    );
+
   for (Index = 0; Index < mHashInterfaceCount; Index++) {
-    mHashInterface[Index].HashUpdate (HashCtx[Index], DataToHash, DataToHashLen);
     mHashInterface[Index].HashFinal (HashCtx[Index], &Digest);
     Tpm2SetHashToDigestList (DigestList, &Digest);
   }
@@ -217,5 +235,109 @@ RegisterHashInterfaceLib (
   CopyMem (&mHashInterface[mHashInterfaceCount], HashInterface, sizeof(*HashInterface));
   mHashInterfaceCount ++;
   
+  return EFI_SUCCESS;
+}
+
+/**
+  Report the bytes hashed and the time spent hashing them in this boot,
+  in PEI and by this module.
+
+  @param[in]  Event     Event whose notification function is being invoked.
+  @param[in]  Context   Pointer to the notification function's context.
+**/
+VOID
+EFIAPI
+HashLibReportStatistics (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  EFI_HOB_GUID_TYPE  *GuidHob;
+  HASH_STATISTICS    *PeiStatistics;
+
+  GuidHob = GetFirstGuidHob (&mHashLibPeiRouterStatisticsGuid);
+  if (GuidHob != NULL) {
+    PeiStatistics = (HASH_STATISTICS *) GET_GUID_HOB_DATA (GuidHob);
+    DEBUG ((
+      EFI_D_INFO,
+      "HashLib: PEI hashed %ld bytes in %ld us\n",
+      PeiStatistics->HashedBytes,
+      DivU64x32 (PeiStatistics->HashTime, 1000)
+      ));
+  }
+
+  DEBUG ((
+    EFI_D_INFO,
+    "HashLib: %a hashed %ld bytes in %ld us with %d hash interfaces\n",
+    gEfiCallerBaseName,
+    mHashStatistics.HashedBytes,
+    DivU64x32 (mHashStatistics.HashTime, 1000),
+    (UINT32) mHashInterfaceCount
+    ));
+}
+
+/**
+  The constructor function registers the report of the hashing statistics
+  at ExitBootServices. SMM drivers don't get the event, so nothing is
+  registered when the library is linked to one.
+
+  @param  ImageHandle   The firmware allocated handle for the EFI image.
+  @param  SystemTable   A pointer to the EFI System Table.
+
+  @retval EFI_SUCCESS   The constructor always returns EFI_SUCCESS.
+**/
+EFI_STATUS
+EFIAPI
+HashLibBaseCryptoRouterDxeConstructor (
+  IN EFI_HANDLE        ImageHandle,
+  IN EFI_SYSTEM_TABLE  *SystemTable
+  )
+{
+  EFI_STATUS                 Status;
+  EFI_SMM_BASE2_PROTOCOL     *SmmBase2;
+  BOOLEAN                    InSmm;
+
+  Status = gBS->LocateProtocol (&gEfiSmmBase2ProtocolGuid, NULL, (VOID **) &SmmBase2);
+  if (!EFI_ERROR (Status)) {
+    Status = SmmBase2->InSmm (SmmBase2, &InSmm);
+    if (!EFI_ERROR (Status) && InSmm) {
+      return EFI_SUCCESS;
+    }
+  }
+
+  Status = gBS->CreateEvent (
+                  EVT_SIGNAL_EXIT_BOOT_SERVICES,
+                  TPL_CALLBACK,
+                  HashLibReportStatistics,
+                  NULL,
+                  &mHashExitBootServicesEvent
+                  );
+  if (EFI_ERROR (Status)) {
+    mHashExitBootServicesEvent = NULL;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  The destructor function closes the ExitBootServices event, as the module
+  is being unloaded.
+
+  @param  ImageHandle   The firmware allocated handle for the EFI image.
+  @param  SystemTable   A pointer to the EFI System Table.
+
+  @retval EFI_SUCCESS   The destructor always returns EFI_SUCCESS.
+**/
+EFI_STATUS
+EFIAPI
+HashLibBaseCryptoRouterDxeDestructor (
+  IN EFI_HANDLE        ImageHandle,
+  IN EFI_SYSTEM_TABLE  *SystemTable
+  )
+{
+  if (mHashExitBootServicesEvent != NULL) {
+    gBS->CloseEvent (mHashExitBootServicesEvent);
+  }
+
   return EFI_SUCCESS;
 }
\ No newline at end of file
@@ -26,16 +26,6 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 
 #include "HashLibBaseCryptoRouterCommon.h"
 
-#define HASH_LIB_PEI_ROUTER_GUID \
-  { 0x84681c08, 0x6873, 0x46f3, { 0x8b, 0xb7, 0xab, 0x66, 0x18, 0x95, 0xa1, 0xb3 } }
-
-EFI_GUID mHashLibPeiRouterGuid = HASH_LIB_PEI_ROUTER_GUID;
-
-typedef struct {
-  UINTN            HashInterfaceCount;
-  HASH_INTERFACE   HashInterface[HASH_COUNT];
-} HASH_INTERFACE_HOB;
-
 /**
   This function get hash interface.
 
@@ -55,6 +45,26 @@ InternalGetHashInterface (
   return (HASH_INTERFACE_HOB *)(Hob + 1);
 }
 
+/**
+  This function get the hashing statistics.
+
+  The statistics HOB is built with the hash interface HOB, so it exists as
+  soon as a hash interface is registered.
+
+  @retval hashing statistics.
+**/
+HASH_STATISTICS *
+InternalGetHashStatistics (
+  VOID
+  )
+{
+  EFI_HOB_GUID_TYPE *Hob;
+
+  Hob = GetFirstGuidHob (&mHashLibPeiRouterStatisticsGuid);
+  ASSERT (Hob != NULL);
+  return (HASH_STATISTICS *)(Hob + 1);
+}
+
 /**
   Start hash sequence.
 
@@ -113,7 +123,6 @@ HashUpdate (
 {
   HASH_INTERFACE_HOB *HashInterfaceHob;
   HASH_HANDLE        *HashCtx;
-  UINTN              Index;
 
   HashInterfaceHob = InternalGetHashInterface ();
   if (HashInterfaceHob == NULL) {
@@ -126,9 +135,14 @@ HashUpdate (
 
   HashCtx = (HASH_HANDLE *)HashHandle;
 
-  for (Index = 0; Index < HashInterfaceHob->HashInterfaceCount; Index++) {
-    HashInterfaceHob->HashInterface[Index].HashUpdate (HashCtx[Index], DataToHash, DataToHashLen);
-  }
+  InternalHashUpdateInterfaces (
+    HashInterfaceHob->HashInterface,
+    HashInterfaceHob->HashInterfaceCount,
+    HashCtx,
+    DataToHash,
+    DataToHashLen,
+    InternalGetHashStatistics ()
+    );
 
   return EFI_SUCCESS;
 }
@@ -172,8 +186,16 @@ HashCompleteAndExtend (
   HashCtx = (HASH_HANDLE *)HashHandle;
   ZeroMem (DigestList, sizeof(*DigestList));
 
+  InternalHashUpdateInterfaces (
+    HashInterfaceHob->HashInterface,
+    HashInterfaceHob->HashInterfaceCount,
+    HashCtx,
+    DataToHash,
+    DataToHashLen,
+    InternalGetHashStatistics ()
+    );
+
   for (Index = 0; Index < HashInterfaceHob->HashInterfaceCount; Index++) {
-    HashInterfaceHob->HashInterface[Index].HashUpdate (HashCtx[Index], DataToHash, DataToHashLen);
     HashInterfaceHob->HashInterface[Index].HashFinal (HashCtx[Index], &Digest);
     Tpm2SetHashToDigestList (DigestList, &Digest);
   }
@@ -244,6 +266,7 @@ RegisterHashInterfaceLib (
   UINTN              Index;
   HASH_INTERFACE_HOB *HashInterfaceHob;
   HASH_INTERFACE_HOB LocalHashInterfaceHob;
+  HASH_STATISTICS    LocalHashStatistics;
   UINT32             HashMask;
 
   //
@@ -261,6 +284,10 @@ RegisterHashInterfaceLib (
     if (HashInterfaceHob == NULL) {
       return EFI_OUT_OF_RESOURCES;
     }
+    ZeroMem (&LocalHashStatistics, sizeof(LocalHashStatistics));
+    if (BuildGuidDataHob (&mHashLibPeiRouterStatisticsGuid, &LocalHashStatistics, sizeof(LocalHashStatistics)) == NULL) {
+      return EFI_OUT_OF_RESOURCES;
+    }
   }
 
   if (HashInterfaceHob->HashInterfaceCount >= HASH_COUNT) {